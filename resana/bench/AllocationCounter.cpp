@@ -0,0 +1,89 @@
+#include "AllocationCounter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace RESANA {
+
+static std::atomic<uint64_t> sAllocations{0};
+
+uint64_t GetAllocationCount() {
+  return sAllocations.load(std::memory_order_relaxed);
+}
+
+static void *CountedAlloc(std::size_t size) {
+  sAllocations.fetch_add(1, std::memory_order_relaxed);
+  if (void *ptr = std::malloc(size ? size : 1)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+static void *CountedAlignedAlloc(std::size_t size, std::align_val_t align) {
+  sAllocations.fetch_add(1, std::memory_order_relaxed);
+#ifdef _MSC_VER
+  void *ptr = _aligned_malloc(size ? size : 1, (std::size_t)align);
+#else
+  void *ptr = nullptr;
+  if (::posix_memalign(&ptr, std::max((std::size_t)align, sizeof(void *)),
+                       size ? size : 1) != 0) {
+    ptr = nullptr;
+  }
+#endif
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+static void CountedAlignedFree(void *ptr) {
+#ifdef _MSC_VER
+  _aligned_free(ptr);
+#else
+  std::free(ptr);
+#endif
+}
+
+} // namespace RESANA
+
+void *operator new(std::size_t size) { return RESANA::CountedAlloc(size); }
+void *operator new[](std::size_t size) { return RESANA::CountedAlloc(size); }
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+  try {
+    return RESANA::CountedAlloc(size);
+  } catch (...) {
+    return nullptr;
+  }
+}
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+  try {
+    return RESANA::CountedAlloc(size);
+  } catch (...) {
+    return nullptr;
+  }
+}
+void *operator new(std::size_t size, std::align_val_t align) {
+  return RESANA::CountedAlignedAlloc(size, align);
+}
+void *operator new[](std::size_t size, std::align_val_t align) {
+  return RESANA::CountedAlignedAlloc(size, align);
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::align_val_t) noexcept {
+  RESANA::CountedAlignedFree(ptr);
+}
+void operator delete[](void *ptr, std::align_val_t) noexcept {
+  RESANA::CountedAlignedFree(ptr);
+}
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept {
+  RESANA::CountedAlignedFree(ptr);
+}
+void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept {
+  RESANA::CountedAlignedFree(ptr);
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstdint>
+
+namespace RESANA {
+
+// Heap allocations made through operator new by any thread since the
+// program started. The bench binary replaces the global operator new to
+// count them.
+uint64_t GetAllocationCount();
+
+} // namespace RESANA
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+namespace RESANA {
+
+// One figure reported by a benchmark
+struct BenchResult {
+  std::string Benchmark;
+  std::string Metric;
+  size_t Size{}; // What the benchmark ran at, 0 if it takes no size
+  double Value{};
+  std::string Unit;
+};
+
+class BenchState {
+public:
+  explicit BenchState(std::string name, std::vector<size_t> sizes = {})
+      : mName(std::move(name)), mSizes(std::move(sizes)) {}
+
+  // The sizes to run at: those given with --sizes, or else the defaults
+  [[nodiscard]] std::vector<size_t>
+  GetSizes(std::initializer_list<size_t> defaults) const {
+    return mSizes.empty() ? std::vector<size_t>(defaults) : mSizes;
+  }
+
+  // Figures reported from here on are at this size
+  void SetSize(size_t size) { mSize = size; }
+
+  void Report(const std::string &metric, double value,
+              const std::string &unit) {
+    mResults.push_back({mName, metric, mSize, value, unit});
+  }
+
+  // Marks the run as failed, for figures that have a hard limit. The
+  // benchmark keeps running and the bench exits with a non-zero status.
+  void Fail(const std::string &reason) { mFailures.push_back(reason); }
+
+  [[nodiscard]] const std::string &GetName() const { return mName; }
+  [[nodiscard]] const std::vector<BenchResult> &GetResults() const {
+    return mResults;
+  }
+  [[nodiscard]] const std::vector<std::string> &GetFailures() const {
+    return mFailures;
+  }
+
+private:
+  std::string mName;
+  std::vector<size_t> mSizes{};
+  size_t mSize{};
+  std::vector<BenchResult> mResults{};
+  std::vector<std::string> mFailures{};
+};
+
+using BenchmarkFn = void (*)(BenchState &state);
+
+bool RegisterBenchmark(const char *name, BenchmarkFn fn);
+
+// Monotonic time in nanoseconds
+inline uint64_t BenchNow() {
+  return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Average nanoseconds per call of fn over the given number of iterations
+template <typename Fn> double MeasureNs(Fn &&fn, size_t iterations) {
+  const uint64_t start = BenchNow();
+  for (size_t i = 0; i < iterations; ++i) {
+    fn();
+  }
+  return (double)(BenchNow() - start) / (double)(iterations ? iterations : 1);
+}
+
+// Keeps the compiler from optimizing a computed value away
+template <typename T> inline void DoNotOptimize(const T &value) {
+#ifdef _MSC_VER
+  static const void *volatile sSink = nullptr;
+  sSink = &value;
+#else
+  asm volatile("" : : "r,m"(value) : "memory");
+#endif
+}
+
+} // namespace RESANA
+
+#define RS_BENCHMARK(name)                                                     \
+  static void name(::RESANA::BenchState &state);                              \
+  static const bool name##Registered =                                         \
+      ::RESANA::RegisterBenchmark(#name, name);                                \
+  static void name(::RESANA::BenchState &state)
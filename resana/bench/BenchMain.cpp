@@ -0,0 +1,139 @@
+#include "Bench.h"
+
+#include "core/Log.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace RESANA {
+
+struct BenchmarkEntry {
+  const char *Name;
+  BenchmarkFn Fn;
+};
+
+static std::vector<BenchmarkEntry> &GetBenchmarks() {
+  static std::vector<BenchmarkEntry> sBenchmarks;
+  return sBenchmarks;
+}
+
+bool RegisterBenchmark(const char *name, BenchmarkFn fn) {
+  GetBenchmarks().push_back({name, fn});
+  return true;
+}
+
+// "1000,10000" to {1000, 10000}; false if any of it is not a size
+static bool ParseSizes(const char *text, std::vector<size_t> &sizes) {
+  while (*text) {
+    char *end = nullptr;
+    const auto size = (size_t)std::strtoull(text, &end, 10);
+    if (end == text || size == 0 || (*end && *end != ',')) {
+      return false;
+    }
+    sizes.push_back(size);
+    text = *end ? end + 1 : end;
+  }
+  return !sizes.empty();
+}
+
+static void PrintJsonString(const std::string &text) {
+  std::putchar('"');
+  for (const char c : text) {
+    if (c == '"' || c == '\\') {
+      std::putchar('\\');
+    }
+    std::putchar(c);
+  }
+  std::putchar('"');
+}
+
+static void PrintJsonResult(const BenchResult &result, bool first) {
+  std::printf("%s\n    {\"benchmark\": ", first ? "" : ",");
+  PrintJsonString(result.Benchmark);
+  std::printf(", \"metric\": ");
+  PrintJsonString(result.Metric);
+  if (result.Size) {
+    std::printf(", \"size\": %zu", result.Size);
+  }
+  // JSON has no NaN or infinity
+  if (std::isfinite(result.Value)) {
+    std::printf(", \"value\": %.6g", result.Value);
+  } else {
+    std::printf(", \"value\": null");
+  }
+  std::printf(", \"unit\": ");
+  PrintJsonString(result.Unit);
+  std::printf("}");
+}
+
+} // namespace RESANA
+
+// Usage: resana_bench [--json] [--sizes <n,n,...>] [name filter]
+//
+// --json writes the results as one JSON object to stdout, to be kept and
+// compared between releases; logs go to stderr either way. --sizes runs the
+// benchmarks that take a size at the given ones instead of their defaults.
+// The exit status is 1 if a benchmark failed one of its limits.
+int main(int argc, char **argv) {
+  using namespace RESANA;
+
+  const char *filter = nullptr;
+  bool json = false;
+  std::vector<size_t> sizes;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--json") == 0) {
+      json = true;
+    } else if (std::strcmp(argv[i], "--sizes") == 0 && i + 1 < argc &&
+               ParseSizes(argv[i + 1], sizes)) {
+      ++i;
+    } else if (argv[i][0] != '-' && !filter) {
+      filter = argv[i];
+    } else {
+      std::fprintf(stderr,
+                   "usage: %s [--json] [--sizes <n,n,...>] [name filter]\n",
+                   argv[0]);
+      return 1;
+    }
+  }
+
+  Log::Init();
+
+  if (json) {
+    std::printf("{\"benchmarks\": [");
+  }
+
+  bool first = true;
+  bool failed = false;
+  for (const auto &benchmark : GetBenchmarks()) {
+    if (filter && !std::strstr(benchmark.Name, filter)) {
+      continue;
+    }
+
+    BenchState state(benchmark.Name, sizes);
+    benchmark.Fn(state);
+
+    for (const auto &result : state.GetResults()) {
+      if (json) {
+        PrintJsonResult(result, first);
+        first = false;
+      } else {
+        std::printf("%-32s %-28s %14.2f %s\n", result.Benchmark.c_str(),
+                    result.Metric.c_str(), result.Value, result.Unit.c_str());
+      }
+    }
+    std::fflush(stdout);
+
+    for (const auto &reason : state.GetFailures()) {
+      std::fprintf(stderr, "%s FAILED: %s\n", benchmark.Name, reason.c_str());
+      failed = true;
+    }
+  }
+
+  if (json) {
+    std::printf("\n]}\n");
+  }
+
+  return failed ? 1 : 0;
+}
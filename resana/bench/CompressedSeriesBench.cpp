@@ -0,0 +1,161 @@
+#include "Bench.h"
+
+#include "system/history/CompressedSeries.h"
+#include "system/history/MetricSeries.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace RESANA {
+
+namespace {
+
+// A day of 1 s samples
+constexpr size_t TRACE_SAMPLES = 86400;
+
+struct Trace {
+  const char *Name;
+  SeriesEncoding Encoding;
+  std::vector<HistoryPoint> Points;
+};
+
+// Sample times as the sampler produces them: 1000 ms apart, a few
+// milliseconds late now and then
+std::vector<HistoryPoint> MakeTimes(std::mt19937 &random) {
+  std::uniform_int_distribution<int> jitter(0, 9);
+  std::vector<HistoryPoint> points(TRACE_SAMPLES);
+  for (size_t i = 0; i < points.size(); ++i) {
+    const int late = jitter(random);
+    points[i].Time = 1000 * (int64_t)i + (late > 6 ? late : 0);
+  }
+  return points;
+}
+
+std::vector<Trace> MakeTraces() {
+  std::mt19937 random(21);
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+  std::vector<Trace> traces;
+
+  // Most processes sleep: zero load with the odd spike
+  auto idle = MakeTimes(random);
+  for (auto &point : idle) {
+    point.Value = unit(random) < 0.02 ? unit(random) * 3.0 : 0.0;
+  }
+  traces.push_back({"idle process cpu", SeriesEncoding::Float, idle});
+
+  // A busy process: load drifting around its average, computed from tick
+  // counts so every value has a full mantissa
+  auto busy = MakeTimes(random);
+  double load = 40.0;
+  for (auto &point : busy) {
+    load += (unit(random) - 0.5) * 8.0 + (40.0 - load) * 0.05;
+    point.Value = std::clamp(load, 0.0, 100.0);
+  }
+  traces.push_back({"busy process cpu", SeriesEncoding::Float, busy});
+
+  // The total load, averaged over 16 cores of such processes
+  auto total = MakeTimes(random);
+  load = 20.0;
+  for (auto &point : total) {
+    load += (unit(random) - 0.5) * 2.0 + (20.0 - load) * 0.05;
+    point.Value = std::clamp(load, 0.0, 100.0);
+  }
+  traces.push_back({"cpu total", SeriesEncoding::Float, total});
+
+  // A working set in pages: flat for a while, then growing or shrinking
+  auto memory = MakeTimes(random);
+  int64_t pages = 20000;
+  for (auto &point : memory) {
+    if (unit(random) < 0.1) {
+      pages += (int64_t)((unit(random) - 0.45) * 64.0);
+    }
+    point.Value = (double)(pages * 4096);
+  }
+  traces.push_back({"process memory", SeriesEncoding::Integer, memory});
+
+  return traces;
+}
+
+} // namespace
+
+// Encodes a day of realistic samples into a series large enough to hold it
+// all. Reports bytes per sample against the 16 of a plain (time, double)
+// pair, encode and decode cost, a window read through random access by block
+// and how many samples failed to round trip.
+RS_BENCHMARK(CompressedSeries_Traces) {
+  for (const auto &trace : MakeTraces()) {
+    const std::string name = trace.Name;
+    CompressedSeries series(4 * 1024 * 1024, trace.Encoding);
+
+    const uint64_t start = BenchNow();
+    for (const auto &point : trace.Points) {
+      series.Append(point.Time, point.Value);
+    }
+    const double encodeNs =
+        (double)(BenchNow() - start) / (double)trace.Points.size();
+
+    const double bytesPerSample =
+        (double)series.GetEncodedBytes() / (double)series.GetSize();
+    state.Report(name + " size", bytesPerSample, "bytes/sample");
+    state.Report(name + " ratio", 16.0 / bytesPerSample, "x");
+    state.Report(name + " encode", encodeNs, "ns/sample");
+
+    std::vector<HistoryPoint> points;
+    points.reserve(trace.Points.size());
+    const double decodeNs = MeasureNs(
+        [&] {
+          points.clear();
+          series.Read(INT64_MIN, INT64_MAX, points);
+        },
+        20);
+    state.Report(name + " decode",
+                 (double)points.size() * 1000.0 / decodeNs, "Msamples/s");
+
+    size_t mismatches = points.size() == trace.Points.size() ? 0 : 1;
+    for (size_t i = 0; i < points.size() && i < trace.Points.size(); ++i) {
+      const double expected = trace.Encoding == SeriesEncoding::Integer
+                                  ? std::round(trace.Points[i].Value)
+                                  : trace.Points[i].Value;
+      if (points[i].Time != trace.Points[i].Time ||
+          points[i].Value != expected) {
+        ++mismatches;
+      }
+    }
+    state.Report(name + " mismatches", (double)mismatches, "samples");
+
+    // A minute from the middle of the day
+    const int64_t from = trace.Points[TRACE_SAMPLES / 2].Time;
+    const double windowNs = MeasureNs(
+        [&] {
+          points.clear();
+          series.Read(from, from + 60000, points);
+        },
+        10000);
+    state.Report(name + " 1 minute read", windowNs, "ns");
+  }
+}
+
+// The same traces in the default per series budget: how far back each
+// series reaches, against the ring of a plain series
+RS_BENCHMARK(CompressedSeries_Retention) {
+  const HistoryConfig config;
+  const auto traces = MakeTraces();
+  for (const auto &trace : traces) {
+    CompressedSeries series(config.CompressedBytes, trace.Encoding);
+    for (const auto &point : trace.Points) {
+      series.Append(point.Time, point.Value);
+    }
+
+    const auto &first = series.GetBlockHeader(0);
+    const auto &last = series.GetBlockHeader(series.GetNumBlocks() - 1);
+    state.Report(std::string(trace.Name) + " kept",
+                 (double)(last.LastTime - first.FirstTime) / 60000.0,
+                 "minutes");
+  }
+
+  const double plainMinutes = (double)config.Capacity / 60.0;
+  state.Report("plain kept", plainMinutes, "minutes");
+}
+
+} // namespace RESANA
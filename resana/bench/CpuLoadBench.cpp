@@ -0,0 +1,56 @@
+#include "Bench.h"
+#include "FakeProcTree.h"
+
+#include "system/cpu/CpuPerformance.h"
+
+#ifdef RS_PLATFORM_LINUX
+#include "platform/linux/ProcStat.h"
+
+#include <filesystem>
+#endif
+
+namespace RESANA {
+
+static constexpr size_t LOAD_CALLS = 100000;
+static constexpr size_t STAT_SAMPLES = 1000;
+
+// The load of one process from two samples of its counters, as the panels
+// ask for it, and on Linux /proc/stat read, parsed and turned into the load
+// of every core, for each core count
+RS_BENCHMARK(CpuLoad_Calculation) {
+  ProcessMetrics metrics{};
+  PdhData data{};
+  const double ns = MeasureNs(
+      [&] {
+        metrics.Time += 10000000;
+        metrics.UserTime += 2500000;
+        metrics.SystemTime += 500000;
+        DoNotOptimize(CpuPerformance::GetProcessLoad(metrics, &data));
+      },
+      LOAD_CALLS);
+  state.Report("process load", ns, "ns");
+
+#ifdef RS_PLATFORM_LINUX
+  const auto root =
+      (std::filesystem::temp_directory_path() / "resana_bench_proc").string();
+  for (const size_t cores : state.GetSizes({8, 64, 512})) {
+    state.SetSize(cores);
+    const std::string suffix = " " + std::to_string(cores);
+
+    FakeProcTree tree(root, 0, cores);
+    ProcStatReader reader(root + "/stat");
+    if (!tree.Create() || !reader.Open()) {
+      state.Report("proc stat" + suffix, -1.0, "failed");
+      continue;
+    }
+
+    const double sampleNs =
+        MeasureNs([&] { DoNotOptimize(reader.Sample()); }, STAT_SAMPLES);
+    state.Report("proc stat" + suffix, sampleNs / 1000.0, "us");
+    state.Report("proc stat per core" + suffix, sampleNs / (double)cores,
+                 "ns");
+  }
+#endif
+}
+
+} // namespace RESANA
@@ -0,0 +1,276 @@
+#include "FakeProcTree.h"
+
+#ifdef RS_PLATFORM_LINUX
+
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <filesystem>
+
+namespace RESANA {
+
+static constexpr uint64_t MEM_TOTAL_KB = 64ull * 1024 * 1024;
+static constexpr uint64_t MEM_AVAILABLE_KB = 24ull * 1024 * 1024;
+static constexpr uint64_t COMMIT_LIMIT_KB = 96ull * 1024 * 1024;
+static constexpr uint64_t COMMITTED_KB = 40ull * 1024 * 1024;
+
+// Jiffies a core spends busy per tick, spread over 0 to TICK_JIFFIES
+static uint64_t GetCoreBusy(size_t core) {
+  return (core * 37 + 11) % (FakeProcTree::TICK_JIFFIES + 1);
+}
+
+static uint64_t GetResidentPages(size_t index) { return 64 + index % 1024; }
+
+static void AppendFormat(std::string &content, const char *format, ...)
+    __attribute__((format(printf, 2, 3)));
+
+static void AppendFormat(std::string &content, const char *format, ...) {
+  char line[512];
+  va_list args;
+  va_start(args, format);
+  const int length = std::vsnprintf(line, sizeof(line), format, args);
+  va_end(args);
+  if (length > 0) {
+    content.append(line, std::min((size_t)length, sizeof(line) - 1));
+  }
+}
+
+FakeProcTree::FakeProcTree(std::string root, size_t processes, size_t cores)
+    : mRoot(std::move(root)), mProcesses(processes), mCores(cores) {}
+
+FakeProcTree::~FakeProcTree() {
+  if (mCreated) {
+    std::error_code error;
+    std::filesystem::remove_all(mRoot, error);
+  }
+}
+
+bool FakeProcTree::Create() {
+  std::error_code error;
+  std::filesystem::remove_all(mRoot, error);
+  if (!std::filesystem::create_directories(mRoot, error)) {
+    return false;
+  }
+  mCreated = true;
+  mTick = 0;
+
+  if (!WriteProcStat() || !WriteMemInfo()) {
+    return false;
+  }
+  for (size_t i = 0; i < mProcesses; ++i) {
+    if (!WriteProcess(i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool FakeProcTree::Advance() {
+  ++mTick;
+  if (!WriteProcStat()) {
+    return false;
+  }
+  for (size_t i = 0; i < mProcesses; ++i) {
+    if (!WriteProcessStat(i) || !WriteProcessIo(i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+double FakeProcTree::GetCoreLoad(size_t core) {
+  return (double)GetCoreBusy(core) * 100.0 / (double)TICK_JIFFIES;
+}
+
+double FakeProcTree::GetTotalLoad() const {
+  uint64_t busy = 0;
+  for (size_t core = 0; core < mCores; ++core) {
+    busy += GetCoreBusy(core);
+  }
+  return mCores ? (double)busy * 100.0 / (double)(TICK_JIFFIES * mCores) : 0.0;
+}
+
+uint64_t FakeProcTree::GetTotalMemory() { return MEM_TOTAL_KB * 1024; }
+
+uint64_t FakeProcTree::GetUsedMemory() {
+  return (MEM_TOTAL_KB - MEM_AVAILABLE_KB) * 1024;
+}
+
+uint32_t FakeProcTree::GetParentId(size_t index) {
+  // A tree eight wide under the first process
+  return index == 0 ? 0 : FIRST_PROCESS_ID + (uint32_t)((index - 1) / 8);
+}
+
+uint32_t FakeProcTree::GetThreadCount(size_t index) {
+  return 1 + (uint32_t)(index % 16);
+}
+
+uint64_t FakeProcTree::GetWorkingSetSize(size_t index) {
+  static const auto sPageSize = (uint64_t)::sysconf(_SC_PAGESIZE);
+  return GetResidentPages(index) * sPageSize;
+}
+
+std::string FakeProcTree::GetName(size_t index) {
+  return "proc" + std::to_string(index);
+}
+
+bool FakeProcTree::WriteFile(const char *path) {
+  // Overwritten in place, as the collectors keep the file open; a new file
+  // renamed over it would not reach them. The counters only grow, so the
+  // file is not truncated first and a reader never finds it empty, but one
+  // that reads during the write may see part of the old contents.
+  const int fd = ::open(path, O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    return false;
+  }
+
+  const ssize_t count = ::pwrite(fd, mContent.data(), mContent.size(), 0);
+  const bool truncated = ::ftruncate(fd, (off_t)mContent.size()) == 0;
+  ::close(fd);
+  return count == (ssize_t)mContent.size() && truncated;
+}
+
+bool FakeProcTree::WriteProcStat() {
+  const auto appendCore = [&](const char *name, uint64_t busy, uint64_t idle) {
+    const uint64_t user = 1000 + mTick * (busy - busy / 4);
+    const uint64_t system = 500 + mTick * (busy / 4);
+    AppendFormat(mContent, "%s %llu 0 %llu %llu 0 0 0 0 0 0\n", name,
+                 (unsigned long long)user, (unsigned long long)system,
+                 (unsigned long long)(10000 + mTick * idle));
+  };
+
+  uint64_t busy = 0;
+  for (size_t core = 0; core < mCores; ++core) {
+    busy += GetCoreBusy(core);
+  }
+
+  mContent.clear();
+  appendCore("cpu ", busy, TICK_JIFFIES * mCores - busy);
+  char name[32];
+  for (size_t core = 0; core < mCores; ++core) {
+    std::snprintf(name, sizeof(name), "cpu%zu", core);
+    appendCore(name, GetCoreBusy(core), TICK_JIFFIES - GetCoreBusy(core));
+  }
+  AppendFormat(mContent,
+               "intr 0\nctxt 0\nbtime 0\nprocesses %zu\nprocs_running 1\n"
+               "procs_blocked 0\n",
+               mProcesses);
+
+  char path[PATH_MAX];
+  std::snprintf(path, sizeof(path), "%s/stat", mRoot.c_str());
+  return WriteFile(path);
+}
+
+bool FakeProcTree::WriteMemInfo() {
+  mContent.clear();
+  AppendFormat(mContent,
+               "MemTotal:       %llu kB\nMemFree:        %llu kB\n"
+               "MemAvailable:   %llu kB\nCommitLimit:    %llu kB\n"
+               "Committed_AS:   %llu kB\n",
+               (unsigned long long)MEM_TOTAL_KB,
+               (unsigned long long)(MEM_AVAILABLE_KB / 2),
+               (unsigned long long)MEM_AVAILABLE_KB,
+               (unsigned long long)COMMIT_LIMIT_KB,
+               (unsigned long long)COMMITTED_KB);
+
+  char path[PATH_MAX];
+  std::snprintf(path, sizeof(path), "%s/meminfo", mRoot.c_str());
+  return WriteFile(path);
+}
+
+bool FakeProcTree::WriteProcess(size_t index) {
+  const uint32_t procId = FIRST_PROCESS_ID + (uint32_t)index;
+  const std::string name = GetName(index);
+
+  char path[PATH_MAX];
+  std::snprintf(path, sizeof(path), "%s/%u", mRoot.c_str(), procId);
+  if (::mkdir(path, 0755) != 0) {
+    return false;
+  }
+
+  if (!WriteProcessStat(index) || !WriteProcessIo(index)) {
+    return false;
+  }
+
+  const uint64_t resident = GetResidentPages(index);
+  mContent.clear();
+  AppendFormat(mContent, "%llu %llu %llu 1 0 %llu 0\n",
+               (unsigned long long)(resident * 4),
+               (unsigned long long)resident,
+               (unsigned long long)(resident / 4),
+               (unsigned long long)(resident * 2));
+  std::snprintf(path, sizeof(path), "%s/%u/statm", mRoot.c_str(), procId);
+  if (!WriteFile(path)) {
+    return false;
+  }
+
+  mContent.clear();
+  AppendFormat(mContent,
+               "Name:\t%s\nState:\tS (sleeping)\nTgid:\t%u\nPid:\t%u\n"
+               "PPid:\t%u\nThreads:\t%u\nVmRSS:\t%llu kB\n",
+               name.c_str(), procId, procId, GetParentId(index),
+               GetThreadCount(index),
+               (unsigned long long)(GetWorkingSetSize(index) / 1024));
+  std::snprintf(path, sizeof(path), "%s/%u/status", mRoot.c_str(), procId);
+  if (!WriteFile(path)) {
+    return false;
+  }
+
+  mContent.clear();
+  AppendFormat(mContent, "/usr/bin/%s", name.c_str());
+  mContent.push_back('\0');
+  AppendFormat(mContent, "--id=%zu", index);
+  mContent.push_back('\0');
+  std::snprintf(path, sizeof(path), "%s/%u/cmdline", mRoot.c_str(), procId);
+  return WriteFile(path);
+}
+
+bool FakeProcTree::WriteProcessStat(size_t index) {
+  const uint32_t procId = FIRST_PROCESS_ID + (uint32_t)index;
+  const uint64_t resident = GetResidentPages(index);
+  static const auto sPageSize = (uint64_t)::sysconf(_SC_PAGESIZE);
+
+  // The fields up to rss are the ones read; the rest keep the kernel's count
+  mContent.clear();
+  AppendFormat(mContent,
+               "%u (proc%zu) %c %u %u %u 0 -1 4194304 0 0 0 0 %llu %llu 0 0 20 "
+               "0 %u 0 %llu %llu %llu ",
+               procId, index, index % 7 == 0 ? 'R' : 'S', GetParentId(index),
+               procId, procId, (unsigned long long)(100 + mTick * (index % 4)),
+               (unsigned long long)(50 + mTick * (index % 2)),
+               GetThreadCount(index), (unsigned long long)(1000 + index),
+               (unsigned long long)(resident * 4 * sPageSize),
+               (unsigned long long)resident);
+  mContent += "18446744073709551615 1 1 0 0 0 0 0 0 0 0 0 0 17 0 0 0 0 0 0 0 "
+              "0 0 0 0 0 0\n";
+
+  char path[PATH_MAX];
+  std::snprintf(path, sizeof(path), "%s/%u/stat", mRoot.c_str(), procId);
+  return WriteFile(path);
+}
+
+bool FakeProcTree::WriteProcessIo(size_t index) {
+  const uint32_t procId = FIRST_PROCESS_ID + (uint32_t)index;
+  const uint64_t readBytes = mTick * 4096 * (index % 8);
+  const uint64_t writeBytes = mTick * 512 * (index % 4);
+
+  mContent.clear();
+  AppendFormat(mContent,
+               "rchar: %llu\nwchar: %llu\nsyscr: %llu\nsyscw: %llu\n"
+               "read_bytes: 0\nwrite_bytes: 0\ncancelled_write_bytes: 0\n",
+               (unsigned long long)readBytes, (unsigned long long)writeBytes,
+               (unsigned long long)(mTick * 4), (unsigned long long)mTick);
+
+  char path[PATH_MAX];
+  std::snprintf(path, sizeof(path), "%s/%u/io", mRoot.c_str(), procId);
+  return WriteFile(path);
+}
+
+} // namespace RESANA
+
+#endif
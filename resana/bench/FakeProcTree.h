@@ -0,0 +1,78 @@
+#pragma once
+
+#include "core/PlatformDetection.h"
+
+#ifdef RS_PLATFORM_LINUX
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace RESANA {
+
+// A generated procfs tree for running the Linux collectors at scales the
+// machine does not have (SystemRuntime::SetProcRoot). It holds /proc/stat for
+// a number of cores, /proc/meminfo, and stat, statm, status, io and cmdline
+// for a number of processes. Each Advance() moves the counters on by one
+// tick of a fixed size per core and per process, so the loads and figures
+// the collectors compute from it are known in advance.
+//
+// Files are rewritten in place, as the collectors keep them open between
+// samples. Advance only between two samples of a collector, not during one.
+// This process is not in the tree; the collectors read its own figures from
+// the real /proc.
+class FakeProcTree {
+public:
+  // Jiffies every core accounts for per Advance()
+  static constexpr uint64_t TICK_JIFFIES = 100;
+  static constexpr uint32_t FIRST_PROCESS_ID = 1;
+
+  FakeProcTree(std::string root, size_t processes, size_t cores);
+  // Removes the tree
+  ~FakeProcTree();
+
+  FakeProcTree(const FakeProcTree &) = delete;
+  FakeProcTree &operator=(const FakeProcTree &) = delete;
+
+  // Writes the whole tree at tick 0; false if a file could not be written
+  bool Create();
+  // Rewrites the files whose counters change, at the next tick
+  bool Advance();
+
+  [[nodiscard]] const std::string &GetRoot() const { return mRoot; }
+  [[nodiscard]] size_t GetNumProcesses() const { return mProcesses; }
+  [[nodiscard]] size_t GetNumCores() const { return mCores; }
+
+  // What the collectors must find between two ticks
+  [[nodiscard]] static double GetCoreLoad(size_t core);
+  [[nodiscard]] double GetTotalLoad() const;
+  [[nodiscard]] static uint64_t GetTotalMemory();
+  [[nodiscard]] static uint64_t GetUsedMemory();
+
+  // Of the process at index, pid FIRST_PROCESS_ID + index
+  [[nodiscard]] static uint32_t GetParentId(size_t index);
+  [[nodiscard]] static uint32_t GetThreadCount(size_t index);
+  [[nodiscard]] static uint64_t GetWorkingSetSize(size_t index);
+  [[nodiscard]] static std::string GetName(size_t index);
+
+private:
+  bool WriteFile(const char *path);
+  bool WriteProcStat();
+  bool WriteMemInfo();
+  bool WriteProcess(size_t index);
+  bool WriteProcessStat(size_t index);
+  bool WriteProcessIo(size_t index);
+
+private:
+  std::string mRoot;
+  size_t mProcesses{};
+  size_t mCores{};
+  uint64_t mTick{};
+
+  std::string mContent{}; // Of the file being written
+  bool mCreated = false;
+};
+
+} // namespace RESANA
+
+#endif
@@ -0,0 +1,156 @@
+#include "Bench.h"
+
+#include "helpers/Time.h"
+#include "system/history/HistoryArchive.h"
+#include "system/history/HistoryStore.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <random>
+
+namespace RESANA {
+
+namespace {
+
+// The series of a machine with a few hundred processes, recorded for an hour
+constexpr size_t STORE_SERIES = 600;
+constexpr size_t STORE_TICKS = 3600;
+
+std::string GetStorePath() {
+  return (std::filesystem::temp_directory_path() / "resana_bench.history")
+      .string();
+}
+
+void RemoveStore(const std::string &path) {
+  std::remove(path.c_str());
+  std::remove((path + ".1").c_str());
+}
+
+// Mostly idle processes, a few busy ones and working sets that change now
+// and then, as the samplers report them
+class StoreTrace {
+public:
+  StoreTrace() : mValues(STORE_SERIES) {
+    for (size_t i = 0; i < STORE_SERIES; ++i) {
+      mIds.push_back((uint32_t)i);
+      mValues[i] = i % 2 ? (double)(4096 * (1000 + i)) : 0.0;
+    }
+  }
+
+  void Next() {
+    for (size_t i = 0; i < STORE_SERIES; i += 2) {
+      mValues[i] = i % 20 == 0 || mUnit(mRandom) < 0.02
+                       ? mUnit(mRandom) * 100.0
+                       : 0.0;
+    }
+    for (size_t i = 1; i < STORE_SERIES; i += 2) {
+      if (mUnit(mRandom) < 0.1) {
+        mValues[i] += 4096.0 * (double)(int)((mUnit(mRandom) - 0.45) * 64.0);
+      }
+    }
+  }
+
+  [[nodiscard]] const uint32_t *GetIds() const { return mIds.data(); }
+  [[nodiscard]] const double *GetValues() const { return mValues.data(); }
+
+private:
+  std::mt19937 mRandom{22};
+  std::uniform_real_distribution<double> mUnit{0.0, 1.0};
+  std::vector<uint32_t> mIds{};
+  std::vector<double> mValues{};
+};
+
+} // namespace
+
+// Records an hour of 1 s ticks to a file, then reads it back: append cost
+// per tick, bytes per sample on disk, the time to open the file and to query
+// a minute and the whole hour, and how much a damaged block costs a reader
+RS_BENCHMARK(HistoryStore_Record) {
+  const auto path = GetStorePath();
+  RemoveStore(path);
+
+  StoreTrace trace;
+  double appendNs;
+  size_t numBlocks;
+  {
+    HistoryStore store(path, 256);
+    for (size_t i = 0; i < STORE_SERIES; ++i) {
+      store.Bind((uint32_t)i, "process." + std::to_string(i) +
+                                  (i % 2 ? ".memory" : ".cpu"));
+    }
+
+    auto time = (int64_t)Time::GetTime();
+    uint64_t elapsed = 0;
+    for (size_t tick = 0; tick < STORE_TICKS; ++tick) {
+      trace.Next();
+      const uint64_t start = BenchNow();
+      store.Append(trace.GetIds(), trace.GetValues(), STORE_SERIES, time);
+      elapsed += BenchNow() - start;
+      time += 1000;
+    }
+    store.Flush();
+
+    appendNs = (double)elapsed / (double)STORE_TICKS;
+    numBlocks = store.GetNumBlocks();
+    state.Report("append 600 series", appendNs / 1000.0, "us/tick");
+    state.Report("append", appendNs / (double)STORE_SERIES, "ns/sample");
+    state.Report("size",
+                 (double)(numBlocks * HISTORY_BLOCK_BYTES) /
+                     (double)(STORE_SERIES * STORE_TICKS),
+                 "bytes/sample");
+    state.Report("file", (double)store.GetFileSize() / (1024.0 * 1024.0),
+                 "MB");
+  }
+
+  HistoryArchive archive;
+  const double openNs = MeasureNs([&] { archive.Open(path); }, 20);
+  state.Report("archive open", openNs / 1000.0, "us");
+
+  const int64_t last = archive.GetLastTime();
+  std::vector<HistoryBucket> buckets;
+  const double minuteNs = MeasureNs(
+      [&] {
+        buckets.clear();
+        archive.Query("process.100.cpu", last - 60000, last, 400, buckets);
+      },
+      1000);
+  state.Report("query 1 minute", minuteNs / 1000.0, "us");
+  const double hourNs = MeasureNs(
+      [&] {
+        buckets.clear();
+        archive.Query("process.100.cpu", last - 3600000, last, 24000, buckets);
+      },
+      20);
+  state.Report("query 1 hour", hourNs / 1000.0, "us");
+
+  std::vector<HistoryPoint> points;
+  archive.Read("process.101.memory", INT64_MIN, INT64_MAX, points);
+  state.Report("samples read back", (double)points.size(), "samples");
+  archive.Close();
+
+  // A byte flipped in the middle of the file only loses its block
+  if (auto *file = std::fopen(path.c_str(), "r+b")) {
+    std::fseek(file, (long)(GetHistoryBlockOffset(numBlocks / 2) + 1000),
+               SEEK_SET);
+    const int byte = std::fgetc(file);
+    std::fseek(file, -1, SEEK_CUR);
+    std::fputc(byte ^ 0x55, file);
+    std::fclose(file);
+  }
+  archive.Open(path);
+  points.clear();
+  archive.Read("process.101.memory", INT64_MIN, INT64_MAX, points);
+  state.Report("damaged blocks", (double)archive.GetNumDamagedBlocks(),
+               "blocks");
+  state.Report("samples after damage", (double)points.size(), "samples");
+  archive.Close();
+
+  // A store reopened on the file continues after its last block
+  {
+    HistoryStore store(path, 256);
+    state.Report("blocks recovered", (double)store.GetNumBlocks(), "blocks");
+  }
+  RemoveStore(path);
+}
+
+} // namespace RESANA
@@ -0,0 +1,130 @@
+#include "Bench.h"
+
+#include "system/history/MetricHistory.h"
+
+namespace RESANA {
+
+// Appends to a full ring, so every append overwrites the oldest sample
+RS_BENCHMARK(MetricHistory_Append) {
+  TimeSeries series(3600);
+  int64_t time = 0;
+  for (size_t i = 0; i < series.GetCapacity(); ++i) {
+    series.Append(time++ * 1000, (double)(i % 100));
+  }
+
+  const double ns = MeasureNs(
+      [&] {
+        series.Append(time * 1000, (double)(time % 100));
+        ++time;
+      },
+      10000000);
+  state.Report("series append", ns, "ns");
+
+  // One tick of a sampler that records a table of processes, which have no
+  // rollups unless they are among the top ones
+  MetricHistory history;
+  std::vector<MetricHistory::SeriesId> ids;
+  std::vector<double> values;
+  for (size_t i = 0; i < 1000; ++i) {
+    ids.push_back(history.Register("process." + std::to_string(i) + ".cpu",
+                                   {false, SeriesEncoding::Float}));
+    values.push_back((double)(i % 100));
+  }
+
+  const double tickNs = MeasureNs(
+      [&] {
+        history.Append(ids.data(), values.data(), ids.size(), time);
+        time += 1000;
+      },
+      10000);
+  state.Report("batch append 1000 series", tickNs / 1000.0, "us/tick");
+  state.Report("memory for 1000 series",
+               (double)history.GetMemoryUsage() / (1024.0 * 1024.0), "MB");
+}
+
+// Min, max, average and rate of the latest samples of a full ring that has
+// wrapped, so every window spans both runs
+RS_BENCHMARK(MetricHistory_Aggregate) {
+  TimeSeries series(3600);
+  for (int64_t i = 0; i < 5000; ++i) {
+    series.Append(i * 1000, (double)(i % 100));
+  }
+
+  const int64_t latest = series.GetLatest().Time;
+  for (const size_t window : state.GetSizes({60, 600, 3600})) {
+    state.SetSize(window);
+    const int64_t from = latest - (int64_t)(window - 1) * 1000;
+    const double ns = MeasureNs(
+        [&] { DoNotOptimize(series.Aggregate(from, latest)); }, 100000);
+    state.Report("window " + std::to_string(window), ns, "ns");
+  }
+}
+
+// A day of 1 s samples for a 16 core host: the CPU and memory series plus
+// the top processes, all with rollups. Reports the memory held, the cost of
+// an append through every level and range queries at plot resolution.
+RS_BENCHMARK(MetricHistory_Rollups) {
+  const HistoryConfig config;
+  MetricHistory history(config);
+
+  std::vector<MetricHistory::SeriesId> ids;
+  ids.push_back(history.Register("cpu.total"));
+  for (int core = 0; core < 16; ++core) {
+    ids.push_back(history.Register("cpu.core." + std::to_string(core)));
+  }
+  ids.push_back(history.Register("memory.used"));
+  ids.push_back(history.Register("memory.load"));
+  ids.push_back(history.Register("memory.self"));
+  for (uint32_t i = 0; i < config.TopProcesses; ++i) {
+    const auto prefix = "process." + std::to_string(1000 + i);
+    ids.push_back(
+        history.Register(prefix + ".cpu", {true, SeriesEncoding::Float}));
+    ids.push_back(
+        history.Register(prefix + ".memory", {true, SeriesEncoding::Integer}));
+  }
+
+  std::vector<double> values(ids.size());
+  const int64_t day = 86400;
+  const uint64_t start = BenchNow();
+  for (int64_t second = 0; second < day; ++second) {
+    for (size_t i = 0; i < values.size(); ++i) {
+      values[i] = (double)((second * 7 + (int64_t)i * 13) % 100);
+    }
+    history.Append(ids.data(), values.data(), ids.size(), second * 1000);
+  }
+  const double appendNs =
+      (double)(BenchNow() - start) / (double)(day * (int64_t)ids.size());
+
+  state.Report("series", (double)ids.size(), "series");
+  state.Report("append through all levels", appendNs, "ns");
+  state.Report("memory for a day",
+               (double)history.GetMemoryUsage() / (1024.0 * 1024.0), "MB");
+
+  struct Range {
+    const char *Name;
+    int64_t WindowMs;
+  };
+  const Range ranges[] = {
+      {"1 minute", 60000}, {"1 hour", 3600000}, {"1 day", 86400000}};
+
+  const int64_t now = (day - 1) * 1000;
+  std::vector<HistoryBucket> buckets;
+  for (const auto &range : ranges) {
+    const int64_t resolution = range.WindowMs / 240;
+    buckets.clear();
+    history.Query(ids[0], now - range.WindowMs, now, resolution, buckets);
+    state.Report(std::string(range.Name) + " buckets", (double)buckets.size(),
+                 "buckets");
+
+    const double ns = MeasureNs(
+        [&] {
+          buckets.clear();
+          history.Query(ids[0], now - range.WindowMs, now, resolution,
+                        buckets);
+        },
+        10000);
+    state.Report(std::string(range.Name) + " query", ns / 1000.0, "us");
+  }
+}
+
+} // namespace RESANA
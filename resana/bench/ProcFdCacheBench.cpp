@@ -0,0 +1,58 @@
+#include "Bench.h"
+
+#include "core/PlatformDetection.h"
+
+#ifdef RS_PLATFORM_LINUX
+
+#include "platform/linux/ProcScanner.h"
+
+namespace RESANA {
+
+static constexpr size_t SAMPLE_TICKS = 20;
+
+// One ProcessManager tick: enumerate and sample every process
+static size_t SampleTick(ProcScanner &scanner) {
+  const auto *records = scanner.Scan();
+  if (!records) {
+    return 0;
+  }
+
+  ProcessMetrics metrics{};
+  for (const auto &record : *records) {
+    scanner.ReadMetrics(record, metrics);
+    DoNotOptimize(metrics);
+  }
+  return records->size();
+}
+
+static void RunSampling(BenchState &state, size_t capacity,
+                        const std::string &label) {
+  ProcScanner scanner;
+  scanner.GetFdCache().SetCapacity(capacity);
+  SampleTick(scanner); // Warm-up, fills the cache
+
+  const ProcSyscallStats before = scanner.GetStats();
+  size_t processes = 0;
+  const double ns = MeasureNs([&] { processes = SampleTick(scanner); },
+                              SAMPLE_TICKS);
+  const ProcSyscallStats &after = scanner.GetStats();
+
+  const auto perTick = [](uint64_t count) {
+    return (double)count / (double)SAMPLE_TICKS;
+  };
+  state.Report(label + " processes", (double)processes, "");
+  state.Report(label + " syscalls/tick",
+               perTick(after.GetTotal() - before.GetTotal()), "");
+  state.Report(label + " opens/tick", perTick(after.Opens - before.Opens), "");
+  state.Report(label + " time/tick", ns / 1000.0, "us");
+}
+
+// Uncached is the open/read/close per file sampling used before the cache
+RS_BENCHMARK(ProcFdCache_SampleTick) {
+  RunSampling(state, 0, "uncached");
+  RunSampling(state, ProcFdCache::GetDefaultCapacity(), "cached");
+}
+
+} // namespace RESANA
+
+#endif
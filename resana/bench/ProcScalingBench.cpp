@@ -0,0 +1,171 @@
+#include "Bench.h"
+#include "FakeProcTree.h"
+
+#ifdef RS_PLATFORM_LINUX
+
+#include "helpers/Time.h"
+#include "system/SystemRuntime.h"
+#include "system/cpu/CpuPerformance.h"
+#include "system/processes/ProcessContainer.h"
+#include "system/processes/ProcessManager.h"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+
+namespace RESANA {
+
+static constexpr size_t SCALING_TICKS = 5;
+static constexpr size_t SCALING_PROCESSES_PER_MS = 20;
+
+static std::string GetFakeProcRoot() {
+  return (std::filesystem::temp_directory_path() / "resana_bench_proc")
+      .string();
+}
+
+// Waits for the next run of a scheduled collector to finish and returns how
+// long it took. With after, only a run known to have started after that
+// time counts: one that overlapped a FakeProcTree::Advance() may have read
+// files of both ticks. A run ended after the last poll that did not see it,
+// which bounds its start from below.
+static uint64_t WaitForRun(const char *name, uint64_t &runs,
+                           const uint64_t after = 0) {
+  const auto &scheduler = SystemRuntime::Get().GetSampleScheduler();
+  uint64_t lastPoll = 0;
+  while (true) {
+    const uint64_t poll = BenchNow();
+    for (const auto &[taskName, stats] : scheduler.GetAllStats()) {
+      if (taskName == name && stats.Runs > runs) {
+        runs = stats.Runs;
+        if (!after ||
+            (lastPoll && lastPoll >= after + stats.LastDuration)) {
+          return stats.LastDuration;
+        }
+      }
+    }
+    lastPoll = poll;
+    Time::Sleep(1);
+  }
+}
+
+// ProcessManager ticks over a generated /proc of each size: the full scan,
+// table update, load calculation and publishing. The counters move between
+// ticks, so every process is re-read as on a busy machine. The published
+// list is checked against the tree; any process that differs is a mismatch.
+RS_BENCHMARK(ProcessManager_Scaling) {
+  for (const size_t count : state.GetSizes({1000, 10000, 100000})) {
+    state.SetSize(count);
+    const std::string suffix = " " + std::to_string(count);
+
+    FakeProcTree tree(GetFakeProcRoot(), count, 8);
+    const uint64_t start = BenchNow();
+    if (!tree.Create()) {
+      state.Report("generate" + suffix, -1.0, "failed");
+      continue;
+    }
+    state.Report("generate" + suffix, (double)(BenchNow() - start) / 1e6,
+                 "ms");
+
+    SystemRuntime runtime;
+    runtime.SetProcRoot(tree.GetRoot());
+
+    // Room for the tree to be advanced between two ticks
+    auto processes = ProcessManager::Get();
+    processes->SetUpdateInterval(
+        (uint32_t)std::max<size_t>(200, count / SCALING_PROCESSES_PER_MS));
+    processes->Run();
+
+    uint64_t runs = 0;
+    state.Report("first tick" + suffix,
+                 (double)WaitForRun("processes", runs) / 1e6, "ms");
+
+    uint64_t tickNs = 0;
+    for (size_t tick = 0; tick < SCALING_TICKS; ++tick) {
+      tree.Advance();
+      tickNs += WaitForRun("processes", runs, BenchNow());
+    }
+    const double meanNs = (double)tickNs / (double)SCALING_TICKS;
+    state.Report("tick" + suffix, meanNs / 1e6, "ms");
+    state.Report("tick per process" + suffix, meanNs / (double)count, "ns");
+
+    ProcessContainer container;
+    ProcessManager::SyncProcessContainer(container);
+    size_t mismatches = count > container.GetEntries().size()
+                            ? count - container.GetEntries().size()
+                            : 0;
+    for (const auto &entry : container.GetEntries()) {
+      const size_t index = entry->GetId() - FakeProcTree::FIRST_PROCESS_ID;
+      if (index >= count ||
+          entry->GetParentId() != FakeProcTree::GetParentId(index) ||
+          entry->GetThreadCount() != FakeProcTree::GetThreadCount(index) ||
+          entry->GetWorkingSetSize() !=
+              FakeProcTree::GetWorkingSetSize(index) ||
+          entry->GetName() != FakeProcTree::GetName(index)) {
+        ++mismatches;
+      }
+    }
+    state.Report("mismatches" + suffix, (double)mismatches, "processes");
+
+    processes->Shutdown();
+  }
+}
+
+// CpuPerformance ticks over a generated /proc/stat of each core count, and
+// the largest difference between a published core load and the one the
+// tree was advanced by
+RS_BENCHMARK(CpuPerformance_Scaling) {
+  for (const size_t cores : state.GetSizes({8, 64, 512})) {
+    state.SetSize(cores);
+    const std::string suffix = " " + std::to_string(cores);
+
+    FakeProcTree tree(GetFakeProcRoot(), 16, cores);
+    if (!tree.Create()) {
+      state.Report("tick" + suffix, -1.0, "failed");
+      continue;
+    }
+
+    SystemRuntime runtime;
+    runtime.SetProcRoot(tree.GetRoot());
+
+    auto cpu = CpuPerformance::Get();
+    cpu->SetUpdateInterval(100);
+    cpu->Run();
+
+    // The first sample has no previous one to compute a load from
+    uint64_t runs = 0;
+    WaitForRun("cpu", runs);
+
+    uint64_t tickNs = 0;
+    for (size_t tick = 0; tick < SCALING_TICKS; ++tick) {
+      tree.Advance();
+      tickNs += WaitForRun("cpu", runs, BenchNow());
+    }
+    while (cpu->GetPendingSamples() > 0) {
+      Time::Sleep(1);
+    }
+
+    double maxError = 0.0;
+    size_t published = 0;
+    if (const auto data = cpu->GetData()) {
+      const auto &processors = data->GetProcessors();
+      published = processors.size();
+      for (size_t core = 0; core < processors.size(); ++core) {
+        maxError = std::max(maxError,
+                            std::abs(processors[core].FmtValue.doubleValue -
+                                     FakeProcTree::GetCoreLoad(core)));
+      }
+    }
+
+    const double meanNs = (double)tickNs / (double)SCALING_TICKS;
+    state.Report("tick" + suffix, meanNs / 1e3, "us");
+    state.Report("tick per core" + suffix, meanNs / (double)cores, "ns");
+    state.Report("cores published" + suffix, (double)published, "cores");
+    state.Report("max load error" + suffix, maxError, "%");
+
+    cpu->Shutdown();
+  }
+}
+
+} // namespace RESANA
+
+#endif
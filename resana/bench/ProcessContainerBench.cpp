@@ -0,0 +1,117 @@
+#include "Bench.h"
+#include "ProcessFixtures.h"
+
+#include "system/processes/ProcessContainer.h"
+
+#include <algorithm>
+
+namespace RESANA {
+
+// ProcessManager::GetPreparedData() for a panel with count processes. The
+// cost per entry must stay flat as the count grows.
+RS_BENCHMARK(ProcessContainer_Sync) {
+  const auto counts = state.GetSizes({5000, 50000});
+  std::vector<double> steadyNs(counts.size());
+
+  for (size_t n = 0; n < counts.size(); ++n) {
+    const size_t count = counts[n];
+    state.SetSize(count);
+    const std::string suffix = " " + std::to_string(count);
+
+    // Stands in for the columns ProcessManager publishes each tick
+    ProcessColumns processes = MakeProcessColumns(count);
+    uint64_t version = 0;
+
+    ProcessContainer container;
+    auto ns = MeasureNs([&] { container.Sync(processes, ++version); }, 1);
+    state.Report("first sync" + suffix, ns / (double)count, "ns/entry");
+
+    ns = MeasureNs([&] { container.Sync(processes, ++version); }, 10);
+    steadyNs[n] = ns / (double)count;
+    state.Report("steady sync" + suffix, steadyNs[n], "ns/entry");
+
+    // A tenth of the processes exit and new ones start between syncs
+    uint32_t nextId = (uint32_t)(count * 4 + 4);
+    ns = MeasureNs(
+        [&] {
+          for (size_t i = 0; i < count; i += 10) {
+            processes.Id[i] = nextId;
+            nextId += 4;
+          }
+          container.Sync(processes, ++version);
+        },
+        10);
+    state.Report("churn sync" + suffix, ns / (double)count, "ns/entry");
+  }
+
+  state.SetSize(0);
+  state.Report("steady sync " + std::to_string(counts.back()) + "/" +
+                   std::to_string(counts.front()) + " per entry",
+               steadyNs.back() / steadyNs.front(), "x");
+}
+
+// The pid index of a container, one process at a time: AddEntry() as new
+// processes are listed, FindEntry() as the panel looks them up, and
+// EraseEntry() of a few of them, with the compaction that follows. The cost
+// of an erase must stay flat as the count grows.
+RS_BENCHMARK(ProcessContainer_Index) {
+  const auto counts = state.GetSizes({1000, 10000, 50000});
+  std::vector<double> eraseNs(counts.size());
+
+  for (size_t n = 0; n < counts.size(); ++n) {
+    const size_t count = counts[n];
+    state.SetSize(count);
+    const std::string suffix = " " + std::to_string(count);
+
+    auto entries = MakeProcessEntries(count);
+    ProcessContainer container;
+    auto ns = MeasureNs(
+        [&] {
+          for (auto &entry : entries) {
+            container.AddEntry(entry);
+          }
+        },
+        1);
+    state.Report("insert" + suffix, ns / (double)count, "ns/op");
+
+    ns = MeasureNs(
+        [&] {
+          for (const auto &entry : entries) {
+            DoNotOptimize(container.FindEntry(entry->GetId()));
+          }
+        },
+        10);
+    state.Report("find hit" + suffix, ns / (double)count, "ns/op");
+
+    ns = MeasureNs(
+        [&] {
+          for (const auto &entry : entries) {
+            DoNotOptimize(container.FindEntry(entry->GetId() + 2));
+          }
+        },
+        10);
+    state.Report("find miss" + suffix, ns / (double)count, "ns/op");
+
+    // Spread over the list, so the erased rows are not all at the end
+    const size_t erased = std::max<size_t>(count / 10, 1);
+    ns = MeasureNs(
+        [&] {
+          for (size_t i = 0; i < erased; ++i) {
+            container.EraseEntry(entries[i * count / erased]);
+          }
+        },
+        1);
+    eraseNs[n] = ns / (double)erased;
+    state.Report("erase" + suffix, eraseNs[n], "ns/op");
+
+    ns = MeasureNs([&] { DoNotOptimize(container.GetEntries().size()); }, 1);
+    state.Report("compact" + suffix, ns / (double)count, "ns/entry");
+  }
+
+  state.SetSize(0);
+  state.Report("erase " + std::to_string(counts.back()) + "/" +
+                   std::to_string(counts.front()) + " per op",
+               eraseNs.back() / eraseNs.front(), "x");
+}
+
+} // namespace RESANA
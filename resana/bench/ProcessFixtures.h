@@ -0,0 +1,38 @@
+#pragma once
+
+#include "system/processes/ProcessEntry.h"
+#include "system/processes/ProcessTable.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace RESANA {
+
+// Entries with pids 4, 8, 12, ... as Windows hands them out
+inline std::vector<std::shared_ptr<ProcessEntry>>
+MakeProcessEntries(size_t count) {
+  std::vector<std::shared_ptr<ProcessEntry>> entries;
+  entries.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    auto entry = std::make_shared<ProcessEntry>(std::shared_ptr<Process>());
+    entry->SetId((uint32_t)(i * 4 + 4));
+    entries.push_back(std::move(entry));
+  }
+  return entries;
+}
+
+// The same pids as ProcessManager publishes them
+inline ProcessColumns MakeProcessColumns(size_t count) {
+  ProcessColumns columns;
+  columns.Resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    columns.Id[i] = (uint32_t)(i * 4 + 4);
+    columns.State[i] = 'R';
+    columns.CreationTime[i] = i + 1;
+    columns.NameId[i] = columns.Strings.Append("Process " + std::to_string(i));
+  }
+  return columns;
+}
+
+} // namespace RESANA
@@ -0,0 +1,124 @@
+#include "Bench.h"
+
+#include "system/processes/ProcessLoad.h"
+
+#include <cstring>
+
+namespace RESANA {
+
+// One tick worth of counters: a second of wall time, a spread of loads and a
+// few rows that exercise the edge cases
+struct LoadFixture {
+  std::vector<uint64_t> CpuTime, LastCpuTime, SampleTime, LastSampleTime;
+  std::vector<float> Load;
+
+  explicit LoadFixture(const size_t count)
+      : CpuTime(count), LastCpuTime(count), SampleTime(count),
+        LastSampleTime(count), Load(count) {
+    uint64_t seed = 0x2545F4914F6CDD1Dull;
+    for (size_t i = 0; i < count; ++i) {
+      seed ^= seed << 13;
+      seed ^= seed >> 7;
+      seed ^= seed << 17;
+
+      LastSampleTime[i] = 1000000000000ull + i;
+      LastCpuTime[i] = seed >> 24;
+      Load[i] = (float)(seed % 100);
+
+      switch (i % 16) {
+      case 0: // The CPU time counter wrapped
+        LastCpuTime[i] = ~0ull - 1000;
+        break;
+      case 1: // The counter went backwards
+        LastCpuTime[i] = ~0ull >> 1;
+        break;
+      case 2: // Not sampled this tick
+        LastSampleTime[i] -= 1000000000ull;
+        break;
+      default:
+        break;
+      }
+    }
+    Advance();
+  }
+
+  // The next tick; the kernel already moved Last* to the previous one
+  void Advance() {
+    for (size_t i = 0; i < CpuTime.size(); ++i) {
+      const uint64_t spin = (i * 7919) % 1100000000ull;
+      SampleTime[i] = LastSampleTime[i] + (i % 16 == 2 ? 0 : 1000000000ull);
+      CpuTime[i] = LastCpuTime[i] + spin;
+    }
+  }
+
+  ProcessLoadColumns Columns() {
+    ProcessLoadColumns columns;
+    columns.CpuTime = CpuTime.data();
+    columns.LastCpuTime = LastCpuTime.data();
+    columns.SampleTime = SampleTime.data();
+    columns.LastSampleTime = LastSampleTime.data();
+    columns.Load = Load.data();
+    columns.Count = CpuTime.size();
+    return columns;
+  }
+};
+
+// UpdateProcessLoads() over count processes per tick, per implementation,
+// in processes per microsecond. Also checks that the AVX2 path matches the
+// scalar one bit for bit.
+RS_BENCHMARK(ProcessLoad_Kernel) {
+  ProcessLoadParams params;
+  params.Scale = 100.0 / 8.0;
+  params.Smoothing = 0.5f;
+
+  state.Report("avx2 available", HasProcessLoadAvx2() ? 1.0 : 0.0, "bool");
+
+  for (const size_t count : state.GetSizes({1000, 10000, 100000})) {
+    state.SetSize(count);
+    const std::string suffix = " " + std::to_string(count);
+    const size_t iterations = 10000000 / count;
+
+    // Advance() is part of the loop; time it alone to take it out
+    LoadFixture fixture(count);
+    const double advanceNs = MeasureNs([&] { fixture.Advance(); }, iterations);
+
+    auto ns = MeasureNs(
+        [&] {
+          UpdateProcessLoadsScalar(fixture.Columns(), params);
+          fixture.Advance();
+        },
+        iterations);
+    state.Report("scalar" + suffix, (double)count / ((ns - advanceNs) / 1000.0),
+                 "processes/us");
+
+#ifdef RS_PROCESS_LOAD_AVX2
+    if (HasProcessLoadAvx2()) {
+      ns = MeasureNs(
+          [&] {
+            UpdateProcessLoadsAvx2(fixture.Columns(), params);
+            fixture.Advance();
+          },
+          iterations);
+      state.Report("avx2" + suffix,
+                   (double)count / ((ns - advanceNs) / 1000.0),
+                   "processes/us");
+
+      // Same inputs through both paths, for several ticks
+      LoadFixture scalar(count), vector(count);
+      size_t mismatches = 0;
+      for (int tick = 0; tick < 4; ++tick) {
+        UpdateProcessLoadsScalar(scalar.Columns(), params);
+        UpdateProcessLoadsAvx2(vector.Columns(), params);
+        mismatches += std::memcmp(scalar.Load.data(), vector.Load.data(),
+                                  count * sizeof(float)) != 0;
+        scalar.Advance();
+        vector.Advance();
+      }
+      state.Report("avx2 mismatched ticks" + suffix, (double)mismatches,
+                   "ticks");
+    }
+#endif
+  }
+}
+
+} // namespace RESANA
@@ -0,0 +1,131 @@
+#include "Bench.h"
+#include "ProcessFixtures.h"
+
+#include "system/processes/ProcessMap.h"
+
+#include <map>
+
+namespace RESANA {
+
+// The previous std::map lookup, which threw for every unknown pid
+static std::shared_ptr<ProcessEntry>
+FindInStdMap(std::map<unsigned long, std::shared_ptr<ProcessEntry>> &map,
+             unsigned long procId) {
+  std::shared_ptr<ProcessEntry> entry = nullptr;
+  try {
+    entry = map.at(procId);
+  } catch (std::exception &) {
+  }
+  return entry;
+}
+
+RS_BENCHMARK(ProcessMap_Lookup) {
+  for (const size_t count : state.GetSizes({1000, 10000, 100000})) {
+    state.SetSize(count);
+    const auto entries = MakeProcessEntries(count);
+    const std::string suffix = " " + std::to_string(count);
+
+    ProcessMap map;
+    std::map<unsigned long, std::shared_ptr<ProcessEntry>> stdMap;
+
+    auto ns = MeasureNs(
+        [&] {
+          map.Clear();
+          for (auto entry : entries) {
+            map.Emplace(entry);
+          }
+        },
+        10);
+    state.Report("emplace" + suffix, ns / (double)count, "ns/op");
+
+    ns = MeasureNs(
+        [&] {
+          stdMap.clear();
+          for (const auto &entry : entries) {
+            stdMap.try_emplace(entry->GetId(), entry);
+          }
+        },
+        10);
+    state.Report("emplace std::map" + suffix, ns / (double)count, "ns/op");
+
+    ns = MeasureNs(
+        [&] {
+          for (const auto &entry : entries) {
+            DoNotOptimize(map.Find(entry->GetId()));
+          }
+        },
+        10);
+    state.Report("find hit" + suffix, ns / (double)count, "ns/op");
+
+    ns = MeasureNs(
+        [&] {
+          for (const auto &entry : entries) {
+            DoNotOptimize(FindInStdMap(stdMap, entry->GetId()));
+          }
+        },
+        10);
+    state.Report("find hit std::map" + suffix, ns / (double)count, "ns/op");
+
+    ns = MeasureNs(
+        [&] {
+          for (const auto &entry : entries) {
+            DoNotOptimize(map.Find(entry->GetId() + 2));
+          }
+        },
+        10);
+    state.Report("find miss" + suffix, ns / (double)count, "ns/op");
+
+    ns = MeasureNs(
+        [&] {
+          for (const auto &entry : entries) {
+            DoNotOptimize(FindInStdMap(stdMap, entry->GetId() + 2));
+          }
+        },
+        1);
+    state.Report("find miss std::map" + suffix, ns / (double)count, "ns/op");
+  }
+}
+
+// A tenth of the processes exit and are replaced every tick
+RS_BENCHMARK(ProcessMap_Churn) {
+  for (const size_t count : state.GetSizes({1000, 10000, 100000})) {
+    state.SetSize(count);
+    auto entries = MakeProcessEntries(count);
+    const std::string suffix = " " + std::to_string(count);
+
+    ProcessMap map;
+    for (auto &entry : entries) {
+      map.Emplace(entry);
+    }
+
+    uint32_t nextId = (uint32_t)(count * 4 + 4);
+    size_t victim = 0;
+    const size_t churn = std::max<size_t>(count / 10, 1);
+    const auto ns = MeasureNs(
+        [&] {
+          for (size_t i = 0; i < churn; ++i) {
+            auto &entry = entries[victim];
+            map.Erase(entry->GetId());
+            entry->SetId(nextId);
+            nextId += 4;
+            map.Emplace(entry);
+            victim = (victim + 7919) % count;
+          }
+        },
+        10);
+    state.Report("erase+emplace" + suffix, ns / (double)churn, "ns/op");
+
+    const auto iterateNs = MeasureNs(
+        [&] {
+          size_t running = 0;
+          for (auto &[id, entry] : map) {
+            running += entry->IsRunning();
+          }
+          DoNotOptimize(running);
+        },
+        10);
+    state.Report("iterate" + suffix, iterateNs / (double)count, "ns/entry");
+  }
+}
+
+} // namespace RESANA
@@ -0,0 +1,112 @@
+#include "Bench.h"
+#include "ProcessFixtures.h"
+
+#include "panels/ProcessPanel.h"
+#include "system/SystemRuntime.h"
+#include "system/cpu/CpuPerformance.h"
+
+#include <imgui.h>
+
+namespace RESANA {
+
+static constexpr size_t PANEL_FRAMES = 120;
+
+// One frame of the process table in a window the size of the default
+// Application window. There is no renderer; Render() only builds the draw
+// lists, which is the part of the frame that depends on the row count.
+static void RenderPanelFrame(ProcessPanel &panel) {
+  ImGui::NewFrame();
+  ImGui::SetNextWindowPos({0.0f, 0.0f});
+  ImGui::SetNextWindowSize(ImGui::GetIO().DisplaySize);
+  ImGui::Begin("Processes", nullptr, ImGuiWindowFlags_NoDecoration);
+  panel.ShowProcessTable();
+  ImGui::End();
+  ImGui::Render();
+}
+
+// ProcessPanel::ShowProcessTable() per frame with count processes listed.
+// Only the visible rows are drawn, so the frame time must stay flat as the
+// count grows.
+RS_BENCHMARK(ProcessPanel_Frame) {
+  SystemRuntime runtime;
+
+  ImGui::CreateContext();
+  auto &io = ImGui::GetIO();
+  io.IniFilename = nullptr;
+  io.DisplaySize = {1280.0f, 720.0f};
+  io.DeltaTime = 1.0f / 60.0f;
+
+  unsigned char *pixels = nullptr;
+  int width = 0, height = 0;
+  io.Fonts->GetTexDataAsAlpha8(&pixels, &width, &height);
+
+  const auto counts = state.GetSizes({1000, 10000, 50000});
+  std::vector<double> frameNs(counts.size());
+
+  for (size_t n = 0; n < counts.size(); ++n) {
+    const size_t count = counts[n];
+    state.SetSize(count);
+    const std::string suffix = " " + std::to_string(count);
+
+    ProcessColumns processes = MakeProcessColumns(count);
+    for (size_t i = 0; i < count; ++i) {
+      processes.WorkingSetSize[i] = (i % 4096 + 1) * 1024 * 1024;
+      processes.ThreadCount[i] = (uint32_t)(i % 64 + 1);
+    }
+
+    ProcessPanel panel;
+    {
+      auto &cache = panel.GetDataCache();
+      std::scoped_lock lock(cache.GetMutex());
+      cache.Sync(processes, 1);
+    }
+
+    // The first frame sorts the new entries
+    auto ns = MeasureNs([&] { RenderPanelFrame(panel); }, 1);
+    state.Report("first frame" + suffix, ns / 1000.0, "us");
+
+    ns = MeasureNs([&] { RenderPanelFrame(panel); }, PANEL_FRAMES);
+    frameNs[n] = ns;
+    state.Report("frame" + suffix, ns / 1000.0, "us");
+  }
+
+  state.SetSize(0);
+  state.Report("frame " + std::to_string(counts.back()) + "/" +
+                   std::to_string(counts.front()),
+               frameNs.back() / frameNs.front(), "x");
+
+  ImGui::DestroyContext();
+  // The CPU column header created the sampler; it must go before the runtime
+  CpuPerformance::Get()->Shutdown();
+}
+
+// ProcessPanel::GetFormattedString() over count working set sizes in KB,
+// from a few KB to a few hundred GB, as the memory columns format them
+RS_BENCHMARK(ProcessPanel_FormattedString) {
+  for (const size_t count : state.GetSizes({1000, 10000, 50000})) {
+    state.SetSize(count);
+    const std::string suffix = " " + std::to_string(count);
+
+    std::vector<uint64_t> values(count);
+    uint64_t seed = 0x9E3779B97F4A7C15ull;
+    for (auto &value : values) {
+      seed ^= seed << 13;
+      seed ^= seed >> 7;
+      seed ^= seed << 17;
+      value = seed >> (24 + seed % 32);
+    }
+
+    size_t length = 0;
+    const double ns = MeasureNs(
+        [&] {
+          for (const auto value : values) {
+            length += ProcessPanel::GetFormattedString(value).size();
+          }
+        },
+        10);
+    DoNotOptimize(length);
+    state.Report("format" + suffix, ns / (double)count, "ns/call");
+  }
+}
+
+} // namespace RESANA
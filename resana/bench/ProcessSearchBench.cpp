@@ -0,0 +1,86 @@
+#include "Bench.h"
+#include "ProcessFixtures.h"
+
+#include "panels/ProcessSearch.h"
+
+#include <algorithm>
+
+namespace RESANA {
+
+static const char *const SEARCH_PROGRAMS[] = {
+    "chrome",  "bash",     "python3", "kworker/3:1", "systemd",
+    "postgres", "nginx",   "code",    "java",        "sshd",
+};
+
+// Names and command lines shaped like a busy desktop or build server
+static ProcessList MakeSearchEntries(const size_t count) {
+  ProcessList processes = MakeProcessEntries(count);
+  for (size_t i = 0; i < count; ++i) {
+    const std::string program = SEARCH_PROGRAMS[i % std::size(SEARCH_PROGRAMS)];
+    processes[i]->SetName(program);
+    processes[i]->SetCommandLine("/usr/bin/" + program + " --type=worker-" +
+                                 std::to_string(i % 97) + " --session=" +
+                                 std::to_string(i * 7919));
+  }
+  return processes;
+}
+
+// Runs every prefix of query, as the search box does while it is typed, and
+// returns the slowest keystroke in nanoseconds
+static double TypeQuery(ProcessSearchIndex &index, const std::string &query,
+                        std::vector<uint32_t> &procIds, double &totalNs) {
+  double slowest = 0.0;
+  for (size_t length = 1; length <= query.size(); ++length) {
+    const auto ns =
+        MeasureNs([&] { index.Search(query.substr(0, length), procIds); }, 1);
+    slowest = std::max(slowest, ns);
+    totalNs += ns;
+  }
+  return slowest;
+}
+
+// ProcessSearchIndex per keystroke while a query is typed, and the cost of
+// keeping the index current as processes start and exit.
+RS_BENCHMARK(ProcessSearch_Keystroke) {
+  static const std::string QUERIES[] = {"type=worker-42", "^postg", "7919",
+                                        "KWORKER"};
+
+  for (const size_t count : state.GetSizes({10000, 50000})) {
+    state.SetSize(count);
+    const std::string suffix = " " + std::to_string(count);
+
+    ProcessList processes = MakeSearchEntries(count);
+    ProcessSearchIndex index;
+    auto ns = MeasureNs([&] { index.Update(processes); }, 1);
+    state.Report("build" + suffix, ns / 1000.0, "us");
+
+    std::vector<uint32_t> procIds;
+    double slowest = 0.0, totalNs = 0.0;
+    size_t keystrokes = 0;
+    for (const auto &query : QUERIES) {
+      slowest = std::max(slowest, TypeQuery(index, query, procIds, totalNs));
+      keystrokes += query.size();
+    }
+    state.Report("keystroke mean" + suffix,
+                 totalNs / (double)keystrokes / 1000.0, "us");
+    state.Report("keystroke max" + suffix, slowest / 1000.0, "us");
+
+    // A tenth of the processes exit and new ones start between updates
+    uint32_t nextId = (uint32_t)(count * 4 + 4);
+    ns = MeasureNs(
+        [&] {
+          for (size_t i = 0; i < count; i += 10) {
+            processes[i]->SetId(nextId);
+            nextId += 4;
+          }
+          index.Update(processes);
+        },
+        10);
+    state.Report("churn update" + suffix, ns / 1000.0, "us");
+
+    ns = MeasureNs([&] { index.Update(processes); }, 10);
+    state.Report("steady update" + suffix, ns / 1000.0, "us");
+  }
+}
+
+} // namespace RESANA
@@ -0,0 +1,74 @@
+#include "Bench.h"
+#include "ProcessFixtures.h"
+
+#include "panels/ProcessSorter.h"
+
+#include <algorithm>
+#include <random>
+
+namespace RESANA {
+
+static const char *const SORT_COLUMN_NAMES[] = {
+    "name",    "pid",     "parent",   "cpu",    "working set",
+    "private", "threads", "priority", "status",
+};
+static_assert(std::size(SORT_COLUMN_NAMES) == View_Count);
+
+static constexpr size_t SORT_TICKS = 20;
+
+// Names that repeat as they do on a real machine, and metrics spread over
+// their ranges
+static ProcessList MakeSortEntries(const size_t count) {
+  ProcessList entries = MakeProcessEntries(count);
+  for (size_t i = 0; i < count; ++i) {
+    auto &entry = entries[i];
+    entry->SetName("Process " + std::to_string(i % 500));
+    entry->SetParentId((uint32_t)(i / 8 * 4 + 4));
+    entry->SetCpuLoad((float)((i * 7919) % 10000) / 100.0f);
+    entry->SetWorkingSetSize((uint32_t)((i * 104729) % (1u << 30)));
+    entry->SetPrivateUsage((uint32_t)((i * 15485863) % (1u << 30)));
+    entry->SetThreadCount((uint32_t)(i % 64 + 1));
+    entry->SetPriorityClass((uint32_t)(i % 4 * 4 + 4));
+  }
+  return entries;
+}
+
+// A sampler tick: the load of every hundredth process changes
+static void ChangeLoads(ProcessList &entries, const size_t tick) {
+  for (size_t i = tick % 100; i < entries.size(); i += 100) {
+    entries[i]->SetCpuLoad((float)((i * 31 + tick * 7) % 10000) / 100.0f);
+  }
+}
+
+// ProcessSorter::Sort() under each column of the process table: the first
+// sort of a shuffled list, and the sorts of the following ticks, where the
+// order is mostly kept and only moved rows are sorted again
+RS_BENCHMARK(ProcessSorter_Columns) {
+  for (const size_t count : state.GetSizes({1000, 10000, 50000})) {
+    state.SetSize(count);
+    const std::string suffix = " " + std::to_string(count);
+
+    for (int column = 0; column < View_Count; ++column) {
+      const std::string label = SORT_COLUMN_NAMES[column] + suffix;
+      const ProcessSortSpec spec{(ProcessMenu)column, true};
+
+      ProcessList entries = MakeSortEntries(count);
+      std::shuffle(entries.begin(), entries.end(), std::mt19937(42));
+
+      ProcessSorter sorter;
+      double ns = MeasureNs([&] { sorter.Sort(entries, spec); }, 1);
+      state.Report("first " + label, ns / 1000.0, "us");
+
+      size_t tick = 0;
+      ns = MeasureNs(
+          [&] {
+            ChangeLoads(entries, ++tick);
+            sorter.Sort(entries, spec);
+          },
+          SORT_TICKS);
+      state.Report("tick " + label, ns / 1000.0, "us");
+    }
+  }
+}
+
+} // namespace RESANA
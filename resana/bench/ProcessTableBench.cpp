@@ -0,0 +1,132 @@
+#include "Bench.h"
+
+#include "system/processes/ProcessEntry.h"
+#include "system/processes/ProcessTable.h"
+
+namespace RESANA {
+
+// One sampler tick over the processes with the given pids, as PrepareData()
+// does it minus the /proc reads
+static void ScanTable(ProcessTable &table, const std::vector<uint32_t> &procIds,
+                      ProcessMetrics &metrics) {
+  metrics.Time += 1000000000ull;
+  metrics.UserTime += 1000ull;
+
+  table.BeginScan();
+  for (const auto procId : procIds) {
+    bool created = false;
+    const auto slot = table.Acquire(procId, procId, created);
+    table.SetStatus(slot, 1, 4, 20, 'S');
+    if (created) {
+      // Few distinct names, but every command line differs
+      static const char *const NAMES[] = {"svchost.exe", "chrome.exe",
+                                          "bash", "kworker/0:1"};
+      table.SetName(slot, NAMES[procId % 4]);
+      table.SetCommandLine(slot, "process --id=" + std::to_string(procId));
+    }
+    table.ApplyMetrics(slot, metrics);
+  }
+  table.EndScan();
+  table.UpdateCpuLoads();
+}
+
+// ProcessTable per sampler tick, pid lookups, exits and the memory a process
+// costs in the columns and the interned strings compared to a ProcessEntry. The cost of a tick in
+// which processes exit must stay flat per process as the count grows.
+RS_BENCHMARK(ProcessTable_Tick) {
+  const auto counts = state.GetSizes({1000, 10000, 100000});
+  std::vector<double> exitNs(counts.size());
+
+  for (size_t n = 0; n < counts.size(); ++n) {
+    const size_t count = counts[n];
+    state.SetSize(count);
+    const std::string suffix = " " + std::to_string(count);
+
+    // Pids 4, 8, 12, ... as Windows hands them out
+    std::vector<uint32_t> procIds(count);
+    for (size_t i = 0; i < count; ++i) {
+      procIds[i] = (uint32_t)(i * 4 + 4);
+    }
+
+    ProcessTable table;
+    ProcessMetrics metrics{};
+    auto ns = MeasureNs([&] { ScanTable(table, procIds, metrics); }, 1);
+    state.Report("first tick" + suffix, ns / (double)count, "ns/process");
+
+    ns = MeasureNs([&] { ScanTable(table, procIds, metrics); }, 10);
+    state.Report("steady tick" + suffix, ns / (double)count, "ns/process");
+
+    ns = MeasureNs(
+        [&] {
+          for (const auto procId : procIds) {
+            DoNotOptimize(table.Find(procId));
+          }
+        },
+        10);
+    state.Report("find hit" + suffix, ns / (double)count, "ns/op");
+
+    ns = MeasureNs(
+        [&] {
+          for (const auto procId : procIds) {
+            DoNotOptimize(table.Find(procId + 2));
+          }
+        },
+        10);
+    state.Report("find miss" + suffix, ns / (double)count, "ns/op");
+
+    // A tenth of the processes exit; they are listed again before the next
+    // measured tick, so every measured tick frees as many slots
+    std::vector<uint32_t> survivors;
+    survivors.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+      if (i % 10 != 0) {
+        survivors.push_back(procIds[i]);
+      }
+    }
+    uint64_t exitTotalNs = 0;
+    for (size_t tick = 0; tick < 10; ++tick) {
+      const uint64_t start = BenchNow();
+      ScanTable(table, survivors, metrics);
+      exitTotalNs += BenchNow() - start;
+      ScanTable(table, procIds, metrics);
+    }
+    exitNs[n] = (double)exitTotalNs / 10.0 / (double)count;
+    state.Report("exit tick" + suffix, exitNs[n], "ns/process");
+
+    // A tenth of the processes exit and new ones start every tick
+    uint32_t nextId = (uint32_t)(count * 4 + 4);
+    ns = MeasureNs(
+        [&] {
+          for (size_t i = 0; i < count; i += 10) {
+            procIds[i] = nextId;
+            nextId += 4;
+          }
+          ScanTable(table, procIds, metrics);
+        },
+        10);
+    state.Report("churn tick" + suffix, ns / (double)count, "ns/process");
+
+    ProcessColumns columns;
+    ns = MeasureNs([&] { table.Gather(columns); }, 10);
+    state.Report("gather" + suffix, ns / (double)count, "ns/process");
+
+    state.Report("column bytes" + suffix,
+                 (double)table.GetColumnBytes() / (double)count,
+                 "bytes/process");
+    state.Report("string bytes" + suffix,
+                 (double)table.GetStringBytes() / (double)count,
+                 "bytes/process");
+  }
+
+  state.SetSize(0);
+  state.Report("exit tick " + std::to_string(counts.back()) + "/" +
+                   std::to_string(counts.front()) + " per process",
+               exitNs.back() / exitNs.front(), "x");
+
+  // Not counting its name, command line and the shared_ptr control blocks
+  state.Report("ProcessEntry bytes",
+               (double)(sizeof(ProcessEntry) + sizeof(PdhData)),
+               "bytes/process");
+}
+
+} // namespace RESANA
@@ -0,0 +1,148 @@
+#include "Bench.h"
+
+#include "helpers/Time.h"
+#include "system/SystemRuntime.h"
+#include "system/cpu/CpuPerformance.h"
+#include "system/memory/MemoryPerformance.h"
+#include "system/processes/ProcessContainer.h"
+#include "system/processes/ProcessManager.h"
+#include "system/trace/SampleReplay.h"
+
+#include <filesystem>
+
+namespace RESANA {
+
+namespace {
+
+constexpr uint32_t TRACE_INTERVAL_MS = 20;
+constexpr uint32_t TRACE_TICKS = 100;
+constexpr size_t REPLAY_RUNS = 5;
+
+// What a replay left the collectors with; identical input must give
+// identical figures
+struct ReplayResult {
+  double CpuLoad{};
+  uint64_t MemoryUsed{};
+  size_t Processes{};
+  double ProcessLoad{};
+  uint64_t WorkingSets{};
+
+  bool operator!=(const ReplayResult &other) const {
+    return CpuLoad != other.CpuLoad || MemoryUsed != other.MemoryUsed ||
+           Processes != other.Processes || ProcessLoad != other.ProcessLoad ||
+           WorkingSets != other.WorkingSets;
+  }
+};
+
+void StartCollectors(const uint32_t intervalMs) {
+  CpuPerformance::Get()->SetUpdateInterval(intervalMs);
+  MemoryPerformance::Get()->SetUpdateInterval(intervalMs);
+  ProcessManager::Get()->SetUpdateInterval(intervalMs);
+  CpuPerformance::Get()->Run();
+  MemoryPerformance::Get()->Run();
+  ProcessManager::Get()->Run();
+}
+
+void StopCollectors() {
+  ProcessManager::Get()->Shutdown();
+  MemoryPerformance::Get()->Shutdown();
+  CpuPerformance::Get()->Shutdown();
+}
+
+} // namespace
+
+// Records this machine's collectors for a hundred ticks, then replays the
+// trace as fast as the pipeline goes, each time into fresh collectors: the
+// throughput of the processing stages on the same input every run, the cost
+// per frame of each, the trace size, and the runs whose results differ
+// from the first
+RS_BENCHMARK(SampleReplay_Pipeline) {
+  const auto path =
+      (std::filesystem::temp_directory_path() / "resana_bench.trace").string();
+
+  {
+    SystemRuntime runtime;
+    auto writer = std::make_unique<SampleTraceWriter>();
+    if (!writer->Open(path)) {
+      return;
+    }
+    runtime.SetTraceWriter(std::move(writer));
+
+    StartCollectors(TRACE_INTERVAL_MS);
+    Time::Sleep(TRACE_INTERVAL_MS * TRACE_TICKS);
+    StopCollectors();
+  }
+
+  SampleReplay replay;
+  if (!replay.Open(path)) {
+    return;
+  }
+
+  ReplayStats best{};
+  ReplayResult first{};
+  size_t mismatches = 0;
+  double syncNs = 0.0;
+  for (size_t run = 0; run < REPLAY_RUNS; ++run) {
+    SystemRuntime runtime;
+    runtime.SetReplaying(true);
+    StartCollectors(TRACE_INTERVAL_MS);
+
+    const auto stats = replay.Run(ReplaySpeed::Fast);
+    if (run == 0 || stats.ElapsedNs < best.ElapsedNs) {
+      best = stats;
+    }
+
+    // The panel's copy of the last list
+    ProcessContainer container;
+    syncNs = MeasureNs([&] { ProcessManager::SyncProcessContainer(container); },
+                       1);
+
+    ReplayResult result;
+    result.CpuLoad = CpuPerformance::GetCurrentLoad();
+    result.MemoryUsed = MemoryPerformance::Get()->GetUsedPhysical();
+    result.Processes = container.GetEntries().size();
+    for (const auto &entry : container.GetEntries()) {
+      result.ProcessLoad += entry->GetCpuLoad();
+      result.WorkingSets += entry->GetWorkingSetSize();
+    }
+    if (run == 0) {
+      first = result;
+    } else if (result != first) {
+      ++mismatches;
+    }
+
+    StopCollectors();
+  }
+
+  const size_t frames = best.CpuFrames + best.MemoryFrames + best.ProcessFrames;
+  state.Report("trace", (double)std::filesystem::file_size(path) / 1024.0,
+               "KB");
+  state.Report("trace per process",
+               (double)std::filesystem::file_size(path) /
+                   (double)std::max<size_t>(best.Processes, 1),
+               "bytes");
+  state.Report("frames", (double)frames, "frames");
+  state.Report("replay", (double)frames * 1e9 / (double)best.ElapsedNs,
+               "frames/s");
+  state.Report("cpu frame",
+               (double)best.CpuNs / 1e3 / (double)std::max<size_t>(best.CpuFrames, 1),
+               "us");
+  state.Report("memory frame",
+               (double)best.MemoryNs / 1e3 /
+                   (double)std::max<size_t>(best.MemoryFrames, 1),
+               "us");
+  state.Report("process frame",
+               (double)best.ProcessNs / 1e3 /
+                   (double)std::max<size_t>(best.ProcessFrames, 1),
+               "us");
+  state.Report("process frame per process",
+               (double)best.ProcessNs /
+                   (double)std::max<size_t>(best.Processes, 1),
+               "ns");
+  state.Report("first container sync", syncNs / 1e3, "us");
+  state.Report("runs that differ", (double)mismatches, "runs");
+
+  std::filesystem::remove(path);
+}
+
+} // namespace RESANA
@@ -0,0 +1,71 @@
+#include "AllocationCounter.h"
+#include "Bench.h"
+
+#include "helpers/Time.h"
+#include "system/SystemRuntime.h"
+#include "system/cpu/CpuPerformance.h"
+#include "system/memory/MemoryPerformance.h"
+#include "system/processes/ProcessManager.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+namespace RESANA {
+
+static constexpr uint32_t ALLOC_INTERVAL_MS = 20;
+static constexpr uint32_t ALLOC_WARMUP_TICKS = 25;
+static constexpr uint32_t ALLOC_MEASURED_TICKS = 50;
+static constexpr uint32_t ALLOC_WINDOWS = 3;
+
+// Runs one sampler on the scheduler and returns the heap allocations per
+// tick once it has warmed up. Every thread counts, so this covers the
+// sampler, the thread that processes its samples and the publishing. A
+// process that starts meanwhile costs the process sampler its slot and
+// command line, so the quietest of a few windows is the steady state.
+template <typename Sampler> static double MeasureSamplerAllocations() {
+  auto sampler = Sampler::Get();
+  sampler->SetUpdateInterval(ALLOC_INTERVAL_MS);
+  sampler->Run();
+
+  Time::Sleep(ALLOC_INTERVAL_MS * ALLOC_WARMUP_TICKS);
+  uint64_t allocations = ~0ull;
+  for (uint32_t window = 0; window < ALLOC_WINDOWS; ++window) {
+    const uint64_t before = GetAllocationCount();
+    Time::Sleep(ALLOC_INTERVAL_MS * ALLOC_MEASURED_TICKS);
+    allocations = std::min(allocations, GetAllocationCount() - before);
+  }
+
+  sampler->Shutdown();
+  return (double)allocations / (double)ALLOC_MEASURED_TICKS;
+}
+
+// Heap allocations per tick of each sampler in steady state. The target is
+// zero: every buffer a tick fills is reused from an earlier one. Any
+// allocation fails the benchmark.
+RS_BENCHMARK(Sampler_Allocations) {
+  SystemRuntime runtime;
+
+  // The runtime's own threads, idle
+  uint64_t before = GetAllocationCount();
+  Time::Sleep(ALLOC_INTERVAL_MS * ALLOC_MEASURED_TICKS);
+  state.Report("idle runtime",
+               (double)(GetAllocationCount() - before) /
+                   (double)ALLOC_MEASURED_TICKS,
+               "allocs/tick");
+
+  const std::pair<const char *, double> samplers[] = {
+      {"cpu", MeasureSamplerAllocations<CpuPerformance>()},
+      {"memory", MeasureSamplerAllocations<MemoryPerformance>()},
+      {"processes", MeasureSamplerAllocations<ProcessManager>()},
+  };
+  for (const auto &[name, allocsPerTick] : samplers) {
+    state.Report(name, allocsPerTick, "allocs/tick");
+    if (allocsPerTick > 0.0) {
+      state.Fail(std::string("the ") + name +
+                 " sampler allocates in steady state");
+    }
+  }
+}
+
+} // namespace RESANA
@@ -0,0 +1,97 @@
+#include "Bench.h"
+
+#include "system/SpscRing.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+namespace RESANA {
+
+static constexpr size_t HANDOFF_COUNT = 100000;
+
+struct StampedSample {
+  uint64_t Sent{};
+  double Values[32]{}; // About the size of a per-core sample
+};
+
+static void ReportLatencies(BenchState &state, const std::string &label,
+                            std::vector<uint64_t> &latencies) {
+  std::sort(latencies.begin(), latencies.end());
+  state.Report(label + " p50", (double)latencies[latencies.size() / 2], "ns");
+  state.Report(label + " p99", (double)latencies[latencies.size() * 99 / 100],
+               "ns");
+}
+
+// Producer to consumer latency of one sample when the consumer is waiting
+RS_BENCHMARK(SpscRing_Handoff) {
+  std::vector<uint64_t> latencies;
+  latencies.reserve(HANDOFF_COUNT);
+
+  {
+    SpscRing<StampedSample> ring(4);
+    std::thread consumer([&] {
+      for (size_t i = 0; i < HANDOFF_COUNT;) {
+        if (auto *slot = ring.WaitRead(100)) {
+          latencies.push_back(BenchNow() - slot->Sent);
+          ring.CommitRead();
+          ++i;
+        }
+      }
+    });
+
+    for (size_t i = 0; i < HANDOFF_COUNT;) {
+      if (auto *slot = ring.BeginWrite()) {
+        slot->Sent = BenchNow();
+        ring.CommitWrite();
+        ++i;
+      }
+      // Let the consumer drain so every hand-off is measured from empty
+      while (ring.GetSize() != 0) {
+        CpuRelax();
+      }
+    }
+    consumer.join();
+  }
+  ReportLatencies(state, "ring", latencies);
+
+  // The previous hand-off: a locked std::queue of shared samples
+  latencies.clear();
+  {
+    std::queue<std::shared_ptr<StampedSample>> queue;
+    std::mutex mutex;
+    std::condition_variable_any condition;
+    std::thread consumer([&] {
+      for (size_t i = 0; i < HANDOFF_COUNT; ++i) {
+        std::unique_lock lock(mutex);
+        condition.wait(lock, [&] { return !queue.empty(); });
+        auto sample = queue.front();
+        queue.pop();
+        lock.unlock();
+        latencies.push_back(BenchNow() - sample->Sent);
+      }
+    });
+
+    for (size_t i = 0; i < HANDOFF_COUNT; ++i) {
+      auto sample = std::make_shared<StampedSample>();
+      sample->Sent = BenchNow();
+      {
+        std::scoped_lock lock(mutex);
+        queue.push(std::move(sample));
+      }
+      condition.notify_all();
+
+      bool empty = false;
+      while (!empty) {
+        std::scoped_lock lock(mutex);
+        empty = queue.empty();
+      }
+    }
+    consumer.join();
+  }
+  ReportLatencies(state, "locked queue", latencies);
+}
+
+} // namespace RESANA
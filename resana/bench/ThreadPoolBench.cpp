@@ -0,0 +1,103 @@
+#include "Bench.h"
+
+#include "system/ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace RESANA {
+
+// Jobs queued per burst size, over as many bursts as that takes
+static constexpr size_t POOL_JOBS = 100000;
+
+// Records when it was queued and when a worker picked it up
+struct LatencyJob final : ThreadPool::Job {
+  uint64_t QueuedAt{};
+  uint64_t StartedAt{};
+  std::atomic<size_t> *Done{};
+
+  void Run() override {
+    StartedAt = BenchNow();
+    Done->fetch_add(1, std::memory_order_release);
+  }
+};
+
+static void WaitForJobs(const std::atomic<size_t> &done, const size_t count) {
+  while (done.load(std::memory_order_acquire) < count) {
+    std::this_thread::yield();
+  }
+}
+
+// ThreadPool::Queue() in bursts of each size: the cost of queuing a job on
+// the calling thread, the time from queuing it to a worker running it, and
+// the time until a whole burst has run. Jobs are the caller's own, as the
+// sample scheduler queues them, and for comparison std::function jobs,
+// which the pool allocates.
+RS_BENCHMARK(ThreadPool_Latency) {
+  ThreadPool pool;
+  pool.Start();
+
+  for (const size_t burst : state.GetSizes({1, 16, 256})) {
+    state.SetSize(burst);
+    const std::string suffix = " " + std::to_string(burst);
+    const size_t rounds = std::max<size_t>(POOL_JOBS / burst, 100);
+
+    std::vector<LatencyJob> jobs(burst);
+    std::vector<uint64_t> latencies;
+    latencies.reserve(rounds * burst);
+    std::atomic<size_t> done{0};
+    for (auto &job : jobs) {
+      job.Done = &done;
+    }
+
+    uint64_t queueNs = 0;
+    uint64_t burstNs = 0;
+    for (size_t round = 0; round < rounds; ++round) {
+      done = 0;
+      const uint64_t start = BenchNow();
+      for (auto &job : jobs) {
+        job.QueuedAt = BenchNow();
+        pool.Queue(job);
+      }
+      queueNs += BenchNow() - start;
+      WaitForJobs(done, burst);
+      burstNs += BenchNow() - start;
+
+      for (const auto &job : jobs) {
+        latencies.push_back(job.StartedAt - job.QueuedAt);
+      }
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    const auto percentile = [&](double p) {
+      return (double)latencies[(size_t)(p * (double)(latencies.size() - 1))];
+    };
+    const double total = (double)(rounds * burst);
+    state.Report("queue" + suffix, (double)queueNs / total, "ns/job");
+    state.Report("dispatch p50" + suffix, percentile(0.5) / 1000.0, "us");
+    state.Report("dispatch p99" + suffix, percentile(0.99) / 1000.0, "us");
+    state.Report("burst" + suffix,
+                 (double)burstNs / (double)rounds / 1000.0, "us");
+
+    // The same bursts through std::function
+    done = 0;
+    uint64_t functionNs = 0;
+    for (size_t round = 0; round < rounds; ++round) {
+      const size_t target = (round + 1) * burst;
+      const uint64_t start = BenchNow();
+      for (size_t i = 0; i < burst; ++i) {
+        pool.Queue([&done] { done.fetch_add(1, std::memory_order_release); });
+      }
+      functionNs += BenchNow() - start;
+      WaitForJobs(done, target);
+    }
+    state.Report("queue function" + suffix, (double)functionNs / total,
+                 "ns/job");
+  }
+
+  pool.Stop();
+}
+
+} // namespace RESANA
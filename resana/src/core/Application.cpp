@@ -7,7 +7,8 @@
 #include "Renderer.h"
 #include <memory>
 
-#include "system/ThreadPool.h"
+#include "system/SystemRuntime.h"
+#include "system/history/HistoryStore.h"
 
 namespace RESANA {
 
@@ -22,10 +23,13 @@ Application::Application() {
 
   // Start statics
   Renderer::Init();
-  Time::Start();
 
-  mThreadPool = std::make_shared<ThreadPool>();
-  mThreadPool->Start();
+  // Time, the thread pool and the sample scheduler. Samples are kept on disk
+  // too, in the user's data directory, so the history of an earlier run can
+  // be looked at.
+  HistoryConfig history;
+  history.StorePath = HistoryStore::GetDefaultPath();
+  mRuntime = std::make_unique<SystemRuntime>(history);
 
   mImGuiLayer = std::make_shared<ImGuiLayer>();
   PushLayer(mImGuiLayer);
@@ -36,8 +40,7 @@ Application::~Application() {
     layer->OnDetach();
   }
 
-  Time::Stop();
-  mThreadPool->Stop();
+  mRuntime.reset();
 
   RS_CORE_TRACE("Application destroyed");
 }
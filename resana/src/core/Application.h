@@ -7,7 +7,7 @@
 
 #include <memory>
 
-#include "system/ThreadPool.h"
+#include "system/SystemRuntime.h"
 
 namespace RESANA {
 
@@ -23,7 +23,12 @@ public:
   [[nodiscard]] bool IsMinimized() const;
 
   [[nodiscard]] Window &GetWindow() const { return *mWindow; }
-  [[nodiscard]] ThreadPool &GetThreadPool() const { return *mThreadPool; }
+  [[nodiscard]] ThreadPool &GetThreadPool() const {
+    return mRuntime->GetThreadPool();
+  }
+  [[nodiscard]] SampleScheduler &GetSampleScheduler() const {
+    return mRuntime->GetSampleScheduler();
+  }
 
   static Application &Get() { return *sInstance; }
 
@@ -31,7 +36,7 @@ private:
   std::shared_ptr<Window> mWindow;
   std::shared_ptr<ImGuiLayer> mImGuiLayer;
   LayerStack<Layer> mLayerStack;
-  std::shared_ptr<ThreadPool> mThreadPool;
+  std::unique_ptr<SystemRuntime> mRuntime;
   bool mRunning{true};
   bool mMinimized{false};
 
@@ -1,9 +1,13 @@
 #pragma once
 
+#include "PlatformDetection.h"
+
 #if defined(__clang__)
 #define DEBUG_BREAK __builtin_debugtrap()
 #elif defined(_MSC_VER)
 #define DEBUG_BREAK __debugbreak()
+#elif defined(__GNUC__)
+#define DEBUG_BREAK __builtin_trap()
 #endif
 
 #if defined(RS_ENABLE_ASSERTS)
@@ -0,0 +1,9 @@
+#pragma once
+
+#if defined(_WIN32)
+#define RS_PLATFORM_WINDOWS
+#elif defined(__linux__)
+#define RS_PLATFORM_LINUX
+#else
+#error "Unsupported platform!"
+#endif
@@ -0,0 +1,236 @@
+#include "rspch.h"
+
+#include "core/Core.h"
+
+#include "system/AtomicWait.h"
+#include "system/SystemRuntime.h"
+#include "system/cpu/CpuPerformance.h"
+#include "system/memory/MemoryPerformance.h"
+#include "system/processes/ProcessManager.h"
+#include "system/trace/SampleReplay.h"
+
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// Runs the collectors without a window and writes one JSON object per sample
+// to stdout; logs go to stderr.
+//
+//   resana_headless [--interval <ms>] [--samples <count>] [--history <count>]
+//                   [--store <path>] [--record <trace>] [--proc-root <dir>]
+//   resana_headless --replay <trace> [--fast] [--history <count>]
+//                   [--store <path>]
+//
+// --record writes what the collectors sample to a trace; --replay feeds one
+// back to them instead of sampling, at the recorded pace or with --fast as
+// fast as they go, and ends with a line of replay statistics. --proc-root
+// samples a procfs tree other than /proc, such as a generated one (Linux).
+
+namespace RESANA {
+
+struct HeadlessOptions {
+  uint32_t IntervalMs = TimeTick::Rate::Normal;
+  uint32_t Samples = 0; // 0 runs until SIGINT/SIGTERM
+  HistoryConfig History{};
+  std::string RecordPath{};
+  std::string ReplayPath{};
+  std::string ProcRoot{};
+  bool Fast = false;
+};
+
+static std::atomic<bool> sInterrupted{false};
+
+static void OnSignal(int) { sInterrupted = true; }
+
+static bool ParseOptions(int argc, char **argv, HeadlessOptions &options) {
+  for (int i = 1; i < argc; ++i) {
+    const bool hasValue = i + 1 < argc;
+    if (std::strcmp(argv[i], "--interval") == 0 && hasValue) {
+      options.IntervalMs = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+    } else if (std::strcmp(argv[i], "--samples") == 0 && hasValue) {
+      options.Samples = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+    } else if (std::strcmp(argv[i], "--history") == 0 && hasValue) {
+      options.History.Capacity =
+          (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+    } else if (std::strcmp(argv[i], "--store") == 0 && hasValue) {
+      options.History.StorePath = argv[++i];
+    } else if (std::strcmp(argv[i], "--record") == 0 && hasValue) {
+      options.RecordPath = argv[++i];
+    } else if (std::strcmp(argv[i], "--replay") == 0 && hasValue) {
+      options.ReplayPath = argv[++i];
+    } else if (std::strcmp(argv[i], "--proc-root") == 0 && hasValue) {
+      options.ProcRoot = argv[++i];
+    } else if (std::strcmp(argv[i], "--fast") == 0) {
+      options.Fast = true;
+    } else {
+      std::fprintf(stderr,
+                   "usage: %s [--interval <ms>] [--samples <count>] "
+                   "[--history <count>] [--store <path>] [--record <trace>] "
+                   "[--proc-root <dir>]\n"
+                   "       %s --replay <trace> [--fast] [--history <count>] "
+                   "[--store <path>]\n",
+                   argv[0], argv[0]);
+      return false;
+    }
+  }
+  return options.IntervalMs > 0 &&
+         (options.RecordPath.empty() || options.ReplayPath.empty());
+}
+
+// The samplers publish on the same deadlines, so a line holds the latest
+// complete value of each, at most one interval old.
+static void EmitSample(const CpuPerformance &cpu,
+                       const MemoryPerformance &memory,
+                       ProcessManager &processes, std::string &line) {
+  char buffer[128];
+  line.clear();
+
+  std::snprintf(buffer, sizeof(buffer), "{\"time_ms\":%lld,\"cpu\":%.1f",
+                Time::GetTime(), CpuPerformance::GetCurrentLoad());
+  line += buffer;
+
+  line += ",\"cores\":[";
+  if (const auto data = cpu.GetData()) {
+    const auto &processors = data->GetProcessors();
+    for (size_t i = 0; i < processors.size(); ++i) {
+      std::snprintf(buffer, sizeof(buffer), "%s%.1f", i ? "," : "",
+                    processors[i].FmtValue.doubleValue);
+      line += buffer;
+    }
+  }
+  line += "]";
+
+  std::snprintf(buffer, sizeof(buffer),
+                ",\"mem_used\":%llu,\"mem_total\":%llu,\"self_rss\":%llu",
+                (unsigned long long)memory.GetUsedPhysical(),
+                (unsigned long long)memory.GetTotalPhysical(),
+                (unsigned long long)memory.GetCurrProcWorkingSet());
+  line += buffer;
+
+  std::snprintf(buffer, sizeof(buffer), ",\"processes\":%d}\n",
+                processes.GetNumProcesses());
+  line += buffer;
+
+  std::fwrite(line.data(), 1, line.size(), stdout);
+  std::fflush(stdout);
+}
+
+// Feeds the trace to the collectors and writes where the time went
+static int RunReplay(const HeadlessOptions &options) {
+  SystemRuntime runtime(options.History);
+  runtime.SetReplaying(true);
+
+  SampleReplay replay;
+  if (!replay.Open(options.ReplayPath)) {
+    return 1;
+  }
+
+  auto cpu = CpuPerformance::Get();
+  auto memory = MemoryPerformance::Get();
+  auto processes = ProcessManager::Get();
+  cpu->Run();
+  memory->Run();
+  processes->Run();
+
+  const auto stats = replay.Run(
+      options.Fast ? ReplaySpeed::Fast : ReplaySpeed::Original, &sInterrupted);
+
+  const double seconds = (double)stats.ElapsedNs / 1e9;
+  const size_t frames =
+      stats.CpuFrames + stats.MemoryFrames + stats.ProcessFrames;
+  std::printf("{\"frames\":%zu,\"cpu_frames\":%zu,\"memory_frames\":%zu,"
+              "\"process_frames\":%zu,\"processes\":%zu,"
+              "\"elapsed_ms\":%.1f,\"frames_per_s\":%.0f,"
+              "\"cpu_us\":%.2f,\"memory_us\":%.2f,\"process_us\":%.2f}\n",
+              frames, stats.CpuFrames, stats.MemoryFrames, stats.ProcessFrames,
+              stats.Processes, seconds * 1000.0,
+              seconds > 0.0 ? (double)frames / seconds : 0.0,
+              stats.CpuFrames ? (double)stats.CpuNs / 1e3 / stats.CpuFrames
+                              : 0.0,
+              stats.MemoryFrames
+                  ? (double)stats.MemoryNs / 1e3 / stats.MemoryFrames
+                  : 0.0,
+              stats.ProcessFrames
+                  ? (double)stats.ProcessNs / 1e3 / stats.ProcessFrames
+                  : 0.0);
+
+  processes->Shutdown();
+  memory->Shutdown();
+  cpu->Shutdown();
+  return 0;
+}
+
+static int RunHeadless(const HeadlessOptions &options) {
+  if (!options.ReplayPath.empty()) {
+    return RunReplay(options);
+  }
+
+  SystemRuntime runtime(options.History);
+  if (!options.ProcRoot.empty()) {
+    runtime.SetProcRoot(options.ProcRoot);
+  }
+  if (!options.RecordPath.empty()) {
+    auto writer = std::make_unique<SampleTraceWriter>();
+    if (!writer->Open(options.RecordPath)) {
+      return 1;
+    }
+    runtime.SetTraceWriter(std::move(writer));
+  }
+
+  auto cpu = CpuPerformance::Get();
+  cpu->SetUpdateInterval(options.IntervalMs);
+  cpu->Run();
+
+  auto memory = MemoryPerformance::Get();
+  memory->SetUpdateInterval(options.IntervalMs);
+  memory->Run();
+
+  auto processes = ProcessManager::Get();
+  processes->SetUpdateInterval(options.IntervalMs);
+  processes->Run();
+
+  RS_CORE_INFO("Collecting every {0} ms", options.IntervalMs);
+
+  std::atomic<uint32_t> emitted{0};
+  std::string line;
+  line.reserve(1024);
+
+  auto &scheduler = runtime.GetSampleScheduler();
+  const auto emitTask = scheduler.Add("emit", options.IntervalMs, [&] {
+    EmitSample(*cpu, *memory, *processes, line);
+    emitted.fetch_add(1);
+    AtomicWakeAll(emitted);
+  });
+
+  uint32_t count = 0;
+  while (!sInterrupted && (options.Samples == 0 || count < options.Samples)) {
+    // Signals interrupt the wait; the timeout covers platforms where they
+    // do not.
+    AtomicWait(emitted, count, 100);
+    count = emitted.load();
+  }
+
+  scheduler.Remove(emitTask);
+  processes->Shutdown();
+  memory->Shutdown();
+  cpu->Shutdown();
+  return 0;
+}
+
+} // namespace RESANA
+
+int main(int argc, char **argv) {
+  RESANA::Log::Init();
+
+  RESANA::HeadlessOptions options;
+  if (!RESANA::ParseOptions(argc, argv, options)) {
+    return 1;
+  }
+
+  std::signal(SIGINT, RESANA::OnSignal);
+  std::signal(SIGTERM, RESANA::OnSignal);
+
+  return RESANA::RunHeadless(options);
+}
@@ -1,6 +1,8 @@
 #include "Time.h"
 
-#include "core/Application.h"
+#include "system/SystemRuntime.h"
+
+#include <cmath>
 
 namespace RESANA {
 
@@ -22,38 +24,42 @@ Time::~Time() {
 
 float Time::GetTimeSeconds() {
   return (float)((double)std::chrono::duration_cast<std::chrono::nanoseconds>(
-                     std::chrono::high_resolution_clock::now() - mTimeStarted)
+                     std::chrono::steady_clock::now() - mTimeStarted)
                      .count() *
                  1E-9);
 };
 
 float Time::GetTimeMilliseconds() {
   return (float)((double)std::chrono::duration_cast<std::chrono::nanoseconds>(
-                     std::chrono::high_resolution_clock::now() - mTimeStarted)
+                     std::chrono::steady_clock::now() - mTimeStarted)
                      .count() *
                  1E-3);
 };
 
 float Time::GetTimeNanoseconds() {
   return (float)((double)std::chrono::duration_cast<std::chrono::nanoseconds>(
-                     std::chrono::high_resolution_clock::now() - mTimeStarted)
+                     std::chrono::steady_clock::now() - mTimeStarted)
                      .count() *
                  1E-6);
 };
 
 long long Time::GetTime() {
   return std::chrono::duration_cast<std::chrono::milliseconds>(
-             std::chrono::high_resolution_clock::now() - mTimeStarted)
+             std::chrono::steady_clock::now() - mTimeStarted)
       .count();
 }
 
 std::string Time::GetTimeFormatted() {
   static char time_buf[50];
+#ifdef _MSC_VER
 #pragma warning(                                                               \
     disable : 4996) // Disable std::asctime and std::localtime depreciation
+#endif
   snprintf(time_buf, sizeof(time_buf), "%s",
            std::asctime(std::localtime(&sSeed)));
+#ifdef _MSC_VER
 #pragma warning(default : 4996)
+#endif
   return time_buf;
 }
 void Time::Start() {
@@ -61,7 +67,10 @@ void Time::Start() {
     sInstance = new Time();
   }
 }
-void Time::Stop() { delete sInstance; }
+void Time::Stop() {
+  delete sInstance;
+  sInstance = nullptr;
+}
 
 //--------------------------------------------------------------
 // [SECTION] TimeTick
@@ -71,33 +80,31 @@ TimeTick::TimeTick() { Start(); }
 
 TimeTick::~TimeTick() {
   Stop();
-  Time::Sleep(1000);
   RS_CORE_TRACE("TimeTick destroyed");
 }
 
-void TimeTick::Stop() { mRunning = false; }
+void TimeTick::Stop() {
+  if (mRunning) {
+    mRunning = false;
+    SystemRuntime::Get().GetSampleScheduler().Remove(mSampleTask);
+    mSampleTask = {};
+  }
+}
 
 void TimeTick::Start() {
   if (!mRunning) {
     mRunning = true;
-    const auto &app = Application::Get();
-    auto &threadPool = app.GetThreadPool();
-    threadPool.Queue([&] { CountTicks(); });
+    mSampleTask = SystemRuntime::Get().GetSampleScheduler().Add(
+        "tick", 1000, [&] { CountTicks(); });
   }
 }
 
 void TimeTick::CountTicks() {
-  unsigned long count = 0;
-
-  while (mRunning) {
-    const auto secondsPassed = std::floor(Time::GetTimeSeconds());
-    count = (secondsPassed > count) ? secondsPassed : count;
-    if (count > mTick) {
-      mTick = static_cast<Timestep>(count);
-      Time::Sleep(1000);
-    } else {
-      Time::Sleep(10);
-    }
+  // The scheduler fires on whole seconds of its clock, so this only has to
+  // read the count instead of polling for the next second.
+  const auto secondsPassed = std::floor(Time::GetTimeSeconds());
+  if (secondsPassed > mTick) {
+    mTick = static_cast<Timestep>(secondsPassed);
   }
 }
 
@@ -153,28 +160,22 @@ std::string StopWatch::GetElapsedTime() {
 // }
 
 void StopWatch::CalculateElapsedTime() {
-  char hour[4], min[4], sec[4], ms[4];
-
   sElapsedTime.clear();
   if (GetHours() > 0) {
-    _itoa_s((int)GetHours(), hour, 10);
-    sElapsedTime = *hour;
+    sElapsedTime = std::to_string(GetHours());
     sElapsedTime += "h ";
   }
   if (GetMinutes() > 0 || GetHours() > 0) {
-    _itoa_s((int)GetMinutes(), min, 10);
-    sElapsedTime += *min;
+    sElapsedTime += std::to_string(GetMinutes());
     sElapsedTime += "m ";
   }
   if (GetSeconds() > 0 || GetMinutes() > 0) {
-    _itoa_s((int)GetSeconds(), sec, 10);
-    sElapsedTime += *sec;
+    sElapsedTime += std::to_string((int)GetSeconds());
     sElapsedTime += "s ";
   }
 
-  _itoa_s((long)GetMilliseconds(), ms, 10);
-  sElapsedTime += *ms;
+  sElapsedTime += std::to_string(GetMilliseconds());
   sElapsedTime += "ms";
 }
 
-} // namespace RESANA
\ No newline at end of file
+} // namespace RESANA
\ No newline at end of file
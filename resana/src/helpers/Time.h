@@ -72,10 +72,12 @@ public:
   Timestep GetTickCount() const { return mTick; }
 
 private:
+  // Fired by the sample scheduler once per second
   void CountTicks();
 
   Timestep mTick = 0;
   bool mRunning = false;
+  uint32_t mSampleTask{};
 };
 
 //--------------------------------------------------------------
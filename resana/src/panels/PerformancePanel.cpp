@@ -3,10 +3,43 @@
 
 #include <imgui.h>
 
+#include <ctime>
+
 #include "core/Application.h"
+#include "system/SystemRuntime.h"
 
 namespace RESANA {
 
+namespace {
+
+struct HistoryRange {
+    const char* Name;
+    int64_t WindowMs;
+};
+
+constexpr HistoryRange HISTORY_RANGES[] = {
+    { "1 minute", 60000 },
+    { "10 minutes", 600000 },
+    { "1 hour", 3600000 },
+    { "6 hours", 21600000 },
+    { "1 day", 86400000 },
+};
+
+// Local date and time of a Unix time in milliseconds
+void FormatWallTime(int64_t time, char* buffer, size_t size)
+{
+    const auto seconds = (std::time_t)(time / 1000);
+    std::tm local {};
+#ifdef _MSC_VER
+    localtime_s(&local, &seconds);
+#else
+    localtime_r(&seconds, &local);
+#endif
+    std::strftime(buffer, size, "%Y-%m-%d %H:%M:%S", &local);
+}
+
+}
+
 PerformancePanel::PerformancePanel() = default;
 
 PerformancePanel::~PerformancePanel() = default;
@@ -49,7 +82,10 @@ void PerformancePanel::ShowPanel(bool* pOpen)
             UpdateCpuPanel();
 
             ShowCpuTable();
+            ShowHistoryRange();
+            ShowHistory("Cpu", "cpu.total", 100.0f);
             ImGui::TextUnformatted("Memory");
+            ShowHistory("Memory", "memory.load", 100.0f);
             ShowPhysicalMemoryTable();
             ShowVirtualMemoryTable();
         }
@@ -80,11 +116,11 @@ void PerformancePanel::ShowPhysicalMemoryTable() const
     ImGui::Text("Used by process");
     ImGui::TableNextColumn();
 
-    const auto totalMem = mMemoryInfo->GetTotalPhysicalMB();
-    const auto usedMem = mMemoryInfo->GetUsedPhysicalMB();
+    const unsigned long long totalMem = mMemoryInfo->GetTotalPhysicalMB();
+    const unsigned long long usedMem = mMemoryInfo->GetUsedPhysicalMB();
     const auto usedPercent = mMemoryInfo->GetMemoryLoad();
-    const auto availMem = mMemoryInfo->GetAvailPhysicalMB();
-    const auto procMem = MemoryPerformance::GetWorkingSetSizeMB(GetCurrentProcessId());
+    const unsigned long long availMem = mMemoryInfo->GetAvailPhysicalMB();
+    const unsigned long long procMem = mMemoryInfo->GetCurrProcWorkingSet() / BYTES_PER_MB;
 
     ImGui::Text("%llu.%llu GB", totalMem / 1000, totalMem % 10);
     ImGui::Text("%llu.%llu GB (%.1f%%)", usedMem / 1000, usedMem % 10, usedPercent);
@@ -107,16 +143,16 @@ void PerformancePanel::ShowVirtualMemoryTable() const
     ImGui::Text("Used by process");
     ImGui::TableNextColumn();
 
-    const auto totalMem = mMemoryInfo->GetTotalVirtual() / BYTES_PER_MB;
-    const auto usedMem = mMemoryInfo->GetUsedVirtual() / BYTES_PER_MB;
+    const unsigned long long totalMem = mMemoryInfo->GetTotalVirtual() / BYTES_PER_MB;
+    const unsigned long long usedMem = mMemoryInfo->GetUsedVirtual() / BYTES_PER_MB;
     const float usedPercent = (float)usedMem / (float)totalMem * 100.0f;
-    const auto availMem = mMemoryInfo->GetAvailVirtual() / BYTES_PER_MB;
-    const auto procMem = mMemoryInfo->GetCurrProcUsageVirtual() / BYTES_PER_MB;
+    const unsigned long long availMem = mMemoryInfo->GetAvailVirtual() / BYTES_PER_MB;
+    const unsigned long long procMem = mMemoryInfo->GetCurrProcUsageVirtual() / BYTES_PER_MB;
 
     ImGui::Text("%llu.%llu GB", totalMem / 1000, totalMem % 10);
     ImGui::Text("%llu.%llu GB (%.1f%%)", usedMem / 1000, usedMem % 10, usedPercent);
     ImGui::Text("%llu.%llu GB", availMem / 1000, availMem % 10);
-    ImGui::Text("%lu MB", procMem);
+    ImGui::Text("%llu MB", procMem);
     ImGui::EndTable();
 }
 
@@ -129,11 +165,9 @@ void PerformancePanel::ShowCpuTable()
     ImGui::TableNextColumn();
 
     mCpuInfo = CpuPerformance::Get();
-    if (const auto& data = mCpuInfo->GetData()) {
-        std::scoped_lock slock(data->GetMutex());
-
+    if (const auto data = mCpuInfo->GetData()) {
         for (const auto& p : data->GetProcessors()) {
-            ImGui::Text("cpu %s", p->szName);
+            ImGui::Text("cpu %s", p.szName);
         }
 
         ImGui::Text("Total");
@@ -142,7 +176,7 @@ void PerformancePanel::ShowCpuTable()
 
         // Display values for all logical processors
         for (const auto& p : data->GetProcessors()) {
-            ImGui::Text("%.1f%%", p->FmtValue.doubleValue);
+            ImGui::Text("%.1f%%", p.FmtValue.doubleValue);
         }
 
         // Display current Cpu load and load in use by process
@@ -159,13 +193,128 @@ void PerformancePanel::ShowCpuTable()
             start = Time::GetTime();
         }
         ImGui::Text("%.1f%%", procLoad);
-
-        mCpuInfo->ReleaseData();
     }
 
     ImGui::EndTable();
 }
 
+void PerformancePanel::ShowHistoryRange()
+{
+    ImGui::SetNextItemWidth(120.0f);
+    if (ImGui::BeginCombo("History", HISTORY_RANGES[mHistoryRange].Name)) {
+        for (int i = 0; i < (int)IM_ARRAYSIZE(HISTORY_RANGES); ++i) {
+            if (ImGui::Selectable(HISTORY_RANGES[i].Name, i == mHistoryRange)) {
+                mHistoryRange = i;
+            }
+        }
+        ImGui::EndCombo();
+    }
+
+    // Earlier runs, when the samples are also kept on disk
+    const auto& storePath = SystemRuntime::Get().GetHistory().GetConfig().StorePath;
+    if (storePath.empty()) {
+        return;
+    }
+
+    ImGui::SameLine();
+    if (ImGui::Checkbox("Recorded", &mShowRecorded) && mShowRecorded) {
+        mArchive.Open(storePath);
+        mRecordedEnd = mArchive.GetLastTime();
+        mRecordedEndShown = mRecordedEnd;
+        mRecordedPlots.clear();
+    }
+    if (mShowRecorded) {
+        ShowRecordedRange();
+    }
+}
+
+void PerformancePanel::ShowRecordedRange()
+{
+    if (!mArchive.IsOpen()) {
+        ImGui::TextUnformatted("No history recorded yet");
+        return;
+    }
+
+    ImGui::SameLine();
+    if (ImGui::Button("Reload")) {
+        const bool atEnd = mRecordedEnd >= mArchive.GetLastTime();
+        mArchive.Refresh();
+        if (atEnd) {
+            mRecordedEnd = mArchive.GetLastTime();
+            mRecordedEndShown = mRecordedEnd;
+        }
+    }
+
+    // The plots follow once the slider is let go
+    int64_t first = mArchive.GetFirstTime();
+    int64_t last = mArchive.GetLastTime();
+    char end[32];
+    FormatWallTime(mRecordedEnd, end, sizeof(end));
+    ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x - 60.0f);
+    ImGui::SliderScalar("Until", ImGuiDataType_S64, &mRecordedEnd, &first, &last, end);
+    if (!ImGui::IsItemActive()) {
+        mRecordedEndShown = mRecordedEnd;
+    }
+}
+
+void PerformancePanel::ShowHistory(const char* label, const char* series, float scaleMax)
+{
+    const std::vector<float>* values = &mHistoryValues;
+    HistoryStats stats;
+    if (mShowRecorded && mArchive.IsOpen()) {
+        LoadRecordedHistory(series);
+        const auto& plot = mRecordedPlots[series];
+        values = &plot.Values;
+        stats = plot.Stats;
+    } else {
+        const auto& history = SystemRuntime::Get().GetHistory();
+        const auto id = history.Find(series);
+        const auto now = (int64_t)Time::GetTime();
+        const auto window = HISTORY_RANGES[mHistoryRange].WindowMs;
+
+        // Long ranges come from the rollups, a bucket per few pixels
+        mHistoryBuckets.clear();
+        history.Query(id, now - window, now, window / HISTORY_PLOT_POINTS, mHistoryBuckets);
+
+        mHistoryValues.resize(mHistoryBuckets.size());
+        for (size_t i = 0; i < mHistoryBuckets.size(); ++i) {
+            mHistoryValues[i] = (float)mHistoryBuckets[i].Avg;
+        }
+        stats = history.Aggregate(id, now - window, now);
+    }
+
+    char overlay[64];
+    std::snprintf(overlay, sizeof(overlay), "avg %.1f%%  max %.1f%%", stats.Avg, stats.Max);
+
+    ImGui::PushID(label);
+    ImGui::PlotLines("##history", values->data(), (int)values->size(), 0, overlay,
+        0.0f, scaleMax, ImVec2(ImGui::GetContentRegionAvail().x, 60.0f));
+    ImGui::PopID();
+}
+
+void PerformancePanel::LoadRecordedHistory(const char* series)
+{
+    const auto window = HISTORY_RANGES[mHistoryRange].WindowMs;
+    auto& plot = mRecordedPlots[series];
+    if (plot.End == mRecordedEndShown && plot.WindowMs == window
+        && plot.Blocks == mArchive.GetNumBlocks()) {
+        return;
+    }
+
+    const auto from = mRecordedEndShown - window;
+    mHistoryBuckets.clear();
+    mArchive.Query(series, from, mRecordedEndShown, window / HISTORY_PLOT_POINTS, mHistoryBuckets);
+
+    plot.Values.resize(mHistoryBuckets.size());
+    for (size_t i = 0; i < mHistoryBuckets.size(); ++i) {
+        plot.Values[i] = (float)mHistoryBuckets[i].Avg;
+    }
+    plot.Stats = mArchive.Aggregate(series, from, mRecordedEndShown);
+    plot.End = mRecordedEndShown;
+    plot.WindowMs = window;
+    plot.Blocks = mArchive.GetNumBlocks();
+}
+
 void PerformancePanel::InitCpuPanel()
 {
     mCpuInfo = CpuPerformance::Get();
@@ -203,4 +352,4 @@ void PerformancePanel::ClosePanels()
     CpuPerformance::Get()->Stop();
 }
 
-} // RESANA
\ No newline at end of file
+} // RESANA
\ No newline at end of file
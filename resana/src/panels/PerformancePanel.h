@@ -2,6 +2,7 @@
 
 #include "Panel.h"
 #include "system/cpu/CpuPerformance.h"
+#include "system/history/HistoryArchive.h"
 #include "system/memory/MemoryPerformance.h"
 
 //#include "helpers/Time.h"
@@ -25,6 +26,12 @@ private:
     void ShowPhysicalMemoryTable() const;
     void ShowVirtualMemoryTable() const;
     void ShowCpuTable();
+    void ShowHistoryRange();
+    // Picks the end of the range shown from the history file
+    void ShowRecordedRange();
+    // Plots the selected range of a metric history series
+    void ShowHistory(const char* label, const char* series, float scaleMax);
+    void LoadRecordedHistory(const char* series);
     void InitCpuPanel();
     void UpdateCpuPanel();
     void InitMemoryPanel();
@@ -38,6 +45,27 @@ private:
     bool mPanelOpen = false;
 
     uint32_t mUpdateInterval {};
+
+    // Points per plot; the history picks the level that gives about as many
+    static constexpr int64_t HISTORY_PLOT_POINTS = 240;
+    int mHistoryRange = 0;
+    std::vector<HistoryBucket> mHistoryBuckets {};
+    std::vector<float> mHistoryValues {};
+
+    // A recorded plot is decoded from the file once per range picked, not
+    // per frame, as a long range spans many blocks
+    struct RecordedPlot {
+        std::vector<float> Values {};
+        HistoryStats Stats {};
+        int64_t End {};
+        int64_t WindowMs {};
+        size_t Blocks {};
+    };
+    bool mShowRecorded = false;
+    HistoryArchive mArchive {};
+    int64_t mRecordedEnd {}; // Unix ms
+    int64_t mRecordedEndShown {};
+    std::unordered_map<std::string, RecordedPlot> mRecordedPlots {};
 };
 
 } // RESANA
@@ -1,23 +1,21 @@
 #include "ProcessPanel.h"
 #include "rspch.h"
 
-#include "core/Application.h"
-
 #include "imgui/ImGuiHelpers.h"
 #include <imgui.h>
 
+#include <cstdio>
 #include <memory>
 #include <mutex>
 
 #include "core/Core.h"
+#include "system/SystemRuntime.h"
 #include "system/cpu/CpuPerformance.h"
 #include "system/memory/MemoryPerformance.h"
 
 namespace RESANA {
 
-const ImGuiTableSortSpecs *ProcessPanel::sCurrentSortSpecs = nullptr;
-
-ProcessPanel::ProcessPanel() = default;
+ProcessPanel::ProcessPanel() { SetDefaultViewOptions(); }
 
 ProcessPanel::ProcessPanel(const ProcessPanel &other) : Panel(other) {
   mDataCache = other.mDataCache;
@@ -72,11 +70,8 @@ void ProcessPanel::OnUpdate(const Timestep ts) {
 void ProcessPanel::OnImGuiRender() {}
 
 void ProcessPanel::UpdateProcessList() {
-  auto &tp = Application::Get().GetThreadPool();
-  tp.Queue([&] {
-    ProcessManager::SyncProcessContainer(mDataCache);
-    mDataCache.UpdateEntries();
-  });
+  auto &tp = SystemRuntime::Get().GetThreadPool();
+  tp.Queue([&] { ProcessManager::SyncProcessContainer(mDataCache); });
 }
 
 void ProcessPanel::ShowPanel(bool *pOpen) {
@@ -85,6 +80,7 @@ void ProcessPanel::ShowPanel(bool *pOpen) {
   if ((mPanelOpen = *pOpen)) {
     if (ImGui::BeginChild("Details", ImGui::GetContentRegionAvail())) {
       processManager->Run();
+      ShowSearchBox();
       ShowProcessTable();
     }
     ImGui::EndChild();
@@ -108,6 +104,17 @@ void ProcessPanel::ShowViewMenu() {
   CalcTableColumnCount();
 }
 
+void ProcessPanel::ShowSearchBox() {
+  ImGui::SetNextItemWidth(-FLT_MIN);
+  if (ImGui::InputTextWithHint(
+          "##process_search",
+          "Search by name, command line or PID (^ for name prefix)",
+          mSearchBuffer, sizeof(mSearchBuffer))) {
+    mSearchQuery = mSearchBuffer;
+    mSearchDirty = true;
+  }
+}
+
 uint32_t ProcessPanel::GetTableColumnCount() const { return mTableColumnCount; }
 
 bool ProcessPanel::ShouldUpdateMemory() {
@@ -134,127 +141,36 @@ bool ProcessPanel::ShouldUpdateProcList() {
   return false;
 }
 
-std::string
-ProcessPanel::GetMemoryUsageFromMap(const uint32_t procId, const bool update,
-                                    std::function<ULONG64(uint32_t)> &&memFn) {
-  std::string fString;
-  if (update) {
-    // Update formatted string
-    fString = GetFormattedString(memFn(procId));
-    if (fString.empty()) {
-      fString = "0";
-    }
-    mMemoryStringMap[procId] = fString;
-  } else {
-    fString = mMemoryStringMap[procId];
-  }
-  return fString;
-}
-
 void ProcessPanel::SortTableEntries() {
-  auto &entries = mDataCache.GetEntries();
-
-  // Sort our data if sort specs have been changed!
+  // Sort our data if sort specs have been changed or the data was synced.
+  // The table has no multi-column sorting, so only the first spec applies.
   if (ImGuiTableSortSpecs *sortSpecs = ImGui::TableGetSortSpecs()) {
     if (sortSpecs->SpecsDirty || mDataCache.IsDirty()) {
-      // Store in variable accessible by the sort function.
-      sCurrentSortSpecs = sortSpecs;
-      if (entries.size() > 1) {
-        std::mutex mutex;
-        std::scoped_lock slock(mutex, mDataCache.GetMutex());
-
-        std::sort(entries.begin(), entries.end(),
-                  [&](const std::shared_ptr<ProcessEntry> &lhs,
-                      const std::shared_ptr<ProcessEntry> &rhs) {
-                    return CompareWithSortSpecs(lhs, rhs);
-                  });
+      if (sortSpecs->SpecsCount > 0) {
+        const ImGuiTableColumnSortSpecs &spec = sortSpecs->Specs[0];
+        const ProcessSortSpec sortSpec{
+            (ProcessMenu)spec.ColumnUserID,
+            spec.SortDirection == ImGuiSortDirection_Ascending};
+
+        std::scoped_lock slock(mDataCache.GetMutex());
+        if (mSorter.Sort(mDataCache.GetEntries(), sortSpec)) {
+          mDataCache.Reindex();
+          mSearchDirty = true;
+        }
       }
-      sCurrentSortSpecs = nullptr;
       sortSpecs->SpecsDirty = false;
       mDataCache.SetClean();
     }
   }
 }
 
-bool ProcessPanel::CompareWithSortSpecs(
-    const std::shared_ptr<ProcessEntry> &lhs,
-    const std::shared_ptr<ProcessEntry> &rhs) {
-  for (int n = 0; n < sCurrentSortSpecs->SpecsCount; n++) {
-    const ImGuiTableColumnSortSpecs *sortSpec = &sCurrentSortSpecs->Specs[n];
-    int64_t delta = 0;
-
-    switch (sortSpec->ColumnUserID) {
-    case View_Name: {
-      std::string lStr = lhs->GetName();
-      std::string rStr = rhs->GetName();
-      // Transform to lowercase for consistent differences regardless of case
-      std::transform(lStr.begin(), lStr.end(), lStr.begin(),
-                     [](auto c) { return std::tolower(c); });
-      std::transform(rStr.begin(), rStr.end(), rStr.begin(),
-                     [](auto c) { return std::tolower(c); });
-      delta = lStr.compare(rStr);
-    } break;
-    case View_Id:
-      delta = (int)(lhs->GetId() - rhs->GetId());
-      break;
-    case View_ParentProcessId:
-      delta = (int)(lhs->GetParentId() - rhs->GetParentId());
-      break;
-    case View_CpuLoad:
-      // int truncates difference, so we have to assign delta based on
-      //  the floating-point value.
-      static double load;
-      load = lhs->GetCpuLoad() - rhs->GetCpuLoad();
-      if (load > 0) {
-        delta = -1;
-      } else if (load < 0) {
-        delta = 1;
-      } else {
-        delta = 0;
-      }
-      break;
-    case View_PrivateUsage:
-      delta = (int64_t)(-lhs->GetPrivateUsage() + rhs->GetPrivateUsage());
-      break;
-    case View_WorkingSet:
-      delta = (int64_t)(-lhs->GetWorkingSetSize() + rhs->GetWorkingSetSize());
-      break;
-    case View_ThreadCount:
-      delta = (int)(-lhs->GetThreadCount() + rhs->GetThreadCount());
-      break;
-    case View_PriorityClass:
-      delta = (int)(-lhs->GetPriorityClass() + rhs->GetPriorityClass());
-      break;
-    case View_Status:
-      if (!lhs->IsRunning() && rhs->IsRunning()) {
-        delta = -1;
-      } else if (lhs->IsRunning() && !rhs->IsRunning()) {
-        delta = 1;
-      } else {
-        delta = 0;
-      }
-      break;
-    default:
-      RS_CORE_ASSERT(false, "Unknown column!")
-      break;
-    }
-    if (delta > 0) {
-      return (sortSpec->SortDirection == ImGuiSortDirection_Ascending) ? true
-                                                                       : false;
-    }
-    if (delta < 0) {
-      return (sortSpec->SortDirection == ImGuiSortDirection_Ascending) ? false
-                                                                       : true;
-    }
-  }
-
-  return false;
-}
-
 void ProcessPanel::CalcTableColumnCount() {
   int numColumns = 1;
+  mVisibleColumns.fill(false);
+  mVisibleColumns[View_Name] = true;
   for (const auto &[item, status] : mMenuMap) {
     numColumns += status ? 1 : 0;
+    mVisibleColumns[item] = status;
   }
 
   mTableColumnCount = numColumns;
@@ -293,70 +209,24 @@ void ProcessPanel::ShowProcessTable() {
     SetupTableColumns();
 
     // Lock the data and read the entries
-    const bool updateMemory = mUpdateMemoryStats;
     SortTableEntries();
 
     std::scoped_lock listLock(mDataCache.GetMutex());
-    for (auto &entry : mDataCache.GetEntries()) {
-      ImGui::TableNextRow();
-      ImGui::TableNextColumn();
-
-      {
-        std::scoped_lock slock(entry->Mutex());
+    auto &entries = mDataCache.GetEntries();
 
-        static char uniqueId[64];
-        sprintf_s(uniqueId, "##%u", entry->GetId());
+    // Rows outside the scroll region are skipped without being locked or
+    // formatted, so a frame costs the same for 100 or 50,000 processes.
+    const bool filtered = !mSearchQuery.empty();
+    if (filtered) {
+      UpdateSearchResults();
+    }
 
-        if (ImGui::Selectable(entry->GetName().c_str(), entry->IsSelected(),
-                              ImGuiSelectableFlags_SpanAllColumns,
-                              ImGui::GetColumnWidth(-1), uniqueId)) {
-          mDataCache.SelectEntry(entry);
-        }
-        if (CheckMenuOption(View_Id)) {
-          ImGui::TableNextColumn();
-          ImGui::Text("%u", entry->GetId());
-        }
-        if (CheckMenuOption(View_ParentProcessId)) {
-          ImGui::TableNextColumn();
-          ImGui::Text("%u", entry->GetParentId());
-        }
-        if (CheckMenuOption(View_CpuLoad)) {
-          ImGui::TableNextColumn();
-          static double procLoad = 0.0;
-          procLoad = entry->GetCpuLoad();
-          ImGui::Text("%.2f%%", procLoad);
-        }
-        if (CheckMenuOption(View_PrivateUsage)) {
-          ImGui::TableNextColumn();
-
-          static std::string fString{};
-          fString = GetMemoryUsageFromMap(entry->GetId(), updateMemory,
-                                          MemoryPerformance::GetPrivateUsageKB);
-          ImGui::SetRightJustify(fString.c_str());
-          ImGui::Text("%s K", fString.c_str());
-        }
-        if (CheckMenuOption(View_WorkingSet)) {
-          ImGui::TableNextColumn();
-
-          static std::string fString{};
-          fString =
-              GetMemoryUsageFromMap(entry->GetId(), updateMemory,
-                                    MemoryPerformance::GetWorkingSetSizeKB);
-          ImGui::SetRightJustify(fString.c_str());
-          ImGui::Text("%s K", fString.c_str());
-        }
-        if (CheckMenuOption(View_ThreadCount)) {
-          ImGui::TableNextColumn();
-          ImGui::Text("%u", entry->GetThreadCount());
-        }
-        if (CheckMenuOption(View_PriorityClass)) {
-          ImGui::TableNextColumn();
-          ImGui::Text("%u", entry->GetPriorityClass());
-        }
-        if (CheckMenuOption(View_Status)) {
-          ImGui::TableNextColumn();
-          ImGui::Text("%s", entry->IsRunning() ? "Running" : "Stopped");
-        }
+    ImGuiListClipper clipper;
+    clipper.Begin(filtered ? (int)mSearchRows.size() : (int)entries.size());
+    while (clipper.Step()) {
+      for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+        ShowProcessRow(
+            entries[filtered ? mSearchRows[(size_t)row] : (size_t)row]);
       }
     }
     ImGui::EndTable();
@@ -367,6 +237,82 @@ void ProcessPanel::ShowProcessTable() {
   mUpdateProcList = false;
 }
 
+void ProcessPanel::ShowProcessRow(std::shared_ptr<ProcessEntry> &entry) {
+  ImGui::TableNextRow();
+  ImGui::TableNextColumn();
+
+  std::scoped_lock slock(entry->Mutex());
+
+  char uniqueId[16];
+  std::snprintf(uniqueId, sizeof(uniqueId), "##%u", entry->GetId());
+
+  if (ImGui::Selectable(entry->GetName().c_str(), entry->IsSelected(),
+                        ImGuiSelectableFlags_SpanAllColumns,
+                        ImGui::GetColumnWidth(-1), uniqueId)) {
+    mDataCache.SelectEntry(entry);
+  }
+  if (mVisibleColumns[View_Id]) {
+    ImGui::TableNextColumn();
+    ImGui::Text("%u", entry->GetId());
+  }
+  if (mVisibleColumns[View_ParentProcessId]) {
+    ImGui::TableNextColumn();
+    ImGui::Text("%u", entry->GetParentId());
+  }
+  if (mVisibleColumns[View_CpuLoad]) {
+    ImGui::TableNextColumn();
+    ImGui::Text("%.2f%%", entry->GetCpuLoad());
+  }
+  if (mVisibleColumns[View_PrivateUsage]) {
+    ImGui::TableNextColumn();
+    const auto fString =
+        GetFormattedString(entry->GetPrivateUsage() / BYTES_PER_KB);
+    ImGui::SetRightJustify(fString.c_str());
+    ImGui::Text("%s K", fString.c_str());
+  }
+  if (mVisibleColumns[View_WorkingSet]) {
+    ImGui::TableNextColumn();
+    const auto fString =
+        GetFormattedString(entry->GetWorkingSetSize() / BYTES_PER_KB);
+    ImGui::SetRightJustify(fString.c_str());
+    ImGui::Text("%s K", fString.c_str());
+  }
+  if (mVisibleColumns[View_ThreadCount]) {
+    ImGui::TableNextColumn();
+    ImGui::Text("%u", entry->GetThreadCount());
+  }
+  if (mVisibleColumns[View_PriorityClass]) {
+    ImGui::TableNextColumn();
+    ImGui::Text("%u", entry->GetPriorityClass());
+  }
+  if (mVisibleColumns[View_Status]) {
+    ImGui::TableNextColumn();
+    ImGui::Text("%s", entry->IsRunning() ? "Running" : "Stopped");
+  }
+}
+
+void ProcessPanel::UpdateSearchResults() {
+  // The entries are locked by the caller
+  if (mSearchSyncVersion != mDataCache.GetSyncVersion()) {
+    mSearchIndex.Update(mDataCache.GetEntries());
+    mSearchSyncVersion = mDataCache.GetSyncVersion();
+    mSearchDirty = true;
+  }
+  if (!mSearchDirty) {
+    return;
+  }
+
+  mSearchIndex.Search(mSearchQuery, mSearchIds);
+  mSearchRows.clear();
+  for (const auto procId : mSearchIds) {
+    if (const int index = mDataCache.FindIndex(procId); index >= 0) {
+      mSearchRows.push_back((uint32_t)index);
+    }
+  }
+  std::sort(mSearchRows.begin(), mSearchRows.end());
+  mSearchDirty = false;
+}
+
 void ProcessPanel::SetDefaultViewOptions() {
   mMenuMap[View_Id] = true;
   mMenuMap[View_CpuLoad] = true;
@@ -398,7 +344,7 @@ void ProcessPanel::SetupTableColumns() {
     if (mUpdateProcList) {
       cpuLoad = CpuPerformance::Get()->GetCpuLoad();
     }
-    sprintf_s(label, "  %.1f%%\n  CPU", cpuLoad);
+    std::snprintf(label, sizeof(label), "  %.1f%%\n  CPU", cpuLoad);
     ImGui::TableSetupColumn(label, ImGuiTableColumnFlags_WidthFixed, 0.0f,
                             View_CpuLoad);
   }
@@ -1,26 +1,19 @@
 #pragma once
 
 #include "Panel.h"
+#include "ProcessSearch.h"
+#include "ProcessSorter.h"
 
 #include "system/processes/ProcessContainer.h"
 #include "system/processes/ProcessManager.h"
 
+#include <imgui.h>
+
+#include <array>
 #include <stack>
 
 namespace RESANA {
 
-enum ProcessMenu {
-  View_Name = 0,
-  View_Id,
-  View_ParentProcessId,
-  View_CpuLoad,
-  View_WorkingSet,
-  View_PrivateUsage,
-  View_ThreadCount,
-  View_PriorityClass,
-  View_Status,
-};
-
 class ProcessPanel final : public Panel {
 public:
   ProcessPanel();
@@ -35,6 +28,9 @@ public:
   void UpdateProcessList();
   void ShowPanel(bool *pOpen) override;
   void ShowViewMenu();
+  void ShowSearchBox();
+  // Draws only the rows inside the table's scroll region
+  void ShowProcessTable();
   void SetUpdateInterval(Timestep interval) override;
 
   [[nodiscard]] bool IsPanelOpen() const override { return mPanelOpen; }
@@ -42,24 +38,22 @@ public:
   bool CheckMenuOption(ProcessMenu option);
 
   [[nodiscard]] uint32_t GetTableColumnCount() const;
+  ProcessContainer &GetDataCache() { return mDataCache; }
 
   void SortTableEntries();
-  static bool CompareWithSortSpecs(const std::shared_ptr<ProcessEntry> &lhs,
-                                   const std::shared_ptr<ProcessEntry> &rhs);
+
+  // The number with thousands separators, as the memory columns show it
+  template <typename T> static std::string GetFormattedString(T number);
 
 private:
-  void ShowProcessTable();
+  void ShowProcessRow(std::shared_ptr<ProcessEntry> &entry);
+  void UpdateSearchResults();
   void SetDefaultViewOptions();
   void SetupTableColumns();
   void CalcTableColumnCount();
   bool ShouldUpdateMemory();
   bool ShouldUpdateProcList();
 
-  std::string GetMemoryUsageFromMap(uint32_t procId, bool update,
-                                    std::function<ULONG64(uint32_t)> &&memFn);
-
-  template <typename T> static std::string GetFormattedString(T number);
-
 private:
   ProcessContainer mDataCache{};
   bool mPanelOpen = false;
@@ -73,12 +67,20 @@ private:
   Timestep mLastMemUpdate{0};
 
   std::atomic<bool> mSortData{false};
+  ProcessSorter mSorter{};
+
+  ProcessSearchIndex mSearchIndex{};
+  char mSearchBuffer[256]{};
+  std::string mSearchQuery{};
+  std::vector<uint32_t> mSearchIds{};
+  std::vector<uint32_t> mSearchRows{}; // Matching rows, in table order
+  uint64_t mSearchSyncVersion{};
+  bool mSearchDirty = true;
 
-  std::unordered_map<uint32_t, std::string> mMemoryStringMap{};
   std::unordered_map<uint32_t, float> mCpuLoadMap{};
   std::unordered_map<ProcessMenu, bool> mMenuMap{};
-
-  static const ImGuiTableSortSpecs *sCurrentSortSpecs;
+  // mMenuMap flattened once per frame for the row loop
+  std::array<bool, View_Count> mVisibleColumns{};
 };
 
 template <typename T> std::string ProcessPanel::GetFormattedString(T number) {
@@ -0,0 +1,290 @@
+#include "ProcessSearch.h"
+#include "rspch.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+namespace RESANA {
+
+namespace {
+
+// Below this the arena is never compacted
+constexpr size_t MIN_COMPACT_SIZE = 64 * 1024;
+
+char Fold(const char c) { return (char)std::tolower((unsigned char)c); }
+
+void AppendFolded(std::string &text, const std::string &value) {
+  const size_t offset = text.size();
+  text.append(value);
+  std::transform(text.begin() + (std::ptrdiff_t)offset, text.end(),
+                 text.begin() + (std::ptrdiff_t)offset, Fold);
+}
+
+uint32_t MakeTrigram(const char *text) {
+  return (uint32_t)(unsigned char)text[0] << 16 |
+         (uint32_t)(unsigned char)text[1] << 8 | (uint32_t)(unsigned char)text[2];
+}
+
+uint32_t CountDigits(uint32_t value) {
+  uint32_t digits = 1;
+  while (value >= 10) {
+    value /= 10;
+    ++digits;
+  }
+  return digits;
+}
+
+// True if the decimal pid starts with the given digits
+bool PidStartsWith(uint32_t procId, const uint32_t value,
+                   const uint32_t digits) {
+  for (uint32_t extra = CountDigits(procId); extra > digits; --extra) {
+    procId /= 10;
+  }
+  return CountDigits(procId) == digits && procId == value;
+}
+
+} // namespace
+
+void ProcessSearchIndex::Update(const ProcessList &entries) {
+  ++mUpdateTick;
+
+  for (const auto &entry : entries) {
+    if (!entry) {
+      continue;
+    }
+
+    const auto it = mDocumentIds.find(entry->GetId());
+    if (it == mDocumentIds.end()) {
+      AddDocument(*entry);
+    } else if (auto &document = mDocuments[it->second];
+               document.CreationTime != entry->GetCreationTime() ||
+               !IsSameName(document, entry->GetName())) {
+      // The pid was reused, or the process exec'd another program
+      RemoveDocument(it->second);
+      AddDocument(*entry);
+    } else {
+      document.UpdateTick = mUpdateTick;
+    }
+  }
+
+  // Drop the processes that exited
+  if (mDocumentIds.size() > entries.size()) {
+    for (auto it = mDocumentIds.begin(); it != mDocumentIds.end();) {
+      if (mDocuments[it->second].UpdateTick != mUpdateTick) {
+        RemoveDocument(it->second);
+        it = mDocumentIds.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  if (mText.size() > MIN_COMPACT_SIZE && mDeadText > mText.size() / 2) {
+    Rebuild();
+  }
+}
+
+void ProcessSearchIndex::Search(std::string_view query,
+                                std::vector<uint32_t> &procIds) {
+  procIds.clear();
+
+  while (!query.empty() && std::isspace((unsigned char)query.front())) {
+    query.remove_prefix(1);
+  }
+  while (!query.empty() && std::isspace((unsigned char)query.back())) {
+    query.remove_suffix(1);
+  }
+
+  const bool prefix = !query.empty() && query.front() == '^';
+  if (prefix) {
+    query.remove_prefix(1);
+  }
+
+  std::string folded(query);
+  std::transform(folded.begin(), folded.end(), folded.begin(), Fold);
+
+  if (folded.empty()) {
+    for (const auto &[procId, document] : mDocumentIds) {
+      procIds.push_back(procId);
+    }
+    mLastQuery.clear();
+    return;
+  }
+
+  // Pick the smallest set of documents that can contain the query
+  const std::vector<uint32_t> *candidates = nullptr;
+  bool checkAll = false;
+  const bool narrows =
+      !mLastQuery.empty() && mLastGeneration == mGeneration &&
+      mLastPrefix == prefix &&
+      (prefix ? folded.compare(0, mLastQuery.size(), mLastQuery) == 0
+              : folded.find(mLastQuery) != std::string::npos);
+
+  if (narrows) {
+    candidates = &mLastMatches;
+  } else if (folded.size() >= 3) {
+    for (size_t i = 0; i + 3 <= folded.size(); ++i) {
+      const auto it = mPostings.find(MakeTrigram(folded.data() + i));
+      if (it == mPostings.end()) {
+        // No document contains this trigram
+        candidates = nullptr;
+        break;
+      }
+      if (!candidates || it->second.size() < candidates->size()) {
+        candidates = &it->second;
+      }
+    }
+  } else {
+    checkAll = true;
+  }
+
+  ++mSearchStamp;
+  mCandidates.clear();
+  auto check = [&](const uint32_t index) {
+    auto &document = mDocuments[index];
+    if (!document.Live || document.SearchStamp == mSearchStamp) {
+      return;
+    }
+
+    const auto text = GetText(document);
+    const bool match =
+        prefix ? document.NameLength >= folded.size() &&
+                     text.compare(0, folded.size(), folded) == 0
+               : text.find(folded) != std::string_view::npos;
+    if (match) {
+      document.SearchStamp = mSearchStamp;
+      mCandidates.push_back(index);
+    }
+  };
+
+  if (checkAll) {
+    for (uint32_t i = 0; i < (uint32_t)mDocuments.size(); ++i) {
+      check(i);
+    }
+  } else if (candidates) {
+    for (const auto index : *candidates) {
+      check(index);
+    }
+  }
+
+  mLastMatches.swap(mCandidates);
+  mLastQuery = folded;
+  mLastPrefix = prefix;
+  mLastGeneration = mGeneration;
+
+  for (const auto index : mLastMatches) {
+    procIds.push_back(mDocuments[index].Id);
+  }
+
+  // A number also matches the pids it starts. Parsed as 64 bits, as
+  // unsigned long is 32 bits on Windows; larger values are no pid.
+  const bool isNumber =
+      !prefix && folded.size() <= 10 &&
+      std::all_of(folded.begin(), folded.end(),
+                  [](char c) { return c >= '0' && c <= '9'; });
+  const uint64_t number =
+      isNumber ? std::strtoull(folded.c_str(), nullptr, 10) : 0;
+  if (isNumber && number <= UINT32_MAX) {
+    const auto value = (uint32_t)number;
+    const auto digits = (uint32_t)folded.size();
+    for (const auto &document : mDocuments) {
+      if (document.Live && document.SearchStamp != mSearchStamp &&
+          PidStartsWith(document.Id, value, digits)) {
+        procIds.push_back(document.Id);
+      }
+    }
+  }
+}
+
+void ProcessSearchIndex::AddDocument(const ProcessEntry &entry) {
+  uint32_t index;
+  if (mFreeDocuments.empty()) {
+    index = (uint32_t)mDocuments.size();
+    mDocuments.emplace_back();
+  } else {
+    index = mFreeDocuments.back();
+    mFreeDocuments.pop_back();
+  }
+
+  auto &document = mDocuments[index];
+  document.Id = entry.GetId();
+  document.CreationTime = entry.GetCreationTime();
+  document.Offset = (uint32_t)mText.size();
+  AppendFolded(mText, entry.GetName());
+  document.NameLength = (uint32_t)(mText.size() - document.Offset);
+  mText.push_back('\n');
+  AppendFolded(mText, entry.GetCommandLine());
+  document.Length = (uint32_t)(mText.size() - document.Offset);
+  document.UpdateTick = mUpdateTick;
+  document.Live = true;
+
+  mDocumentIds[document.Id] = index;
+  IndexDocument(index);
+  ++mGeneration;
+}
+
+void ProcessSearchIndex::RemoveDocument(const uint32_t index) {
+  auto &document = mDocuments[index];
+  document.Live = false;
+  mDeadText += document.Length;
+  mFreeDocuments.push_back(index);
+  ++mGeneration;
+}
+
+void ProcessSearchIndex::IndexDocument(const uint32_t index) {
+  const auto text = GetText(mDocuments[index]);
+
+  // Each trigram once, and none spanning the name and command line
+  auto &trigrams = mTrigrams;
+  trigrams.clear();
+  for (size_t i = 0; i + 3 <= text.size(); ++i) {
+    if (text[i] != '\n' && text[i + 1] != '\n' && text[i + 2] != '\n') {
+      trigrams.push_back(MakeTrigram(text.data() + i));
+    }
+  }
+  std::sort(trigrams.begin(), trigrams.end());
+  trigrams.erase(std::unique(trigrams.begin(), trigrams.end()),
+                 trigrams.end());
+
+  for (const auto trigram : trigrams) {
+    mPostings[trigram].push_back(index);
+  }
+}
+
+void ProcessSearchIndex::Rebuild() {
+  std::string text;
+  text.reserve(mText.size() - mDeadText);
+  for (auto &document : mDocuments) {
+    if (document.Live) {
+      const auto offset = (uint32_t)text.size();
+      text.append(GetText(document));
+      document.Offset = offset;
+    }
+  }
+  mText.swap(text);
+  mDeadText = 0;
+
+  mPostings.clear();
+  for (uint32_t i = 0; i < (uint32_t)mDocuments.size(); ++i) {
+    if (mDocuments[i].Live) {
+      IndexDocument(i);
+    }
+  }
+}
+
+bool ProcessSearchIndex::IsSameName(const Document &document,
+                                    const std::string &name) const {
+  if (document.NameLength != name.size()) {
+    return false;
+  }
+  const char *text = mText.data() + document.Offset;
+  for (size_t i = 0; i < name.size(); ++i) {
+    if (text[i] != Fold(name[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace RESANA
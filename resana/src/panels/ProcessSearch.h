@@ -0,0 +1,86 @@
+#pragma once
+
+#include "system/processes/ProcessContainer.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace RESANA {
+
+// Finds processes by name, command line or pid as the user types.
+//
+// The case folded name and command line of every process are packed into one
+// text arena, and each trigram of that text maps to the processes containing
+// it. A query looks up its rarest trigram and only checks those processes; a
+// query that extends the previous one only checks the previous matches.
+// Processes that start or exit are added and removed incrementally; the arena
+// is compacted once most of it belongs to exited processes.
+//
+// Query syntax:
+//   text   substring of the name or command line
+//   ^text  prefix of the name
+//   123    also matches pids starting with those digits
+class ProcessSearchIndex {
+public:
+  // Indexes the processes that started and drops those that exited since the
+  // last call. Only new processes are tokenized.
+  void Update(const ProcessList &entries);
+
+  // Pids of the matching processes, in no particular order. An empty query
+  // matches every process.
+  void Search(std::string_view query, std::vector<uint32_t> &procIds);
+
+  [[nodiscard]] size_t GetNumProcesses() const { return mDocumentIds.size(); }
+
+private:
+  struct Document {
+    uint32_t Id{};
+    uint64_t CreationTime{};
+    uint32_t Offset{};     // Folded name, '\n', folded command line
+    uint32_t NameLength{};
+    uint32_t Length{};
+    uint32_t UpdateTick{}; // Last Update() that saw this pid
+    uint32_t SearchStamp{};
+    bool Live = false;
+  };
+
+  void AddDocument(const ProcessEntry &entry);
+  void RemoveDocument(uint32_t document);
+  void IndexDocument(uint32_t document);
+  void Rebuild();
+
+  [[nodiscard]] bool IsSameName(const Document &document,
+                                const std::string &name) const;
+  [[nodiscard]] std::string_view GetText(const Document &document) const {
+    return {mText.data() + document.Offset, document.Length};
+  }
+
+private:
+  std::vector<Document> mDocuments{};
+  std::vector<uint32_t> mFreeDocuments{};
+  std::unordered_map<uint32_t, uint32_t> mDocumentIds{}; // pid -> document
+
+  std::string mText{};
+  size_t mDeadText{};
+
+  // Trigram -> documents containing it. Removed documents stay listed until
+  // the next rebuild; every candidate is checked against its text anyway.
+  std::unordered_map<uint32_t, std::vector<uint32_t>> mPostings{};
+
+  uint32_t mUpdateTick{};
+  uint32_t mSearchStamp{};
+  uint32_t mGeneration{}; // Changes whenever documents are added or removed
+
+  // The last search, to narrow it down while the user keeps typing
+  std::string mLastQuery{};
+  bool mLastPrefix = false;
+  uint32_t mLastGeneration{};
+  std::vector<uint32_t> mLastMatches{};
+  std::vector<uint32_t> mCandidates{};
+  std::vector<uint32_t> mTrigrams{};
+};
+
+} // namespace RESANA
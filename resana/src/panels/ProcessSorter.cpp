@@ -0,0 +1,219 @@
+#include "ProcessSorter.h"
+#include "rspch.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+#include "core/Core.h"
+
+namespace RESANA {
+
+namespace {
+
+// Maps a double to an integer with the same order
+uint64_t OrderedBits(const double value) {
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return (bits & (1ull << 63)) ? ~bits : bits | (1ull << 63);
+}
+
+} // namespace
+
+bool ProcessSorter::Sort(ProcessList &entries, const ProcessSortSpec &spec) {
+  const bool incremental = mSorted && spec.Column == mLastSpec.Column &&
+                           spec.Ascending == mLastSpec.Ascending;
+  mLastSpec = spec;
+  mSorted = true;
+
+  if (entries.size() < 2) {
+    return false;
+  }
+
+  switch (spec.Column) {
+  case View_Name:
+    InternNames(entries);
+    BuildKeys<View_Name>(entries, spec.Ascending);
+    break;
+  case View_Id:
+    BuildKeys<View_Id>(entries, spec.Ascending);
+    break;
+  case View_ParentProcessId:
+    BuildKeys<View_ParentProcessId>(entries, spec.Ascending);
+    break;
+  case View_CpuLoad:
+    BuildKeys<View_CpuLoad>(entries, spec.Ascending);
+    break;
+  case View_WorkingSet:
+    BuildKeys<View_WorkingSet>(entries, spec.Ascending);
+    break;
+  case View_PrivateUsage:
+    BuildKeys<View_PrivateUsage>(entries, spec.Ascending);
+    break;
+  case View_ThreadCount:
+    BuildKeys<View_ThreadCount>(entries, spec.Ascending);
+    break;
+  case View_PriorityClass:
+    BuildKeys<View_PriorityClass>(entries, spec.Ascending);
+    break;
+  case View_Status:
+    BuildKeys<View_Status>(entries, spec.Ascending);
+    break;
+  default:
+    RS_CORE_ASSERT(false, "Unknown column!")
+    return false;
+  }
+
+  const bool reordered = SortKeys(incremental);
+  if (reordered) {
+    mReordered.resize(entries.size());
+    for (size_t i = 0; i < mKeys.size(); ++i) {
+      mReordered[i] = std::move(entries[mKeys[i].Index]);
+    }
+    entries.swap(mReordered);
+  }
+
+  if (spec.Column == View_Name) {
+    KeepNameOrder(entries);
+  }
+  return reordered;
+}
+
+template <ProcessMenu Column>
+void ProcessSorter::BuildKeys(const ProcessList &entries,
+                              const bool ascending) {
+  // Descending flips every bit of the key
+  const uint64_t flip = ascending ? 0 : ~0ull;
+
+  mKeys.resize(entries.size());
+  for (uint32_t i = 0; i < (uint32_t)entries.size(); ++i) {
+    const auto &entry = *entries[i];
+    mKeys[i] = {GetKey<Column>(entry, i) ^ flip, entry.GetId(), i};
+  }
+}
+
+// Ascending keys give the order the table has always used: names and pids
+// from the highest, the metrics from the lowest and running processes first.
+template <ProcessMenu Column>
+uint64_t ProcessSorter::GetKey(const ProcessEntry &entry,
+                               const uint32_t index) const {
+  if constexpr (Column == View_Name) {
+    return ~(uint64_t)mNameRanks[mEntryNames[index]];
+  } else if constexpr (Column == View_Id) {
+    return ~(uint64_t)entry.GetId();
+  } else if constexpr (Column == View_ParentProcessId) {
+    return ~(uint64_t)entry.GetParentId();
+  } else if constexpr (Column == View_CpuLoad) {
+    return OrderedBits(entry.GetCpuLoad());
+  } else if constexpr (Column == View_WorkingSet) {
+    return entry.GetWorkingSetSize();
+  } else if constexpr (Column == View_PrivateUsage) {
+    return entry.GetPrivateUsage();
+  } else if constexpr (Column == View_ThreadCount) {
+    return entry.GetThreadCount();
+  } else if constexpr (Column == View_PriorityClass) {
+    return entry.GetPriorityClass();
+  } else {
+    return entry.IsRunning() ? 0 : 1;
+  }
+}
+
+void ProcessSorter::InternNames(const ProcessList &entries) {
+  // Forget the pids that exited once they outnumber the live ones
+  if (mProcessNames.size() > entries.size() * 2) {
+    mProcessNames.clear();
+  }
+
+  mEntryNames.resize(entries.size());
+  for (size_t i = 0; i < entries.size(); ++i) {
+    const auto &entry = *entries[i];
+    if (i < mSortedNames.size() && mSortedNames[i].IsOf(entry)) {
+      mEntryNames[i] = mSortedNames[i].NameId;
+      continue;
+    }
+
+    auto &interned = mProcessNames[entry.GetId()];
+    if (!interned.IsOf(entry)) {
+      // First sort since the pid appeared or its process exec'd another
+      // program; the name is only copied here
+      std::string folded = entry.GetName();
+      std::transform(folded.begin(), folded.end(), folded.begin(),
+                     [](unsigned char c) { return (char)std::tolower(c); });
+
+      const auto [it, inserted] =
+          mNameLookup.try_emplace(std::move(folded), (uint32_t)mNames.size());
+      if (inserted) {
+        mNames.push_back(&it->first);
+        mNewNames = true;
+      }
+      interned = {&entry, entry.GetId(), entry.GetNameGeneration(),
+                  it->second};
+    }
+    mEntryNames[i] = interned.NameId;
+  }
+
+  if (mNewNames) {
+    UpdateNameRanks();
+  }
+}
+
+void ProcessSorter::KeepNameOrder(const ProcessList &entries) {
+  mSortedNames.resize(entries.size());
+  for (size_t i = 0; i < entries.size(); ++i) {
+    const auto &entry = *entries[i];
+    mSortedNames[i] = {&entry, entry.GetId(), entry.GetNameGeneration(),
+                       mEntryNames[mKeys[i].Index]};
+  }
+}
+
+void ProcessSorter::UpdateNameRanks() {
+  std::vector<uint32_t> order(mNames.size());
+  for (uint32_t i = 0; i < (uint32_t)order.size(); ++i) {
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), [&](uint32_t lhs, uint32_t rhs) {
+    return *mNames[lhs] < *mNames[rhs];
+  });
+
+  mNameRanks.resize(mNames.size());
+  for (uint32_t rank = 0; rank < (uint32_t)order.size(); ++rank) {
+    mNameRanks[order[rank]] = rank;
+  }
+  mNewNames = false;
+}
+
+bool ProcessSorter::SortKeys(const bool incremental) {
+  if (!incremental) {
+    std::sort(mKeys.begin(), mKeys.end());
+    return true;
+  }
+
+  // Keep the rows that are still in order and move the others aside. A row
+  // smaller than the last kept one takes that row with it, as either of the
+  // two may be the one whose value changed.
+  mOutOfOrder.clear();
+  size_t kept = 0;
+  for (const auto &key : mKeys) {
+    if (kept == 0 || !(key < mKeys[kept - 1])) {
+      mKeys[kept++] = key;
+    } else {
+      mOutOfOrder.push_back(mKeys[--kept]);
+      mOutOfOrder.push_back(key);
+    }
+  }
+
+  if (mOutOfOrder.empty()) {
+    return false;
+  }
+
+  mKeys.resize(kept);
+  std::sort(mOutOfOrder.begin(), mOutOfOrder.end());
+
+  mMerged.resize(mKeys.size() + mOutOfOrder.size());
+  std::merge(mKeys.begin(), mKeys.end(), mOutOfOrder.begin(),
+             mOutOfOrder.end(), mMerged.begin());
+  mKeys.swap(mMerged);
+  return true;
+}
+
+} // namespace RESANA
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "system/processes/ProcessContainer.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace RESANA {
+
+enum ProcessMenu {
+  View_Name = 0,
+  View_Id,
+  View_ParentProcessId,
+  View_CpuLoad,
+  View_WorkingSet,
+  View_PrivateUsage,
+  View_ThreadCount,
+  View_PriorityClass,
+  View_Status,
+  View_Count
+};
+
+struct ProcessSortSpec {
+  ProcessMenu Column = View_Name;
+  bool Ascending = true;
+};
+
+// Orders the process table by one column. Every row is reduced to an integer
+// key that already holds the column's value and the sort direction, so one
+// comparator serves all columns. Names are case folded and interned once per
+// process, and their key is the rank of the folded name.
+//
+// Between calls the entries keep the order of the last sort. When the column
+// and direction are unchanged, only the rows that fell out of order are
+// sorted, and then merged back into the rows that did not, so a tick where a
+// few values changed costs O(n + k log k) for k moved rows.
+class ProcessSorter {
+public:
+  // Returns true if the order of the entries changed
+  bool Sort(ProcessList &entries, const ProcessSortSpec &spec);
+
+private:
+  struct SortKey {
+    uint64_t Key{};
+    uint32_t Id{};    // Breaks ties, so equal keys always sort the same way
+    uint32_t Index{}; // Position of the entry before sorting
+
+    bool operator<(const SortKey &rhs) const {
+      return Key < rhs.Key || (Key == rhs.Key && Id < rhs.Id);
+    }
+  };
+
+  // A freed entry's address can be reused, so the pid is checked as well.
+  // The name changes on exec, which gives the entry a new name generation.
+  struct InternedName {
+    const ProcessEntry *Entry{};
+    uint32_t Id{};
+    uint32_t NameGeneration{};
+    uint32_t NameId{};
+
+    bool IsOf(const ProcessEntry &entry) const {
+      return Entry == &entry && Id == entry.GetId() &&
+             NameGeneration == entry.GetNameGeneration();
+    }
+  };
+
+  template <ProcessMenu Column>
+  void BuildKeys(const ProcessList &entries, bool ascending);
+  template <ProcessMenu Column>
+  [[nodiscard]] uint64_t GetKey(const ProcessEntry &entry,
+                                uint32_t index) const;
+
+  void InternNames(const ProcessList &entries);
+  void KeepNameOrder(const ProcessList &entries);
+  void UpdateNameRanks();
+
+  bool SortKeys(bool incremental);
+
+private:
+  std::vector<SortKey> mKeys{};
+  std::vector<SortKey> mOutOfOrder{};
+  std::vector<SortKey> mMerged{};
+  ProcessList mReordered{};
+
+  // Folded names, interned by pid
+  std::unordered_map<uint32_t, InternedName> mProcessNames{};
+  std::unordered_map<std::string, uint32_t> mNameLookup{};
+  std::vector<const std::string *> mNames{};
+  std::vector<uint32_t> mNameRanks{}; // Name id -> rank of the folded name
+  std::vector<uint32_t> mEntryNames{}; // Name id of each entry being sorted
+  // Names in the order of the last name sort, so rows that did not move
+  // skip the pid lookup
+  std::vector<InternedName> mSortedNames{};
+  bool mNewNames = false;
+
+  ProcessSortSpec mLastSpec{};
+  bool mSorted = false;
+};
+
+} // namespace RESANA
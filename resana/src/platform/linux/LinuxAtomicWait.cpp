@@ -0,0 +1,34 @@
+#include "system/AtomicWait.h"
+#include "rspch.h"
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <climits>
+#include <ctime>
+
+namespace RESANA {
+
+static long Futex(std::atomic<uint32_t> &word, int op, uint32_t value,
+                  const timespec *timeout) {
+  return ::syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), op, value,
+                   timeout, nullptr, 0);
+}
+
+void AtomicWait(std::atomic<uint32_t> &word, uint32_t expected,
+                uint32_t timeoutMs) {
+  const timespec timeout{(time_t)(timeoutMs / 1000),
+                         (long)(timeoutMs % 1000) * 1000000L};
+  Futex(word, FUTEX_WAIT_PRIVATE, expected, &timeout);
+}
+
+void AtomicWakeOne(std::atomic<uint32_t> &word) {
+  Futex(word, FUTEX_WAKE_PRIVATE, 1, nullptr);
+}
+
+void AtomicWakeAll(std::atomic<uint32_t> &word) {
+  Futex(word, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr);
+}
+
+} // namespace RESANA
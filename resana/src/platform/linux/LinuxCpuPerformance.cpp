@@ -0,0 +1,55 @@
+#include "system/cpu/CpuPerformance.h"
+#include "rspch.h"
+
+#include "core/Core.h"
+
+#include "ProcPidStat.h"
+#include "ProcStat.h"
+
+#include <limits.h>
+#include <unistd.h>
+
+#include <cstdio>
+
+namespace RESANA {
+
+void CpuPerformance::InitCpuData() {
+  mProcStat = std::make_unique<ProcStatReader>(std::string(GetProcRoot()) +
+                                               "/stat");
+
+  if (mProcStat->Open()) {
+    mNumProcessors = mProcStat->GetNumProcessors();
+  } else {
+    RS_CORE_ERROR("Could not initialize the /proc/stat sampler");
+    mNumProcessors = (int)::sysconf(_SC_NPROCESSORS_ONLN);
+  }
+}
+
+bool CpuPerformance::PrepareData(LogicalCoreData &data) {
+  // /proc/stat holds cumulative counters, so one read per scheduler tick is
+  // enough for the reader to compute the load since the previous one.
+  if (!mProcStat || !mProcStat->Sample()) {
+    return false;
+  }
+
+  // First sample, or cores went on or offline; map the new set once
+  const auto &items = mProcStat->GetItems();
+  const bool layoutChanged = mProcStat->GetGeneration() != mProcStatGeneration;
+  mProcStatGeneration = mProcStat->GetGeneration();
+  ApplyItems(items.data(), (PdhSize)items.size(), layoutChanged, data);
+
+  return true;
+}
+
+float CpuPerformance::GetCpuLoad() {
+  char path[PATH_MAX];
+  std::snprintf(path, sizeof(path), "%s/stat", GetProcRoot());
+  CpuTimes times{};
+  auto loadNorm = ProcStatReader::ReadTotal(times, path)
+                      ? CalcCpuLoad(times.GetIdle(), times.GetTotal())
+                      : -1.0f;
+  auto loadPerc = loadNorm * 100.0f;
+  return loadPerc;
+}
+
+} // namespace RESANA
@@ -0,0 +1,107 @@
+#include "system/history/MappedFile.h"
+#include "rspch.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+namespace RESANA {
+
+MappedFile::~MappedFile() { Close(); }
+
+bool MappedFile::Open(const std::string &path, const Access access) {
+  Close();
+
+  const int flags = access == Access::ReadWrite ? O_RDWR | O_CREAT : O_RDONLY;
+  mFd = ::open(path.c_str(), flags | O_CLOEXEC, 0644);
+  if (mFd < 0) {
+    RS_CORE_WARN("Could not open {0}: {1}", path, std::strerror(errno));
+    return false;
+  }
+
+  struct stat status {};
+  if (::fstat(mFd, &status) != 0) {
+    Close();
+    return false;
+  }
+
+  mAccess = access;
+  if (!Map((size_t)status.st_size)) {
+    Close();
+    return false;
+  }
+  return true;
+}
+
+void MappedFile::Close() {
+  Unmap();
+  if (mFd >= 0) {
+    ::close(mFd);
+    mFd = -1;
+  }
+}
+
+bool MappedFile::Resize(const size_t bytes) {
+  if (mFd < 0 || mAccess != Access::ReadWrite) {
+    return false;
+  }
+
+  Unmap();
+  if (::ftruncate(mFd, (off_t)bytes) != 0) {
+    RS_CORE_ERROR("Could not resize a mapped file to {0} bytes: {1}", bytes,
+                  std::strerror(errno));
+    return false;
+  }
+  return Map(bytes);
+}
+
+bool MappedFile::Remap() {
+  struct stat status {};
+  if (mFd < 0 || ::fstat(mFd, &status) != 0 ||
+      (size_t)status.st_size <= mSize) {
+    return false;
+  }
+
+  Unmap();
+  return Map((size_t)status.st_size);
+}
+
+void MappedFile::FlushAsync() {
+  if (mData && mAccess == Access::ReadWrite) {
+    ::msync(mData, mSize, MS_ASYNC);
+  }
+}
+
+bool MappedFile::IsOpen() const { return mFd >= 0; }
+
+bool MappedFile::Map(const size_t bytes) {
+  if (bytes == 0) {
+    return true;
+  }
+
+  const int protection =
+      mAccess == Access::ReadWrite ? PROT_READ | PROT_WRITE : PROT_READ;
+  void *data = ::mmap(nullptr, bytes, protection, MAP_SHARED, mFd, 0);
+  if (data == MAP_FAILED) {
+    RS_CORE_ERROR("Could not map {0} bytes: {1}", bytes, std::strerror(errno));
+    return false;
+  }
+
+  mData = static_cast<uint8_t *>(data);
+  mSize = bytes;
+  return true;
+}
+
+void MappedFile::Unmap() {
+  if (mData) {
+    ::munmap(mData, mSize);
+    mData = nullptr;
+  }
+  mSize = 0;
+}
+
+} // namespace RESANA
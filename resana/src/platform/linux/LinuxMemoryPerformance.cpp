@@ -0,0 +1,70 @@
+#include "system/memory/MemoryPerformance.h"
+#include "rspch.h"
+
+#include "ProcPidStat.h"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+
+namespace RESANA {
+
+// Returns the value of a "Key:   1234 kB" line in bytes, or 0 if missing
+static uint64_t FindMemInfoValue(const char *buffer, const char *key) {
+  const char *pos = std::strstr(buffer, key);
+  if (!pos) {
+    return 0;
+  }
+
+  pos += std::strlen(key);
+  while (*pos == ' ') {
+    ++pos;
+  }
+
+  uint64_t value = 0;
+  while (*pos >= '0' && *pos <= '9') {
+    value = value * 10 + (uint64_t)(*pos++ - '0');
+  }
+  return value * 1024;
+}
+
+bool MemoryPerformance::QueryMemoryStatus(MemoryStatus &status) {
+  char path[PATH_MAX];
+  std::snprintf(path, sizeof(path), "%s/meminfo", GetProcRoot());
+  const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+
+  char buffer[4096];
+  const ssize_t count = ::read(fd, buffer, sizeof(buffer) - 1);
+  ::close(fd);
+  if (count <= 0) {
+    return false;
+  }
+  buffer[count] = '\0';
+
+  status.TotalPhys = FindMemInfoValue(buffer, "MemTotal:");
+  status.AvailPhys = FindMemInfoValue(buffer, "\nMemAvailable:");
+
+  // The commit limit plays the role of the Windows page file total; there is
+  // no per-process address space limit worth reporting, so the virtual
+  // figures mirror the commit charge.
+  const uint64_t commitLimit = FindMemInfoValue(buffer, "\nCommitLimit:");
+  const uint64_t committed = FindMemInfoValue(buffer, "\nCommitted_AS:");
+  status.TotalPageFile = commitLimit;
+  status.AvailPageFile = commitLimit > committed ? commitLimit - committed : 0;
+  status.TotalVirtual = status.TotalPageFile;
+  status.AvailVirtual = status.AvailPageFile;
+
+  if (status.TotalPhys != 0) {
+    status.MemoryLoad = (uint32_t)(
+        (status.TotalPhys - status.AvailPhys) * 100 / status.TotalPhys);
+  }
+  return true;
+}
+
+} // namespace RESANA
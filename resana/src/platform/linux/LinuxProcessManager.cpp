@@ -0,0 +1,58 @@
+#include "system/processes/ProcessManager.h"
+#include "rspch.h"
+
+#include "core/Core.h"
+
+#include "ProcScanner.h"
+
+namespace RESANA {
+
+bool ProcessManager::PrepareData() {
+  if (!mScanner) {
+    mScanner = std::make_unique<ProcScanner>(GetProcRoot());
+  }
+
+  // Walk /proc without holding any lock
+  const auto *records = mScanner->Scan();
+  if (!records || ShouldClose()) {
+    return false;
+  }
+
+  // One pass over the snapshot. The stat line is already parsed and the other
+  // files are cached, so a known process costs two preads and a few stores
+  // into the table's columns.
+  ProcessMetrics metrics{};
+  std::string commandLine;
+  mTable.BeginScan();
+  for (const auto &record : *records) {
+    if (ShouldClose()) {
+      return false;
+    }
+
+    bool created = false;
+    const uint64_t creationTime = ProcTicksToNanoseconds(record.StartTicks);
+    const auto slot = mTable.Acquire(record.Id, creationTime, created);
+    mTable.SetStatus(slot, record.ParentId, record.ThreadCount,
+                     (uint32_t)record.Priority, record.State);
+    mTable.SetName(slot, record.Name); // Changes on exec
+
+    if (created) {
+      mScanner->ReadCommandLine(record.Id, commandLine);
+      mTable.SetCommandLine(slot, commandLine);
+    }
+    const bool hasMetrics = mScanner->ReadMetrics(record, metrics);
+    if (hasMetrics) {
+      mTable.ApplyMetrics(slot, metrics);
+    }
+    if (mTrace) {
+      AddTraceProcess(slot, creationTime, created,
+                      hasMetrics ? &metrics : nullptr);
+    }
+  }
+  mTable.EndScan();
+  mTable.UpdateCpuLoads();
+
+  return !ShouldClose();
+}
+
+} // namespace RESANA
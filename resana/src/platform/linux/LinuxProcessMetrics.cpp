@@ -0,0 +1,79 @@
+#include "system/processes/ProcessMetrics.h"
+#include "rspch.h"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <ctime>
+
+namespace RESANA {
+
+static uint64_t GetMonotonicNanoseconds() {
+  timespec ts{};
+  ::clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static ssize_t ReadProcFile(uint32_t procId, const char *name, char *buffer,
+                            size_t size) {
+  char path[PATH_MAX];
+  std::snprintf(path, sizeof(path), "%s/%u/%s", GetProcRoot(procId), procId,
+                name);
+
+  const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return -1;
+  }
+
+  const ssize_t count = ::read(fd, buffer, size);
+  ::close(fd);
+  return count;
+}
+
+bool CollectProcessMetrics(uint32_t procId, ProcessMetrics &metrics) {
+  ProcPidStat stat{};
+  if (!ReadProcPidStat(procId, stat)) {
+    return false;
+  }
+
+  char buffer[256];
+  ProcPidStatm statm{};
+  ssize_t count = ReadProcFile(procId, "statm", buffer, sizeof(buffer));
+  if (count <= 0 || !ParseProcPidStatm(buffer, (size_t)count, statm)) {
+    return false;
+  }
+
+  // Only readable for our own processes unless privileged
+  ProcPidIo io{};
+  count = ReadProcFile(procId, "io", buffer, sizeof(buffer));
+  const bool hasIo = count > 0 && ParseProcPidIo(buffer, (size_t)count, io);
+
+  MakeProcessMetrics(stat, statm, hasIo ? &io : nullptr, metrics);
+  return true;
+}
+
+void MakeProcessMetrics(const ProcPidStat &stat, const ProcPidStatm &statm,
+                        const ProcPidIo *io, ProcessMetrics &metrics) {
+  metrics.Time = GetMonotonicNanoseconds();
+  metrics.CreationTime = ProcTicksToNanoseconds(stat.StartTicks);
+  metrics.UserTime = ProcTicksToNanoseconds(stat.UserTicks);
+  metrics.SystemTime = ProcTicksToNanoseconds(stat.SystemTicks);
+  metrics.ThreadCount = stat.ThreadCount;
+
+  // Resident pages not backed by a shared mapping are what this process
+  // alone keeps in memory.
+  metrics.WorkingSetSize = ProcPagesToBytes(statm.ResidentPages);
+  metrics.PrivateUsage = ProcPagesToBytes(
+      statm.ResidentPages > statm.SharedPages
+          ? statm.ResidentPages - statm.SharedPages
+          : 0);
+
+  metrics.ReadBytes = io ? io->ReadBytes : 0;
+  metrics.WriteBytes = io ? io->WriteBytes : 0;
+}
+
+uint32_t GetCurrentProcessIdentifier() { return (uint32_t)::getpid(); }
+
+} // namespace RESANA
@@ -0,0 +1,193 @@
+#include "ProcFdCache.h"
+#include "rspch.h"
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+
+namespace RESANA {
+
+static const char *const PROC_FILE_NAMES[] = {"stat", "statm", "io"};
+
+// Descriptors kept free for everything else the application opens
+static constexpr size_t RESERVED_FDS = 256;
+
+ProcFdCache::ProcFdCache(size_t capacity) : mCapacity(capacity) {}
+
+ProcFdCache::~ProcFdCache() { Clear(); }
+
+void ProcFdCache::SetRootFd(int rootFd) {
+  if (rootFd != mRootFd) {
+    Clear();
+    mRootFd = rootFd;
+  }
+}
+
+size_t ProcFdCache::GetDefaultCapacity() {
+  rlimit limit{};
+  if (::getrlimit(RLIMIT_NOFILE, &limit) != 0 ||
+      limit.rlim_cur == RLIM_INFINITY) {
+    return 4096;
+  }
+
+  const auto available = (size_t)limit.rlim_cur;
+  if (available <= RESERVED_FDS) {
+    return 0;
+  }
+  return (available - RESERVED_FDS) / (size_t)ProcFile::Count;
+}
+
+void ProcFdCache::SetCapacity(size_t capacity) {
+  mCapacity = capacity;
+  if (mCapacity == 0) {
+    Clear();
+  } else {
+    EvictOverflow();
+  }
+}
+
+ssize_t ProcFdCache::Read(uint32_t procId, ProcFile file, char *buffer,
+                          size_t size) {
+  if (mCapacity == 0) {
+    return ReadUncached(procId, file, buffer, size);
+  }
+
+  // A second attempt is made when the cached file belonged to a process that
+  // exited, as its pid may already have been reused.
+  for (int attempt = 0; attempt < 2; ++attempt) {
+    Entry &entry = Touch(procId);
+    int &fd = entry.Fds[(size_t)file];
+
+    if (fd == FD_UNAVAILABLE) {
+      return -1;
+    }
+    if (fd == FD_CLOSED) {
+      fd = OpenFile(procId, file);
+      if (fd < 0) {
+        if (errno == EACCES || errno == EPERM) {
+          fd = FD_UNAVAILABLE;
+        } else {
+          Evict(procId);
+        }
+        return -1;
+      }
+    }
+
+    ++mStats.Reads;
+    const ssize_t count = ::pread(fd, buffer, size, 0);
+    if (count >= 0) {
+      return count;
+    }
+
+    const int error = errno;
+    if (error == EACCES || error == EPERM) {
+      // Some files (io) are checked on read rather than on open
+      ++mStats.Closes;
+      ::close(fd);
+      fd = FD_UNAVAILABLE;
+      return -1;
+    }
+
+    Evict(procId);
+    if (error != ESRCH) {
+      return -1;
+    }
+  }
+
+  return -1;
+}
+
+void ProcFdCache::EndTick() {
+  while (!mEntries.empty() && mEntries.back().Tick != mTick) {
+    Evict(mEntries.back().ProcId);
+  }
+}
+
+void ProcFdCache::Evict(uint32_t procId) {
+  const auto it = mIndex.find(procId);
+  if (it == mIndex.end()) {
+    return;
+  }
+
+  CloseEntry(*it->second);
+  mFreeEntries.splice(mFreeEntries.begin(), mEntries, it->second);
+  mIndex.erase(it);
+}
+
+void ProcFdCache::Clear() {
+  for (auto &entry : mEntries) {
+    CloseEntry(entry);
+  }
+  mFreeEntries.splice(mFreeEntries.begin(), mEntries);
+  mIndex.clear();
+}
+
+ProcFdCache::Entry &ProcFdCache::Touch(uint32_t procId) {
+  if (const auto it = mIndex.find(procId); it != mIndex.end()) {
+    mEntries.splice(mEntries.begin(), mEntries, it->second);
+    it->second->Tick = mTick;
+    return *it->second;
+  }
+
+  if (mFreeEntries.empty()) {
+    mEntries.emplace_front();
+  } else {
+    mEntries.splice(mEntries.begin(), mFreeEntries, mFreeEntries.begin());
+  }
+
+  Entry &entry = mEntries.front();
+  entry.ProcId = procId;
+  entry.Tick = mTick;
+  for (int &fd : entry.Fds) {
+    fd = FD_CLOSED;
+  }
+  mIndex[procId] = mEntries.begin();
+
+  EvictOverflow();
+  return entry;
+}
+
+int ProcFdCache::OpenFile(uint32_t procId, ProcFile file) {
+  char path[32];
+  std::snprintf(path, sizeof(path), "%u/%s", procId,
+                PROC_FILE_NAMES[(size_t)file]);
+
+  ++mStats.Opens;
+  return ::openat(mRootFd, path, O_RDONLY | O_CLOEXEC);
+}
+
+ssize_t ProcFdCache::ReadUncached(uint32_t procId, ProcFile file, char *buffer,
+                                  size_t size) {
+  const int fd = OpenFile(procId, file);
+  if (fd < 0) {
+    return -1;
+  }
+
+  ++mStats.Reads;
+  const ssize_t count = ::read(fd, buffer, size);
+  ++mStats.Closes;
+  ::close(fd);
+  return count;
+}
+
+void ProcFdCache::CloseEntry(Entry &entry) {
+  for (int &fd : entry.Fds) {
+    if (fd >= 0) {
+      ++mStats.Closes;
+      ::close(fd);
+    }
+    fd = FD_CLOSED;
+  }
+}
+
+void ProcFdCache::EvictOverflow() {
+  // The front entry is the one being sampled and is never evicted here
+  while (mIndex.size() > std::max<size_t>(mCapacity, 1)) {
+    Evict(mEntries.back().ProcId);
+  }
+}
+
+} // namespace RESANA
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+
+#include <sys/types.h>
+
+namespace RESANA {
+
+// The per-process files the sampler reads every tick
+enum class ProcFile : uint8_t { Stat = 0, Statm, Io, Count };
+
+// Number of /proc calls made, to compare sampling strategies
+struct ProcSyscallStats {
+  uint64_t Opens{};
+  uint64_t Reads{};
+  uint64_t Closes{};
+  uint64_t Other{}; // getdents64, lseek, ...
+
+  [[nodiscard]] uint64_t GetTotal() const {
+    return Opens + Reads + Closes + Other;
+  }
+};
+
+// Keeps /proc/<pid>/{stat,statm,io} open between ticks so re-sampling a
+// process is one pread per file instead of open/read/close. The number of
+// cached processes is bounded; the least recently sampled ones are closed
+// first. A process that exits is dropped as soon as a read fails with ESRCH
+// or it is not seen for a whole tick.
+class ProcFdCache {
+public:
+  // capacity 0 disables caching: every read opens and closes the file
+  explicit ProcFdCache(size_t capacity = GetDefaultCapacity());
+  ~ProcFdCache();
+
+  ProcFdCache(const ProcFdCache &) = delete;
+  ProcFdCache &operator=(const ProcFdCache &) = delete;
+
+  // Directory the "<pid>/<file>" paths are resolved against
+  void SetRootFd(int rootFd);
+
+  // Reads the whole file from offset 0. Returns the number of bytes read or
+  // -1 if the process is gone or the file is not readable.
+  ssize_t Read(uint32_t procId, ProcFile file, char *buffer, size_t size);
+
+  // Starts a new sampling tick
+  void BeginTick() { ++mTick; }
+  // Drops the processes that were not read since BeginTick()
+  void EndTick();
+
+  void Evict(uint32_t procId);
+  void Clear();
+
+  void SetCapacity(size_t capacity);
+  [[nodiscard]] size_t GetCapacity() const { return mCapacity; }
+  [[nodiscard]] size_t GetSize() const { return mIndex.size(); }
+
+  [[nodiscard]] const ProcSyscallStats &GetStats() const { return mStats; }
+  ProcSyscallStats &GetStats() { return mStats; }
+
+  // Leaves room for the rest of the application within RLIMIT_NOFILE
+  static size_t GetDefaultCapacity();
+
+private:
+  static constexpr int FD_CLOSED = -1;
+  static constexpr int FD_UNAVAILABLE = -2; // Permission denied, don't retry
+
+  struct Entry {
+    uint32_t ProcId{};
+    uint64_t Tick{};
+    int Fds[(size_t)ProcFile::Count]{FD_CLOSED, FD_CLOSED, FD_CLOSED};
+  };
+  using EntryList = std::list<Entry>;
+
+  Entry &Touch(uint32_t procId);
+  int OpenFile(uint32_t procId, ProcFile file);
+  ssize_t ReadUncached(uint32_t procId, ProcFile file, char *buffer,
+                       size_t size);
+  void CloseEntry(Entry &entry);
+  void EvictOverflow();
+
+private:
+  int mRootFd = -1;
+  size_t mCapacity{};
+  uint64_t mTick{};
+
+  // Most recently sampled first
+  EntryList mEntries{};
+  std::unordered_map<uint32_t, EntryList::iterator> mIndex{};
+  // Nodes of evicted entries, kept for reuse
+  EntryList mFreeEntries{};
+
+  ProcSyscallStats mStats{};
+};
+
+} // namespace RESANA
@@ -0,0 +1,185 @@
+#include "ProcPidStat.h"
+#include "rspch.h"
+
+#include "system/SystemRuntime.h"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+
+namespace RESANA {
+
+static const char *ParseNumber(const char *pos, const char *end,
+                               int64_t &value) {
+  while (pos < end && *pos == ' ') {
+    ++pos;
+  }
+
+  bool negative = false;
+  if (pos < end && *pos == '-') {
+    negative = true;
+    ++pos;
+  }
+
+  uint64_t result = 0;
+  while (pos < end && *pos >= '0' && *pos <= '9') {
+    result = result * 10 + (uint64_t)(*pos++ - '0');
+  }
+
+  value = negative ? -(int64_t)result : (int64_t)result;
+  return pos;
+}
+
+bool ParseProcPidStat(const char *buffer, size_t length, ProcPidStat &stat) {
+  const char *end = buffer + length;
+
+  // The name may itself contain spaces and parentheses, so it spans from the
+  // first '(' to the last ')'.
+  const char *open = (const char *)std::memchr(buffer, '(', length);
+  const char *close = nullptr;
+  for (const char *pos = end - 1; pos > buffer; --pos) {
+    if (*pos == ')') {
+      close = pos;
+      break;
+    }
+  }
+  if (!open || !close || close < open || end - close < 4) {
+    return false;
+  }
+
+  int64_t value = 0;
+  ParseNumber(buffer, open, value);
+  stat.Id = (uint32_t)value;
+
+  const size_t nameLength =
+      std::min((size_t)(close - open - 1), sizeof(stat.Name) - 1);
+  std::memcpy(stat.Name, open + 1, nameLength);
+  stat.Name[nameLength] = '\0';
+
+  // Field 3 (state) follows ") "
+  const char *pos = close + 2;
+  stat.State = *pos++;
+
+  for (int field = 4; field <= 24 && pos < end; ++field) {
+    pos = ParseNumber(pos, end, value);
+
+    switch (field) {
+    case 4:
+      stat.ParentId = (uint32_t)value;
+      break;
+    case 14:
+      stat.UserTicks = (uint64_t)value;
+      break;
+    case 15:
+      stat.SystemTicks = (uint64_t)value;
+      break;
+    case 18:
+      stat.Priority = (int32_t)value;
+      break;
+    case 19:
+      stat.Nice = (int32_t)value;
+      break;
+    case 20:
+      stat.ThreadCount = (uint32_t)value;
+      break;
+    case 22:
+      stat.StartTicks = (uint64_t)value;
+      break;
+    case 23:
+      stat.VirtualSize = (uint64_t)value;
+      break;
+    case 24:
+      stat.RssPages = (uint64_t)value;
+      return true;
+    default:
+      break;
+    }
+  }
+
+  return false;
+}
+
+bool ParseProcPidStatm(const char *buffer, size_t length, ProcPidStatm &statm) {
+  // size resident shared text lib data dt
+  const char *end = buffer + length;
+  int64_t value = 0;
+
+  const char *pos = ParseNumber(buffer, end, value);
+  statm.SizePages = (uint64_t)value;
+  pos = ParseNumber(pos, end, value);
+  statm.ResidentPages = (uint64_t)value;
+  pos = ParseNumber(pos, end, value);
+  statm.SharedPages = (uint64_t)value;
+
+  return pos < end && *pos == ' ';
+}
+
+bool ParseProcPidIo(const char *buffer, size_t length, ProcPidIo &io) {
+  // "rchar: N\nwchar: N\n...", one key per line
+  const char *end = buffer + length;
+  int64_t value = 0;
+  int found = 0;
+
+  for (const char *pos = buffer; pos < end && found < 2;) {
+    const char *colon = (const char *)std::memchr(pos, ':', (size_t)(end - pos));
+    if (!colon) {
+      break;
+    }
+
+    const size_t keyLength = (size_t)(colon - pos);
+    pos = ParseNumber(colon + 1, end, value);
+    if (keyLength == 5 && std::memcmp(colon - 5, "rchar", 5) == 0) {
+      io.ReadBytes = (uint64_t)value;
+      ++found;
+    } else if (keyLength == 5 && std::memcmp(colon - 5, "wchar", 5) == 0) {
+      io.WriteBytes = (uint64_t)value;
+      ++found;
+    }
+
+    while (pos < end && *pos++ != '\n') {
+    }
+  }
+
+  return found == 2;
+}
+
+const char *GetProcRoot() {
+  return SystemRuntime::Exists() ? SystemRuntime::Get().GetProcRoot().c_str()
+                                 : "/proc";
+}
+
+const char *GetProcRoot(const uint32_t procId) {
+  return procId == (uint32_t)::getpid() ? "/proc" : GetProcRoot();
+}
+
+bool ReadProcPidStat(uint32_t procId, ProcPidStat &stat) {
+  char path[PATH_MAX];
+  std::snprintf(path, sizeof(path), "%s/%u/stat", GetProcRoot(procId),
+                procId);
+
+  const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+
+  char buffer[1024];
+  const ssize_t count = ::read(fd, buffer, sizeof(buffer));
+  ::close(fd);
+
+  return count > 0 && ParseProcPidStat(buffer, (size_t)count, stat);
+}
+
+uint64_t ProcTicksToNanoseconds(uint64_t ticks) {
+  static const auto sTicksPerSecond = (uint64_t)::sysconf(_SC_CLK_TCK);
+  return ticks * 1000000000ull / sTicksPerSecond;
+}
+
+uint64_t ProcPagesToBytes(uint64_t pages) {
+  static const auto sPageSize = (uint64_t)::sysconf(_SC_PAGESIZE);
+  return pages * sPageSize;
+}
+
+} // namespace RESANA
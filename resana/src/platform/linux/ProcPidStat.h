@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace RESANA {
+
+// The fields of /proc/<pid>/stat the process views need
+struct ProcPidStat {
+  uint32_t Id{};
+  uint32_t ParentId{};
+  char State{};
+  int32_t Priority{};
+  int32_t Nice{};
+  uint32_t ThreadCount{};
+  uint64_t UserTicks{};
+  uint64_t SystemTicks{};
+  uint64_t StartTicks{};
+  uint64_t VirtualSize{};
+  uint64_t RssPages{};
+  char Name[16]{}; // TASK_COMM_LEN
+};
+
+// The fields of /proc/<pid>/statm, in pages
+struct ProcPidStatm {
+  uint64_t SizePages{};
+  uint64_t ResidentPages{};
+  uint64_t SharedPages{};
+};
+
+// The fields of /proc/<pid>/io that match the Windows I/O transfer counters
+struct ProcPidIo {
+  uint64_t ReadBytes{};  // rchar
+  uint64_t WriteBytes{}; // wchar
+};
+
+// The procfs directory of the SystemRuntime (SystemRuntime::SetProcRoot), or
+// /proc outside of one. Every path the collectors read starts with it.
+const char *GetProcRoot();
+// The same for the files of one process, except that this process is always
+// read from /proc: a generated tree does not hold it, and its own CPU and
+// memory figures are still wanted.
+const char *GetProcRoot(uint32_t procId);
+
+// Parses the contents of a /proc/<pid>/stat file. Returns false if the
+// buffer is not a complete stat line.
+bool ParseProcPidStat(const char *buffer, size_t length, ProcPidStat &stat);
+
+bool ParseProcPidStatm(const char *buffer, size_t length, ProcPidStatm &statm);
+bool ParseProcPidIo(const char *buffer, size_t length, ProcPidIo &io);
+
+// Reads and parses /proc/<pid>/stat with a single read into a stack buffer
+bool ReadProcPidStat(uint32_t procId, ProcPidStat &stat);
+
+// Converts clock ticks (USER_HZ) to nanoseconds
+uint64_t ProcTicksToNanoseconds(uint64_t ticks);
+
+uint64_t ProcPagesToBytes(uint64_t pages);
+
+} // namespace RESANA
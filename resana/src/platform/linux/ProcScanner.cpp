@@ -0,0 +1,173 @@
+#include "ProcScanner.h"
+#include "rspch.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace RESANA {
+
+static constexpr size_t DIR_BUFFER_SIZE = 64 * 1024;
+static constexpr size_t MAX_COMMAND_LINE = 16 * 1024;
+
+// Layout of the records returned by getdents64
+struct LinuxDirent64 {
+  uint64_t Inode;
+  int64_t Offset;
+  unsigned short RecordLength;
+  unsigned char Type;
+  char Name[];
+};
+
+ProcScanner::ProcScanner(std::string root) : mRoot(std::move(root)) {}
+
+ProcScanner::~ProcScanner() { Close(); }
+
+bool ProcScanner::Open() {
+  if (mDirFd >= 0) {
+    return true;
+  }
+
+  mDirFd = ::open(mRoot.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (mDirFd < 0) {
+    RS_CORE_ERROR("Could not open '{0}' (errno {1})", mRoot, errno);
+    return false;
+  }
+
+  mDirBuffer.resize(DIR_BUFFER_SIZE);
+  mFdCache.SetRootFd(mDirFd);
+  return true;
+}
+
+void ProcScanner::Close() {
+  if (mDirFd >= 0) {
+    mFdCache.SetRootFd(-1);
+    ::close(mDirFd);
+    mDirFd = -1;
+  }
+}
+
+const std::vector<ProcPidStat> *ProcScanner::Scan() {
+  if (!Open()) {
+    return nullptr;
+  }
+
+  mRecords.clear();
+  mFdCache.BeginTick();
+
+  auto &stats = mFdCache.GetStats();
+  ++stats.Other;
+  if (::lseek(mDirFd, 0, SEEK_SET) < 0) {
+    RS_CORE_ERROR("Could not rewind '{0}' (errno {1})", mRoot, errno);
+    Close();
+    return nullptr;
+  }
+
+  while (true) {
+    ++stats.Other;
+    const long count = ::syscall(SYS_getdents64, mDirFd, mDirBuffer.data(),
+                                 mDirBuffer.size());
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      RS_CORE_ERROR("getdents64 on '{0}' failed (errno {1})", mRoot, errno);
+      return nullptr;
+    }
+    if (count == 0) {
+      break;
+    }
+
+    for (long offset = 0; offset < count;) {
+      const auto *entry =
+          reinterpret_cast<const LinuxDirent64 *>(mDirBuffer.data() + offset);
+      offset += entry->RecordLength;
+
+      // Only the numeric directories are processes
+      if (entry->Name[0] < '0' || entry->Name[0] > '9' ||
+          (entry->Type != DT_DIR && entry->Type != DT_UNKNOWN)) {
+        continue;
+      }
+
+      const auto procId = (uint32_t)std::strtoul(entry->Name, nullptr, 10);
+      ProcPidStat stat{};
+      if (ReadStat(procId, stat)) {
+        mRecords.push_back(stat);
+      }
+    }
+  }
+
+  // Close the files of the processes that exited
+  mFdCache.EndTick();
+  return &mRecords;
+}
+
+bool ProcScanner::ReadMetrics(const ProcPidStat &stat,
+                              ProcessMetrics &metrics) {
+  char buffer[256];
+  ProcPidStatm statm{};
+  ssize_t count =
+      mFdCache.Read(stat.Id, ProcFile::Statm, buffer, sizeof(buffer));
+  if (count <= 0 || !ParseProcPidStatm(buffer, (size_t)count, statm)) {
+    return false;
+  }
+
+  ProcPidIo io{};
+  count = mFdCache.Read(stat.Id, ProcFile::Io, buffer, sizeof(buffer));
+  const bool hasIo = count > 0 && ParseProcPidIo(buffer, (size_t)count, io);
+
+  MakeProcessMetrics(stat, statm, hasIo ? &io : nullptr, metrics);
+  return true;
+}
+
+bool ProcScanner::ReadCommandLine(uint32_t procId, std::string &commandLine) {
+  commandLine.clear();
+  if (!Open()) {
+    return false;
+  }
+
+  auto &stats = mFdCache.GetStats();
+  char path[32];
+  std::snprintf(path, sizeof(path), "%u/cmdline", procId);
+  ++stats.Opens;
+  const int fd = ::openat(mDirFd, path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+
+  char buffer[4096];
+  while (commandLine.size() < MAX_COMMAND_LINE) {
+    ++stats.Reads;
+    const ssize_t count = ::read(fd, buffer, sizeof(buffer));
+    if (count <= 0) {
+      break;
+    }
+    commandLine.append(buffer, (size_t)count);
+  }
+  ++stats.Closes;
+  ::close(fd);
+
+  // The arguments are separated and terminated by NULs
+  while (!commandLine.empty() && commandLine.back() == '\0') {
+    commandLine.pop_back();
+  }
+  std::replace(commandLine.begin(), commandLine.end(), '\0', ' ');
+  return true;
+}
+
+bool ProcScanner::ReadStat(uint32_t procId, ProcPidStat &stat) {
+  // The process may exit at any point during the walk; just skip it.
+  char buffer[1024];
+  const ssize_t count =
+      mFdCache.Read(procId, ProcFile::Stat, buffer, sizeof(buffer));
+  return count > 0 && ParseProcPidStat(buffer, (size_t)count, stat);
+}
+
+} // namespace RESANA
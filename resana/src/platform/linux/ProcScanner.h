@@ -0,0 +1,54 @@
+#pragma once
+
+#include "ProcFdCache.h"
+#include "ProcPidStat.h"
+
+#include "system/processes/ProcessMetrics.h"
+
+#include <string>
+#include <vector>
+
+namespace RESANA {
+
+// Lists the processes in /proc. The directory stays open between scans and is
+// read with getdents64 into a reusable buffer. The per-process files stay
+// open in a ProcFdCache, so re-sampling a known process is one pread each.
+class ProcScanner {
+public:
+  explicit ProcScanner(std::string root = "/proc");
+  ~ProcScanner();
+
+  ProcScanner(const ProcScanner &) = delete;
+  ProcScanner &operator=(const ProcScanner &) = delete;
+
+  // Returns nullptr if /proc could not be read. The records stay valid until
+  // the next call.
+  const std::vector<ProcPidStat> *Scan();
+
+  // Reads statm and io of a process returned by the last Scan()
+  bool ReadMetrics(const ProcPidStat &stat, ProcessMetrics &metrics);
+
+  // Arguments of a process, separated by spaces. Empty for kernel threads.
+  // The file is not cached, as it is only read for new processes.
+  bool ReadCommandLine(uint32_t procId, std::string &commandLine);
+
+  ProcFdCache &GetFdCache() { return mFdCache; }
+  [[nodiscard]] const ProcSyscallStats &GetStats() const {
+    return mFdCache.GetStats();
+  }
+
+private:
+  bool Open();
+  void Close();
+  bool ReadStat(uint32_t procId, ProcPidStat &stat);
+
+private:
+  std::string mRoot;
+  int mDirFd = -1;
+
+  std::vector<char> mDirBuffer{};
+  std::vector<ProcPidStat> mRecords{};
+  ProcFdCache mFdCache{};
+};
+
+} // namespace RESANA
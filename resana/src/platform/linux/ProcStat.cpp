@@ -0,0 +1,254 @@
+#include "ProcStat.h"
+#include "rspch.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+namespace RESANA {
+
+static constexpr size_t INITIAL_BUFFER_SIZE = 16 * 1024;
+
+ProcStatReader::ProcStatReader(std::string path) : mPath(std::move(path)) {}
+
+ProcStatReader::~ProcStatReader() { Close(); }
+
+bool ProcStatReader::Open() {
+  if (mFd >= 0) {
+    return true;
+  }
+
+  mFd = ::open(mPath.c_str(), O_RDONLY | O_CLOEXEC);
+  if (mFd < 0) {
+    RS_CORE_ERROR("Could not open '{0}' (errno {1})", mPath, errno);
+    return false;
+  }
+
+  if (mBuffer.empty()) {
+    mBuffer.resize(INITIAL_BUFFER_SIZE);
+  }
+
+  // Prime the previous counters so the first real sample has a delta
+  return Sample();
+}
+
+void ProcStatReader::Close() {
+  if (mFd >= 0) {
+    ::close(mFd);
+    mFd = -1;
+  }
+}
+
+bool ProcStatReader::Sample() {
+  if (mFd < 0 || !Read()) {
+    return false;
+  }
+
+  if (!Parse()) {
+    // The set of online cores changed (hotplug); rebuild and parse again.
+    Rebuild();
+    if (!Parse()) {
+      return false;
+    }
+  }
+
+  UpdateLoad(mTotal);
+  for (size_t i = 0; i < mCores.size(); ++i) {
+    UpdateLoad(mCores[i]);
+    mItems[i].FmtValue.doubleValue = mCores[i].Load;
+  }
+  mItems.back().FmtValue.doubleValue = mTotal.Load;
+
+  return true;
+}
+
+bool ProcStatReader::Read() {
+  while (true) {
+    size_t length = 0;
+    ssize_t count;
+
+    while ((count = ::pread(mFd, mBuffer.data() + length,
+                            mBuffer.size() - length, (off_t)length)) > 0) {
+      length += (size_t)count;
+      if (length == mBuffer.size()) {
+        break;
+      }
+    }
+
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      RS_CORE_ERROR("Could not read '{0}' (errno {1})", mPath, errno);
+      return false;
+    }
+
+    if (length < mBuffer.size()) {
+      mLength = length;
+      return true;
+    }
+
+    // The file did not fit; grow once and read it again from the start.
+    mBuffer.resize(mBuffer.size() * 2);
+  }
+}
+
+bool ProcStatReader::Parse() {
+  const char *pos = mBuffer.data();
+  const char *end = pos + mLength;
+
+  bool sawTotal = false;
+  size_t numSeen = 0;
+
+  while (pos < end && end - pos > 3 && pos[0] == 'c' && pos[1] == 'p' &&
+         pos[2] == 'u') {
+    pos += 3;
+
+    if (*pos == ' ') {
+      pos = ParseTimes(pos, end, mTotal.Current);
+      sawTotal = true;
+    } else {
+      int index = 0;
+      while (pos < end && *pos >= '0' && *pos <= '9') {
+        index = index * 10 + (*pos++ - '0');
+      }
+
+      if (index >= (int)mSlotByIndex.size() || mSlotByIndex[index] < 0) {
+        return false;
+      }
+
+      auto &core = mCores[mSlotByIndex[index]];
+      pos = ParseTimes(pos, end, core.Current);
+      ++numSeen;
+    }
+
+    // Skip to the next line
+    while (pos < end && *pos != '\n') {
+      ++pos;
+    }
+    ++pos;
+  }
+
+  if (!sawTotal && mCores.empty()) {
+    RS_CORE_ERROR("No cpu lines found in '{0}'", mPath);
+  }
+
+  return sawTotal && numSeen == mCores.size() && !mCores.empty();
+}
+
+void ProcStatReader::Rebuild() {
+  std::vector<int> indices;
+  int maxIndex = -1;
+
+  const char *pos = mBuffer.data();
+  const char *end = pos + mLength;
+  while (pos < end && end - pos > 3 && std::strncmp(pos, "cpu", 3) == 0) {
+    pos += 3;
+    if (*pos >= '0' && *pos <= '9') {
+      int index = 0;
+      while (pos < end && *pos >= '0' && *pos <= '9') {
+        index = index * 10 + (*pos++ - '0');
+      }
+      indices.push_back(index);
+      maxIndex = std::max(maxIndex, index);
+    }
+    while (pos < end && *pos != '\n') {
+      ++pos;
+    }
+    ++pos;
+  }
+
+  std::sort(indices.begin(), indices.end());
+
+  // Keep the history of cores that are still online
+  std::vector<CoreState> cores(indices.size());
+  for (size_t i = 0; i < indices.size(); ++i) {
+    const int index = indices[i];
+    cores[i].Index = index;
+    if (index < (int)mSlotByIndex.size() && mSlotByIndex[index] >= 0) {
+      cores[i] = mCores[mSlotByIndex[index]];
+    }
+  }
+
+  mCores = std::move(cores);
+  mSlotByIndex.assign((size_t)maxIndex + 1, -1);
+  mNames.resize(mCores.size() + 1);
+  mItems.resize(mCores.size() + 1);
+
+  for (size_t i = 0; i < mCores.size(); ++i) {
+    mSlotByIndex[mCores[i].Index] = (int)i;
+    mNames[i] = std::to_string(mCores[i].Index);
+  }
+  mNames.back() = "_Total";
+
+  for (size_t i = 0; i < mItems.size(); ++i) {
+    mItems[i].szName = mNames[i].data();
+  }
+  ++mGeneration;
+
+  RS_CORE_INFO("Tracking {0} logical processors from '{1}'", mCores.size(),
+               mPath);
+}
+
+void ProcStatReader::UpdateLoad(CoreState &state) {
+  const uint64_t total = state.Current.GetTotal();
+  const uint64_t idle = state.Current.GetIdle();
+  const uint64_t prevTotal = state.Previous.GetTotal();
+  const uint64_t prevIdle = state.Previous.GetIdle();
+
+  if (total > prevTotal && idle >= prevIdle) {
+    const double deltaTotal = (double)(total - prevTotal);
+    const double deltaIdle = (double)(idle - prevIdle);
+    state.Load = std::clamp((deltaTotal - deltaIdle) / deltaTotal * 100.0,
+                            0.0, 100.0);
+  } else if (total < prevTotal) {
+    // Counters went backwards (core was reset); start over.
+    state.Load = 0.0;
+  }
+
+  state.Previous = state.Current;
+}
+
+const char *ProcStatReader::ParseTimes(const char *pos, const char *end,
+                                       CpuTimes &times) {
+  uint64_t *fields[] = {&times.User,   &times.Nice, &times.System,
+                        &times.Idle,   &times.IoWait, &times.Irq,
+                        &times.SoftIrq, &times.Steal};
+
+  for (uint64_t *field : fields) {
+    while (pos < end && *pos == ' ') {
+      ++pos;
+    }
+
+    uint64_t value = 0;
+    while (pos < end && *pos >= '0' && *pos <= '9') {
+      value = value * 10 + (uint64_t)(*pos++ - '0');
+    }
+    *field = value;
+  }
+
+  return pos;
+}
+
+bool ProcStatReader::ReadTotal(CpuTimes &times, const char *path) {
+  const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+
+  // The aggregate line is always first and well below 256 bytes
+  char buffer[256];
+  const ssize_t count = ::read(fd, buffer, sizeof(buffer));
+  ::close(fd);
+
+  if (count <= 4 || std::strncmp(buffer, "cpu ", 4) != 0) {
+    return false;
+  }
+
+  ParseTimes(buffer + 3, buffer + count, times);
+  return true;
+}
+
+} // namespace RESANA
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "system/cpu/LogicalCoreData.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace RESANA {
+
+// Cumulative jiffies of one "cpu" line in /proc/stat
+struct CpuTimes {
+  uint64_t User{};
+  uint64_t Nice{};
+  uint64_t System{};
+  uint64_t Idle{};
+  uint64_t IoWait{};
+  uint64_t Irq{};
+  uint64_t SoftIrq{};
+  uint64_t Steal{};
+
+  [[nodiscard]] uint64_t GetIdle() const { return Idle + IoWait; }
+  [[nodiscard]] uint64_t GetTotal() const {
+    return User + Nice + System + Idle + IoWait + Irq + SoftIrq + Steal;
+  }
+};
+
+// Samples /proc/stat and turns the per-core counters into load percentages.
+// The file is re-read into the same buffer on every sample and parsed in
+// place; memory is only (re)allocated when the set of online cores changes.
+class ProcStatReader {
+public:
+  explicit ProcStatReader(std::string path = "/proc/stat");
+  ~ProcStatReader();
+
+  ProcStatReader(const ProcStatReader &) = delete;
+  ProcStatReader &operator=(const ProcStatReader &) = delete;
+
+  bool Open();
+  void Close();
+
+  // Reads the counters and computes the load since the previous sample
+  bool Sample();
+
+  [[nodiscard]] int GetNumProcessors() const { return (int)mCores.size(); }
+  [[nodiscard]] double GetTotalLoad() const { return mTotal.Load; }
+  // Changes whenever the set of online cores, and so the items, changes
+  [[nodiscard]] uint32_t GetGeneration() const { return mGeneration; }
+
+  // One item per core, in core order, followed by "_Total"
+  [[nodiscard]] const std::vector<PdhItem> &GetItems() const { return mItems; }
+
+  // Reads only the aggregate "cpu" line
+  static bool ReadTotal(CpuTimes &times, const char *path = "/proc/stat");
+
+private:
+  struct CoreState {
+    int Index = -1; // N of the "cpuN" line
+    CpuTimes Previous{};
+    CpuTimes Current{};
+    double Load = 0.0;
+  };
+
+  bool Read();
+  bool Parse();
+  void Rebuild();
+  static void UpdateLoad(CoreState &state);
+
+  static const char *ParseTimes(const char *pos, const char *end,
+                                CpuTimes &times);
+
+private:
+  std::string mPath;
+  int mFd = -1;
+
+  std::vector<char> mBuffer{};
+  size_t mLength = 0;
+
+  CoreState mTotal{};
+  std::vector<CoreState> mCores{};
+  std::vector<int> mSlotByIndex{}; // cpuN -> position in mCores
+  std::vector<std::string> mNames{};
+  std::vector<PdhItem> mItems{};
+  uint32_t mGeneration{};
+};
+
+} // namespace RESANA
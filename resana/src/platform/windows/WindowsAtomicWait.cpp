@@ -0,0 +1,22 @@
+#include "system/AtomicWait.h"
+#include "rspch.h"
+
+#include <Windows.h>
+
+namespace RESANA {
+
+void AtomicWait(std::atomic<uint32_t> &word, uint32_t expected,
+                uint32_t timeoutMs) {
+  ::WaitOnAddress(reinterpret_cast<volatile VOID *>(&word), &expected,
+                  sizeof(expected), timeoutMs);
+}
+
+void AtomicWakeOne(std::atomic<uint32_t> &word) {
+  ::WakeByAddressSingle(reinterpret_cast<PVOID>(&word));
+}
+
+void AtomicWakeAll(std::atomic<uint32_t> &word) {
+  ::WakeByAddressAll(reinterpret_cast<PVOID>(&word));
+}
+
+} // namespace RESANA
@@ -0,0 +1,86 @@
+#include "system/cpu/CpuPerformance.h"
+#include "rspch.h"
+
+#include "core/Core.h"
+
+#include "helpers/WinFuncs.h"
+
+#include <PdhMsg.h>
+#include <Windows.h>
+
+namespace RESANA {
+
+void CpuPerformance::InitCpuData() {
+  SYSTEM_INFO sysInfo;
+  GetSystemInfo(&sysInfo);
+  mNumProcessors = (int)sysInfo.dwNumberOfProcessors;
+
+  PDH_STATUS pdhStatus = PdhOpenQuery(nullptr, 0, &mCpuData.Query);
+
+  if (pdhStatus != ERROR_SUCCESS) {
+    RS_CORE_ERROR("PdhOpenQuery failed with 0x{0}", pdhStatus);
+  }
+
+  // Specify a counter object with a wildcard for the instance.
+  pdhStatus =
+      PdhAddCounter(mCpuData.Query, TEXT("\\Processor(*)\\% Processor Time"), 0,
+                    &mCpuData.Counter);
+  if (pdhStatus != ERROR_SUCCESS) {
+    RS_CORE_ERROR("PdhAddData failed with 0x{0}", pdhStatus);
+  }
+
+  // Some counters need two samples in order to format a value, so collect
+  // the first one now; each scheduler tick then adds the next.
+  pdhStatus = PdhCollectQueryData(mCpuData.Query);
+  if (pdhStatus != ERROR_SUCCESS) {
+    RS_CORE_ERROR("PdhCollectQueryData failed with 0x{0}", pdhStatus);
+  }
+}
+
+bool CpuPerformance::PrepareData(LogicalCoreData &data) {
+  // The values cover the time since the previous tick's collection
+  PDH_STATUS pdhStatus = PdhCollectQueryData(mCpuData.Query);
+  if (pdhStatus != ERROR_SUCCESS) {
+    RS_CORE_ERROR("PdhCollectQueryData failed with 0x{0}", pdhStatus);
+    return false;
+  }
+
+  // Format into the reused buffer, growing it only when PDH asks for more
+  DWORD bufferSize = (DWORD)mPdhBuffer.size();
+  DWORD itemCount = 0;
+  pdhStatus = PdhGetFormattedCounterArray(
+      mCpuData.Counter, PDH_FMT_DOUBLE, &bufferSize, &itemCount,
+      mPdhBuffer.empty() ? nullptr : (PdhItem *)mPdhBuffer.data());
+
+  if (pdhStatus == (long)PDH_MORE_DATA) {
+    mPdhBuffer.resize(bufferSize);
+    pdhStatus = PdhGetFormattedCounterArray(mCpuData.Counter, PDH_FMT_DOUBLE,
+                                            &bufferSize, &itemCount,
+                                            (PdhItem *)mPdhBuffer.data());
+  }
+
+  if (pdhStatus != ERROR_SUCCESS) {
+    RS_CORE_ERROR("PdhGetFormattedDataArray failed with 0x{0}", pdhStatus);
+    return false;
+  }
+
+  // PDH lists the instances in the same order as long as the set of
+  // processors stays the same, so the names are only parsed when the count
+  // changes: on the first sample and after a hotplug
+  const auto *items = (const PdhItem *)mPdhBuffer.data();
+  ApplyItems(items, itemCount, itemCount != mCoreLayout.GetNumItems(), data);
+  return true;
+}
+
+float CpuPerformance::GetCpuLoad() {
+  FILETIME idleTime, kernelTime, userTime;
+  auto loadNorm =
+      GetSystemTimes(&idleTime, &kernelTime, &userTime)
+          ? CalcCpuLoad(FileTimeToInt64(idleTime),
+                        FileTimeToInt64(kernelTime) + FileTimeToInt64(userTime))
+          : -1.0f;
+  auto loadPerc = loadNorm * 100.0f;
+  return loadPerc;
+}
+
+} // namespace RESANA
@@ -0,0 +1,132 @@
+#include "system/history/MappedFile.h"
+#include "rspch.h"
+
+#include <Windows.h>
+
+namespace RESANA {
+
+MappedFile::~MappedFile() { Close(); }
+
+bool MappedFile::Open(const std::string &path, const Access access) {
+  Close();
+
+  const bool writable = access == Access::ReadWrite;
+  // Readers share delete access, so the writer can rotate the file under them
+  HANDLE file = ::CreateFileA(
+      path.c_str(), writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+      FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+      writable ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    RS_CORE_WARN("Could not open {0}: error {1}", path, ::GetLastError());
+    return false;
+  }
+  mFile = file;
+
+  LARGE_INTEGER size{};
+  if (!::GetFileSizeEx(file, &size)) {
+    Close();
+    return false;
+  }
+
+  mAccess = access;
+  if (!Map((size_t)size.QuadPart)) {
+    Close();
+    return false;
+  }
+  return true;
+}
+
+void MappedFile::Close() {
+  Unmap();
+  if (mFile) {
+    ::CloseHandle(mFile);
+    mFile = nullptr;
+  }
+}
+
+bool MappedFile::Resize(const size_t bytes) {
+  if (!mFile || mAccess != Access::ReadWrite) {
+    return false;
+  }
+
+  // A mapping larger than the file extends it; shrinking needs every view
+  // gone first
+  Unmap();
+  if (bytes < mSize) {
+    LARGE_INTEGER end{};
+    end.QuadPart = (LONGLONG)bytes;
+    if (!::SetFilePointerEx(mFile, end, nullptr, FILE_BEGIN) ||
+        !::SetEndOfFile(mFile)) {
+      RS_CORE_ERROR("Could not resize a mapped file to {0} bytes: error {1}",
+                    bytes, ::GetLastError());
+      return false;
+    }
+  }
+  return Map(bytes);
+}
+
+bool MappedFile::Remap() {
+  LARGE_INTEGER size{};
+  if (!mFile || !::GetFileSizeEx(mFile, &size) ||
+      (size_t)size.QuadPart <= mSize) {
+    return false;
+  }
+
+  Unmap();
+  return Map((size_t)size.QuadPart);
+}
+
+void MappedFile::FlushAsync() {
+  // Only queues the dirty pages; FlushFileBuffers would wait for the disk
+  if (mData && mAccess == Access::ReadWrite) {
+    ::FlushViewOfFile(mData, 0);
+  }
+}
+
+bool MappedFile::IsOpen() const { return mFile != nullptr; }
+
+bool MappedFile::Map(const size_t bytes) {
+  if (bytes == 0) {
+    return true;
+  }
+
+  const bool writable = mAccess == Access::ReadWrite;
+  const auto size = (uint64_t)bytes;
+  HANDLE mapping = ::CreateFileMappingA(
+      mFile, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY,
+      (DWORD)(size >> 32), (DWORD)size, nullptr);
+  if (!mapping) {
+    RS_CORE_ERROR("Could not map {0} bytes: error {1}", bytes,
+                  ::GetLastError());
+    return false;
+  }
+
+  void *data = ::MapViewOfFile(
+      mapping, writable ? FILE_MAP_READ | FILE_MAP_WRITE : FILE_MAP_READ, 0, 0,
+      bytes);
+  if (!data) {
+    RS_CORE_ERROR("Could not map {0} bytes: error {1}", bytes,
+                  ::GetLastError());
+    ::CloseHandle(mapping);
+    return false;
+  }
+
+  mMapping = mapping;
+  mData = static_cast<uint8_t *>(data);
+  mSize = bytes;
+  return true;
+}
+
+void MappedFile::Unmap() {
+  if (mData) {
+    ::UnmapViewOfFile(mData);
+    mData = nullptr;
+  }
+  if (mMapping) {
+    ::CloseHandle(mMapping);
+    mMapping = nullptr;
+  }
+  mSize = 0;
+}
+
+} // namespace RESANA
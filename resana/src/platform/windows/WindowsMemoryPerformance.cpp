@@ -0,0 +1,24 @@
+#include "system/memory/MemoryPerformance.h"
+#include "rspch.h"
+
+namespace RESANA {
+
+bool MemoryPerformance::QueryMemoryStatus(MemoryStatus &status) {
+  MEMORYSTATUSEX memInfo{};
+  memInfo.dwLength = sizeof(MEMORYSTATUSEX);
+
+  if (!GlobalMemoryStatusEx(&memInfo)) {
+    return false;
+  }
+
+  status.TotalPhys = memInfo.ullTotalPhys;
+  status.AvailPhys = memInfo.ullAvailPhys;
+  status.TotalPageFile = memInfo.ullTotalPageFile;
+  status.AvailPageFile = memInfo.ullAvailPageFile;
+  status.TotalVirtual = memInfo.ullTotalVirtual;
+  status.AvailVirtual = memInfo.ullAvailVirtual;
+  status.MemoryLoad = memInfo.dwMemoryLoad;
+  return true;
+}
+
+} // namespace RESANA
@@ -0,0 +1,107 @@
+#include "system/processes/ProcessManager.h"
+#include "rspch.h"
+
+#include "core/Core.h"
+
+#include "helpers/WinFuncs.h"
+
+#include <ProcessSnapshot.h>
+#include <TlHelp32.h>
+#include <Windows.h>
+
+namespace RESANA {
+
+namespace {
+
+// 0 if the times cannot be read
+uint64_t GetCreationTime(const HANDLE handle) {
+  FILETIME creationTime{}, exitTime{}, systemTime{}, userTime{};
+  if (!::GetProcessTimes(handle, &creationTime, &exitTime, &systemTime,
+                         &userTime)) {
+    return 0;
+  }
+  return FileTimeToInt64(creationTime);
+}
+
+} // namespace
+
+bool ProcessManager::PrepareData() {
+  HANDLE hProcessSnap;
+  PROCESSENTRY32 processEntry32{};
+  processEntry32.dwSize = sizeof(PROCESSENTRY32);
+
+  // Take a snapshot of all processes in the system.
+  hProcessSnap = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+  if (hProcessSnap == INVALID_HANDLE_VALUE) {
+    PrintWin32Error("CreateToolhelp32Snapshot (of processes)");
+    return false;
+  }
+
+  if (!Process32First(hProcessSnap, &processEntry32)) {
+    PrintWin32Error("Process32First");
+    CloseHandle(hProcessSnap); // clean the snapshot object
+    return false;
+  }
+
+  // Now walk the snapshot of processes, and
+  // get information about each process in turn
+  ProcessMetrics metrics{};
+  mTable.BeginScan();
+  do {
+    if (ShouldClose()) {
+      CloseHandle(hProcessSnap);
+      return false;
+    }
+
+    // Windows does not reuse the pid of a process with open handles, so a
+    // slot that holds one keeps its creation time. Otherwise the process is
+    // opened again, which fails for System and protected or elevated
+    // processes; once it succeeds, its creation time tells whether the pid
+    // still names the process the slot was made for.
+    const auto procId = (uint32_t)processEntry32.th32ProcessID;
+    const auto known = mTable.Find(procId);
+    HANDLE opened = nullptr;
+    uint64_t creationTime = 0;
+    if (known != ProcessTable::INVALID_SLOT && mTable.GetHandle(known)) {
+      creationTime = mTable.GetCreationTime(known);
+    } else {
+      opened = ::OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, procId);
+      if (opened) {
+        creationTime = GetCreationTime(opened);
+      }
+    }
+
+    bool created = false;
+    const auto slot = mTable.Acquire(procId, creationTime, created);
+    mTable.SetStatus(slot, processEntry32.th32ParentProcessID,
+                     processEntry32.cntThreads,
+                     (uint32_t)processEntry32.pcPriClassBase, 'R');
+    mTable.SetName(slot, processEntry32.szExeFile);
+
+    if (opened) {
+      if (mTable.GetHandle(slot)) {
+        ::CloseHandle(opened); // Listed twice in one scan
+      } else {
+        mTable.SetHandle(slot, opened);
+      }
+    }
+    const HANDLE handle = mTable.GetHandle(slot);
+    const bool hasMetrics = handle && CollectProcessMetrics(handle, metrics);
+    if (hasMetrics) {
+      mTable.ApplyMetrics(slot, metrics);
+    }
+    if (mTrace) {
+      AddTraceProcess(slot, creationTime, created,
+                      hasMetrics ? &metrics : nullptr);
+    }
+  } while (Process32Next(hProcessSnap, &processEntry32));
+
+  CloseHandle(hProcessSnap);
+
+  mTable.EndScan();
+  mTable.UpdateCpuLoads();
+
+  return true;
+}
+
+} // namespace RESANA
@@ -0,0 +1,54 @@
+#include "system/processes/ProcessMetrics.h"
+#include "rspch.h"
+
+#include "helpers/WinFuncs.h"
+
+#include <Psapi.h>
+#include <Windows.h>
+
+namespace RESANA {
+
+bool CollectProcessMetrics(uint32_t procId, ProcessMetrics &metrics) {
+  if (procId == ::GetCurrentProcessId()) {
+    return CollectProcessMetrics(::GetCurrentProcess(), metrics);
+  }
+
+  const HANDLE handle =
+      ::OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, procId);
+  if (!handle) {
+    return false;
+  }
+
+  const bool success = CollectProcessMetrics(handle, metrics);
+  ::CloseHandle(handle);
+  return success;
+}
+
+bool CollectProcessMetrics(HANDLE handle, ProcessMetrics &metrics) {
+  FILETIME currentTime{}, creationTime{}, exitTime{}, systemTime{}, userTime{};
+  PROCESS_MEMORY_COUNTERS_EX pmc{};
+  IO_COUNTERS io{};
+
+  ::GetSystemTimeAsFileTime(&currentTime);
+  bool success = ::GetProcessTimes(handle, &creationTime, &exitTime,
+                                   &systemTime, &userTime);
+  success &= (bool)::GetProcessMemoryInfo(
+      handle, (PROCESS_MEMORY_COUNTERS *)&pmc, sizeof(pmc));
+  ::GetProcessIoCounters(handle, &io);
+
+  metrics.Time = FileTimeToInt64(currentTime);
+  metrics.CreationTime = FileTimeToInt64(creationTime);
+  metrics.UserTime = FileTimeToInt64(userTime);
+  metrics.SystemTime = FileTimeToInt64(systemTime);
+  metrics.WorkingSetSize = pmc.WorkingSetSize;
+  metrics.PrivateUsage = pmc.PrivateUsage;
+  metrics.ReadBytes = io.ReadTransferCount;
+  metrics.WriteBytes = io.WriteTransferCount;
+  metrics.ThreadCount = 0; // Reported by the Toolhelp snapshot
+
+  return success;
+}
+
+uint32_t GetCurrentProcessIdentifier() { return ::GetCurrentProcessId(); }
+
+} // namespace RESANA
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace RESANA {
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+              "AtomicWait needs a plain 32-bit word");
+
+// Blocks while word still holds expected, until another thread calls
+// AtomicWake* on it or timeoutMs elapses. Like a futex, it may return early;
+// callers re-check their condition in a loop.
+void AtomicWait(std::atomic<uint32_t> &word, uint32_t expected,
+                uint32_t timeoutMs);
+void AtomicWakeOne(std::atomic<uint32_t> &word);
+void AtomicWakeAll(std::atomic<uint32_t> &word);
+
+// Hint for spin-wait loops
+inline void CpuRelax() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  _mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#else
+  std::this_thread::yield();
+#endif
+}
+
+} // namespace RESANA
@@ -0,0 +1,266 @@
+#include "SampleScheduler.h"
+#include "rspch.h"
+
+#include "core/Core.h"
+#include "AtomicWait.h"
+
+namespace RESANA {
+
+static constexpr int64_t NS_PER_MS = 1000000;
+// Remove() re-checks a run it waits for at least this often
+static constexpr uint32_t REMOVE_WAIT_MS = 100;
+
+SampleScheduler::SampleScheduler(ThreadPool &threadPool)
+    : mThreadPool(threadPool), mEpoch(Clock::now()) {}
+
+SampleScheduler::~SampleScheduler() {
+  Stop();
+  while (mLoopActive) {
+    std::this_thread::yield();
+  }
+
+  // Runs already handed to the pool still report their stats here
+  std::vector<std::shared_ptr<Task>> tasks;
+  {
+    std::scoped_lock lock(mMutex);
+    for (const auto &[id, task] : mTasks) {
+      tasks.push_back(task);
+    }
+    tasks.insert(tasks.end(), mRemovedTasks.begin(), mRemovedTasks.end());
+  }
+  for (const auto &task : tasks) {
+    while (task->Busy) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+void SampleScheduler::Start() {
+  {
+    std::scoped_lock lock(mMutex);
+    if (mRunning) {
+      return;
+    }
+    mRunning = true;
+  }
+
+  mLoopActive = true;
+  mThreadPool.RunDedicated([this] { SchedulerLoop(); });
+}
+
+void SampleScheduler::Stop() {
+  {
+    std::scoped_lock lock(mMutex);
+    mRunning = false;
+  }
+  mCondition.notify_all();
+}
+
+SampleScheduler::TaskId SampleScheduler::Add(const std::string &name,
+                                             uint32_t intervalMs,
+                                             std::function<void()> collect) {
+  RS_CORE_ASSERT((intervalMs > 0), "Sample interval must not be zero");
+
+  auto task = std::make_shared<Task>();
+  task->Name = name;
+  task->Collect = std::move(collect);
+  task->IntervalMs = intervalMs;
+
+  TaskId id;
+  {
+    std::scoped_lock lock(mMutex);
+    id = mNextId++;
+    mTasks.emplace(id, task);
+    mDeadlines.push({NextAligned(Now(), intervalMs), id, task->Generation});
+  }
+  mCondition.notify_all();
+  return id;
+}
+
+void SampleScheduler::Remove(TaskId id) {
+  std::shared_ptr<Task> task;
+  {
+    std::scoped_lock lock(mMutex);
+    const auto it = mTasks.find(id);
+    if (it == mTasks.end()) {
+      return;
+    }
+    task = it->second;
+    task->Removed = true;
+    mTasks.erase(it);
+
+    mRemovedTasks.erase(
+        std::remove_if(mRemovedTasks.begin(), mRemovedTasks.end(),
+                       [](const auto &removed) { return !removed->Busy; }),
+        mRemovedTasks.end());
+    if (task->Busy) {
+      mRemovedTasks.push_back(task);
+    }
+  }
+
+  // Its deadlines are dropped when they come up. RunTask() announces a run
+  // in Collecting before it checks Removed, so either the run sees Removed
+  // and skips the collector, or this sees the run and waits for it.
+  if (task->Runner == std::this_thread::get_id()) {
+    return;
+  }
+  uint32_t collecting = task->Collecting;
+  while (collecting != COLLECT_IDLE) {
+    if (collecting == COLLECT_RUNNING &&
+        !task->Collecting.compare_exchange_weak(collecting,
+                                                COLLECT_WAITED_ON)) {
+      continue;
+    }
+    AtomicWait(task->Collecting, COLLECT_WAITED_ON, REMOVE_WAIT_MS);
+    collecting = task->Collecting;
+  }
+}
+
+void SampleScheduler::SetInterval(TaskId id, uint32_t intervalMs) {
+  if (intervalMs == 0) {
+    return;
+  }
+
+  {
+    std::scoped_lock lock(mMutex);
+    const auto it = mTasks.find(id);
+    if (it == mTasks.end() || it->second->IntervalMs == intervalMs) {
+      return;
+    }
+
+    // The pending deadline becomes stale; the next one is on the new grid
+    auto &task = *it->second;
+    task.IntervalMs = intervalMs;
+    ++task.Generation;
+    mDeadlines.push({NextAligned(Now(), intervalMs), id, task.Generation});
+  }
+  mCondition.notify_all();
+}
+
+uint32_t SampleScheduler::GetInterval(TaskId id) const {
+  std::scoped_lock lock(mMutex);
+  const auto it = mTasks.find(id);
+  return it != mTasks.end() ? it->second->IntervalMs : 0;
+}
+
+SampleStats SampleScheduler::GetStats(TaskId id) const {
+  std::scoped_lock lock(mMutex);
+  const auto it = mTasks.find(id);
+  return it != mTasks.end() ? it->second->Stats : SampleStats{};
+}
+
+std::vector<std::pair<std::string, SampleStats>>
+SampleScheduler::GetAllStats() const {
+  std::scoped_lock lock(mMutex);
+  std::vector<std::pair<std::string, SampleStats>> stats;
+  stats.reserve(mTasks.size());
+  for (const auto &[id, task] : mTasks) {
+    stats.emplace_back(task->Name, task->Stats);
+  }
+  return stats;
+}
+
+void SampleScheduler::SchedulerLoop() {
+  std::unique_lock lock(mMutex);
+
+  while (mRunning) {
+    if (mDeadlines.empty()) {
+      mCondition.wait(lock);
+      continue;
+    }
+
+    const Deadline next = mDeadlines.top();
+    const int64_t now = Now();
+    if (next.Time > now) {
+      // Woken early by Add/SetInterval/Stop; re-check the top either way
+      mCondition.wait_until(lock, mEpoch + std::chrono::nanoseconds(next.Time));
+      continue;
+    }
+    mDeadlines.pop();
+
+    const auto it = mTasks.find(next.Id);
+    if (it == mTasks.end() || it->second->Generation != next.Generation) {
+      continue; // Removed or rescheduled
+    }
+    const auto task = it->second;
+
+    // Stay on the grid: if the scheduler woke late by more than an interval,
+    // skip the passed deadlines rather than firing them back to back.
+    const int64_t interval = (int64_t)task->IntervalMs * NS_PER_MS;
+    int64_t following = next.Time + interval;
+    if (following <= now) {
+      const int64_t skipped = (now - next.Time) / interval;
+      task->Stats.Missed += (uint64_t)skipped;
+      following = next.Time + (skipped + 1) * interval;
+    }
+    mDeadlines.push({following, next.Id, next.Generation});
+
+    Dispatch(task, next.Time);
+  }
+
+  lock.unlock();
+  mLoopActive = false;
+}
+
+void SampleScheduler::Dispatch(const std::shared_ptr<Task> &task,
+                               int64_t deadline) {
+  // Called with mMutex held
+  if (task->Busy.exchange(true)) {
+    ++task->Stats.Overruns;
+    return;
+  }
+
+  // Busy keeps the job from being queued twice
+  auto &job = task->Job;
+  job.Scheduler = this;
+  job.Self = task;
+  job.Deadline = deadline;
+  mThreadPool.Queue(job);
+}
+
+void SampleScheduler::RunJob::Run() {
+  // Released once the run is over, which may destroy a removed task
+  const auto task = std::move(Self);
+  Scheduler->RunTask(*task, Deadline);
+}
+
+void SampleScheduler::RunTask(Task &task, int64_t deadline) {
+  const int64_t start = Now();
+  task.Runner = std::this_thread::get_id();
+  task.Collecting = COLLECT_RUNNING;
+  if (!task.Removed) {
+    task.Collect();
+  }
+  if (task.Collecting.exchange(COLLECT_IDLE) == COLLECT_WAITED_ON) {
+    AtomicWakeAll(task.Collecting);
+  }
+  const int64_t end = Now();
+
+  {
+    std::scoped_lock lock(mMutex);
+    auto &stats = task.Stats;
+    const int64_t jitter = start - deadline;
+    ++stats.Runs;
+    stats.LastJitter = jitter;
+    stats.MaxJitter = std::max(stats.MaxJitter, jitter);
+    stats.MeanJitter +=
+        ((double)jitter - stats.MeanJitter) / (double)stats.Runs;
+    stats.LastDuration = (uint64_t)(end - start);
+  }
+
+  task.Runner = std::thread::id();
+  task.Busy = false;
+}
+
+int64_t SampleScheduler::Now() const {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() -
+                                                              mEpoch)
+      .count();
+}
+
+int64_t SampleScheduler::NextAligned(int64_t after, uint32_t intervalMs) const {
+  const int64_t interval = (int64_t)intervalMs * NS_PER_MS;
+  return (after / interval + 1) * interval;
+}
+
+} // namespace RESANA
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "ThreadPool.h"
+
+namespace RESANA {
+
+// Timing of one collector's runs, in nanoseconds
+struct SampleStats {
+  uint64_t Runs{};
+  uint64_t Overruns{}; // Deadlines skipped because the last run was still busy
+  uint64_t Missed{};   // Deadlines that passed before the scheduler woke
+  int64_t LastJitter{}; // Start of the last run minus its deadline
+  int64_t MaxJitter{};
+  double MeanJitter{};
+  uint64_t LastDuration{};
+};
+
+// Fires every registered collector on absolute deadlines of the monotonic
+// clock. A collector with interval T runs at Start + k * T, so collectors with
+// the same or nested intervals (500/1000/2000 ms) run on the same ticks, and
+// a late run does not push back the next one. Runs are dispatched to the
+// thread pool; a collector never runs twice at the same time.
+class SampleScheduler {
+public:
+  using TaskId = uint32_t;
+  using Clock = std::chrono::steady_clock;
+
+  explicit SampleScheduler(ThreadPool &threadPool);
+  ~SampleScheduler();
+
+  SampleScheduler(const SampleScheduler &) = delete;
+  SampleScheduler &operator=(const SampleScheduler &) = delete;
+
+  void Start();
+  void Stop();
+
+  // The first run is on the next deadline
+  TaskId Add(const std::string &name, uint32_t intervalMs,
+             std::function<void()> collect);
+  // A run that is queued but has not started yet skips the collector and is
+  // dropped by the pool. A run already inside the collector is waited for,
+  // unless this is that run. So Remove() never waits on a pool worker, and
+  // may be called from one; the collector must not wait on the caller.
+  void Remove(TaskId id);
+
+  // Takes effect from the next aligned deadline; the thread keeps running
+  void SetInterval(TaskId id, uint32_t intervalMs);
+  [[nodiscard]] uint32_t GetInterval(TaskId id) const;
+
+  [[nodiscard]] SampleStats GetStats(TaskId id) const;
+  // Name and stats of every collector
+  [[nodiscard]] std::vector<std::pair<std::string, SampleStats>>
+  GetAllStats() const;
+
+private:
+  struct Task;
+
+  static constexpr uint32_t COLLECT_IDLE = 0;
+  static constexpr uint32_t COLLECT_RUNNING = 1;
+  static constexpr uint32_t COLLECT_WAITED_ON = 2; // Remove() is waiting
+
+  // Queued to the pool for each run, so dispatching does not allocate
+  struct RunJob final : ThreadPool::Job {
+    void Run() override;
+
+    SampleScheduler *Scheduler = nullptr;
+    std::shared_ptr<Task> Self{}; // Keeps a removed task alive while it runs
+    int64_t Deadline{};
+  };
+
+  struct Task {
+    std::string Name;
+    std::function<void()> Collect;
+    uint32_t IntervalMs{};
+    uint32_t Generation{}; // Bumped when the interval changes
+    std::atomic<bool> Busy{false};
+    std::atomic<bool> Removed{false};
+    std::atomic<std::thread::id> Runner{};
+    // COLLECT_IDLE, or a run is in Collect; the wait word for Remove()
+    std::atomic<uint32_t> Collecting{COLLECT_IDLE};
+    SampleStats Stats{};
+    RunJob Job{};
+  };
+
+  struct Deadline {
+    int64_t Time{}; // ns since mEpoch
+    TaskId Id{};
+    uint32_t Generation{};
+
+    bool operator>(const Deadline &rhs) const { return Time > rhs.Time; }
+  };
+
+  void SchedulerLoop();
+  void Dispatch(const std::shared_ptr<Task> &task, int64_t deadline);
+  void RunTask(Task &task, int64_t deadline);
+  [[nodiscard]] int64_t Now() const;
+  [[nodiscard]] int64_t NextAligned(int64_t after, uint32_t intervalMs) const;
+
+private:
+  ThreadPool &mThreadPool;
+  Clock::time_point mEpoch{};
+
+  mutable std::mutex mMutex{};
+  std::condition_variable mCondition{};
+  std::unordered_map<TaskId, std::shared_ptr<Task>> mTasks{};
+  // Removed tasks whose queued run has not finished; it still reports here
+  std::vector<std::shared_ptr<Task>> mRemovedTasks{};
+  std::priority_queue<Deadline, std::vector<Deadline>, std::greater<>>
+      mDeadlines{};
+  TaskId mNextId = 1;
+
+  bool mRunning = false;
+  std::atomic<bool> mLoopActive{false};
+};
+
+} // namespace RESANA
@@ -0,0 +1,212 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace RESANA {
+
+template <typename T> class SnapshotPublisher;
+
+// A reader's pin on one published version. The value stays alive and
+// unchanged until the snapshot is released, however often the writer
+// publishes in the meantime.
+template <typename T> class Snapshot {
+public:
+  Snapshot() = default;
+  ~Snapshot() { Release(); }
+
+  Snapshot(Snapshot &&other) noexcept { *this = std::move(other); }
+  Snapshot &operator=(Snapshot &&other) noexcept;
+
+  Snapshot(const Snapshot &) = delete;
+  Snapshot &operator=(const Snapshot &) = delete;
+
+  void Release();
+
+  [[nodiscard]] const T *Get() const { return mValue; }
+  [[nodiscard]] uint64_t GetVersion() const { return mVersion; }
+
+  const T *operator->() const { return mValue; }
+  const T &operator*() const { return *mValue; }
+  explicit operator bool() const { return mValue != nullptr; }
+
+private:
+  const T *mValue = nullptr;
+  uint64_t mVersion{};
+  std::atomic<uint64_t> *mSlot = nullptr;
+
+  friend class SnapshotPublisher<T>;
+};
+
+// Publishes immutable versions of a value from a single writer thread to any
+// number of readers, without either side blocking. A reader announces the
+// epoch it started in and then loads the current version; the writer bumps
+// the epoch on every publish and reuses a retired version's storage once no
+// announced epoch predates its retirement.
+template <typename T> class SnapshotPublisher {
+public:
+  // Snapshots that may be held at the same time
+  static constexpr size_t MAX_READERS = 8;
+
+  SnapshotPublisher() = default;
+  ~SnapshotPublisher();
+
+  SnapshotPublisher(const SnapshotPublisher &) = delete;
+  SnapshotPublisher &operator=(const SnapshotPublisher &) = delete;
+
+  // Writer side. BeginPublish() returns the storage of an older version, so
+  // containers keep their capacity; the caller overwrites all of it.
+  T &BeginPublish();
+  void CommitPublish();
+  void Publish(const T &value);
+
+  // Reader side. The snapshot is empty until the first publish.
+  [[nodiscard]] Snapshot<T> Acquire() const;
+  // Copy of the latest value, or T{} before the first publish
+  [[nodiscard]] T Load() const;
+
+private:
+  struct Node {
+    T Value{};
+    uint64_t Version{};
+    uint64_t RetireEpoch{};
+  };
+
+  struct alignas(64) ReaderSlot {
+    std::atomic<uint64_t> Epoch{0}; // 0 while free
+  };
+
+  void Reclaim();
+
+private:
+  std::atomic<Node *> mCurrent{nullptr};
+  std::atomic<uint64_t> mEpoch{1};
+  mutable std::array<ReaderSlot, MAX_READERS> mReaders{};
+
+  // Only touched by the writer
+  Node *mPending = nullptr;
+  uint64_t mVersion{};
+  std::vector<Node *> mRetired{};
+  std::vector<Node *> mFree{};
+};
+
+template <typename T>
+Snapshot<T> &Snapshot<T>::operator=(Snapshot &&other) noexcept {
+  if (this != &other) {
+    Release();
+    mValue = std::exchange(other.mValue, nullptr);
+    mVersion = std::exchange(other.mVersion, 0);
+    mSlot = std::exchange(other.mSlot, nullptr);
+  }
+  return *this;
+}
+
+template <typename T> void Snapshot<T>::Release() {
+  mValue = nullptr;
+  if (mSlot) {
+    mSlot->store(0, std::memory_order_release);
+    mSlot = nullptr;
+  }
+}
+
+template <typename T> SnapshotPublisher<T>::~SnapshotPublisher() {
+  delete mCurrent.load();
+  delete mPending;
+  for (auto *node : mRetired) {
+    delete node;
+  }
+  for (auto *node : mFree) {
+    delete node;
+  }
+}
+
+template <typename T> T &SnapshotPublisher<T>::BeginPublish() {
+  if (!mPending) {
+    if (mFree.empty()) {
+      mPending = new Node;
+    } else {
+      mPending = mFree.back();
+      mFree.pop_back();
+    }
+  }
+  return mPending->Value;
+}
+
+template <typename T> void SnapshotPublisher<T>::CommitPublish() {
+  if (!mPending) {
+    return;
+  }
+
+  mPending->Version = ++mVersion;
+  Node *previous = mCurrent.exchange(mPending);
+  mPending = nullptr;
+
+  if (previous) {
+    // Readers announcing this epoch or later can only load the new version
+    previous->RetireEpoch = mEpoch.fetch_add(1) + 1;
+    mRetired.push_back(previous);
+  }
+  Reclaim();
+}
+
+template <typename T> void SnapshotPublisher<T>::Publish(const T &value) {
+  BeginPublish() = value;
+  CommitPublish();
+}
+
+template <typename T> Snapshot<T> SnapshotPublisher<T>::Acquire() const {
+  Snapshot<T> snapshot;
+  while (true) {
+    for (auto &slot : mReaders) {
+      // Claiming the slot and announcing the epoch is a single CAS
+      uint64_t expected = 0;
+      if (slot.Epoch.compare_exchange_strong(expected, mEpoch.load())) {
+        if (const Node *node = mCurrent.load()) {
+          snapshot.mValue = &node->Value;
+          snapshot.mVersion = node->Version;
+          snapshot.mSlot = &slot.Epoch;
+        } else {
+          slot.Epoch.store(0, std::memory_order_release);
+        }
+        return snapshot;
+      }
+    }
+
+    // Every slot is pinned; they are only held for the length of a read
+    std::this_thread::yield();
+  }
+}
+
+template <typename T> T SnapshotPublisher<T>::Load() const {
+  const auto snapshot = Acquire();
+  return snapshot ? *snapshot : T{};
+}
+
+template <typename T> void SnapshotPublisher<T>::Reclaim() {
+  uint64_t oldest = std::numeric_limits<uint64_t>::max();
+  for (auto &slot : mReaders) {
+    if (const auto epoch = slot.Epoch.load(); epoch != 0) {
+      oldest = std::min(oldest, epoch);
+    }
+  }
+
+  // A reader that announced epoch e may hold any version retired after e
+  auto isReleased = [&](Node *node) {
+    if (node->RetireEpoch > oldest) {
+      return false;
+    }
+    mFree.push_back(node);
+    return true;
+  };
+  mRetired.erase(std::remove_if(mRetired.begin(), mRetired.end(), isReleased),
+                 mRetired.end());
+}
+
+} // namespace RESANA
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "AtomicWait.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace RESANA {
+
+// Bounded single-producer/single-consumer queue over preallocated slots. The
+// producer fills a slot in place and publishes it, the consumer reads it in
+// place and hands it back, so nothing is locked, copied or allocated after
+// construction. An idle consumer spins briefly and then sleeps on the
+// publish counter; the producer only makes a wake call if it is asleep.
+template <typename T> class SpscRing {
+public:
+  // The capacity is rounded up to a power of two
+  explicit SpscRing(size_t capacity);
+
+  SpscRing(const SpscRing &) = delete;
+  SpscRing &operator=(const SpscRing &) = delete;
+
+  // Producer side. Returns nullptr if the ring is full.
+  T *BeginWrite();
+  void CommitWrite();
+
+  // Consumer side. Returns nullptr if the ring is empty.
+  T *BeginRead();
+  // Same, but waits up to timeoutMs for a slot or a Wake()
+  T *WaitRead(uint32_t timeoutMs);
+  void CommitRead();
+
+  // Releases a consumer blocked in WaitRead(), e.g. on shutdown
+  void Wake();
+
+  [[nodiscard]] size_t GetCapacity() const { return mMask + 1; }
+  [[nodiscard]] size_t GetSize() const {
+    return (uint32_t)(mHead.load(std::memory_order_acquire) -
+                      mTail.load(std::memory_order_acquire));
+  }
+
+private:
+  static constexpr size_t CACHE_LINE_SIZE = 64;
+  static constexpr int SPIN_COUNT = 256;
+
+  std::unique_ptr<T[]> mSlots;
+  uint32_t mMask{};
+
+  // Producer line: publish counter (also the wait word) and its view of mTail
+  alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> mHead{0};
+  uint32_t mCachedTail{};
+
+  // Consumer line: release counter and its view of mHead
+  alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> mTail{0};
+  uint32_t mCachedHead{};
+
+  alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> mSleeping{0};
+  std::atomic<bool> mWakeRequested{false};
+};
+
+template <typename T> SpscRing<T>::SpscRing(size_t capacity) {
+  size_t size = 1;
+  while (size < capacity) {
+    size <<= 1;
+  }
+  mSlots = std::make_unique<T[]>(size);
+  mMask = (uint32_t)(size - 1);
+}
+
+template <typename T> T *SpscRing<T>::BeginWrite() {
+  const uint32_t head = mHead.load(std::memory_order_relaxed);
+  if (head - mCachedTail > mMask) {
+    mCachedTail = mTail.load(std::memory_order_acquire);
+    if (head - mCachedTail > mMask) {
+      return nullptr;
+    }
+  }
+  return &mSlots[head & mMask];
+}
+
+template <typename T> void SpscRing<T>::CommitWrite() {
+  mHead.store(mHead.load(std::memory_order_relaxed) + 1,
+              std::memory_order_release);
+
+  // Pairs with the fence in WaitRead(): either the consumer sees the new
+  // head, or we see that it went to sleep.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (mSleeping.load(std::memory_order_relaxed)) {
+    AtomicWakeOne(mHead);
+  }
+}
+
+template <typename T> T *SpscRing<T>::BeginRead() {
+  const uint32_t tail = mTail.load(std::memory_order_relaxed);
+  if (tail == mCachedHead) {
+    mCachedHead = mHead.load(std::memory_order_acquire);
+    if (tail == mCachedHead) {
+      return nullptr;
+    }
+  }
+  return &mSlots[tail & mMask];
+}
+
+template <typename T> T *SpscRing<T>::WaitRead(uint32_t timeoutMs) {
+  for (int i = 0; i < SPIN_COUNT; ++i) {
+    if (T *slot = BeginRead()) {
+      return slot;
+    }
+    CpuRelax();
+  }
+
+  mSleeping.store(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  T *slot = BeginRead();
+  if (!slot && !mWakeRequested.exchange(false)) {
+    AtomicWait(mHead, mTail.load(std::memory_order_relaxed), timeoutMs);
+    slot = BeginRead();
+  }
+
+  mSleeping.store(0, std::memory_order_relaxed);
+  return slot;
+}
+
+template <typename T> void SpscRing<T>::CommitRead() {
+  mTail.store(mTail.load(std::memory_order_relaxed) + 1,
+              std::memory_order_release);
+}
+
+template <typename T> void SpscRing<T>::Wake() {
+  mWakeRequested = true;
+  AtomicWakeAll(mHead);
+}
+
+} // namespace RESANA
@@ -0,0 +1,44 @@
+#include "SystemRuntime.h"
+#include "rspch.h"
+
+#include "core/Core.h"
+
+#include "trace/SampleTrace.h"
+
+namespace RESANA {
+
+SystemRuntime *SystemRuntime::sInstance = nullptr;
+
+SystemRuntime::SystemRuntime(const HistoryConfig &history) {
+  RS_CORE_ASSERT(!sInstance, "SystemRuntime already exists!");
+  sInstance = this;
+
+  Time::Start();
+
+  mHistory = std::make_unique<MetricHistory>(history);
+
+  mThreadPool = std::make_unique<ThreadPool>();
+  mThreadPool->Start();
+
+  mSampleScheduler = std::make_unique<SampleScheduler>(*mThreadPool);
+  mSampleScheduler->Start();
+}
+
+SystemRuntime::~SystemRuntime() {
+  // Collectors still registered stop firing before the workers go away
+  mSampleScheduler.reset();
+  mThreadPool->Stop();
+  mThreadPool.reset();
+  mTraceWriter.reset();
+  mHistory.reset();
+
+  Time::Stop();
+  sInstance = nullptr;
+  RS_CORE_TRACE("SystemRuntime destroyed");
+}
+
+void SystemRuntime::SetTraceWriter(std::unique_ptr<SampleTraceWriter> writer) {
+  mTraceWriter = std::move(writer);
+}
+
+} // namespace RESANA
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "SampleScheduler.h"
+#include "ThreadPool.h"
+#include "history/MetricHistory.h"
+
+#include <memory>
+#include <string>
+
+namespace RESANA {
+
+class SampleTraceWriter;
+
+// Owns the threads the samplers run on and the history they record into. It
+// needs no window or graphics context, so the GUI Application and the
+// headless collector both create one before starting any sampler.
+class SystemRuntime {
+public:
+  explicit SystemRuntime(const HistoryConfig &history = {});
+  ~SystemRuntime();
+
+  SystemRuntime(const SystemRuntime &) = delete;
+  SystemRuntime &operator=(const SystemRuntime &) = delete;
+
+  [[nodiscard]] ThreadPool &GetThreadPool() const { return *mThreadPool; }
+  [[nodiscard]] SampleScheduler &GetSampleScheduler() const {
+    return *mSampleScheduler;
+  }
+  [[nodiscard]] MetricHistory &GetHistory() const { return *mHistory; }
+
+  // While a writer is set, the collectors also write what they sample to
+  // it. Set it before starting them.
+  void SetTraceWriter(std::unique_ptr<SampleTraceWriter> writer);
+  [[nodiscard]] SampleTraceWriter *GetTraceWriter() const {
+    return mTraceWriter.get();
+  }
+
+  // Collectors started while replaying leave sampling to a SampleReplay
+  void SetReplaying(bool replaying) { mReplaying = replaying; }
+  [[nodiscard]] bool IsReplaying() const { return mReplaying; }
+
+  // Where the Linux collectors read procfs from, /proc unless a generated
+  // tree is put in its place. This process's own files are still read from
+  // /proc. Set it before starting them; unused on Windows.
+  void SetProcRoot(std::string root) { mProcRoot = std::move(root); }
+  [[nodiscard]] const std::string &GetProcRoot() const { return mProcRoot; }
+
+  static bool Exists() { return sInstance != nullptr; }
+
+  static SystemRuntime &Get() { return *sInstance; }
+
+private:
+  std::unique_ptr<ThreadPool> mThreadPool;
+  std::unique_ptr<SampleScheduler> mSampleScheduler;
+  std::unique_ptr<MetricHistory> mHistory;
+  std::unique_ptr<SampleTraceWriter> mTraceWriter;
+  bool mReplaying = false;
+  std::string mProcRoot = "/proc";
+
+  static SystemRuntime *sInstance;
+};
+
+} // namespace RESANA
@@ -1,66 +1,183 @@
 #include "ThreadPool.h"
 
+#include "AtomicWait.h"
+
+#include <algorithm>
+
 namespace RESANA {
+
+// Re-checks for work even without a wake, in case one was missed
+static constexpr uint32_t IDLE_WAIT_MS = 100;
+static constexpr int STEAL_ATTEMPTS = 2;
+
+// The pool and worker the current thread belongs to, if any
+static thread_local const ThreadPool *sWorkerPool = nullptr;
+static thread_local size_t sWorkerIndex = 0;
+
 ThreadPool::ThreadPool() {}
 
 ThreadPool::~ThreadPool() {
-  for (std::thread &active_thread : mThreads) {
-    active_thread.join();
+  Stop();
+  for (auto &worker : mWorkers) {
+    if (worker->Thread.joinable()) {
+      worker->Thread.join();
+    }
+  }
+
+  // Tasks that never ran; their futures report a broken promise
+  auto discard = [](Job *task) {
+    if (task->mOwnedByPool) {
+      delete task;
+    }
+  };
+  for (auto &worker : mWorkers) {
+    while (Job *task = worker->Deque.Pop()) {
+      discard(task);
+    }
+  }
+  for (size_t i = 0; i < mInjectedCount.load(); ++i) {
+    discard(mInjected[(mInjectedHead + i) % mInjected.size()]);
+  }
+
+  for (auto &dedicated : mDedicated) {
+    dedicated.Thread.join();
   }
 }
 
 void ThreadPool::Start() {
   const uint32_t numThreads =
-      std::thread::hardware_concurrency(); // Max # of threads the system
-                                           // supports
-  mThreads.resize(numThreads);
-
+      std::max(1u, std::thread::hardware_concurrency()); // Max # of threads
+                                                         // the system supports
+  mWorkers.reserve(numThreads);
   for (uint32_t i = 0; i < numThreads; i++) {
-    mThreads.at(i) = std::thread([this] { ThreadLoop(); });
+    mWorkers.push_back(std::make_unique<Worker>());
+  }
+
+  // Every deque exists before any worker may try to steal from it
+  for (size_t i = 0; i < mWorkers.size(); i++) {
+    mWorkers[i]->Thread = std::thread([this, i] { WorkerLoop(i); });
   }
 }
 
 void ThreadPool::Stop() {
-  {
-    std::unique_lock<std::mutex> lock(mMutex);
-    mShouldTerminate = true;
+  mShouldTerminate = true;
+  mSignal.fetch_add(1);
+  AtomicWakeAll(mSignal);
+}
+
+void ThreadPool::Queue(std::function<void()> job) {
+  Push(new TaskImpl<std::function<void()>>(std::move(job)));
+}
+
+void ThreadPool::Queue(Job &job) { Push(&job); }
+
+void ThreadPool::RunDedicated(std::function<void()> job) {
+  std::scoped_lock lock(mDedicatedMutex);
+  JoinFinishedDedicated();
+
+  auto &dedicated = mDedicated.emplace_back();
+  dedicated.Thread = std::thread([&dedicated, job = std::move(job)] {
+    job();
+    dedicated.Finished = true;
+  });
+}
+
+bool ThreadPool::Busy() const { return mPending.load() != 0; }
+
+void ThreadPool::Push(Job *task) {
+  mPending.fetch_add(1);
+
+  if (sWorkerPool == this) {
+    mWorkers[sWorkerIndex]->Deque.Push(task);
+  } else {
+    std::scoped_lock lock(mInjectionMutex);
+    size_t count = mInjectedCount.load(std::memory_order_relaxed);
+    if (count == mInjected.size()) {
+      // Unroll the ring into a larger one
+      std::vector<Job *> ring(std::max<size_t>(16, count * 2));
+      for (size_t i = 0; i < count; ++i) {
+        ring[i] = mInjected[(mInjectedHead + i) % mInjected.size()];
+      }
+      mInjected.swap(ring);
+      mInjectedHead = 0;
+    }
+    mInjected[(mInjectedHead + count) % mInjected.size()] = task;
+    mInjectedCount.store(count + 1);
+  }
+
+  // Pairs with the sleeper count in WorkerLoop: either the worker sees the
+  // new signal value, or we see it sleeping and wake it.
+  mSignal.fetch_add(1);
+  if (mSleeping.load() != 0) {
+    AtomicWakeOne(mSignal);
   }
-  mCondition.notify_all();
 }
 
-void ThreadPool::Queue(const std::function<void()> &job) {
-  {
-    std::unique_lock<std::mutex> lock(mMutex);
-    mQueue.push(job);
+ThreadPool::Job *ThreadPool::FindTask(size_t index) {
+  if (Job *task = mWorkers[index]->Deque.Pop()) {
+    return task;
+  }
+
+  if (mInjectedCount.load(std::memory_order_relaxed) != 0) {
+    std::scoped_lock lock(mInjectionMutex);
+    if (const size_t count = mInjectedCount.load(); count != 0) {
+      Job *task = mInjected[mInjectedHead];
+      mInjectedHead = (mInjectedHead + 1) % mInjected.size();
+      mInjectedCount.store(count - 1);
+      return task;
+    }
   }
-  mCondition.notify_one();
+
+  // Start at the next worker so thieves spread over the victims
+  const size_t count = mWorkers.size();
+  for (int attempt = 0; attempt < STEAL_ATTEMPTS; ++attempt) {
+    for (size_t i = 1; i < count; ++i) {
+      if (Job *task = mWorkers[(index + i) % count]->Deque.Steal()) {
+        return task;
+      }
+    }
+  }
+  return nullptr;
 }
 
-bool ThreadPool::Busy() {
-  bool pollBusy;
-  {
-    std::unique_lock<std::mutex> lock(mMutex);
-    pollBusy = mQueue.empty();
+void ThreadPool::RunTask(Job *task) {
+  // A caller's job may be queued again or destroyed once Run() returns
+  const bool owned = task->mOwnedByPool;
+  task->Run();
+  if (owned) {
+    delete task;
   }
-  return pollBusy;
+  mPending.fetch_sub(1);
 }
 
-void ThreadPool::ThreadLoop() {
-  while (true) {
-    std::function<void()> job;
-    {
-      std::unique_lock<std::mutex> lock(mMutex);
-      mCondition.wait(
-          lock, [&, this] { return !mQueue.empty() || mShouldTerminate; });
+void ThreadPool::WorkerLoop(size_t index) {
+  sWorkerPool = this;
+  sWorkerIndex = index;
 
-      if (mShouldTerminate) {
-        return;
-      }
+  while (!mShouldTerminate) {
+    const uint32_t signal = mSignal.load();
+    if (Job *task = FindTask(index)) {
+      RunTask(task);
+      continue;
+    }
 
-      job = mQueue.front();
-      mQueue.pop();
+    mSleeping.fetch_add(1);
+    if (!mShouldTerminate) {
+      AtomicWait(mSignal, signal, IDLE_WAIT_MS);
     }
-    job();
+    mSleeping.fetch_sub(1);
   }
 }
+
+void ThreadPool::JoinFinishedDedicated() {
+  for (auto it = mDedicated.begin(); it != mDedicated.end();) {
+    if (it->Finished) {
+      it->Thread.join();
+      it = mDedicated.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
 } // namespace RESANA
@@ -1,36 +1,117 @@
 #pragma once
 
-#include <condition_variable>
+#include "WorkStealingDeque.h"
+
+#include <atomic>
 #include <functional>
+#include <future>
+#include <list>
+#include <memory>
 #include <mutex>
-#include <queue>
 #include <thread>
+#include <type_traits>
 #include <vector>
 
 namespace RESANA {
 
+// Runs short tasks on one worker per core. Each worker owns a Chase-Lev deque:
+// tasks queued from a worker go to its own deque, tasks queued from any other
+// thread go to a shared injection queue, and idle workers steal from each
+// other before sleeping. Jobs that loop for the lifetime of a system run on
+// dedicated threads instead, so they never hold a worker.
 class ThreadPool {
 public:
+  // Work the caller owns, for work that is queued over and over: queuing a
+  // job does not allocate. It must stay alive until Run() returns, and must
+  // not be queued again before Run() was called.
+  class Job {
+  public:
+    virtual ~Job() = default;
+    virtual void Run() = 0;
+
+  private:
+    bool mOwnedByPool = false; // Deleted after it ran
+
+    friend class ThreadPool;
+  };
+
   ThreadPool();
   ~ThreadPool();
 
   void Start();
   void Stop();
 
-  void Queue(const std::function<void()> &job);
-  bool Busy();
+  // Short task; the worker is blocked until it returns
+  void Queue(std::function<void()> job);
+  void Queue(Job &job);
+
+  // Same, but the result or exception is delivered through the future
+  template <typename Fn>
+  std::future<std::invoke_result_t<Fn>> Submit(Fn &&job);
+
+  // Runs a long-lived job, e.g. a sampling loop, on its own thread. The thread
+  // is joined once the job returns.
+  void RunDedicated(std::function<void()> job);
+
+  // True while queued tasks have not finished
+  bool Busy() const;
+
+  [[nodiscard]] size_t GetNumWorkers() const { return mWorkers.size(); }
 
 private:
-  void ThreadLoop();
+  template <typename Fn> struct TaskImpl final : Job {
+    explicit TaskImpl(Fn &&fn) : Function(std::move(fn)) {
+      mOwnedByPool = true;
+    }
+    void Run() override { Function(); }
+    Fn Function;
+  };
+
+  struct Worker {
+    WorkStealingDeque<Job> Deque{};
+    std::thread Thread{};
+  };
+
+  struct DedicatedThread {
+    std::thread Thread{};
+    std::atomic<bool> Finished{false};
+  };
+
+  void Push(Job *task);
+  Job *FindTask(size_t index);
+  void RunTask(Job *task);
+  void WorkerLoop(size_t index);
+  void JoinFinishedDedicated();
 
 private:
-  std::queue<std::function<void()>> mQueue{};
-  std::vector<std::thread> mThreads{};
+  std::vector<std::unique_ptr<Worker>> mWorkers{};
+
+  // Tasks queued from threads that are not workers, in a ring that only
+  // grows, so steady queuing does not allocate
+  std::mutex mInjectionMutex{};
+  std::vector<Job *> mInjected{};
+  size_t mInjectedHead{};
+  std::atomic<size_t> mInjectedCount{0};
 
-  std::mutex mMutex{};
-  std::condition_variable mCondition{};
+  // Idle workers sleep on mSignal; it changes whenever work is queued
+  std::atomic<uint32_t> mSignal{0};
+  std::atomic<uint32_t> mSleeping{0};
+  std::atomic<size_t> mPending{0};
 
-  bool mShouldTerminate = false;
+  std::mutex mDedicatedMutex{};
+  std::list<DedicatedThread> mDedicated{};
+
+  std::atomic<bool> mShouldTerminate{false};
 };
 
-} // namespace RESANA
\ No newline at end of file
+template <typename Fn>
+std::future<std::invoke_result_t<Fn>> ThreadPool::Submit(Fn &&job) {
+  using Result = std::invoke_result_t<Fn>;
+
+  std::packaged_task<Result()> task(std::forward<Fn>(job));
+  auto future = task.get_future();
+  Push(new TaskImpl<std::packaged_task<Result()>>(std::move(task)));
+  return future;
+}
+
+} // namespace RESANA
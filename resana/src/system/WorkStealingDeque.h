@@ -0,0 +1,141 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace RESANA {
+
+// Chase-Lev deque of pointers (Le et al., "Correct and Efficient Work-Stealing
+// for Weak Memory Models"). The owning worker pushes and pops at the bottom
+// without contention; other workers steal from the top with a single CAS.
+// Outgrown buffers are kept until the deque is destroyed, because a thief may
+// still be reading from one.
+template <typename T> class WorkStealingDeque {
+public:
+  explicit WorkStealingDeque(size_t capacity = 256);
+
+  WorkStealingDeque(const WorkStealingDeque &) = delete;
+  WorkStealingDeque &operator=(const WorkStealingDeque &) = delete;
+
+  // Owner side
+  void Push(T *item);
+  T *Pop();
+
+  // Any thread. Returns nullptr if empty or if another thread won the race.
+  T *Steal();
+
+  [[nodiscard]] bool IsEmpty() const {
+    return mBottom.load(std::memory_order_relaxed) <=
+           mTop.load(std::memory_order_relaxed);
+  }
+
+private:
+  struct Buffer {
+    explicit Buffer(int64_t capacity)
+        : Mask(capacity - 1), Items(new std::atomic<T *>[(size_t)capacity]) {}
+
+    T *Get(int64_t index) const {
+      return Items[(size_t)(index & Mask)].load(std::memory_order_relaxed);
+    }
+    void Put(int64_t index, T *item) {
+      Items[(size_t)(index & Mask)].store(item, std::memory_order_relaxed);
+    }
+
+    int64_t Mask;
+    std::unique_ptr<std::atomic<T *>[]> Items;
+  };
+
+  Buffer *Grow(Buffer *buffer, int64_t top, int64_t bottom);
+
+private:
+  alignas(64) std::atomic<int64_t> mTop{0};
+  alignas(64) std::atomic<int64_t> mBottom{0};
+  std::atomic<Buffer *> mBuffer{nullptr};
+  std::vector<std::unique_ptr<Buffer>> mBuffers{}; // Owner only
+};
+
+template <typename T>
+WorkStealingDeque<T>::WorkStealingDeque(size_t capacity) {
+  size_t size = 2;
+  while (size < capacity) {
+    size <<= 1;
+  }
+  mBuffers.push_back(std::make_unique<Buffer>((int64_t)size));
+  mBuffer.store(mBuffers.back().get(), std::memory_order_relaxed);
+}
+
+template <typename T> void WorkStealingDeque<T>::Push(T *item) {
+  const int64_t bottom = mBottom.load(std::memory_order_relaxed);
+  const int64_t top = mTop.load(std::memory_order_acquire);
+  Buffer *buffer = mBuffer.load(std::memory_order_relaxed);
+
+  if (bottom - top > buffer->Mask) {
+    buffer = Grow(buffer, top, bottom);
+  }
+
+  buffer->Put(bottom, item);
+  std::atomic_thread_fence(std::memory_order_release);
+  mBottom.store(bottom + 1, std::memory_order_relaxed);
+}
+
+template <typename T> T *WorkStealingDeque<T>::Pop() {
+  const int64_t bottom = mBottom.load(std::memory_order_relaxed) - 1;
+  Buffer *buffer = mBuffer.load(std::memory_order_relaxed);
+  mBottom.store(bottom, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  int64_t top = mTop.load(std::memory_order_relaxed);
+
+  if (top > bottom) {
+    // Empty
+    mBottom.store(bottom + 1, std::memory_order_relaxed);
+    return nullptr;
+  }
+
+  T *item = buffer->Get(bottom);
+  if (top == bottom) {
+    // Last item; race the thieves for it
+    if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+      item = nullptr;
+    }
+    mBottom.store(bottom + 1, std::memory_order_relaxed);
+  }
+  return item;
+}
+
+template <typename T> T *WorkStealingDeque<T>::Steal() {
+  int64_t top = mTop.load(std::memory_order_acquire);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  const int64_t bottom = mBottom.load(std::memory_order_acquire);
+
+  if (top >= bottom) {
+    return nullptr;
+  }
+
+  Buffer *buffer = mBuffer.load(std::memory_order_acquire);
+  T *item = buffer->Get(top);
+  if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                    std::memory_order_relaxed)) {
+    return nullptr;
+  }
+  return item;
+}
+
+template <typename T>
+typename WorkStealingDeque<T>::Buffer *
+WorkStealingDeque<T>::Grow(Buffer *buffer, int64_t top, int64_t bottom) {
+  auto grown = std::make_unique<Buffer>((buffer->Mask + 1) * 2);
+  for (int64_t i = top; i < bottom; ++i) {
+    grown->Put(i, buffer->Get(i));
+  }
+
+  Buffer *result = grown.get();
+  mBuffers.push_back(std::move(grown));
+  mBuffer.store(result, std::memory_order_release);
+  return result;
+}
+
+} // namespace RESANA
@@ -0,0 +1,69 @@
+#include "CoreLayout.h"
+#include "rspch.h"
+
+#include "core/Core.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace RESANA {
+
+void CoreLayout::Build(const PdhItem *items, const PdhSize count) {
+  struct Core {
+    long Number;
+    PdhSize Item;
+  };
+
+  std::vector<Core> cores;
+  cores.reserve(count);
+  mSlotByItem.assign(count, SKIPPED_SLOT);
+
+  for (PdhSize i = 0; i < count; ++i) {
+    const char *name = items[i].szName ? items[i].szName : "";
+    if (std::strcmp(name, "_Total") == 0) {
+      mSlotByItem[i] = TOTAL_SLOT;
+      continue;
+    }
+
+    char *end = nullptr;
+    const long number = std::strtol(name, &end, 10);
+    if (end == name || *end != '\0' || number < 0) {
+      RS_CORE_WARN("Skipping processor counter '{0}'", name);
+      continue;
+    }
+    cores.push_back({number, i});
+  }
+
+  std::sort(cores.begin(), cores.end(), [](const Core &left, const Core &right) {
+    return left.Number < right.Number;
+  });
+
+  mNames.resize(cores.size());
+  for (size_t slot = 0; slot < cores.size(); ++slot) {
+    mSlotByItem[cores[slot].Item] = (int32_t)slot;
+    mNames[slot] = std::to_string(cores[slot].Number);
+  }
+
+  ++mGeneration;
+  RS_CORE_INFO("Mapped {0} logical processors", mNames.size());
+}
+
+void CoreLayout::Apply(const PdhItem *items, const PdhSize count,
+                       LogicalCoreData &data) const {
+  RS_CORE_ASSERT((count == mSlotByItem.size()),
+                 "The sample does not match the core layout");
+
+  data.SetLayout(*this);
+  auto *cores = data.GetProcessors().data();
+
+  for (PdhSize i = 0; i < count; ++i) {
+    const int32_t slot = mSlotByItem[i];
+    if (slot >= 0) {
+      cores[slot].FmtValue = items[i].FmtValue;
+    } else if (slot == TOTAL_SLOT) {
+      data.SetTotalLoad(items[i].FmtValue.doubleValue);
+    }
+  }
+}
+
+} // namespace RESANA
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "LogicalCoreData.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace RESANA {
+
+// Where each item of a raw per-processor sample goes. The item names are
+// parsed once, when the layout is built, and the cores are given fixed slots
+// in ascending core order; a tick then only copies values by index. The
+// layout is rebuilt when the set of processors changes (CPU hotplug), never
+// per tick.
+class CoreLayout {
+public:
+  // Parses the item names: "_Total" is the aggregate, any other name is the
+  // core number. Items with a name that is neither are skipped.
+  void Build(const PdhItem *items, PdhSize count);
+
+  // Writes the values of a sample with the layout's item order into the
+  // fixed per-core array of data
+  void Apply(const PdhItem *items, PdhSize count, LogicalCoreData &data) const;
+
+  [[nodiscard]] PdhSize GetNumItems() const {
+    return (PdhSize)mSlotByItem.size();
+  }
+  [[nodiscard]] size_t GetNumCores() const { return mNames.size(); }
+  // Core names by slot
+  [[nodiscard]] const std::vector<std::string> &GetNames() const {
+    return mNames;
+  }
+  // Changes on every Build(); zero before the first
+  [[nodiscard]] uint32_t GetGeneration() const { return mGeneration; }
+
+private:
+  static constexpr int32_t TOTAL_SLOT = -1;
+  static constexpr int32_t SKIPPED_SLOT = -2;
+
+  std::vector<int32_t> mSlotByItem{}; // Item position -> core slot
+  std::vector<std::string> mNames{};
+  uint32_t mGeneration{};
+};
+
+} // namespace RESANA
@@ -0,0 +1,282 @@
+#include "CpuPerformance.h"
+#include "rspch.h"
+
+#include "system/SystemRuntime.h"
+#include "system/processes/ProcessLoad.h"
+#include "system/trace/SampleTrace.h"
+#include "core/Core.h"
+
+#include <memory>
+#include <mutex>
+
+#ifdef RS_PLATFORM_LINUX
+#include "platform/linux/ProcStat.h"
+#endif
+
+namespace RESANA {
+
+std::shared_ptr<CpuPerformance> CpuPerformance::sInstance = nullptr;
+
+CpuPerformance::CpuPerformance()
+    : SystemObject(this), mUpdateInterval(TimeTick::Rate::Normal) {}
+
+CpuPerformance::CpuPerformance(const CpuPerformance &other)
+    : SystemObject(other.mContext) {
+  mRunning = other.mRunning;
+  mUpdateInterval = other.mUpdateInterval;
+  mCpuLoadAvg = other.mCpuLoadAvg;
+  mProcessLoad = other.mProcessLoad;
+  mNumProcessors = other.mNumProcessors;
+  mCpuData = other.mCpuData;
+  mLoadData = other.mLoadData;
+  mProcData = other.mProcData;
+}
+
+CpuPerformance::~CpuPerformance() {
+  Time::Sleep(mUpdateInterval); // Let threads finish before destructing
+  RS_CORE_TRACE("CpuPerformance destroyed");
+}
+
+void CpuPerformance::InitProcessData() {
+  ProcessMetrics metrics{};
+  if (CollectProcessMetrics(GetCurrentProcessIdentifier(), metrics)) {
+    CalcProcessLoad(metrics, &mProcData);
+  }
+}
+
+void CpuPerformance::Run() {
+  if (!sInstance) {
+    sInstance = Get();
+  }
+
+  if (!sInstance->IsRunning()) {
+    sInstance->mRunning = true;
+
+    const auto &runtime = SystemRuntime::Get();
+    auto &threadPool = runtime.GetThreadPool();
+
+    if (!runtime.IsReplaying()) {
+      sInstance->mSampleTask = runtime.GetSampleScheduler().Add(
+          "cpu", sInstance->mUpdateInterval, [&] { sInstance->SampleTick(); });
+    }
+    threadPool.RunDedicated([&] { sInstance->ProcessDataThread(); });
+  }
+}
+
+void CpuPerformance::Stop() {
+  if (IsRunning()) {
+    mRunning = false;
+    if (mSampleTask) {
+      SystemRuntime::Get().GetSampleScheduler().Remove(mSampleTask);
+      mSampleTask = {};
+    }
+    mSampleRing.Wake();
+    mLockContainer.NotifyAll();
+  }
+}
+
+void CpuPerformance::Shutdown() {
+  Stop();
+  sInstance.reset();
+}
+
+std::shared_ptr<CpuPerformance> CpuPerformance::Get() {
+  if (!sInstance) {
+    sInstance.reset(new CpuPerformance);
+    sInstance->InitCpuData();
+    sInstance->InitProcessData();
+  }
+
+  return sInstance;
+}
+
+Snapshot<LogicalCoreData> CpuPerformance::GetData() const {
+  RS_CORE_ASSERT(IsRunning(), "Process is not currently running! Call "
+                              "'CpuPerformance::Run()' to start process.");
+
+  return mPublishedData.Acquire();
+}
+
+int CpuPerformance::GetNumProcessors() const { return mNumProcessors; }
+
+double CpuPerformance::GetCurrentLoad() {
+  if (sInstance) {
+    return sInstance->mCpuLoadAvg;
+  }
+  return 0.0;
+}
+
+double CpuPerformance::GetProcessLoad(const uint32_t procId, PdhData *data) {
+  ProcessMetrics metrics{};
+  if (!CollectProcessMetrics(procId, metrics)) {
+    return 0.0;
+  }
+  return CalcProcessLoad(metrics, data);
+}
+
+double CpuPerformance::GetProcessLoad(const ProcessMetrics &metrics,
+                                      PdhData *data) {
+  return CalcProcessLoad(metrics, data);
+}
+
+double CpuPerformance::GetCurrentProcessLoad() {
+  return GetProcessLoad(GetCurrentProcessIdentifier(), &sInstance->mProcData);
+}
+
+void CpuPerformance::SetUpdateInterval(Timestep interval) {
+  if ((uint32_t)interval == mUpdateInterval) {
+    return;
+  }
+
+  mUpdateInterval = interval;
+  if (mSampleTask) {
+    SystemRuntime::Get().GetSampleScheduler().SetInterval(mSampleTask,
+                                                        mUpdateInterval);
+  }
+}
+
+bool CpuPerformance::IsRunning() const { return mRunning; }
+
+void CpuPerformance::SampleTick() {
+  auto *slot = mSampleRing.BeginWrite();
+  if (!slot) {
+    // The process thread is behind; drop this interval instead of blocking
+    return;
+  }
+
+  slot->SetTime(Time::GetTime());
+  if (PrepareData(*slot)) {
+    mSampleRing.CommitWrite();
+  }
+}
+
+void CpuPerformance::ApplyItems(const PdhItem *items, const PdhSize count,
+                                const bool layoutChanged,
+                                LogicalCoreData &data) {
+  if (layoutChanged) {
+    mCoreLayout.Build(items, count);
+  }
+  mCoreLayout.Apply(items, count, data);
+
+  if (auto *trace = SystemRuntime::Get().GetTraceWriter()) {
+    trace->WriteCpu(data.GetTime(), items, count, layoutChanged);
+  }
+}
+
+bool CpuPerformance::ReplaySample(const PdhItem *items, const PdhSize count,
+                                  const bool layoutChanged,
+                                  const int64_t time) {
+  auto *slot = mSampleRing.BeginWrite();
+  if (!slot) {
+    return false;
+  }
+
+  slot->SetTime(time);
+  if (layoutChanged || count != mCoreLayout.GetNumItems()) {
+    mCoreLayout.Build(items, count);
+  }
+  mCoreLayout.Apply(items, count, *slot);
+  mSampleRing.CommitWrite();
+  return true;
+}
+
+void CpuPerformance::ProcessDataThread() {
+  while (IsRunning()) {
+    auto *slot = mSampleRing.WaitRead(mUpdateInterval);
+    if (!slot) {
+      continue;
+    }
+
+    ProcessData(*slot);
+    SetData(*slot);
+    mSampleRing.CommitRead();
+  }
+}
+
+void CpuPerformance::ProcessData(LogicalCoreData &data) {
+  // The per-core values are already in place, in core order
+  RecordHistory(data);
+
+  // The current load is the average of the latest totals
+  const auto &history = SystemRuntime::Get().GetHistory();
+  const auto stats = history.AggregateLast(mTotalSeries, MAX_LOAD_COUNT);
+
+  std::lock_guard lock(mLockContainer.GetMutex());
+  mCpuLoadAvg = stats.Avg;
+}
+
+void CpuPerformance::RecordHistory(const LogicalCoreData &data) {
+  auto &history = SystemRuntime::Get().GetHistory();
+  const auto &processors = data.GetProcessors();
+
+  if (mTotalSeries == MetricHistory::INVALID_SERIES) {
+    mTotalSeries = history.Register("cpu.total");
+  }
+
+  // Cores that stay online keep their series across a hotplug
+  if (data.GetLayoutGeneration() != mCoreSeriesGeneration) {
+    mCoreSeries.resize(processors.size());
+    mCoreValues.resize(processors.size());
+    for (size_t i = 0; i < processors.size(); ++i) {
+      mCoreSeries[i] =
+          history.Register(std::string("cpu.core.") + processors[i].szName);
+    }
+    mCoreSeriesGeneration = data.GetLayoutGeneration();
+  }
+
+  for (size_t i = 0; i < processors.size(); ++i) {
+    mCoreValues[i] = processors[i].FmtValue.doubleValue;
+  }
+
+  const int64_t time = data.GetTime();
+  history.Append(mCoreSeries.data(), mCoreValues.data(), mCoreValues.size(),
+                 time);
+  history.Append(mTotalSeries, time, data.GetTotalLoad());
+}
+
+float CpuPerformance::CalcCpuLoad(uint64_t idleTicks, uint64_t totalTicks) {
+  static uint64_t previousTotalTicks = 0;
+  static uint64_t previousIdleTicks = 0;
+
+  uint64_t totalTicksSinceLastTime = totalTicks - previousTotalTicks;
+  uint64_t idleTicksSinceLastTime = idleTicks - previousIdleTicks;
+
+  float ret =
+      1.0f - ((totalTicksSinceLastTime > 0)
+                  ? ((float)idleTicksSinceLastTime) / totalTicksSinceLastTime
+                  : 0);
+
+  previousTotalTicks = totalTicks;
+  previousIdleTicks = idleTicks;
+  return ret;
+}
+
+double CpuPerformance::CalcProcessLoad(const ProcessMetrics &metrics,
+                                       PdhData *data) {
+  static const double scale =
+      100.0 / (double)std::max(1u, std::thread::hardware_concurrency());
+
+  // The same delta and wrap handling as the process table's kernel
+  const double load = CalcLoadSample(
+      metrics.UserTime + metrics.SystemTime, data->UserTime + data->SystemTime,
+      metrics.Time, data->Time, scale);
+
+  data->Time = metrics.Time;
+  data->UserTime = metrics.UserTime;
+  data->SystemTime = metrics.SystemTime;
+  data->CreationTime = metrics.CreationTime;
+
+  return load;
+}
+
+void CpuPerformance::SetData(LogicalCoreData &data) {
+  if (!sInstance) {
+    return;
+  }
+
+  // Copy out of the ring slot into a retired snapshot's storage. Readers still
+  // holding an older snapshot keep it until they release it.
+  mPublishedData.Publish(data);
+}
+
+} // namespace RESANA
\ No newline at end of file
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "CoreLayout.h"
+#include "LogicalCoreData.h"
+#include "system/SampleScheduler.h"
+#include "system/Snapshot.h"
+#include "system/SpscRing.h"
+#include "system/base/SystemObject.h"
+#include "system/history/MetricHistory.h"
+#include "system/processes/ProcessMetrics.h"
+
+#include "helpers/Time.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace RESANA {
+
+struct PdhData;
+class ProcStatReader;
+
+class CpuPerformance : public SystemObject {
+public:
+  ~CpuPerformance() override;
+  CpuPerformance(const CpuPerformance &other);
+
+  void Run() override;
+  void Stop() override;
+  void Shutdown() override;
+
+  static std::shared_ptr<CpuPerformance> Get();
+
+  // The latest sample; never waits for the sampler threads. Empty until the
+  // first sample has been processed.
+  Snapshot<LogicalCoreData> GetData() const;
+
+  [[nodiscard]] int GetNumProcessors() const;
+  [[nodiscard]] static double GetCurrentLoad();
+  [[nodiscard]] static double GetCurrentProcessLoad();
+  [[nodiscard]] static double GetProcessLoad(uint32_t procId, PdhData *data);
+  [[nodiscard]] static double GetProcessLoad(const ProcessMetrics &metrics,
+                                             PdhData *data);
+  float GetCpuLoad();
+
+  void SetUpdateInterval(Timestep interval);
+
+  bool IsRunning() const;
+
+  // Queues a sample read from a trace in place of one from the OS. False if
+  // the process thread has not caught up yet.
+  bool ReplaySample(const PdhItem *items, PdhSize count, bool layoutChanged,
+                    int64_t time);
+  // Samples queued and not processed yet
+  [[nodiscard]] size_t GetPendingSamples() const {
+    return mSampleRing.GetSize();
+  }
+
+private:
+  CpuPerformance();
+
+  // Initializer
+  void InitCpuData();
+  void InitProcessData();
+
+  // Fired by the sample scheduler; hands a sample to the process thread
+  void SampleTick();
+  void ProcessDataThread();
+
+  // PrepareData fills a ring slot in place
+  bool PrepareData(LogicalCoreData &data);
+  // Maps the raw per-processor items of a live sample to core slots, and
+  // writes them to the trace if one is recorded
+  void ApplyItems(const PdhItem *items, PdhSize count, bool layoutChanged,
+                  LogicalCoreData &data);
+  void SetData(LogicalCoreData &data);
+  void ProcessData(LogicalCoreData &data);
+  // Records the sample into the metric history
+  void RecordHistory(const LogicalCoreData &data);
+  static float CalcCpuLoad(uint64_t idleTicks, uint64_t totalTicks);
+  static double CalcProcessLoad(const ProcessMetrics &metrics, PdhData *data);
+
+private:
+  // Samples in the current load's moving average
+  const unsigned int MAX_LOAD_COUNT = 3;
+  // Samples in flight between the prepare and process threads
+  static constexpr size_t SAMPLE_SLOTS = 4;
+
+  bool mRunning = false;
+  uint32_t mUpdateInterval{};
+  SampleScheduler::TaskId mSampleTask{};
+
+  SnapshotPublisher<LogicalCoreData> mPublishedData{};
+  SpscRing<LogicalCoreData> mSampleRing{SAMPLE_SLOTS};
+
+  // History series; written by the process thread only
+  MetricHistory::SeriesId mTotalSeries = MetricHistory::INVALID_SERIES;
+  std::vector<MetricHistory::SeriesId> mCoreSeries{}; // By core slot
+  std::vector<double> mCoreValues{};
+  uint32_t mCoreSeriesGeneration{}; // The core layout mCoreSeries follows
+
+  double mCpuLoadAvg{};
+  double mProcessLoad{};
+  int mNumProcessors{};
+
+  PdhData mCpuData;
+  PdhData mLoadData;
+  PdhData mProcData;
+
+  // Sampler thread only; maps the raw per-processor items to core slots
+  CoreLayout mCoreLayout{};
+
+#ifdef RS_PLATFORM_WINDOWS
+  std::vector<uint8_t> mPdhBuffer{}; // Reused by PrepareData
+#else
+  std::unique_ptr<ProcStatReader> mProcStat;
+  uint32_t mProcStatGeneration{}; // The reader's cores that mCoreLayout maps
+#endif
+
+  static std::shared_ptr<CpuPerformance> sInstance;
+};
+} // namespace RESANA
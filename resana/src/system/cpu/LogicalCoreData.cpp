@@ -1,6 +1,10 @@
 #include "LogicalCoreData.h"
 #include "rspch.h"
 
+#include "CoreLayout.h"
+
+#include <cstring>
+
 namespace RESANA {
 LogicalCoreData::LogicalCoreData() = default;
 
@@ -16,33 +20,64 @@ std::mutex& LogicalCoreData::GetMutex()
     return mMutex;
 }
 
-std::vector<std::shared_ptr<PdhItem>>& LogicalCoreData::GetProcessors()
+std::vector<PdhItem>& LogicalCoreData::GetProcessors()
+{
+    return mProcessors;
+}
+
+const std::vector<PdhItem>& LogicalCoreData::GetProcessors() const
 {
     return mProcessors;
 }
 
-void LogicalCoreData::SetProcessorRef(PdhItem* ref)
+void LogicalCoreData::SetLayout(const CoreLayout& layout)
 {
-    if (mProcessorRef) {
-        delete mProcessorRef;
-        mProcessorRef = nullptr;
+    if (mLayoutGeneration == layout.GetGeneration()) {
+        return;
+    }
+
+    mNames.clear();
+    for (const auto& name : layout.GetNames()) {
+        mNames.insert(mNames.end(), name.c_str(), name.c_str() + name.size() + 1);
     }
-    mProcessorRef = ref;
+
+    mProcessors.assign(layout.GetNumCores(), PdhItem {});
+    PointNames();
+    mLayoutGeneration = layout.GetGeneration();
+}
+
+uint32_t LogicalCoreData::GetLayoutGeneration() const
+{
+    return mLayoutGeneration;
+}
+
+void LogicalCoreData::SetTotalLoad(double load)
+{
+    mTotalLoad = load;
 }
 
-PdhItem* LogicalCoreData::GetProcessorRef() const
+double LogicalCoreData::GetTotalLoad() const
 {
-    return mProcessorRef;
+    return mTotalLoad;
 }
 
-DWORD& LogicalCoreData::GetSize()
+void LogicalCoreData::SetTime(int64_t time)
 {
-    return mSize;
+    mTime = time;
 }
 
-DWORD& LogicalCoreData::GetBuffer()
+int64_t LogicalCoreData::GetTime() const
 {
-    return mBuffer;
+    return mTime;
+}
+
+void LogicalCoreData::PointNames()
+{
+    size_t offset = 0;
+    for (auto& item : mProcessors) {
+        item.szName = mNames.data() + offset;
+        offset += std::strlen(item.szName) + 1;
+    }
 }
 
 void LogicalCoreData::Clear()
@@ -50,6 +85,10 @@ void LogicalCoreData::Clear()
     std::mutex mutex;
     std::scoped_lock lock(mutex);
     mProcessors.clear();
+    mNames.clear();
+    mTotalLoad = 0.0;
+    mTime = 0;
+    mLayoutGeneration = 0;
 }
 
 void LogicalCoreData::Copy(const LogicalCoreData& other)
@@ -58,18 +97,21 @@ void LogicalCoreData::Copy(const LogicalCoreData& other)
         return;
     }
 
-    Clear();
-
     std::scoped_lock lock(mMutex);
 
-    for (const auto& processor : other.mProcessors) {
-        auto copy = std::make_shared<PdhItem>(*processor);
-        mProcessors.emplace_back(copy);
+    if (mLayoutGeneration != other.mLayoutGeneration) {
+        mNames = other.mNames;
+        mProcessors = other.mProcessors;
+        PointNames();
+        mLayoutGeneration = other.mLayoutGeneration;
+    } else {
+        // Same cores and names; only the values differ
+        for (size_t i = 0; i < mProcessors.size(); ++i) {
+            mProcessors[i].FmtValue = other.mProcessors[i].FmtValue;
+        }
     }
-
-    mProcessorRef = other.mProcessorRef;
-    mSize = other.mSize;
-    mBuffer = other.mBuffer;
+    mTotalLoad = other.mTotalLoad;
+    mTime = other.mTime;
 }
 
 LogicalCoreData& LogicalCoreData::operator=(const LogicalCoreData& rhs)
@@ -79,4 +121,4 @@ LogicalCoreData& LogicalCoreData::operator=(const LogicalCoreData& rhs)
     }
     return *this;
 }
-}
\ No newline at end of file
+}
\ No newline at end of file
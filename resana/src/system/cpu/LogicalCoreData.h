@@ -1,15 +1,22 @@
 #pragma once
 
+#include "core/PlatformDetection.h"
+
+#include <cstdint>
 #include <memory>
 #include <mutex>
 #include <vector>
 
+#ifdef RS_PLATFORM_WINDOWS
 #include <Pdh.h>
 #include <tchar.h>
+#endif
 
 namespace RESANA {
 
+#ifdef RS_PLATFORM_WINDOWS
 typedef PDH_FMT_COUNTERVALUE_ITEM PdhItem;
+typedef DWORD PdhSize;
 
 struct PdhData {
   HANDLE Handle{};
@@ -53,7 +60,34 @@ struct PdhData {
     return *this;
   }
 };
+#else
+typedef uint32_t PdhSize;
+
+// Mirrors the parts of PDH_FMT_COUNTERVALUE_ITEM read by the panels, so the
+// procfs sampler can feed the same pipeline as the PDH one.
+struct PdhItem {
+  char *szName = nullptr;
+  struct {
+    long CStatus = 0;
+    double doubleValue = 0.0;
+  } FmtValue;
+};
 
+struct PdhData {
+  int Handle{}; // Process id; procfs has no handle objects
+  uint64_t Time{};
+  uint64_t SystemTime{};
+  uint64_t UserTime{};
+  uint64_t CreationTime{};
+  uint64_t ExitTime{};
+};
+#endif
+
+class CoreLayout;
+
+// One CPU sample: the load of every logical core in a fixed array, in core
+// order, and the total. The array and the core names only change when the
+// core layout is rebuilt.
 class LogicalCoreData {
 public:
     LogicalCoreData();
@@ -62,26 +96,38 @@ public:
 
     std::mutex& GetMutex();
 
-    std::vector<std::shared_ptr<PdhItem>>& GetProcessors();
+    // Per-processor items without _Total, indexed by core slot; names point
+    // into this object
+    std::vector<PdhItem>& GetProcessors();
+    [[nodiscard]] const std::vector<PdhItem>& GetProcessors() const;
 
-    void SetProcessorRef(PdhItem* ref);
-    [[nodiscard]] PdhItem* GetProcessorRef() const;
+    // Sizes the per-core array and takes the core names of the layout. Does
+    // nothing unless the layout was rebuilt since the last call.
+    void SetLayout(const CoreLayout& layout);
+    [[nodiscard]] uint32_t GetLayoutGeneration() const;
 
-    [[nodiscard]] DWORD& GetSize();
+    void SetTotalLoad(double load);
+    [[nodiscard]] double GetTotalLoad() const;
 
-    DWORD& GetBuffer();
+    // When the sample was taken (Time::GetTime)
+    void SetTime(int64_t time);
+    [[nodiscard]] int64_t GetTime() const;
 
     void Clear();
     void Copy(const LogicalCoreData& other);
 
     LogicalCoreData& operator=(const LogicalCoreData& rhs);
 
+private:
+    void PointNames();
+
 private:
     std::mutex mMutex {};
-    std::vector<std::shared_ptr<PdhItem>> mProcessors {};
-    PdhItem* mProcessorRef = nullptr;
-    DWORD mSize = 0;
-    DWORD mBuffer = 0;
+    std::vector<PdhItem> mProcessors {};
+    std::vector<char> mNames {};
+    double mTotalLoad = 0.0;
+    int64_t mTime = 0;
+    uint32_t mLayoutGeneration = 0;
 };
 
 }
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+
+namespace RESANA {
+
+constexpr size_t HISTORY_ALIGNMENT = 64;
+
+struct AlignedDelete {
+  void operator()(void *data) const {
+    ::operator delete(data, std::align_val_t(HISTORY_ALIGNMENT));
+  }
+};
+
+// Uninitialized storage for trivial types, aligned to a cache line
+template <typename T> using AlignedArray = std::unique_ptr<T[], AlignedDelete>;
+
+template <typename T> AlignedArray<T> AllocateAligned(const size_t count) {
+  return AlignedArray<T>(static_cast<T *>(::operator new(
+      sizeof(T) * count, std::align_val_t(HISTORY_ALIGNMENT))));
+}
+
+} // namespace RESANA
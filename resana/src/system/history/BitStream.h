@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace RESANA {
+
+// Writes bit fields most significant bit first into a caller owned buffer
+class BitWriter {
+public:
+  void Reset(uint8_t *data, const size_t bytes) {
+    mData = data;
+    mCapacity = bytes * 8;
+    mCount = 0;
+  }
+
+  // Writes the low count bits of value; count is at most 64
+  void Write(const uint64_t value, unsigned count) {
+    while (count > 0) {
+      const size_t byte = mCount >> 3;
+      const unsigned free = 8 - (unsigned)(mCount & 7);
+      const unsigned take = count < free ? count : free;
+      const auto bits =
+          (uint8_t)((value >> (count - take)) & ((1u << take) - 1));
+
+      if (free == 8) {
+        mData[byte] = 0;
+      }
+      mData[byte] |= (uint8_t)(bits << (free - take));
+      mCount += take;
+      count -= take;
+    }
+  }
+
+  [[nodiscard]] size_t GetBitCount() const { return mCount; }
+  [[nodiscard]] size_t GetRemainingBits() const { return mCapacity - mCount; }
+
+private:
+  uint8_t *mData = nullptr;
+  size_t mCapacity{};
+  size_t mCount{};
+};
+
+// Reads what a BitWriter wrote
+class BitReader {
+public:
+  BitReader(const uint8_t *data, const size_t bits)
+      : mData(data), mCapacity(bits) {}
+
+  uint64_t Read(unsigned count) {
+    uint64_t value = 0;
+    while (count > 0) {
+      const size_t byte = mPosition >> 3;
+      const unsigned free = 8 - (unsigned)(mPosition & 7);
+      const unsigned take = count < free ? count : free;
+      const unsigned bits =
+          ((unsigned)mData[byte] >> (free - take)) & ((1u << take) - 1);
+
+      value = (value << take) | bits;
+      mPosition += take;
+      count -= take;
+    }
+    return value;
+  }
+
+  bool ReadBit() { return Read(1) != 0; }
+
+  [[nodiscard]] bool IsAtEnd() const { return mPosition >= mCapacity; }
+
+private:
+  const uint8_t *mData;
+  size_t mCapacity;
+  size_t mPosition{};
+};
+
+inline uint64_t ZigZagEncode(const int64_t value) {
+  return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+inline int64_t ZigZagDecode(const uint64_t value) {
+  return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+// Zero bits above and below the highest and lowest set bit; value != 0
+inline unsigned CountLeadingZeros(const uint64_t value) {
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanReverse64(&index, value);
+  return 63 - (unsigned)index;
+#else
+  return (unsigned)__builtin_clzll(value);
+#endif
+}
+
+inline unsigned CountTrailingZeros(const uint64_t value) {
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanForward64(&index, value);
+  return (unsigned)index;
+#else
+  return (unsigned)__builtin_ctzll(value);
+#endif
+}
+
+} // namespace RESANA
@@ -0,0 +1,333 @@
+#include "CompressedSeries.h"
+#include "rspch.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace RESANA {
+
+namespace {
+
+uint64_t ToBits(const double value) {
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+double FromBits(const uint64_t bits) {
+  double value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+int64_t ToInteger(const double value) {
+  // Out of range values saturate instead of being undefined
+  if (!(value > -9.2e18)) {
+    return value != value ? 0 : INT64_MIN;
+  }
+  if (!(value < 9.2e18)) {
+    return INT64_MAX;
+  }
+  return std::llround(value);
+}
+
+void WriteVarint(BitWriter &writer, uint64_t value) {
+  while (value >= 0x80) {
+    writer.Write((value & 0x7f) | 0x80, 8);
+    value >>= 7;
+  }
+  writer.Write(value, 8);
+}
+
+uint64_t ReadVarint(BitReader &reader) {
+  uint64_t value = 0;
+  for (unsigned shift = 0; shift < 64; shift += 7) {
+    const uint64_t group = reader.Read(8);
+    value |= (group & 0x7f) << shift;
+    if (!(group & 0x80)) {
+      break;
+    }
+  }
+  return value;
+}
+
+} // namespace
+
+CompressedSeries::BlockDecoder::BlockDecoder(const CompressedSeries &series,
+                                             const size_t block)
+    : mReader(series.GetBlockData(block), series.GetBlockHeader(block).Bits),
+      mHeader(series.GetBlockHeader(block)), mEncoding(series.mEncoding),
+      mLeading(~0u) {}
+
+bool CompressedSeries::BlockDecoder::Next(HistoryPoint &point) {
+  if (mIndex >= mHeader.Count) {
+    return false;
+  }
+
+  if (mIndex == 0) {
+    mTime = mHeader.FirstTime;
+    if (mEncoding == SeriesEncoding::Integer) {
+      mInteger = ZigZagDecode(ReadVarint(mReader));
+    } else {
+      mBits = mReader.Read(64);
+    }
+  } else {
+    // Time: delta of delta
+    int64_t deltaOfDelta = 0;
+    if (mReader.ReadBit()) {
+      if (!mReader.ReadBit()) {
+        deltaOfDelta = ZigZagDecode(mReader.Read(7));
+      } else if (!mReader.ReadBit()) {
+        deltaOfDelta = ZigZagDecode(mReader.Read(9));
+      } else if (!mReader.ReadBit()) {
+        deltaOfDelta = ZigZagDecode(mReader.Read(12));
+      } else {
+        deltaOfDelta = ZigZagDecode(mReader.Read(64));
+      }
+    }
+    mDelta += deltaOfDelta;
+    mTime += mDelta;
+
+    // Value
+    if (mEncoding == SeriesEncoding::Integer) {
+      // Wraps like the encoder's subtraction
+      mInteger = (int64_t)((uint64_t)mInteger +
+                           (uint64_t)ZigZagDecode(ReadVarint(mReader)));
+    } else if (mReader.ReadBit()) {
+      if (mReader.ReadBit()) {
+        mLeading = (unsigned)mReader.Read(5);
+        const unsigned length = (unsigned)mReader.Read(6) + 1;
+        mTrailing = 64 - mLeading - length;
+      }
+      const unsigned length = 64 - mLeading - mTrailing;
+      mBits ^= mReader.Read(length) << mTrailing;
+    }
+  }
+
+  ++mIndex;
+  point.Time = mTime;
+  point.Value = mEncoding == SeriesEncoding::Integer ? (double)mInteger
+                                                     : FromBits(mBits);
+  return true;
+}
+
+CompressedSeries::CompressedSeries(const size_t bytes,
+                                   const SeriesEncoding encoding)
+    : mEncoding(encoding),
+      // Two blocks at least, so dropping the oldest leaves history behind
+      mCapacity(std::max<size_t>((bytes + BLOCK_BYTES - 1) / BLOCK_BYTES, 2)),
+      mData(AllocateAligned<uint8_t>(mCapacity * BLOCK_BYTES)),
+      mHeaders(mCapacity) {}
+
+void CompressedSeries::Append(const int64_t time, const double value) {
+  if (mNumBlocks == 0 || mWriter.GetRemainingBits() < MAX_SAMPLE_BITS) {
+    StartBlock(time, value);
+    return;
+  }
+
+  auto &header = mHeaders[ToRing(mNumBlocks - 1)];
+  EncodeTime(time);
+  EncodeValue(value);
+  header.LastTime = time;
+  header.Bits = (uint32_t)mWriter.GetBitCount();
+  ++header.Count;
+  ++mNumSamples;
+}
+
+void CompressedSeries::Clear() {
+  mHead = 0;
+  mNumBlocks = 0;
+  mNumSamples = 0;
+  mDropped = false;
+}
+
+bool CompressedSeries::Covers(const int64_t time) const {
+  return !mDropped || (mNumBlocks > 0 && GetBlockHeader(0).FirstTime <= time);
+}
+
+size_t CompressedSeries::FindBlock(const int64_t time) const {
+  size_t first = 0;
+  size_t count = mNumBlocks;
+  while (count > 0) {
+    const size_t step = count / 2;
+    if (GetBlockHeader(first + step).LastTime < time) {
+      first += step + 1;
+      count -= step + 1;
+    } else {
+      count = step;
+    }
+  }
+  return first;
+}
+
+void CompressedSeries::Read(const int64_t from, const int64_t to,
+                            std::vector<HistoryPoint> &points) const {
+  HistoryPoint point;
+  for (size_t block = FindBlock(from); block < mNumBlocks; ++block) {
+    if (GetBlockHeader(block).FirstTime > to) {
+      break;
+    }
+
+    BlockDecoder decoder(*this, block);
+    while (decoder.Next(point)) {
+      if (point.Time > to) {
+        return;
+      }
+      if (point.Time >= from) {
+        points.push_back(point);
+      }
+    }
+  }
+}
+
+HistoryStats CompressedSeries::Aggregate(const int64_t from,
+                                         const int64_t to) const {
+  HistoryAccumulator accumulator;
+  HistoryPoint point;
+  for (size_t block = FindBlock(from); block < mNumBlocks; ++block) {
+    if (GetBlockHeader(block).FirstTime > to) {
+      break;
+    }
+
+    BlockDecoder decoder(*this, block);
+    while (decoder.Next(point) && point.Time <= to) {
+      if (point.Time >= from) {
+        accumulator.Add(point.Time, point.Value);
+      }
+    }
+  }
+  return accumulator.Finish();
+}
+
+HistoryStats CompressedSeries::AggregateLast(size_t count) const {
+  count = std::min(count, mNumSamples);
+
+  // Walk back to the block holding the first of the latest count samples
+  size_t block = mNumBlocks;
+  size_t skip = 0;
+  size_t remaining = count;
+  while (remaining > 0 && block > 0) {
+    const size_t blockCount = GetBlockHeader(--block).Count;
+    if (blockCount >= remaining) {
+      skip = blockCount - remaining;
+      break;
+    }
+    remaining -= blockCount;
+  }
+
+  HistoryAccumulator accumulator;
+  HistoryPoint point;
+  for (; count > 0 && block < mNumBlocks; ++block) {
+    BlockDecoder decoder(*this, block);
+    while (decoder.Next(point)) {
+      if (skip > 0) {
+        --skip;
+        continue;
+      }
+      accumulator.Add(point.Time, point.Value);
+    }
+  }
+  return accumulator.Finish();
+}
+
+size_t CompressedSeries::GetEncodedBytes() const {
+  size_t bits = 0;
+  for (size_t block = 0; block < mNumBlocks; ++block) {
+    bits += GetBlockHeader(block).Bits;
+  }
+  return (bits + 7) / 8;
+}
+
+size_t CompressedSeries::GetMemoryUsage() const {
+  return sizeof(*this) + mCapacity * (BLOCK_BYTES + sizeof(BlockHeader));
+}
+
+void CompressedSeries::StartBlock(const int64_t time, const double value) {
+  if (mNumBlocks == mCapacity) {
+    mNumSamples -= mHeaders[mHead].Count;
+    mHead = ToRing(1);
+    --mNumBlocks;
+    mDropped = true;
+  }
+
+  const size_t position = ToRing(mNumBlocks++);
+  mWriter.Reset(mData.get() + position * BLOCK_BYTES, BLOCK_BYTES);
+
+  // The first sample in full
+  mDelta = 0;
+  mLeading = ~0u;
+  mTrailing = 0;
+  if (mEncoding == SeriesEncoding::Integer) {
+    mInteger = ToInteger(value);
+    WriteVarint(mWriter, ZigZagEncode(mInteger));
+  } else {
+    mBits = ToBits(value);
+    mWriter.Write(mBits, 64);
+  }
+
+  auto &header = mHeaders[position];
+  header.FirstTime = time;
+  header.LastTime = time;
+  header.Count = 1;
+  header.Bits = (uint32_t)mWriter.GetBitCount();
+  ++mNumSamples;
+}
+
+void CompressedSeries::EncodeTime(const int64_t time) {
+  const int64_t last = mHeaders[ToRing(mNumBlocks - 1)].LastTime;
+  const int64_t delta = time - last;
+  const uint64_t deltaOfDelta = ZigZagEncode(delta - mDelta);
+  mDelta = delta;
+
+  if (deltaOfDelta == 0) {
+    mWriter.Write(0b0, 1);
+  } else if (deltaOfDelta < (1u << 7)) {
+    mWriter.Write(0b10, 2);
+    mWriter.Write(deltaOfDelta, 7);
+  } else if (deltaOfDelta < (1u << 9)) {
+    mWriter.Write(0b110, 3);
+    mWriter.Write(deltaOfDelta, 9);
+  } else if (deltaOfDelta < (1u << 12)) {
+    mWriter.Write(0b1110, 4);
+    mWriter.Write(deltaOfDelta, 12);
+  } else {
+    mWriter.Write(0b1111, 4);
+    mWriter.Write(deltaOfDelta, 64);
+  }
+}
+
+void CompressedSeries::EncodeValue(const double value) {
+  if (mEncoding == SeriesEncoding::Integer) {
+    const int64_t integer = ToInteger(value);
+    WriteVarint(mWriter, ZigZagEncode((int64_t)((uint64_t)integer -
+                                                 (uint64_t)mInteger)));
+    mInteger = integer;
+    return;
+  }
+
+  const uint64_t bits = ToBits(value);
+  const uint64_t xored = bits ^ mBits;
+  mBits = bits;
+  if (xored == 0) {
+    mWriter.Write(0b0, 1);
+    return;
+  }
+
+  const unsigned leading = std::min(CountLeadingZeros(xored), 31u);
+  const unsigned trailing = CountTrailingZeros(xored);
+  if (mLeading != ~0u && leading >= mLeading && trailing >= mTrailing) {
+    mWriter.Write(0b10, 2);
+    mWriter.Write(xored >> mTrailing, 64 - mLeading - mTrailing);
+    return;
+  }
+
+  const unsigned length = 64 - leading - trailing;
+  mWriter.Write(0b11, 2);
+  mWriter.Write(leading, 5);
+  mWriter.Write(length - 1, 6);
+  mWriter.Write(xored >> trailing, length);
+  mLeading = leading;
+  mTrailing = trailing;
+}
+
+} // namespace RESANA
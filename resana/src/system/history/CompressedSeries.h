@@ -0,0 +1,139 @@
+#pragma once
+
+#include "AlignedArray.h"
+#include "BitStream.h"
+#include "TimeSeries.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace RESANA {
+
+enum class SeriesEncoding : uint8_t {
+  Plain,   // Uncompressed ring; the fastest to query
+  Float,   // Delta of delta times and XOR compressed doubles
+  Integer, // Delta of delta times and zig-zag varint value deltas; values
+           // are rounded to whole numbers
+};
+
+// A series encoded Gorilla style into fixed size blocks.
+//
+// Times are stored as the delta of their delta, which is zero for a sampler
+// that keeps its interval, in a prefix coded field:
+//   0                          same interval as before
+//   10   + 7 bits              zig-zag delta of delta below 2^7
+//   110  + 9 bits                                     below 2^9
+//   1110 + 12 bits                                    below 2^12
+//   1111 + 64 bits             anything else
+// Float values are XORed with the previous one:
+//   0                          unchanged
+//   10 + meaningful bits       fit in the previous window of meaningful bits
+//   11 + 5 bits leading zeros + 6 bits length - 1 + meaningful bits
+// Integer values are the zig-zag varint of the change, 8 bits per group.
+// The first sample of a block has its time in the block header and its value
+// in full, so every block decodes on its own.
+//
+// Blocks live in one ring allocated up front; the oldest block is dropped
+// when the ring is full, so the series keeps as many samples as its bytes
+// hold and never allocates after construction.
+class CompressedSeries {
+public:
+  static constexpr size_t BLOCK_BYTES = 256;
+
+  struct BlockHeader {
+    int64_t FirstTime{};
+    int64_t LastTime{};
+    uint32_t Count{};
+    uint32_t Bits{};
+  };
+
+  // Streams the samples of one block
+  class BlockDecoder {
+  public:
+    BlockDecoder(const CompressedSeries &series, size_t block);
+
+    // False after the last sample
+    bool Next(HistoryPoint &point);
+
+  private:
+    BitReader mReader;
+    const BlockHeader &mHeader;
+    SeriesEncoding mEncoding;
+    uint32_t mIndex{};
+    int64_t mTime{};
+    int64_t mDelta{};
+    uint64_t mBits{};
+    int64_t mInteger{};
+    unsigned mLeading{};
+    unsigned mTrailing{};
+  };
+
+  CompressedSeries(size_t bytes, SeriesEncoding encoding);
+
+  CompressedSeries(const CompressedSeries &) = delete;
+  CompressedSeries &operator=(const CompressedSeries &) = delete;
+
+  void Append(int64_t time, double value);
+  void Clear();
+
+  [[nodiscard]] SeriesEncoding GetEncoding() const { return mEncoding; }
+  [[nodiscard]] size_t GetSize() const { return mNumSamples; }
+  // True if no sample at or after time was dropped
+  [[nodiscard]] bool Covers(int64_t time) const;
+
+  // Blocks in time order; the last one is still being appended to
+  [[nodiscard]] size_t GetNumBlocks() const { return mNumBlocks; }
+  [[nodiscard]] const BlockHeader &GetBlockHeader(size_t block) const {
+    return mHeaders[ToRing(block)];
+  }
+  // First block with samples at or after time; GetNumBlocks() if none
+  [[nodiscard]] size_t FindBlock(int64_t time) const;
+
+  // Appends the samples with from <= time <= to
+  void Read(int64_t from, int64_t to, std::vector<HistoryPoint> &points) const;
+  [[nodiscard]] HistoryStats Aggregate(int64_t from, int64_t to) const;
+  // Aggregates the latest count samples
+  [[nodiscard]] HistoryStats AggregateLast(size_t count) const;
+
+  // Bytes of encoded samples
+  [[nodiscard]] size_t GetEncodedBytes() const;
+  [[nodiscard]] size_t GetMemoryUsage() const;
+
+private:
+  // Largest encoding of one sample: a 64 bit time and value field, or a
+  // 10 group varint, plus their prefixes
+  static constexpr size_t MAX_SAMPLE_BITS = 160;
+
+  void StartBlock(int64_t time, double value);
+  void EncodeTime(int64_t time);
+  void EncodeValue(double value);
+
+  [[nodiscard]] size_t ToRing(size_t block) const {
+    const size_t position = mHead + block;
+    return position >= mCapacity ? position - mCapacity : position;
+  }
+  [[nodiscard]] const uint8_t *GetBlockData(size_t block) const {
+    return mData.get() + ToRing(block) * BLOCK_BYTES;
+  }
+
+private:
+  SeriesEncoding mEncoding;
+  size_t mCapacity{}; // Blocks
+  AlignedArray<uint8_t> mData;
+  std::vector<BlockHeader> mHeaders{};
+  size_t mHead{};
+  size_t mNumBlocks{};
+  size_t mNumSamples{};
+  bool mDropped = false;
+
+  // Encoder state of the last block
+  BitWriter mWriter{};
+  int64_t mDelta{};
+  uint64_t mBits{};
+  int64_t mInteger{};
+  unsigned mLeading = ~0u; // ~0u until a window of meaningful bits is set
+  unsigned mTrailing{};
+};
+
+} // namespace RESANA
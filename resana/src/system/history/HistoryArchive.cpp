@@ -0,0 +1,256 @@
+#include "HistoryArchive.h"
+#include "rspch.h"
+
+namespace RESANA {
+
+template <typename Visit>
+bool HistoryArchive::VisitSeries(const std::string_view name,
+                                 const int64_t from, const int64_t to,
+                                 Visit &&visit) const {
+  const auto it = mSeriesIds.find(std::string(name));
+  if (it == mSeriesIds.end()) {
+    return false;
+  }
+  const uint32_t series = it->second;
+
+  // Blocks are in time order
+  auto block = std::partition_point(
+      mBlocks.begin(), mBlocks.end(),
+      [from](const Block &candidate) { return candidate.LastTime < from; });
+  for (; block != mBlocks.end() && block->FirstTime <= to; ++block) {
+    if (block->State == BlockState::Damaged ||
+        (block->State == BlockState::Unchecked && !Verify(*block))) {
+      continue;
+    }
+
+    ++mSerial;
+    ParseHistoryBlock(
+        GetBlockData(block->Index), block->Bytes,
+        [](uint32_t, std::string_view) {},
+        [&](const int64_t time, const uint32_t id, const uint64_t xored) {
+          // Only the series asked for needs its values decoded
+          if (id >= mFileSeries.size() || mFileSeries[id] != series) {
+            return;
+          }
+
+          const uint64_t bits =
+              xored ^ (mLastSerial[id] == mSerial ? mLastBits[id] : 0);
+          mLastBits[id] = bits;
+          mLastSerial[id] = mSerial;
+          if (time >= from && time <= to) {
+            visit(time, BitsToDouble(bits));
+          }
+        });
+  }
+  return true;
+}
+
+bool HistoryArchive::Open(const std::string &path) {
+  Close();
+  mPath = path;
+
+  if (!mFile.Open(path, MappedFile::Access::ReadOnly)) {
+    return false;
+  }
+  if (!CheckHistoryFileHeader(mFile.GetData(), mFile.GetSize())) {
+    // An empty file is one the store is about to start
+    if (mFile.GetSize() > 0) {
+      RS_CORE_WARN("{0} is not a history file", path);
+    }
+    mFile.Close();
+    return false;
+  }
+
+  mCreatedTime =
+      reinterpret_cast<const HistoryFileHeader *>(mFile.GetData())->CreatedTime;
+  Scan();
+  return true;
+}
+
+void HistoryArchive::Close() {
+  mFile.Close();
+  mCreatedTime = 0;
+  mBlocks.clear();
+  mNumDamaged = 0;
+  mNames.clear();
+  mSeriesIds.clear();
+  mFileSeries.clear();
+  mLastBits.clear();
+  mLastSerial.clear();
+}
+
+void HistoryArchive::Refresh() {
+  if (mPath.empty()) {
+    return;
+  }
+  if (!IsOpen()) {
+    Open(mPath);
+    return;
+  }
+
+  // A rotated file has been replaced by a new one under the same path
+  MappedFile current;
+  if (!current.Open(mPath, MappedFile::Access::ReadOnly) ||
+      !CheckHistoryFileHeader(current.GetData(), current.GetSize())) {
+    return;
+  }
+  const auto &header =
+      *reinterpret_cast<const HistoryFileHeader *>(current.GetData());
+  if (header.CreatedTime != mCreatedTime) {
+    current.Close();
+    Open(mPath);
+    return;
+  }
+
+  current.Close();
+  mFile.Remap();
+  Scan();
+}
+
+int64_t HistoryArchive::GetFirstTime() const {
+  return mBlocks.empty() ? 0 : mBlocks.front().FirstTime;
+}
+
+int64_t HistoryArchive::GetLastTime() const {
+  return mBlocks.empty() ? 0 : mBlocks.back().LastTime;
+}
+
+bool HistoryArchive::Read(const std::string_view name, const int64_t from,
+                          const int64_t to,
+                          std::vector<HistoryPoint> &points) const {
+  return VisitSeries(name, from, to,
+                     [&points](const int64_t time, const double value) {
+                       points.push_back({time, value});
+                     });
+}
+
+bool HistoryArchive::Query(const std::string_view name, const int64_t from,
+                           const int64_t to, int64_t resolution,
+                           std::vector<HistoryBucket> &buckets) const {
+  resolution = std::max<int64_t>(resolution, 1);
+
+  // Avg holds the sum until the buckets are complete
+  const size_t first = buckets.size();
+  const bool found = VisitSeries(
+      name, from, to,
+      [&buckets, from, resolution](const int64_t time, const double value) {
+        const int64_t start = from + (time - from) / resolution * resolution;
+        if (buckets.empty() || buckets.back().Time != start) {
+          buckets.push_back({start, value, value, 0.0, 0});
+        }
+
+        auto &bucket = buckets.back();
+        bucket.Min = std::min(bucket.Min, value);
+        bucket.Max = std::max(bucket.Max, value);
+        bucket.Avg += value;
+        ++bucket.Count;
+      });
+
+  for (size_t i = first; i < buckets.size(); ++i) {
+    buckets[i].Avg /= (double)buckets[i].Count;
+  }
+  return found;
+}
+
+HistoryStats HistoryArchive::Aggregate(const std::string_view name,
+                                       const int64_t from,
+                                       const int64_t to) const {
+  HistoryAccumulator accumulator;
+  VisitSeries(name, from, to,
+              [&accumulator](const int64_t time, const double value) {
+                accumulator.Add(time, value);
+              });
+  return accumulator.Finish();
+}
+
+void HistoryArchive::Scan() {
+  if (!mBlocks.empty()) {
+    mBlocks.pop_back();
+  }
+
+  const auto *data = mFile.GetData();
+  const size_t numSegments =
+      mFile.GetSize() < HISTORY_PAGE_BYTES
+          ? 0
+          : (mFile.GetSize() - HISTORY_PAGE_BYTES) / HISTORY_SEGMENT_BYTES;
+
+  size_t index = mBlocks.empty() ? 0 : mBlocks.back().Index + 1;
+  for (; index < numSegments * HISTORY_BLOCKS_PER_SEGMENT; ++index) {
+    const auto &segment = *reinterpret_cast<const HistorySegmentHeader *>(
+        data + GetHistorySegmentOffset(index / HISTORY_BLOCKS_PER_SEGMENT));
+    const auto &entry = segment.Index[index % HISTORY_BLOCKS_PER_SEGMENT];
+
+    // A sealed block is found through the index alone; its pages are read
+    // once a query needs them
+    Block block{index};
+    uint32_t definitions;
+    if (segment.Magic == HISTORY_SEGMENT_MAGIC && entry.FirstTime != 0) {
+      block.FirstTime = entry.FirstTime;
+      block.LastTime = entry.LastTime;
+      block.Bytes = entry.Bytes;
+      definitions = entry.Definitions;
+    } else {
+      // The block being written, or where the writer stopped
+      const uint8_t *blockData = GetBlockData(index);
+      if (!CheckHistoryBlock(blockData, block.Bytes)) {
+        break;
+      }
+      const auto &header =
+          *reinterpret_cast<const HistoryBlockHeader *>(blockData);
+      block.FirstTime = header.FirstTime;
+      block.LastTime = header.LastTime;
+      block.State = BlockState::Intact;
+      definitions = header.Definitions;
+    }
+
+    if (definitions > 0) {
+      if (block.State == BlockState::Unchecked) {
+        Verify(block);
+      }
+      if (block.State == BlockState::Intact) {
+        ReadDefinitions(block);
+      }
+    }
+    mBlocks.push_back(block);
+  }
+}
+
+void HistoryArchive::ReadDefinitions(const Block &block) {
+  ParseHistoryBlock(
+      GetBlockData(block.Index), block.Bytes,
+      [this](const uint32_t id, const std::string_view name) {
+        auto [it, added] =
+            mSeriesIds.emplace(std::string(name), (uint32_t)mNames.size());
+        if (added) {
+          mNames.emplace_back(name);
+        }
+        if (id >= mFileSeries.size()) {
+          mFileSeries.resize(id + 1, INVALID_SERIES);
+          mLastBits.resize(id + 1);
+          mLastSerial.resize(id + 1);
+        }
+        mFileSeries[id] = it->second;
+      },
+      [](int64_t, uint32_t, uint64_t) {});
+}
+
+bool HistoryArchive::Verify(Block &block) const {
+  const uint8_t *data = GetBlockData(block.Index);
+  uint32_t bytes;
+  if (!CheckHistoryBlock(data, bytes)) {
+    if (block.State != BlockState::Damaged) {
+      ++mNumDamaged;
+    }
+    block.State = BlockState::Damaged;
+    return false;
+  }
+
+  // Take the header's figures, as a block sealed early may have grown
+  const auto &header = *reinterpret_cast<const HistoryBlockHeader *>(data);
+  block.Bytes = bytes;
+  block.LastTime = std::max(block.LastTime, header.LastTime);
+  block.State = BlockState::Intact;
+  return true;
+}
+
+} // namespace RESANA
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "HistoryFormat.h"
+#include "MappedFile.h"
+#include "RollupTier.h"
+#include "TimeSeries.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace RESANA {
+
+// Reads a history file a HistoryStore wrote, or is still writing, through a
+// read-only mapping: samples are decoded straight from the file's pages and
+// nothing is loaded up front. Opening reads the index pages and the blocks
+// that define series; a block's checksum is verified the first time a query
+// reads it, and a damaged block is skipped. Times are Unix milliseconds.
+//
+// Not thread safe.
+class HistoryArchive {
+public:
+  HistoryArchive() = default;
+
+  HistoryArchive(const HistoryArchive &) = delete;
+  HistoryArchive &operator=(const HistoryArchive &) = delete;
+
+  bool Open(const std::string &path);
+  void Close();
+  // Picks up the blocks appended since, and starts over if the store rotated
+  // the file
+  void Refresh();
+
+  [[nodiscard]] bool IsOpen() const { return mFile.GetData() != nullptr; }
+  [[nodiscard]] const std::string &GetPath() const { return mPath; }
+  // Of the first and last sample; 0 if there are none
+  [[nodiscard]] int64_t GetFirstTime() const;
+  [[nodiscard]] int64_t GetLastTime() const;
+  [[nodiscard]] size_t GetNumBlocks() const { return mBlocks.size(); }
+  [[nodiscard]] size_t GetNumDamagedBlocks() const { return mNumDamaged; }
+  [[nodiscard]] const std::vector<std::string> &GetSeriesNames() const {
+    return mNames;
+  }
+
+  // Appends the samples of the named series with from <= time <= to. False
+  // if the file has no such series.
+  bool Read(std::string_view name, int64_t from, int64_t to,
+            std::vector<HistoryPoint> &points) const;
+  // Appends buckets of resolution milliseconds over [from, to]
+  bool Query(std::string_view name, int64_t from, int64_t to,
+             int64_t resolution, std::vector<HistoryBucket> &buckets) const;
+  [[nodiscard]] HistoryStats Aggregate(std::string_view name, int64_t from,
+                                       int64_t to) const;
+
+private:
+  static constexpr uint32_t INVALID_SERIES = ~0u;
+
+  enum class BlockState : uint8_t { Unchecked, Intact, Damaged };
+
+  struct Block {
+    size_t Index{};
+    int64_t FirstTime{};
+    int64_t LastTime{};
+    uint32_t Bytes{};
+    BlockState State = BlockState::Unchecked;
+  };
+
+  // Adds the blocks after the last one found, which is looked at again as it
+  // may have grown
+  void Scan();
+  void ReadDefinitions(const Block &block);
+  bool Verify(Block &block) const;
+
+  // Calls visit(time, value) for the samples of the named series in [from, to]
+  template <typename Visit>
+  bool VisitSeries(std::string_view name, int64_t from, int64_t to,
+                   Visit &&visit) const;
+
+  [[nodiscard]] const uint8_t *GetBlockData(size_t index) const {
+    return mFile.GetData() + GetHistoryBlockOffset(index);
+  }
+
+private:
+  std::string mPath{};
+  MappedFile mFile{};
+  int64_t mCreatedTime{};
+
+  mutable std::vector<Block> mBlocks{};
+  mutable size_t mNumDamaged{};
+
+  std::vector<std::string> mNames{};
+  std::unordered_map<std::string, uint32_t> mSeriesIds{}; // By name
+  std::vector<uint32_t> mFileSeries{}; // Series of each file id
+
+  // Decoder state: the previous value of each file id in the block read
+  mutable std::vector<uint64_t> mLastBits{};
+  mutable std::vector<uint64_t> mLastSerial{};
+  mutable uint64_t mSerial{};
+};
+
+} // namespace RESANA
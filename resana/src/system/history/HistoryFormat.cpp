@@ -0,0 +1,93 @@
+#include "HistoryFormat.h"
+#include "rspch.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+
+namespace RESANA {
+
+namespace {
+
+// Castagnoli polynomial, reflected
+constexpr uint32_t CRC32C_POLYNOMIAL = 0x82f63b78;
+
+struct Crc32cTable {
+  uint32_t Entries[8][256]{};
+
+  constexpr Crc32cTable() {
+    for (uint32_t i = 0; i < 256; ++i) {
+      uint32_t crc = i;
+      for (int bit = 0; bit < 8; ++bit) {
+        crc = crc & 1 ? (crc >> 1) ^ CRC32C_POLYNOMIAL : crc >> 1;
+      }
+      Entries[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; ++i) {
+      for (int slice = 1; slice < 8; ++slice) {
+        const uint32_t previous = Entries[slice - 1][i];
+        Entries[slice][i] = (previous >> 8) ^ Entries[0][previous & 0xff];
+      }
+    }
+  }
+};
+
+constexpr Crc32cTable CRC32C_TABLE{};
+
+} // namespace
+
+uint32_t Crc32c(uint32_t crc, const uint8_t *data, size_t size) {
+  const auto &table = CRC32C_TABLE.Entries;
+  crc = ~crc;
+
+  // Eight bytes per step
+  while (size >= 8) {
+    const uint32_t low = crc ^ ((uint32_t)data[0] | (uint32_t)data[1] << 8 |
+                                (uint32_t)data[2] << 16 |
+                                (uint32_t)data[3] << 24);
+    crc = table[7][low & 0xff] ^ table[6][(low >> 8) & 0xff] ^
+          table[5][(low >> 16) & 0xff] ^ table[4][low >> 24] ^
+          table[3][data[4]] ^ table[2][data[5]] ^ table[1][data[6]] ^
+          table[0][data[7]];
+    data += 8;
+    size -= 8;
+  }
+  while (size-- > 0) {
+    crc = (crc >> 8) ^ table[0][(crc ^ *data++) & 0xff];
+  }
+  return ~crc;
+}
+
+bool CheckHistoryBlock(const uint8_t *data, uint32_t &bytes) {
+  const auto &header = *reinterpret_cast<const HistoryBlockHeader *>(data);
+  const uint32_t magic = header.Magic;
+  bytes = header.Bytes;
+  const uint32_t checksum = header.Checksum;
+
+  // Pairs with the writer's fence between the records and the header
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return magic == HISTORY_BLOCK_MAGIC && bytes <= HISTORY_BLOCK_PAYLOAD &&
+         Crc32c(0, data + sizeof(HistoryBlockHeader), bytes) == checksum;
+}
+
+uint32_t GetHistoryHeaderChecksum(const HistoryFileHeader &header) {
+  return Crc32c(0, reinterpret_cast<const uint8_t *>(&header),
+                offsetof(HistoryFileHeader, Checksum));
+}
+
+bool CheckHistoryFileHeader(const uint8_t *data, const size_t size) {
+  if (size < HISTORY_PAGE_BYTES) {
+    return false;
+  }
+
+  const auto &header = *reinterpret_cast<const HistoryFileHeader *>(data);
+  return std::memcmp(header.Magic, HISTORY_FILE_MAGIC,
+                     sizeof(header.Magic)) == 0 &&
+         header.Checksum == GetHistoryHeaderChecksum(header) &&
+         header.Version == HISTORY_FILE_VERSION &&
+         header.PageBytes == HISTORY_PAGE_BYTES &&
+         header.BlockBytes == HISTORY_BLOCK_BYTES &&
+         header.BlocksPerSegment == HISTORY_BLOCKS_PER_SEGMENT;
+}
+
+} // namespace RESANA
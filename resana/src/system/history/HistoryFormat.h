@@ -0,0 +1,256 @@
+#pragma once
+
+#include "BitStream.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace RESANA {
+
+// Layout of a history file, shared by HistoryStore, which appends to it, and
+// HistoryArchive, which reads it:
+//
+//   file header page
+//   segment 0:  index page, HISTORY_BLOCKS_PER_SEGMENT blocks
+//   segment 1:  ...
+//
+// A block is a header followed by records:
+//   Define  id varint, name length varint, name bytes
+//   Tick    zig-zag varint of the time less the block's first time, uint16
+//           sample count, then per sample the series id varint and the value
+//           XORed with the previous value of that series in the block
+//           (EncodeXor)
+// The header carries the CRC-32C of the records committed so far and is
+// updated after them, so a block torn by a crash fails its check and is the
+// only data lost. A sealed block, one that will not grow anymore, is also
+// listed in the index page of its segment, which lets a reader find blocks by
+// time without touching their pages.
+//
+// Times are Unix milliseconds; integers are little endian.
+
+constexpr uint32_t HISTORY_FILE_VERSION = 1;
+constexpr char HISTORY_FILE_MAGIC[8] = {'R', 'S', 'H', 'I', 'S', 'T', 0, 0};
+constexpr uint32_t HISTORY_SEGMENT_MAGIC = 0x47455352; // "RSEG"
+constexpr uint32_t HISTORY_BLOCK_MAGIC = 0x4b4c4252;   // "RBLK"
+
+constexpr size_t HISTORY_PAGE_BYTES = 4096;
+constexpr size_t HISTORY_BLOCK_BYTES = 64 * 1024;
+constexpr uint32_t HISTORY_BLOCKS_PER_SEGMENT = 16;
+constexpr size_t HISTORY_SEGMENT_BYTES =
+    HISTORY_PAGE_BYTES + HISTORY_BLOCKS_PER_SEGMENT * HISTORY_BLOCK_BYTES;
+
+enum class HistoryRecord : uint8_t { Define = 1, Tick = 2 };
+
+struct HistoryFileHeader {
+  char Magic[8];
+  uint32_t Version;
+  uint32_t PageBytes;
+  uint32_t BlockBytes;
+  uint32_t BlocksPerSegment;
+  int64_t CreatedTime;
+  uint32_t Checksum; // Of the fields above
+  uint32_t Reserved;
+};
+
+// All zero until the block is sealed
+struct HistoryIndexEntry {
+  int64_t FirstTime;
+  int64_t LastTime;
+  uint32_t Bytes;
+  uint32_t Checksum;
+  uint32_t Definitions;
+  uint32_t Reserved;
+};
+
+struct HistorySegmentHeader {
+  uint32_t Magic;
+  uint32_t Segment; // Number in the file
+  uint64_t Reserved;
+  HistoryIndexEntry Index[HISTORY_BLOCKS_PER_SEGMENT];
+};
+
+struct HistoryBlockHeader {
+  uint32_t Magic;
+  uint32_t Checksum; // CRC-32C of the first Bytes bytes of records
+  uint32_t Bytes;
+  uint32_t Samples;
+  int64_t FirstTime;
+  int64_t LastTime;
+  uint32_t Definitions; // Define records, so readers skip blocks without
+  uint32_t Reserved;
+};
+
+static_assert(sizeof(HistoryFileHeader) <= HISTORY_PAGE_BYTES);
+static_assert(sizeof(HistorySegmentHeader) <= HISTORY_PAGE_BYTES);
+
+constexpr size_t HISTORY_BLOCK_PAYLOAD =
+    HISTORY_BLOCK_BYTES - sizeof(HistoryBlockHeader);
+// A Tick record without samples, and one sample at most
+constexpr size_t HISTORY_TICK_BYTES = 1 + 10 + 2;
+constexpr size_t HISTORY_SAMPLE_BYTES = 5 + 1 + 8;
+
+[[nodiscard]] inline size_t GetHistoryBlockOffset(const size_t block) {
+  const size_t segment = block / HISTORY_BLOCKS_PER_SEGMENT;
+  const size_t index = block % HISTORY_BLOCKS_PER_SEGMENT;
+  return HISTORY_PAGE_BYTES + segment * HISTORY_SEGMENT_BYTES +
+         HISTORY_PAGE_BYTES + index * HISTORY_BLOCK_BYTES;
+}
+
+[[nodiscard]] inline size_t GetHistorySegmentOffset(const size_t segment) {
+  return HISTORY_PAGE_BYTES + segment * HISTORY_SEGMENT_BYTES;
+}
+
+// Continues crc over data; start with 0
+uint32_t Crc32c(uint32_t crc, const uint8_t *data, size_t size);
+
+[[nodiscard]] uint32_t
+GetHistoryHeaderChecksum(const HistoryFileHeader &header);
+// True if the size bytes at data start with a header this version reads
+[[nodiscard]] bool CheckHistoryFileHeader(const uint8_t *data, size_t size);
+
+// True if the block at data has a header and records that pass its checksum.
+// bytes is set to the length of the records checked, which a block that is
+// still being appended to may have outgrown by the time it is parsed.
+[[nodiscard]] bool CheckHistoryBlock(const uint8_t *data, uint32_t &bytes);
+
+// Writes value at data and returns its length, at most 10 bytes
+inline size_t PutVarint(uint8_t *data, uint64_t value) {
+  size_t length = 0;
+  while (value >= 0x80) {
+    data[length++] = (uint8_t)(value | 0x80);
+    value >>= 7;
+  }
+  data[length++] = (uint8_t)value;
+  return length;
+}
+
+// Reads a varint at data; 0 if it runs past end
+inline size_t GetVarint(const uint8_t *data, const uint8_t *end,
+                        uint64_t &value) {
+  value = 0;
+  for (size_t length = 0; length < 10 && data + length < end; ++length) {
+    value |= (uint64_t)(data[length] & 0x7f) << (7 * length);
+    if (!(data[length] & 0x80)) {
+      return length + 1;
+    }
+  }
+  return 0;
+}
+
+// Writes the bits of a value XORed with the previous one as a byte holding
+// the number of zero bytes below them and the number of bytes left, then
+// those bytes; an unchanged value takes the one byte. Returns the length.
+inline size_t EncodeXor(uint8_t *data, uint64_t xored) {
+  if (xored == 0) {
+    data[0] = 0;
+    return 1;
+  }
+
+  unsigned trailing = 0;
+  while (!(xored & 0xff)) {
+    xored >>= 8;
+    ++trailing;
+  }
+  unsigned length = 0;
+  while (xored) {
+    data[1 + length++] = (uint8_t)xored;
+    xored >>= 8;
+  }
+  data[0] = (uint8_t)(trailing << 4 | length);
+  return 1 + length;
+}
+
+// Reads what EncodeXor wrote; 0 if it runs past end or is malformed
+inline size_t DecodeXor(const uint8_t *data, const uint8_t *end,
+                        uint64_t &xored) {
+  if (data >= end) {
+    return 0;
+  }
+
+  const unsigned trailing = data[0] >> 4;
+  const unsigned length = data[0] & 0xf;
+  if (trailing + length > 8 || (size_t)(end - data) < 1 + length) {
+    return 0;
+  }
+
+  xored = 0;
+  for (unsigned i = 0; i < length; ++i) {
+    xored |= (uint64_t)data[1 + i] << (8 * (trailing + i));
+  }
+  return 1 + length;
+}
+
+// Calls onDefine(id, name) and onSample(time, id, xored) for the first bytes
+// of records of an intact block, in order; the value of a sample is xored with the
+// previous value of its series in the block, or with 0 for the first. False
+// if a record is malformed.
+template <typename OnDefine, typename OnSample>
+bool ParseHistoryBlock(const uint8_t *data, const uint32_t bytes,
+                       OnDefine &&onDefine, OnSample &&onSample) {
+  const auto &header = *reinterpret_cast<const HistoryBlockHeader *>(data);
+  const uint8_t *position = data + sizeof(HistoryBlockHeader);
+  const uint8_t *end = position + bytes;
+
+  uint64_t id;
+  while (position < end) {
+    const auto record = (HistoryRecord)*position++;
+    if (record == HistoryRecord::Define) {
+      uint64_t length;
+      size_t read = GetVarint(position, end, id);
+      if (!read) {
+        return false;
+      }
+      position += read;
+      if (!(read = GetVarint(position, end, length)) ||
+          length > (uint64_t)(end - position - read)) {
+        return false;
+      }
+      position += read;
+      onDefine((uint32_t)id, std::string_view((const char *)position, length));
+      position += length;
+    } else if (record == HistoryRecord::Tick) {
+      uint64_t delta;
+      const size_t read = GetVarint(position, end, delta);
+      if (!read || end - position - read < 2) {
+        return false;
+      }
+      position += read;
+      const int64_t time = header.FirstTime + ZigZagDecode(delta);
+      const uint32_t samples = position[0] | (uint32_t)position[1] << 8;
+      position += 2;
+
+      uint64_t xored;
+      for (uint32_t sample = 0; sample < samples; ++sample) {
+        size_t length = GetVarint(position, end, id);
+        if (!length) {
+          return false;
+        }
+        position += length;
+        if (!(length = DecodeXor(position, end, xored))) {
+          return false;
+        }
+        position += length;
+        onSample(time, (uint32_t)id, xored);
+      }
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+inline uint64_t DoubleToBits(const double value) {
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+inline double BitsToDouble(const uint64_t bits) {
+  double value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+} // namespace RESANA
@@ -0,0 +1,398 @@
+#include "HistoryStore.h"
+#include "rspch.h"
+
+#include "BitStream.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+
+namespace RESANA {
+
+namespace {
+
+// Longer names are cut; series names are a few dozen bytes
+constexpr size_t MAX_NAME_BYTES = 255;
+
+constexpr const char *HISTORY_FILE_NAME = "resana.history";
+
+// Keeps the previous file, replacing the one kept before
+bool MoveAside(const std::string &path) {
+  const auto previous = path + ".1";
+  std::remove(previous.c_str());
+  return std::rename(path.c_str(), previous.c_str()) == 0;
+}
+
+} // namespace
+
+HistoryStore::HistoryStore(std::string path, const uint32_t maxSegments)
+    : mPath(std::move(path)), mMaxSegments(std::max<uint32_t>(maxSegments, 1)) {
+  const auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::system_clock::now().time_since_epoch());
+  mWallBase = (int64_t)now.count() - (int64_t)Time::GetTime();
+
+  std::error_code error;
+  const auto absolutePath = std::filesystem::absolute(mPath, error).string();
+  if (Open()) {
+    RS_CORE_INFO("Recording history to {0}, continuing after {1} blocks",
+                 absolutePath, GetNumBlocks());
+  } else {
+    RS_CORE_ERROR("Could not record history to {0}", absolutePath);
+  }
+}
+
+std::string HistoryStore::GetDefaultPath() {
+  std::filesystem::path directory;
+#ifdef RS_PLATFORM_WINDOWS
+  if (const char *localAppData = std::getenv("LOCALAPPDATA");
+      localAppData && *localAppData) {
+    directory = std::filesystem::path(localAppData) / "Resana";
+  }
+#else
+  // Relative paths in XDG_DATA_HOME are to be ignored
+  if (const char *dataHome = std::getenv("XDG_DATA_HOME");
+      dataHome && *dataHome == '/') {
+    directory = std::filesystem::path(dataHome) / "resana";
+  } else if (const char *home = std::getenv("HOME"); home && *home == '/') {
+    directory = std::filesystem::path(home) / ".local" / "share" / "resana";
+  }
+#endif
+  if (directory.empty()) {
+    RS_CORE_WARN("No per-user data directory, history is not recorded");
+    return {};
+  }
+
+  std::error_code error;
+  std::filesystem::create_directories(directory, error);
+  if (error) {
+    RS_CORE_ERROR("Could not create {0}: {1}", directory.string(),
+                  error.message());
+    return {};
+  }
+  return (directory / HISTORY_FILE_NAME).string();
+}
+
+HistoryStore::~HistoryStore() { Flush(); }
+
+void HistoryStore::Bind(const uint32_t id, const std::string_view name) {
+  if (id >= mBindings.size()) {
+    mBindings.resize(id + 1);
+  }
+
+  auto &binding = mBindings[id];
+  binding.Name.assign(name.substr(0, MAX_NAME_BYTES));
+  binding.FileId = INVALID_ID;
+  binding.Bound = true;
+  if (IsOpen()) {
+    // Not the current time: the tick that registered the series may have
+    // been taken before it, and blocks must stay in time order
+    Define(binding, mLastTime != 0 ? mLastTime : GetWallTime());
+  }
+}
+
+void HistoryStore::Unbind(const uint32_t id) {
+  if (id < mBindings.size()) {
+    mBindings[id] = {};
+  }
+}
+
+void HistoryStore::Append(const uint32_t *ids, const double *values,
+                          const size_t count, const int64_t time) {
+  if (!IsOpen()) {
+    return;
+  }
+
+  // Ticks that overflow the block continue in the next one
+  const int64_t wallTime = time + mWallBase;
+  mLastTime = wallTime;
+  size_t i = 0;
+  while (i < count) {
+    if (!Reserve(HISTORY_TICK_BYTES + HISTORY_SAMPLE_BYTES, wallTime)) {
+      return;
+    }
+
+    uint8_t *payload = GetPayload();
+    size_t end = mBytes;
+    payload[end++] = (uint8_t)HistoryRecord::Tick;
+    end += PutVarint(payload + end,
+                     ZigZagEncode(wallTime - GetHeader().FirstTime));
+    const size_t countAt = end;
+    end += 2;
+
+    uint32_t samples = 0;
+    for (; i < count && samples < UINT16_MAX; ++i) {
+      const uint32_t id = ids[i];
+      if (id >= mBindings.size() || mBindings[id].FileId == INVALID_ID) {
+        continue;
+      }
+      if (end + HISTORY_SAMPLE_BYTES > HISTORY_BLOCK_PAYLOAD) {
+        break;
+      }
+
+      const uint32_t fileId = mBindings[id].FileId;
+      const uint64_t bits = DoubleToBits(values[i]);
+      const uint64_t previous =
+          mLastSerial[fileId] == mSerial ? mLastBits[fileId] : 0;
+      mLastBits[fileId] = bits;
+      mLastSerial[fileId] = mSerial;
+
+      end += PutVarint(payload + end, fileId);
+      end += EncodeXor(payload + end, bits ^ previous);
+      ++samples;
+    }
+
+    if (samples > 0) {
+      payload[countAt] = (uint8_t)samples;
+      payload[countAt + 1] = (uint8_t)(samples >> 8);
+      Commit(end, samples, wallTime);
+    }
+  }
+}
+
+void HistoryStore::Flush() {
+  if (!IsOpen()) {
+    return;
+  }
+  if (mHasBlock) {
+    SealBlock();
+  }
+  mFile.FlushAsync();
+}
+
+bool HistoryStore::Open() {
+  if (!mFile.Open(mPath, MappedFile::Access::ReadWrite)) {
+    return false;
+  }
+  if (mFile.GetSize() == 0) {
+    return Create();
+  }
+  if (Recover()) {
+    return true;
+  }
+
+  // Not a file this version wrote: keep it rather than append to it
+  RS_CORE_WARN("{0} is not a history file, moving it aside", mPath);
+  mFile.Close();
+  return MoveAside(mPath) &&
+         mFile.Open(mPath, MappedFile::Access::ReadWrite) && Create();
+}
+
+bool HistoryStore::Create() {
+  mNumSegments = 0;
+  mHasBlock = false;
+  mBlock = 0;
+  mBytes = 0;
+  mNextFileId = 0;
+
+  if (!mFile.Resize(HISTORY_PAGE_BYTES)) {
+    return false;
+  }
+
+  auto &header = *reinterpret_cast<HistoryFileHeader *>(mFile.GetData());
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.Magic, HISTORY_FILE_MAGIC, sizeof(header.Magic));
+  header.Version = HISTORY_FILE_VERSION;
+  header.PageBytes = (uint32_t)HISTORY_PAGE_BYTES;
+  header.BlockBytes = (uint32_t)HISTORY_BLOCK_BYTES;
+  header.BlocksPerSegment = HISTORY_BLOCKS_PER_SEGMENT;
+  header.CreatedTime = GetWallTime();
+  header.Checksum = GetHistoryHeaderChecksum(header);
+  return AddSegment();
+}
+
+bool HistoryStore::Recover() {
+  if (!CheckHistoryFileHeader(mFile.GetData(), mFile.GetSize())) {
+    return false;
+  }
+
+  // Blocks are appended in order, so the first one that fails its check is
+  // where the earlier run stopped
+  mNumSegments = (mFile.GetSize() - HISTORY_PAGE_BYTES) / HISTORY_SEGMENT_BYTES;
+  size_t numBlocks = 0;
+  for (; numBlocks < mNumSegments * HISTORY_BLOCKS_PER_SEGMENT; ++numBlocks) {
+    const uint8_t *block = mFile.GetData() + GetHistoryBlockOffset(numBlocks);
+    uint32_t bytes;
+    if (!CheckHistoryBlock(block, bytes)) {
+      break;
+    }
+
+    if (reinterpret_cast<const HistoryBlockHeader *>(block)->Definitions) {
+      ParseHistoryBlock(
+          block, bytes,
+          [this](const uint32_t id, std::string_view) {
+            mNextFileId = std::max(mNextFileId, id + 1);
+          },
+          [](int64_t, uint32_t, uint64_t) {});
+    }
+  }
+
+  // A segment cut short by a crash while the file grew is dropped
+  if (mFile.GetSize() != GetHistorySegmentOffset(mNumSegments) &&
+      !mFile.Resize(GetHistorySegmentOffset(mNumSegments))) {
+    return false;
+  }
+  if (mNumSegments == 0 && !AddSegment()) {
+    return false;
+  }
+
+  // The next append starts a new block after the last intact one
+  mHasBlock = numBlocks > 0;
+  mBlock = mHasBlock ? numBlocks - 1 : 0;
+  mBytes = HISTORY_BLOCK_PAYLOAD;
+  mLastBits.resize(mNextFileId);
+  mLastSerial.resize(mNextFileId);
+  return true;
+}
+
+bool HistoryStore::Rotate(const int64_t time) {
+  RS_CORE_INFO("{0} is full, keeping it as {0}.1", mPath);
+
+  mFile.FlushAsync();
+  mFile.Close();
+  if (!MoveAside(mPath) || !mFile.Open(mPath, MappedFile::Access::ReadWrite) ||
+      !Create()) {
+    RS_CORE_ERROR("Could not start a new history file at {0}", mPath);
+    mFile.Close();
+    return false;
+  }
+
+  // Series ids are per file
+  for (auto &binding : mBindings) {
+    binding.FileId = INVALID_ID;
+  }
+  for (auto &binding : mBindings) {
+    if (binding.Bound) {
+      Define(binding, time);
+    }
+  }
+  return IsOpen();
+}
+
+bool HistoryStore::AddSegment() {
+  const size_t segment = mNumSegments;
+  if (!mFile.Resize(GetHistorySegmentOffset(segment + 1))) {
+    return false;
+  }
+
+  auto &header = *reinterpret_cast<HistorySegmentHeader *>(
+      mFile.GetData() + GetHistorySegmentOffset(segment));
+  header.Segment = (uint32_t)segment;
+  header.Magic = HISTORY_SEGMENT_MAGIC;
+  ++mNumSegments;
+
+  // The previous segment is complete; have it written back in the background
+  mFile.FlushAsync();
+  return true;
+}
+
+bool HistoryStore::Reserve(const size_t bytes, const int64_t time) {
+  while (!mHasBlock || mBytes + bytes > HISTORY_BLOCK_PAYLOAD) {
+    if (mHasBlock) {
+      SealBlock();
+    }
+
+    const size_t block = mHasBlock ? mBlock + 1 : 0;
+    if (block >= mNumSegments * HISTORY_BLOCKS_PER_SEGMENT) {
+      if (mNumSegments >= mMaxSegments) {
+        if (!Rotate(time)) {
+          return false;
+        }
+        continue;
+      }
+      if (!AddSegment()) {
+        return false;
+      }
+    }
+    StartBlock(block, time);
+  }
+  return true;
+}
+
+void HistoryStore::StartBlock(const size_t block, const int64_t time) {
+  mBlock = block;
+  mHasBlock = true;
+  mBytes = 0;
+  mCrc = 0;
+  ++mSerial;
+
+  // A segment added by a run that crashed right after may lack its header
+  auto &segment = *reinterpret_cast<HistorySegmentHeader *>(
+      mFile.GetData() +
+      GetHistorySegmentOffset(block / HISTORY_BLOCKS_PER_SEGMENT));
+  segment.Segment = (uint32_t)(block / HISTORY_BLOCKS_PER_SEGMENT);
+  segment.Magic = HISTORY_SEGMENT_MAGIC;
+
+  // Whatever a crashed run left here stops being a block before the header
+  // is rewritten
+  auto &header = GetHeader();
+  header.Magic = 0;
+  std::atomic_thread_fence(std::memory_order_release);
+  header.Checksum = 0;
+  header.Bytes = 0;
+  header.Samples = 0;
+  header.FirstTime = time;
+  header.LastTime = time;
+  header.Definitions = 0;
+  header.Reserved = 0;
+  std::atomic_thread_fence(std::memory_order_release);
+  header.Magic = HISTORY_BLOCK_MAGIC;
+}
+
+void HistoryStore::SealBlock() {
+  const auto &header = GetHeader();
+  auto &segment = *reinterpret_cast<HistorySegmentHeader *>(
+      mFile.GetData() +
+      GetHistorySegmentOffset(mBlock / HISTORY_BLOCKS_PER_SEGMENT));
+  auto &entry = segment.Index[mBlock % HISTORY_BLOCKS_PER_SEGMENT];
+  entry.FirstTime = header.FirstTime;
+  entry.LastTime = header.LastTime;
+  entry.Bytes = header.Bytes;
+  entry.Checksum = header.Checksum;
+  entry.Definitions = header.Definitions;
+}
+
+void HistoryStore::Commit(const size_t end, const uint32_t samples,
+                          const int64_t time) {
+  mCrc = Crc32c(mCrc, GetPayload() + mBytes, end - mBytes);
+  mBytes = end;
+
+  // The records reach memory before the header that covers them
+  std::atomic_thread_fence(std::memory_order_release);
+  auto &header = GetHeader();
+  header.Bytes = (uint32_t)mBytes;
+  header.Checksum = mCrc;
+  header.Samples += samples;
+  header.LastTime = std::max(header.LastTime, time);
+}
+
+void HistoryStore::Define(Binding &binding, const int64_t time) {
+  if (!Reserve(1 + 5 + 2 + binding.Name.size(), time)) {
+    return;
+  }
+
+  binding.FileId = mNextFileId++;
+  if (mLastBits.size() < mNextFileId) {
+    mLastBits.resize(mNextFileId);
+    mLastSerial.resize(mNextFileId);
+  }
+
+  uint8_t *payload = GetPayload();
+  size_t end = mBytes;
+  payload[end++] = (uint8_t)HistoryRecord::Define;
+  end += PutVarint(payload + end, binding.FileId);
+  end += PutVarint(payload + end, binding.Name.size());
+  std::memcpy(payload + end, binding.Name.data(), binding.Name.size());
+  end += binding.Name.size();
+
+  ++GetHeader().Definitions;
+  Commit(end, 0, time);
+}
+
+int64_t HistoryStore::GetWallTime() const {
+  return (int64_t)Time::GetTime() + mWallBase;
+}
+
+} // namespace RESANA
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "HistoryFormat.h"
+#include "MappedFile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace RESANA {
+
+// Appends the samples of a MetricHistory to a history file (HistoryFormat.h)
+// so they outlive the process. Samples are encoded straight into a writable
+// mapping of the file and committed by updating the block header, which
+// costs no system call: the kernel writes the pages back on its own and a
+// process killed at any point loses at most the block it was committing.
+// The file only grows, a segment at a time; once it holds maxSegments it is
+// renamed to <path>.1, replacing the previous one, and a new file is started.
+//
+// Not thread safe; MetricHistory calls it under its lock.
+class HistoryStore {
+public:
+  // Opens the file and continues after the last intact block an earlier run
+  // left in it, or creates it
+  HistoryStore(std::string path, uint32_t maxSegments);
+  ~HistoryStore();
+
+  HistoryStore(const HistoryStore &) = delete;
+  HistoryStore &operator=(const HistoryStore &) = delete;
+
+  // The history file in the per-user data directory: $XDG_DATA_HOME/resana,
+  // else ~/.local/share/resana, or %LOCALAPPDATA%\Resana on Windows. The
+  // directory is created; empty if there is none to use.
+  [[nodiscard]] static std::string GetDefaultPath();
+
+  [[nodiscard]] bool IsOpen() const { return mFile.GetData() != nullptr; }
+  [[nodiscard]] const std::string &GetPath() const { return mPath; }
+
+  // Names the series a MetricHistory id refers to until it is unbound
+  void Bind(uint32_t id, std::string_view name);
+  void Unbind(uint32_t id);
+
+  // Appends one sample per bound series, all taken at the same steady time
+  // (Time::GetTime)
+  void Append(const uint32_t *ids, const double *values, size_t count,
+              int64_t time);
+
+  // Seals the open block and starts writing the file back
+  void Flush();
+
+  // Blocks in the current file
+  [[nodiscard]] size_t GetNumBlocks() const { return mHasBlock ? mBlock + 1 : 0; }
+  [[nodiscard]] size_t GetFileSize() const { return mFile.GetSize(); }
+
+private:
+  static constexpr uint32_t INVALID_ID = ~0u;
+
+  struct Binding {
+    std::string Name{};
+    uint32_t FileId = INVALID_ID;
+    bool Bound = false;
+  };
+
+  bool Open();
+  bool Create();
+  // Finds the last intact block; false if the file is not a history file
+  bool Recover();
+  bool Rotate(int64_t time);
+  bool AddSegment();
+
+  // Makes room for bytes more in the open block, starting a new block when
+  // it is full. False if the file can not grow.
+  bool Reserve(size_t bytes, int64_t time);
+  void StartBlock(size_t block, int64_t time);
+  void SealBlock();
+  // Publishes the records written up to end
+  void Commit(size_t end, uint32_t samples, int64_t time);
+  void Define(Binding &binding, int64_t time);
+
+  [[nodiscard]] int64_t GetWallTime() const;
+  [[nodiscard]] HistoryBlockHeader &GetHeader() {
+    return *reinterpret_cast<HistoryBlockHeader *>(
+        mFile.GetData() + GetHistoryBlockOffset(mBlock));
+  }
+  [[nodiscard]] uint8_t *GetPayload() {
+    return mFile.GetData() + GetHistoryBlockOffset(mBlock) +
+           sizeof(HistoryBlockHeader);
+  }
+
+private:
+  std::string mPath;
+  uint32_t mMaxSegments;
+  MappedFile mFile{};
+  int64_t mWallBase{}; // Unix time of steady time 0
+  int64_t mLastTime{}; // Of the latest tick appended
+
+  std::vector<Binding> mBindings{}; // By MetricHistory id
+  uint32_t mNextFileId{};
+
+  // Previous value of each file id in the open block; mLastSerial tells
+  // whether it was written in this block
+  std::vector<uint64_t> mLastBits{};
+  std::vector<uint64_t> mLastSerial{};
+  uint64_t mSerial{}; // Of the open block, never reused
+
+  size_t mNumSegments{};
+  size_t mBlock{};
+  bool mHasBlock = false;
+  size_t mBytes{};    // Committed bytes of the open block
+  uint32_t mCrc{};    // Over those
+};
+
+} // namespace RESANA
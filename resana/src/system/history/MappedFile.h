@@ -0,0 +1,59 @@
+#pragma once
+
+#include "core/PlatformDetection.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace RESANA {
+
+// A whole file mapped into memory. Mappings of the same file, in this or
+// another process, share its pages, so stores made through a writable
+// mapping are visible to readers at once and reach the disk when the kernel
+// writes them back, even if the process is killed right after.
+class MappedFile {
+public:
+  enum class Access { ReadOnly, ReadWrite };
+
+  MappedFile() = default;
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  // Opens and maps the file; ReadWrite creates it if it does not exist. An
+  // empty file is open but has no data until it is resized.
+  bool Open(const std::string &path, Access access);
+  void Close();
+
+  // Sets the size of a ReadWrite file and maps it again; the data moves
+  bool Resize(size_t bytes);
+  // Maps the file again if it grew elsewhere. False if it did not.
+  bool Remap();
+  // Starts writing dirty pages back without waiting for the disk
+  void FlushAsync();
+
+  [[nodiscard]] bool IsOpen() const;
+  [[nodiscard]] uint8_t *GetData() { return mData; }
+  [[nodiscard]] const uint8_t *GetData() const { return mData; }
+  [[nodiscard]] size_t GetSize() const { return mSize; }
+
+private:
+  bool Map(size_t bytes);
+  void Unmap();
+
+private:
+  Access mAccess = Access::ReadOnly;
+  uint8_t *mData = nullptr;
+  size_t mSize{};
+
+#ifdef RS_PLATFORM_WINDOWS
+  void *mFile = nullptr; // HANDLE, INVALID_HANDLE_VALUE mapped to nullptr
+  void *mMapping = nullptr;
+#else
+  int mFd = -1;
+#endif
+};
+
+} // namespace RESANA
@@ -0,0 +1,197 @@
+#include "MetricHistory.h"
+#include "rspch.h"
+
+namespace RESANA {
+
+MetricHistory::MetricHistory(const HistoryConfig &config) : mConfig(config) {
+  RS_CORE_INFO("Keeping {0} samples of up to {1} metrics, {2} of them with "
+               "{3} rollup levels ({4} MB at most)",
+               mConfig.Capacity, mConfig.MaxSeries, mConfig.MaxRollupSeries,
+               mConfig.Rollups.size(), mConfig.GetMaxBytes() / (1024 * 1024));
+
+  if (!mConfig.StorePath.empty()) {
+    mStore = std::make_unique<HistoryStore>(mConfig.StorePath,
+                                            mConfig.StoreSegments);
+  }
+}
+
+MetricHistory::~MetricHistory() = default;
+
+MetricHistory::SeriesId MetricHistory::Register(const std::string_view name,
+                                                const SeriesOptions &options) {
+  std::lock_guard lock(mMutex);
+
+  std::string key(name);
+  if (const auto it = mSeriesIds.find(key); it != mSeriesIds.end()) {
+    return it->second;
+  }
+
+  SeriesId id;
+  if (!mFreeSeries.empty()) {
+    id = mFreeSeries.back();
+    mFreeSeries.pop_back();
+  } else if (mSeries.size() < mConfig.MaxSeries) {
+    id = (SeriesId)mSeries.size();
+    mSeries.emplace_back();
+  } else {
+    return INVALID_SERIES;
+  }
+
+  auto &series = mSeries[id];
+  if (!series.Data || series.Data->GetEncoding() != options.Encoding) {
+    series.Data = std::make_unique<MetricSeries>(mConfig, options.Encoding);
+  }
+  series.Name = key;
+  series.Live = true;
+  SetRollupsLocked(series, options.Rollups);
+  if (mStore) {
+    mStore->Bind(id, key);
+  }
+  mSeriesIds.emplace(std::move(key), id);
+  return id;
+}
+
+void MetricHistory::Remove(const SeriesId id) {
+  std::lock_guard lock(mMutex);
+
+  if (id >= mSeries.size() || !mSeries[id].Live) {
+    return;
+  }
+
+  auto &series = mSeries[id];
+  mSeriesIds.erase(series.Name);
+  SetRollupsLocked(series, false);
+  series.Name.clear();
+  series.Data->Clear();
+  series.Live = false;
+  mFreeSeries.push_back(id);
+  if (mStore) {
+    mStore->Unbind(id);
+  }
+}
+
+MetricHistory::SeriesId MetricHistory::Find(const std::string_view name) const {
+  std::lock_guard lock(mMutex);
+
+  const auto it = mSeriesIds.find(std::string(name));
+  return it != mSeriesIds.end() ? it->second : INVALID_SERIES;
+}
+
+bool MetricHistory::SetRollups(const SeriesId id, const bool enabled) {
+  std::lock_guard lock(mMutex);
+
+  if (id >= mSeries.size() || !mSeries[id].Live) {
+    return false;
+  }
+  return SetRollupsLocked(mSeries[id], enabled);
+}
+
+bool MetricHistory::SetRollupsLocked(Series &series, const bool enabled) {
+  if (enabled == series.Data->HasRollups()) {
+    return true;
+  }
+  if (enabled && mNumRollupSeries >= mConfig.MaxRollupSeries) {
+    return false;
+  }
+
+  series.Data->SetRollups(enabled);
+  mNumRollupSeries += enabled ? 1 : -1;
+  return true;
+}
+
+void MetricHistory::Append(const SeriesId id, const int64_t time,
+                           const double value) {
+  std::lock_guard lock(mMutex);
+
+  if (id < mSeries.size() && mSeries[id].Live) {
+    mSeries[id].Data->Append(time, value);
+    if (mStore) {
+      mStore->Append(&id, &value, 1, time);
+    }
+  }
+}
+
+void MetricHistory::Append(const SeriesId *ids, const double *values,
+                           const size_t count, const int64_t time) {
+  std::lock_guard lock(mMutex);
+
+  for (size_t i = 0; i < count; ++i) {
+    const SeriesId id = ids[i];
+    if (id < mSeries.size() && mSeries[id].Live) {
+      mSeries[id].Data->Append(time, values[i]);
+    }
+  }
+  if (mStore) {
+    mStore->Append(ids, values, count, time);
+  }
+}
+
+HistoryStats MetricHistory::Aggregate(const SeriesId id, const int64_t from,
+                                      const int64_t to) const {
+  std::lock_guard lock(mMutex);
+
+  const auto *series = GetSeries(id);
+  return series ? series->Aggregate(from, to) : HistoryStats{};
+}
+
+HistoryStats MetricHistory::AggregateLast(const SeriesId id,
+                                          const size_t count) const {
+  std::lock_guard lock(mMutex);
+
+  const auto *series = GetSeries(id);
+  return series ? series->AggregateLast(count) : HistoryStats{};
+}
+
+bool MetricHistory::Read(const SeriesId id, const int64_t from,
+                         const int64_t to,
+                         std::vector<HistoryPoint> &points) const {
+  std::lock_guard lock(mMutex);
+
+  const auto *series = GetSeries(id);
+  if (!series) {
+    return false;
+  }
+
+  series->Read(from, to, points);
+  return true;
+}
+
+bool MetricHistory::Query(const SeriesId id, const int64_t from,
+                          const int64_t to, const int64_t resolution,
+                          std::vector<HistoryBucket> &buckets) const {
+  std::lock_guard lock(mMutex);
+
+  const auto *series = GetSeries(id);
+  if (!series) {
+    return false;
+  }
+
+  series->Query(from, to, resolution, buckets);
+  return true;
+}
+
+size_t MetricHistory::GetNumSeries() const {
+  std::lock_guard lock(mMutex);
+  return mSeriesIds.size();
+}
+
+size_t MetricHistory::GetMemoryUsage() const {
+  std::lock_guard lock(mMutex);
+
+  size_t bytes = mSeries.capacity() * sizeof(Series);
+  for (const auto &series : mSeries) {
+    if (series.Data) {
+      bytes += series.Data->GetMemoryUsage();
+    }
+  }
+  return bytes;
+}
+
+const MetricSeries *MetricHistory::GetSeries(const SeriesId id) const {
+  if (id >= mSeries.size() || !mSeries[id].Live) {
+    return nullptr;
+  }
+  return mSeries[id].Data.get();
+}
+
+} // namespace RESANA
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "HistoryStore.h"
+#include "MetricSeries.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace RESANA {
+
+// The recent history of every sampled metric, one MetricSeries per metric.
+// Series are named after what they hold:
+//   cpu.total, cpu.core.<n>                          load in percent
+//   memory.used, memory.self                         bytes
+//   memory.load                                      percent
+//   process.<pid>.cpu, process.<pid>.memory          percent, bytes
+//
+// Samplers append as they sample and readers query windows, so the last
+// minutes of any metric are available without resampling. Series with
+// rollups also keep coarser levels reaching back hours to a day; only the
+// per-process series of the top processes have them. Series registered with
+// a compressed encoding keep their raw samples Gorilla encoded, several
+// times as many in the same bytes. Memory is bounded by
+// the config; the storage of removed series is reused by new ones. With a
+// StorePath, every sample is also appended to a HistoryStore, which a
+// HistoryArchive reads after the process is gone. All calls are thread safe.
+class MetricHistory {
+public:
+  using SeriesId = uint32_t;
+  static constexpr SeriesId INVALID_SERIES = ~(SeriesId)0;
+
+  explicit MetricHistory(const HistoryConfig &config = {});
+  ~MetricHistory();
+
+  MetricHistory(const MetricHistory &) = delete;
+  MetricHistory &operator=(const MetricHistory &) = delete;
+
+  // Id of the named series, created empty if it does not exist yet.
+  // INVALID_SERIES once MaxSeries series exist. The options of an existing
+  // series are left as they are.
+  SeriesId Register(std::string_view name, const SeriesOptions &options = {});
+  // Drops the series and its samples
+  void Remove(SeriesId id);
+  [[nodiscard]] SeriesId Find(std::string_view name) const;
+
+  // Adds or drops the rollup levels of a series. False if MaxRollupSeries
+  // series already have them.
+  bool SetRollups(SeriesId id, bool enabled);
+
+  // Ignores INVALID_SERIES, so a sampler need not check its registrations
+  void Append(SeriesId id, int64_t time, double value);
+  // Appends one sample per series, all taken at the same time, under a
+  // single lock
+  void Append(const SeriesId *ids, const double *values, size_t count,
+              int64_t time);
+
+  // Aggregates the samples with from <= time <= to, from the finest level
+  // that reaches back to from
+  [[nodiscard]] HistoryStats Aggregate(SeriesId id, int64_t from,
+                                       int64_t to) const;
+  // Aggregates the latest count samples
+  [[nodiscard]] HistoryStats AggregateLast(SeriesId id, size_t count) const;
+  // Appends the raw samples with from <= time <= to to points. False if
+  // there is no such series.
+  bool Read(SeriesId id, int64_t from, int64_t to,
+            std::vector<HistoryPoint> &points) const;
+  // Appends the buckets over [from, to] of the coarsest level whose buckets
+  // are at most resolution milliseconds wide. False if there is no such
+  // series.
+  bool Query(SeriesId id, int64_t from, int64_t to, int64_t resolution,
+             std::vector<HistoryBucket> &buckets) const;
+
+  [[nodiscard]] const HistoryConfig &GetConfig() const { return mConfig; }
+  [[nodiscard]] size_t GetNumSeries() const;
+  // Bytes held by the series, including those kept for reuse
+  [[nodiscard]] size_t GetMemoryUsage() const;
+
+private:
+  struct Series {
+    std::string Name{};
+    std::unique_ptr<MetricSeries> Data{};
+    bool Live = false;
+  };
+
+  [[nodiscard]] const MetricSeries *GetSeries(SeriesId id) const;
+  bool SetRollupsLocked(Series &series, bool enabled);
+
+private:
+  const HistoryConfig mConfig;
+
+  mutable std::mutex mMutex{};
+  std::vector<Series> mSeries{};
+  std::vector<SeriesId> mFreeSeries{};
+  std::unordered_map<std::string, SeriesId> mSeriesIds{};
+  size_t mNumRollupSeries{};
+  std::unique_ptr<HistoryStore> mStore{};
+};
+
+} // namespace RESANA
@@ -0,0 +1,193 @@
+#include "MetricSeries.h"
+#include "rspch.h"
+
+namespace RESANA {
+
+size_t HistoryConfig::GetCompressedBytes() const {
+  const size_t blocks = std::max<size_t>(
+      (CompressedBytes + CompressedSeries::BLOCK_BYTES - 1) /
+          CompressedSeries::BLOCK_BYTES,
+      2);
+  return blocks * (CompressedSeries::BLOCK_BYTES +
+                   sizeof(CompressedSeries::BlockHeader));
+}
+
+size_t HistoryConfig::GetRollupBytes() const {
+  size_t bytes = 0;
+  for (const auto &rollup : Rollups) {
+    bytes += (size_t)rollup.Capacity *
+             (sizeof(int64_t) + 3 * sizeof(float) + sizeof(uint32_t));
+  }
+  return bytes;
+}
+
+MetricSeries::MetricSeries(const HistoryConfig &config,
+                           const SeriesEncoding encoding)
+    : mConfig(config) {
+  if (encoding == SeriesEncoding::Plain) {
+    mPlain = std::make_unique<TimeSeries>(config.Capacity);
+  } else {
+    mCompressed =
+        std::make_unique<CompressedSeries>(config.CompressedBytes, encoding);
+  }
+}
+
+template <typename Visit>
+void MetricSeries::VisitRaw(const int64_t from, const int64_t to,
+                            Visit &&visit) const {
+  if (mPlain) {
+    const size_t end =
+        to == INT64_MAX ? mPlain->GetSize() : mPlain->LowerBound(to + 1);
+    for (size_t i = mPlain->LowerBound(from); i < end; ++i) {
+      visit(mPlain->GetPoint(i));
+    }
+    return;
+  }
+
+  // Decodes in place, so compressed samples never go through a buffer
+  HistoryPoint point;
+  for (size_t block = mCompressed->FindBlock(from);
+       block < mCompressed->GetNumBlocks(); ++block) {
+    if (mCompressed->GetBlockHeader(block).FirstTime > to) {
+      break;
+    }
+
+    CompressedSeries::BlockDecoder decoder(*mCompressed, block);
+    while (decoder.Next(point) && point.Time <= to) {
+      if (point.Time >= from) {
+        visit(point);
+      }
+    }
+  }
+}
+
+void MetricSeries::Append(const int64_t time, const double value) {
+  if (mPlain) {
+    mPlain->Append(time, value);
+  } else {
+    mCompressed->Append(time, value);
+  }
+  for (auto &tier : mTiers) {
+    tier->Add(time, value);
+  }
+}
+
+void MetricSeries::Clear() {
+  if (mPlain) {
+    mPlain->Clear();
+  } else {
+    mCompressed->Clear();
+  }
+  mTiers.clear();
+}
+
+void MetricSeries::SetRollups(const bool enabled) {
+  if (enabled == HasRollups()) {
+    return;
+  }
+
+  if (!enabled) {
+    mTiers.clear();
+    return;
+  }
+
+  for (const auto &rollup : mConfig.Rollups) {
+    auto tier = std::make_unique<RollupTier>(rollup.WidthMs, rollup.Capacity);
+    VisitRaw(INT64_MIN, INT64_MAX, [&tier](const HistoryPoint &point) {
+      tier->Add(point.Time, point.Value);
+    });
+    mTiers.push_back(std::move(tier));
+  }
+}
+
+SeriesEncoding MetricSeries::GetEncoding() const {
+  return mPlain ? SeriesEncoding::Plain : mCompressed->GetEncoding();
+}
+
+size_t MetricSeries::GetSize() const {
+  return mPlain ? mPlain->GetSize() : mCompressed->GetSize();
+}
+
+int MetricSeries::SelectLevel(const int64_t from,
+                              const int64_t resolution) const {
+  int level = RAW_LEVEL;
+  for (size_t tier = 0; tier < mTiers.size(); ++tier) {
+    if (mTiers[tier]->GetWidth() <= resolution) {
+      level = (int)tier;
+    }
+  }
+
+  // Older data only survives at coarser levels
+  while (!Covers(level, from) && level + 1 < (int)mTiers.size()) {
+    ++level;
+  }
+  return level;
+}
+
+void MetricSeries::Query(const int64_t from, const int64_t to,
+                         const int64_t resolution,
+                         std::vector<HistoryBucket> &buckets) const {
+  const int level = SelectLevel(from, resolution);
+  if (level != RAW_LEVEL) {
+    mTiers[level]->Read(from, to, buckets);
+    return;
+  }
+
+  VisitRaw(from, to, [&buckets](const HistoryPoint &point) {
+    buckets.push_back({point.Time, point.Value, point.Value, point.Value, 1});
+  });
+}
+
+HistoryStats MetricSeries::Aggregate(const int64_t from,
+                                     const int64_t to) const {
+  const int level = SelectLevel(from, 0);
+  if (level != RAW_LEVEL) {
+    return mTiers[level]->Aggregate(from, to);
+  }
+  return mPlain ? mPlain->Aggregate(from, to)
+                : mCompressed->Aggregate(from, to);
+}
+
+HistoryStats MetricSeries::AggregateLast(const size_t count) const {
+  if (!mPlain) {
+    return mCompressed->AggregateLast(count);
+  }
+
+  const size_t size = mPlain->GetSize();
+  const size_t first = size > count ? size - count : 0;
+  return mPlain->Aggregate(first, size - first);
+}
+
+void MetricSeries::Read(const int64_t from, const int64_t to,
+                        std::vector<HistoryPoint> &points) const {
+  if (mPlain) {
+    mPlain->Read(from, to, points);
+  } else {
+    mCompressed->Read(from, to, points);
+  }
+}
+
+size_t MetricSeries::GetMemoryUsage() const {
+  size_t bytes = sizeof(*this) + (mPlain ? mPlain->GetMemoryUsage()
+                                          : mCompressed->GetMemoryUsage());
+  for (const auto &tier : mTiers) {
+    bytes += tier->GetMemoryUsage();
+  }
+  return bytes;
+}
+
+bool MetricSeries::Covers(const int level, const int64_t time) const {
+  if (level != RAW_LEVEL) {
+    return mTiers[level]->Covers(time);
+  }
+
+  if (mCompressed) {
+    return mCompressed->Covers(time);
+  }
+
+  // A ring that never filled up has dropped nothing
+  return mPlain->GetSize() < mPlain->GetCapacity() ||
+         mPlain->GetPoint(0).Time <= time;
+}
+
+} // namespace RESANA
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "CompressedSeries.h"
+#include "RollupTier.h"
+#include "TimeSeries.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace RESANA {
+
+// One rollup level: buckets of WidthMs milliseconds, the latest Capacity kept
+struct RollupConfig {
+  int64_t WidthMs{};
+  uint32_t Capacity{};
+};
+
+struct HistoryConfig {
+  uint32_t Capacity = 600;   // Raw samples kept per series
+  // Bytes of raw samples kept per compressed series; less than a plain
+  // ring, yet a quarter of an hour of a noisy load and hours of an idle one
+  uint32_t CompressedBytes = 8192;
+  uint32_t MaxSeries = 4096; // Series that may exist at once
+
+  // Coarser levels, finest first: an hour of 10 s buckets, six hours of
+  // 1 min buckets and a day of 10 min buckets
+  std::vector<RollupConfig> Rollups = {
+      {10000, 360}, {60000, 360}, {600000, 144}};
+  uint32_t MaxRollupSeries = 256; // Series that may keep rollups at once
+  uint32_t TopProcesses = 32;     // Processes whose series keep rollups
+
+  // File every sample is also appended to, so it outlives the process;
+  // empty keeps the history in memory only
+  std::string StorePath{};
+  uint32_t StoreSegments = 256; // Of about 1 MB, kept per store file
+
+  [[nodiscard]] size_t GetRawBytes() const {
+    return (size_t)Capacity * (sizeof(int64_t) + sizeof(double));
+  }
+  [[nodiscard]] size_t GetCompressedBytes() const;
+  [[nodiscard]] size_t GetRollupBytes() const;
+  // Upper bound of the sample storage
+  [[nodiscard]] size_t GetMaxBytes() const {
+    const size_t raw = GetRawBytes() > GetCompressedBytes()
+                           ? GetRawBytes()
+                           : GetCompressedBytes();
+    return MaxSeries * raw + MaxRollupSeries * GetRollupBytes();
+  }
+};
+
+// How a series is kept
+struct SeriesOptions {
+  bool Rollups = true;
+  SeriesEncoding Encoding = SeriesEncoding::Plain;
+};
+
+// A series at every resolution: the raw samples, in a plain ring or
+// compressed, and, when rollups are enabled, one RollupTier per configured
+// level, all fed on append. A range query reads the coarsest level that still
+// meets the requested resolution, so a day of history costs a few hundred
+// buckets rather than a day of samples.
+class MetricSeries {
+public:
+  static constexpr int RAW_LEVEL = -1;
+
+  MetricSeries(const HistoryConfig &config, SeriesEncoding encoding);
+
+  MetricSeries(const MetricSeries &) = delete;
+  MetricSeries &operator=(const MetricSeries &) = delete;
+
+  void Append(int64_t time, double value);
+  void Clear();
+
+  // Enabling allocates the tiers and backfills them from the raw samples;
+  // disabling frees them
+  void SetRollups(bool enabled);
+  [[nodiscard]] bool HasRollups() const { return !mTiers.empty(); }
+
+  [[nodiscard]] SeriesEncoding GetEncoding() const;
+  // Raw samples kept
+  [[nodiscard]] size_t GetSize() const;
+  [[nodiscard]] size_t GetNumTiers() const { return mTiers.size(); }
+  [[nodiscard]] const RollupTier &GetTier(size_t tier) const {
+    return *mTiers[tier];
+  }
+
+  // The level a query from time at the given resolution in milliseconds
+  // reads: the coarsest one whose buckets are no wider than the resolution,
+  // or a coarser one if that no longer reaches back to from
+  [[nodiscard]] int SelectLevel(int64_t from, int64_t resolution) const;
+
+  // Appends the buckets of the selected level that overlap [from, to]; raw
+  // samples come back as buckets of one
+  void Query(int64_t from, int64_t to, int64_t resolution,
+             std::vector<HistoryBucket> &buckets) const;
+  // Aggregates [from, to] at the finest level that reaches back to from
+  [[nodiscard]] HistoryStats Aggregate(int64_t from, int64_t to) const;
+  // Aggregates the latest count raw samples
+  [[nodiscard]] HistoryStats AggregateLast(size_t count) const;
+  // Appends the raw samples with from <= time <= to
+  void Read(int64_t from, int64_t to, std::vector<HistoryPoint> &points) const;
+
+  [[nodiscard]] size_t GetMemoryUsage() const;
+
+private:
+  [[nodiscard]] bool Covers(int level, int64_t time) const;
+  // Calls visit(point) for each raw sample with from <= time <= to
+  template <typename Visit>
+  void VisitRaw(int64_t from, int64_t to, Visit &&visit) const;
+
+private:
+  const HistoryConfig &mConfig;
+  // Exactly one of the two holds the raw samples
+  std::unique_ptr<TimeSeries> mPlain{};
+  std::unique_ptr<CompressedSeries> mCompressed{};
+  std::vector<std::unique_ptr<RollupTier>> mTiers{};
+};
+
+} // namespace RESANA
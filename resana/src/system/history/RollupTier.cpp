@@ -0,0 +1,158 @@
+#include "RollupTier.h"
+#include "rspch.h"
+
+namespace RESANA {
+
+RollupTier::RollupTier(const int64_t width, const size_t capacity)
+    : mWidth(std::max<int64_t>(width, 1)),
+      mCapacity(std::max<size_t>(capacity, 1)),
+      mTimes(AllocateAligned<int64_t>(mCapacity)),
+      mMin(AllocateAligned<float>(mCapacity)),
+      mMax(AllocateAligned<float>(mCapacity)),
+      mAvg(AllocateAligned<float>(mCapacity)),
+      mCount(AllocateAligned<uint32_t>(mCapacity)) {}
+
+void RollupTier::Add(const int64_t time, const double value) {
+  // Floor division, so times before the clock's start still align
+  int64_t start = time - time % mWidth;
+  if (start > time) {
+    start -= mWidth;
+  }
+
+  // A sample older than the open bucket is folded into it, so the buckets
+  // stay ordered
+  if (mOpen.Count && start > mOpen.Time) {
+    Close();
+  }
+
+  if (mOpen.Count == 0) {
+    mOpen.Time = start;
+    mOpen.Min = value;
+    mOpen.Max = value;
+    mOpen.Sum = 0.0;
+  }
+
+  mOpen.Min = std::min(mOpen.Min, value);
+  mOpen.Max = std::max(mOpen.Max, value);
+  mOpen.Sum += value;
+  ++mOpen.Count;
+}
+
+void RollupTier::Clear() {
+  mHead = 0;
+  mSize = 0;
+  mDropped = false;
+  mOpen = {};
+}
+
+bool RollupTier::Covers(const int64_t time) const {
+  return !mDropped || (mSize > 0 && mTimes[mHead] <= time);
+}
+
+HistoryBucket RollupTier::GetBucket(const size_t index) const {
+  if (index == mSize) {
+    return {mOpen.Time, mOpen.Min, mOpen.Max, mOpen.Sum / (double)mOpen.Count,
+            mOpen.Count};
+  }
+
+  const size_t position = ToRing(index);
+  return {mTimes[position], mMin[position], mMax[position], mAvg[position],
+          mCount[position]};
+}
+
+void RollupTier::Read(const int64_t from, const int64_t to,
+                      std::vector<HistoryBucket> &buckets) const {
+  const size_t size = GetSize();
+  for (size_t i = LowerBound(from); i < size; ++i) {
+    const auto bucket = GetBucket(i);
+    if (bucket.Time > to) {
+      break;
+    }
+    if (bucket.Time + mWidth > from) {
+      buckets.push_back(bucket);
+    }
+  }
+}
+
+HistoryStats RollupTier::Aggregate(const int64_t from, const int64_t to) const {
+  HistoryStats stats{};
+  double sum = 0.0;
+  HistoryBucket first{};
+  HistoryBucket last{};
+
+  const size_t size = GetSize();
+  for (size_t i = LowerBound(from); i < size; ++i) {
+    const auto bucket = GetBucket(i);
+    if (bucket.Time > to) {
+      break;
+    }
+    if (bucket.Time + mWidth <= from) {
+      continue; // The open bucket, when it ended before the window
+    }
+
+    if (stats.Count == 0) {
+      first = bucket;
+      stats.Min = bucket.Min;
+      stats.Max = bucket.Max;
+    }
+    stats.Min = std::min(stats.Min, bucket.Min);
+    stats.Max = std::max(stats.Max, bucket.Max);
+    stats.Count += bucket.Count;
+    sum += bucket.Avg * bucket.Count;
+    last = bucket;
+  }
+
+  if (stats.Count == 0) {
+    return {};
+  }
+
+  stats.Avg = sum / (double)stats.Count;
+  stats.FirstTime = first.Time;
+  stats.LastTime = last.Time;
+  if (last.Time > first.Time) {
+    stats.Rate =
+        (last.Avg - first.Avg) * 1000.0 / (double)(last.Time - first.Time);
+  }
+  return stats;
+}
+
+size_t RollupTier::GetMemoryUsage() const {
+  return sizeof(*this) +
+         mCapacity * (sizeof(int64_t) + 3 * sizeof(float) + sizeof(uint32_t));
+}
+
+void RollupTier::Close() {
+  size_t position;
+  if (mSize < mCapacity) {
+    position = ToRing(mSize++);
+  } else {
+    position = mHead;
+    mHead = ToRing(1);
+    mDropped = true;
+  }
+
+  mTimes[position] = mOpen.Time;
+  mMin[position] = (float)mOpen.Min;
+  mMax[position] = (float)mOpen.Max;
+  mAvg[position] = (float)(mOpen.Sum / (double)mOpen.Count);
+  mCount[position] = mOpen.Count;
+  mOpen = {};
+}
+
+size_t RollupTier::LowerBound(const int64_t time) const {
+  // Buckets are ordered by start; the open one is never before the last
+  size_t first = 0;
+  size_t count = mSize;
+  while (count > 0) {
+    const size_t step = count / 2;
+    if (mTimes[ToRing(first + step)] + mWidth <= time) {
+      first += step + 1;
+      count -= step + 1;
+    } else {
+      count = step;
+    }
+  }
+  return first;
+}
+
+} // namespace RESANA
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "AlignedArray.h"
+#include "TimeSeries.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace RESANA {
+
+// The samples of one interval of a series, or a single raw sample
+struct HistoryBucket {
+  int64_t Time{}; // Start of the interval
+  double Min{};
+  double Max{};
+  double Avg{};
+  uint32_t Count{};
+};
+
+// One downsampled level of a series: a fixed capacity ring of buckets of
+// Width milliseconds, each holding the min, max, average and count of the
+// samples that fell into it. Samples are folded into the open bucket as they
+// are appended, so the rollup costs O(1) per sample and never rescans; the
+// bucket is closed into the ring when the first sample of a later interval
+// arrives. Closed buckets store their figures as floats, which keeps a bucket
+// at 24 bytes.
+class RollupTier {
+public:
+  RollupTier(int64_t width, size_t capacity);
+
+  RollupTier(const RollupTier &) = delete;
+  RollupTier &operator=(const RollupTier &) = delete;
+
+  void Add(int64_t time, double value);
+  void Clear();
+
+  [[nodiscard]] int64_t GetWidth() const { return mWidth; }
+  [[nodiscard]] size_t GetCapacity() const { return mCapacity; }
+  // Closed buckets plus the open one
+  [[nodiscard]] size_t GetSize() const { return mSize + (mOpen.Count ? 1 : 0); }
+  // True if no bucket holding a sample at or after time was dropped
+  [[nodiscard]] bool Covers(int64_t time) const;
+
+  // Index 0 is the oldest bucket; the last one may be open
+  [[nodiscard]] HistoryBucket GetBucket(size_t index) const;
+
+  // Appends the buckets that overlap from <= time <= to
+  void Read(int64_t from, int64_t to,
+            std::vector<HistoryBucket> &buckets) const;
+  // Aggregates the buckets that overlap from <= time <= to. Rate is taken
+  // between the averages of the first and last bucket.
+  [[nodiscard]] HistoryStats Aggregate(int64_t from, int64_t to) const;
+
+  [[nodiscard]] size_t GetMemoryUsage() const;
+
+private:
+  void Close();
+  // Index of the first bucket that ends after time
+  [[nodiscard]] size_t LowerBound(int64_t time) const;
+
+  [[nodiscard]] size_t ToRing(size_t index) const {
+    const size_t position = mHead + index;
+    return position >= mCapacity ? position - mCapacity : position;
+  }
+
+private:
+  struct OpenBucket {
+    int64_t Time{};
+    double Min{};
+    double Max{};
+    double Sum{};
+    uint32_t Count{};
+  };
+
+  int64_t mWidth{};
+  size_t mCapacity{};
+
+  AlignedArray<int64_t> mTimes;
+  AlignedArray<float> mMin;
+  AlignedArray<float> mMax;
+  AlignedArray<float> mAvg;
+  AlignedArray<uint32_t> mCount;
+  size_t mHead{};
+  size_t mSize{};
+  bool mDropped = false; // A bucket was overwritten
+
+  OpenBucket mOpen{};
+};
+
+} // namespace RESANA
@@ -0,0 +1,119 @@
+#include "TimeSeries.h"
+#include "rspch.h"
+
+namespace RESANA {
+
+TimeSeries::TimeSeries(const size_t capacity)
+    : mTimes(AllocateAligned<int64_t>(std::max<size_t>(capacity, 1))),
+      mValues(AllocateAligned<double>(std::max<size_t>(capacity, 1))),
+      mCapacity(std::max<size_t>(capacity, 1)) {}
+
+void TimeSeries::Append(const int64_t time, const double value) {
+  size_t position;
+  if (mSize < mCapacity) {
+    position = ToRing(mSize++);
+  } else {
+    // Full; the oldest sample makes room
+    position = mHead;
+    mHead = ToRing(1);
+  }
+
+  mTimes[position] = time;
+  mValues[position] = value;
+}
+
+void TimeSeries::Clear() {
+  mHead = 0;
+  mSize = 0;
+}
+
+HistoryPoint TimeSeries::GetPoint(const size_t index) const {
+  const size_t position = ToRing(index);
+  return {mTimes[position], mValues[position]};
+}
+
+size_t TimeSeries::LowerBound(const int64_t time) const {
+  size_t first = 0;
+  size_t count = mSize;
+  while (count > 0) {
+    const size_t step = count / 2;
+    if (mTimes[ToRing(first + step)] < time) {
+      first += step + 1;
+      count -= step + 1;
+    } else {
+      count = step;
+    }
+  }
+  return first;
+}
+
+HistoryStats TimeSeries::Aggregate(const size_t first, size_t count) const {
+  HistoryStats stats{};
+  if (first >= mSize) {
+    return stats;
+  }
+  count = std::min(count, mSize - first);
+  if (count == 0) {
+    return stats;
+  }
+
+  double min = mValues[ToRing(first)];
+  double max = min;
+  double sum = 0.0;
+
+  // The window is at most two contiguous runs of the ring
+  const size_t start = ToRing(first);
+  const size_t firstRun = std::min(count, mCapacity - start);
+  const auto accumulate = [&](const double *values, const size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+      min = std::min(min, values[i]);
+      max = std::max(max, values[i]);
+      sum += values[i];
+    }
+  };
+  accumulate(mValues.get() + start, firstRun);
+  accumulate(mValues.get(), count - firstRun);
+
+  const HistoryPoint oldest = GetPoint(first);
+  const HistoryPoint latest = GetPoint(first + count - 1);
+
+  stats.Count = count;
+  stats.Min = min;
+  stats.Max = max;
+  stats.Avg = sum / (double)count;
+  stats.FirstTime = oldest.Time;
+  stats.LastTime = latest.Time;
+  if (latest.Time > oldest.Time) {
+    stats.Rate = (latest.Value - oldest.Value) * 1000.0 /
+                 (double)(latest.Time - oldest.Time);
+  }
+  return stats;
+}
+
+HistoryStats TimeSeries::Aggregate(const int64_t from, const int64_t to) const {
+  if (to < from) {
+    return {};
+  }
+
+  const size_t first = LowerBound(from);
+  const size_t end = to == INT64_MAX ? mSize : LowerBound(to + 1);
+  return Aggregate(first, end - first);
+}
+
+void TimeSeries::Read(const int64_t from, const int64_t to,
+                      std::vector<HistoryPoint> &points) const {
+  if (to < from) {
+    return;
+  }
+
+  const size_t end = to == INT64_MAX ? mSize : LowerBound(to + 1);
+  for (size_t i = LowerBound(from); i < end; ++i) {
+    points.push_back(GetPoint(i));
+  }
+}
+
+size_t TimeSeries::GetMemoryUsage() const {
+  return sizeof(*this) + mCapacity * (sizeof(int64_t) + sizeof(double));
+}
+
+} // namespace RESANA
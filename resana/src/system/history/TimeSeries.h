@@ -0,0 +1,118 @@
+#pragma once
+
+#include "AlignedArray.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace RESANA {
+
+// One sample; times are Time::GetTime() milliseconds
+struct HistoryPoint {
+  int64_t Time{};
+  double Value{};
+};
+
+// Aggregates over a window of samples. Rate is the change of the value per
+// second from the first to the last sample of the window.
+struct HistoryStats {
+  size_t Count{};
+  double Min{};
+  double Max{};
+  double Avg{};
+  double Rate{};
+  int64_t FirstTime{};
+  int64_t LastTime{};
+};
+
+// Builds HistoryStats from samples added in time order
+class HistoryAccumulator {
+public:
+  void Add(const int64_t time, const double value) {
+    if (mStats.Count == 0) {
+      mStats.Min = value;
+      mStats.Max = value;
+      mStats.FirstTime = time;
+      mFirstValue = value;
+    }
+    mStats.Min = value < mStats.Min ? value : mStats.Min;
+    mStats.Max = value > mStats.Max ? value : mStats.Max;
+    mStats.LastTime = time;
+    mLastValue = value;
+    mSum += value;
+    ++mStats.Count;
+  }
+
+  [[nodiscard]] HistoryStats Finish() const {
+    HistoryStats stats = mStats;
+    if (stats.Count > 0) {
+      stats.Avg = mSum / (double)stats.Count;
+    }
+    if (stats.LastTime > stats.FirstTime) {
+      stats.Rate = (mLastValue - mFirstValue) * 1000.0 /
+                   (double)(stats.LastTime - stats.FirstTime);
+    }
+    return stats;
+  }
+
+private:
+  HistoryStats mStats{};
+  double mSum{};
+  double mFirstValue{};
+  double mLastValue{};
+};
+
+// The most recent samples of one metric in a fixed capacity ring. Times and
+// values are separate cache line aligned arrays, so a window aggregate
+// streams through at most two contiguous runs of each. Appending is O(1) and
+// overwrites the oldest sample once the ring is full; nothing is allocated
+// after construction.
+//
+// Times are expected not to decrease; a window is found by binary search.
+class TimeSeries {
+public:
+  explicit TimeSeries(size_t capacity);
+
+  TimeSeries(const TimeSeries &) = delete;
+  TimeSeries &operator=(const TimeSeries &) = delete;
+
+  void Append(int64_t time, double value);
+  void Clear();
+
+  [[nodiscard]] size_t GetSize() const { return mSize; }
+  [[nodiscard]] size_t GetCapacity() const { return mCapacity; }
+  [[nodiscard]] bool IsEmpty() const { return mSize == 0; }
+
+  // Index 0 is the oldest sample
+  [[nodiscard]] HistoryPoint GetPoint(size_t index) const;
+  [[nodiscard]] HistoryPoint GetLatest() const { return GetPoint(mSize - 1); }
+
+  // Index of the first sample at or after time; GetSize() if there is none
+  [[nodiscard]] size_t LowerBound(int64_t time) const;
+
+  // Aggregates count samples starting at index first
+  [[nodiscard]] HistoryStats Aggregate(size_t first, size_t count) const;
+  // Aggregates the samples with from <= time <= to
+  [[nodiscard]] HistoryStats Aggregate(int64_t from, int64_t to) const;
+  // Appends the samples with from <= time <= to to points
+  void Read(int64_t from, int64_t to, std::vector<HistoryPoint> &points) const;
+
+  [[nodiscard]] size_t GetMemoryUsage() const;
+
+private:
+  // Ring position of a sample index
+  [[nodiscard]] size_t ToRing(size_t index) const {
+    const size_t position = mHead + index;
+    return position >= mCapacity ? position - mCapacity : position;
+  }
+
+private:
+  AlignedArray<int64_t> mTimes;
+  AlignedArray<double> mValues;
+  size_t mCapacity{};
+  size_t mHead{}; // Ring position of the oldest sample
+  size_t mSize{};
+};
+
+} // namespace RESANA
@@ -1,7 +1,8 @@
 #include "MemoryPerformance.h"
 #include "rspch.h"
 
-#include "core/Application.h"
+#include "system/SystemRuntime.h"
+#include "system/trace/SampleTrace.h"
 #include "core/Core.h"
 
 namespace RESANA {
@@ -12,8 +13,6 @@ MemoryPerformance::MemoryPerformance()
     : SystemObject(this), mUpdateInterval(TimeTick::Rate::Normal) {}
 
 MemoryPerformance::~MemoryPerformance() {
-  // Wait for loops to stop
-  Time::Sleep(mUpdateInterval);
   RS_CORE_TRACE("MemoryPerformance destroyed");
 }
 
@@ -33,17 +32,23 @@ void MemoryPerformance::Run() {
   if (!IsRunning()) {
     mRunning = true;
 
-    const auto &app = Application::Get();
-    auto &threadPool = app.GetThreadPool();
-
-    threadPool.Queue([&] { sInstance->UpdateMemoryInfo(); });
-    threadPool.Queue([&] { sInstance->UpdatePmc(); });
+    if (!SystemRuntime::Get().IsReplaying()) {
+      mSampleTask = SystemRuntime::Get().GetSampleScheduler().Add(
+          "memory", mUpdateInterval, [&] { sInstance->SampleTick(); });
+    }
   }
 }
 
 void MemoryPerformance::Stop() {
   if (sInstance && IsRunning()) {
     mRunning = false;
+    if (mSampleTask) {
+      SystemRuntime::Get().GetSampleScheduler().Remove(mSampleTask);
+      mSampleTask = {};
+    }
+
+    mMemoryInfo.Publish({});
+    mProcessMetrics.Publish({});
   }
 }
 
@@ -55,151 +60,163 @@ void MemoryPerformance::Shutdown() {
 }
 
 float MemoryPerformance::GetMemoryLoad() const {
-  if (const auto divisor = (float)GetTotalPhysical(); divisor != 0.0f) {
-    return (float)GetUsedPhysical() / divisor * 100.0f;
+  const auto status = mMemoryInfo.Load();
+  if (const auto divisor = (float)status.TotalPhys; divisor != 0.0f) {
+    return (float)(status.TotalPhys - status.AvailPhys) / divisor * 100.0f;
   }
   return 0;
 }
-DWORD MemoryPerformance::GetMemoryLoad(int) {
-  MEMORYSTATUSEX memInfo{};
-  memInfo.dwLength = sizeof(MEMORYSTATUSEX);
-
-  GlobalMemoryStatusEx(&memInfo);
-  const auto result = memInfo.dwMemoryLoad;
-  ZeroMemory(&memInfo, sizeof(MEMORYSTATUSEX));
-
-  return result;
+uint32_t MemoryPerformance::GetMemoryLoad(int) {
+  MemoryStatus status{};
+  QueryMemoryStatus(status);
+  return status.MemoryLoad;
 }
 
-DWORDLONG MemoryPerformance::GetTotalPhysical() const {
-  return mMemoryInfo.ullTotalPhys;
+uint64_t MemoryPerformance::GetTotalPhysical() const {
+  return mMemoryInfo.Load().TotalPhys;
 }
 
-DWORDLONG MemoryPerformance::GetTotalPhysicalKB() const {
+uint64_t MemoryPerformance::GetTotalPhysicalKB() const {
   return GetTotalPhysical() / BYTES_PER_KB;
 }
 
-DWORDLONG MemoryPerformance::GetTotalPhysicalMB() const {
+uint64_t MemoryPerformance::GetTotalPhysicalMB() const {
   return GetTotalPhysical() / BYTES_PER_MB;
 }
 
-DWORDLONG MemoryPerformance::GetAvailPhysical() const {
-  return mMemoryInfo.ullAvailPhys;
+uint64_t MemoryPerformance::GetAvailPhysical() const {
+  return mMemoryInfo.Load().AvailPhys;
 }
 
-DWORDLONG MemoryPerformance::GetAvailPhysicalKB() const {
+uint64_t MemoryPerformance::GetAvailPhysicalKB() const {
   return GetAvailPhysical() / BYTES_PER_KB;
 }
 
-DWORDLONG MemoryPerformance::GetAvailPhysicalMB() const {
+uint64_t MemoryPerformance::GetAvailPhysicalMB() const {
   return GetAvailPhysical() / BYTES_PER_MB;
 }
 
-DWORDLONG MemoryPerformance::GetUsedPhysical() const {
-  return mMemoryInfo.ullTotalPhys - mMemoryInfo.ullAvailPhys;
+uint64_t MemoryPerformance::GetUsedPhysical() const {
+  const auto status = mMemoryInfo.Load();
+  return status.TotalPhys - status.AvailPhys;
 }
 
-DWORDLONG MemoryPerformance::GetUsedPhysicalKB() const {
+uint64_t MemoryPerformance::GetUsedPhysicalKB() const {
   return GetUsedPhysical() / BYTES_PER_KB;
 }
 
-DWORDLONG MemoryPerformance::GetUsedPhysicalMB() const {
+uint64_t MemoryPerformance::GetUsedPhysicalMB() const {
   return GetUsedPhysical() / BYTES_PER_MB;
 }
 
-void MemoryPerformance::GetProcessMemoryInformation(
-    PROCESS_MEMORY_COUNTERS_EX &dest, uint32_t procId) {
-  HANDLE hProcess{};
-
-  if ((hProcess =
-           OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, procId))) {
-    // GetProcessInformation(hProcess, ProcessAppMemoryInfo, &dest,
-    // sizeof(APP_MEMORY_INFORMATION));
-    ::GetProcessMemoryInfo(hProcess, (PROCESS_MEMORY_COUNTERS *)&dest,
-                           sizeof(PROCESS_MEMORY_COUNTERS_EX));
-  } else {
-    //::ZeroMemory(&dest, sizeof(APP_MEMORY_INFORMATION));
-    ::ZeroMemory(&dest, sizeof(PROCESS_MEMORY_COUNTERS_EX));
-  }
-  CloseHandle(hProcess);
+uint64_t MemoryPerformance::GetPrivateUsage(uint32_t procId) {
+  ProcessMetrics metrics{};
+  CollectProcessMetrics(procId, metrics);
+  return metrics.PrivateUsage;
 }
 
-ULONG64 MemoryPerformance::GetPrivateUsage(uint32_t procId) {
-  static PROCESS_MEMORY_COUNTERS_EX info{};
-  ZeroMemory(&info, sizeof(PROCESS_MEMORY_COUNTERS_EX));
-  GetProcessMemoryInformation(info, procId);
-
-  return info.PrivateUsage;
-}
-
-ULONG64 MemoryPerformance::GetPrivateUsageKB(uint32_t procId) {
+uint64_t MemoryPerformance::GetPrivateUsageKB(uint32_t procId) {
   return GetPrivateUsage(procId) / BYTES_PER_KB;
 }
 
-ULONG64 MemoryPerformance::GetPrivateUsageMB(uint32_t procId) {
+uint64_t MemoryPerformance::GetPrivateUsageMB(uint32_t procId) {
   return GetPrivateUsage(procId) / BYTES_PER_MB;
 }
 
-ULONG64 MemoryPerformance::GetWorkingSetSize(uint32_t procId) {
-  static PROCESS_MEMORY_COUNTERS_EX info{};
-  ZeroMemory(&info, sizeof(PROCESS_MEMORY_COUNTERS_EX));
-  GetProcessMemoryInformation(info, procId);
-
-  return info.WorkingSetSize;
+uint64_t MemoryPerformance::GetWorkingSetSize(uint32_t procId) {
+  ProcessMetrics metrics{};
+  CollectProcessMetrics(procId, metrics);
+  return metrics.WorkingSetSize;
 }
 
-ULONG64 MemoryPerformance::GetWorkingSetSizeKB(uint32_t procId) {
+uint64_t MemoryPerformance::GetWorkingSetSizeKB(uint32_t procId) {
   return GetWorkingSetSize(procId) / BYTES_PER_KB;
 }
 
-ULONG64 MemoryPerformance::GetWorkingSetSizeMB(uint32_t procId) {
+uint64_t MemoryPerformance::GetWorkingSetSizeMB(uint32_t procId) {
   return GetWorkingSetSize(procId) / BYTES_PER_MB;
 }
 
-DWORDLONG MemoryPerformance::GetTotalVirtual() const {
-  return mMemoryInfo.ullTotalPageFile;
+uint64_t MemoryPerformance::GetTotalVirtual() const {
+  return mMemoryInfo.Load().TotalPageFile;
 }
 
-DWORDLONG MemoryPerformance::GetAvailVirtual() const {
-  return mMemoryInfo.ullAvailVirtual;
+uint64_t MemoryPerformance::GetAvailVirtual() const {
+  return mMemoryInfo.Load().AvailVirtual;
 }
 
-DWORDLONG MemoryPerformance::GetUsedVirtual() const {
-  return mMemoryInfo.ullTotalPageFile - mMemoryInfo.ullAvailPageFile;
+uint64_t MemoryPerformance::GetUsedVirtual() const {
+  const auto status = mMemoryInfo.Load();
+  return status.TotalPageFile - status.AvailPageFile;
 }
 
-SIZE_T MemoryPerformance::GetCurrProcUsageVirtual() const {
-  return mPmc.PrivateUsage;
+uint64_t MemoryPerformance::GetCurrProcUsageVirtual() const {
+  return mProcessMetrics.Load().PrivateUsage;
+}
+
+uint64_t MemoryPerformance::GetCurrProcWorkingSet() const {
+  return mProcessMetrics.Load().WorkingSetSize;
 }
 
 void MemoryPerformance::SetUpdateInterval(const Timestep interval) {
+  if ((uint32_t)interval == mUpdateInterval) {
+    return;
+  }
+
   mUpdateInterval = (uint32_t)interval;
+  if (mSampleTask) {
+    SystemRuntime::Get().GetSampleScheduler().SetInterval(mSampleTask,
+                                                        mUpdateInterval);
+  }
 }
 
-void MemoryPerformance::UpdateMemoryInfo() {
-  MEMORYSTATUSEX memInfo{};
-  mMemoryInfo = memInfo;
-  mMemoryInfo.dwLength = sizeof(MEMORYSTATUSEX);
+void MemoryPerformance::SampleTick() {
+  MemoryStatus status{};
+  QueryMemoryStatus(status);
+
+  ProcessMetrics metrics{};
+  CollectProcessMetrics(GetCurrentProcessIdentifier(), metrics);
 
-  do {
-    GlobalMemoryStatusEx(&mMemoryInfo);
-  } while (IsRunning() && Time::Sleep(mUpdateInterval));
-  ZeroMemory(&mMemoryInfo, sizeof(MEMORYSTATUSEX));
+  const int64_t time = Time::GetTime();
+  if (auto *trace = SystemRuntime::Get().GetTraceWriter()) {
+    trace->WriteMemory(time, status, metrics);
+  }
+  ApplySample(status, metrics, time);
 }
 
-void MemoryPerformance::UpdatePmc() {
-  PROCESS_MEMORY_COUNTERS_EX pmc{};
-  mPmc = pmc;
+void MemoryPerformance::ReplaySample(const MemoryStatus &status,
+                                     const ProcessMetrics &metrics,
+                                     const int64_t time) {
+  ApplySample(status, metrics, time);
+}
 
-  const auto hProcess = GetCurrentProcess();
-  do {
-    ZeroMemory(&mPmc, sizeof(PROCESS_MEMORY_COUNTERS_EX));
-    GetProcessMemoryInfo(hProcess, (PROCESS_MEMORY_COUNTERS *)&mPmc,
-                         sizeof(mPmc));
-  } while (IsRunning() && Time::Sleep(mUpdateInterval));
+void MemoryPerformance::ApplySample(const MemoryStatus &status,
+                                    const ProcessMetrics &metrics,
+                                    const int64_t time) {
+  mMemoryInfo.Publish(status);
+  mProcessMetrics.Publish(metrics);
+  RecordHistory(status, metrics, time);
+}
+
+void MemoryPerformance::RecordHistory(const MemoryStatus &status,
+                                      const ProcessMetrics &metrics,
+                                      const int64_t time) {
+  auto &history = SystemRuntime::Get().GetHistory();
+  if (mUsedSeries == MetricHistory::INVALID_SERIES) {
+    mUsedSeries = history.Register("memory.used");
+    mLoadSeries = history.Register("memory.load");
+    mSelfSeries = history.Register("memory.self");
+  }
 
-  CloseHandle(hProcess);
-  ZeroMemory(&mPmc, sizeof(PROCESS_MEMORY_COUNTERS_EX));
+  const MetricHistory::SeriesId ids[] = {mUsedSeries, mLoadSeries,
+                                         mSelfSeries};
+  const double load =
+      status.TotalPhys ? (double)(status.TotalPhys - status.AvailPhys) /
+                             (double)status.TotalPhys * 100.0
+                       : 0.0;
+  const double values[] = {(double)(status.TotalPhys - status.AvailPhys), load,
+                           (double)metrics.WorkingSetSize};
+  history.Append(ids, values, 3, time);
 }
 
 } // namespace RESANA
@@ -1,18 +1,30 @@
 #pragma once
 
 #include "helpers/Time.h"
+#include <system/SampleScheduler.h>
+#include <system/Snapshot.h>
 #include <system/base/SystemObject.h>
+#include <system/history/MetricHistory.h>
+#include <system/processes/ProcessMetrics.h>
 
-#include <Windows.h>
 #include <memory>
 
-#include <Psapi.h>
-
 namespace RESANA {
 
 constexpr auto BYTES_PER_KB = 1024;
 constexpr auto BYTES_PER_MB = 1048576;
 
+// System wide memory counters in bytes
+struct MemoryStatus {
+  uint64_t TotalPhys{};
+  uint64_t AvailPhys{};
+  uint64_t TotalPageFile{};
+  uint64_t AvailPageFile{};
+  uint64_t TotalVirtual{};
+  uint64_t AvailVirtual{};
+  uint32_t MemoryLoad{}; // Percent of physical memory in use
+};
+
 class MemoryPerformance : public SystemObject {
 public:
   ~MemoryPerformance();
@@ -23,51 +35,68 @@ public:
   void Stop() override;
   void Shutdown() override;
 
-  static ULONG64 GetPrivateUsage(uint32_t procId);
-  static ULONG64 GetPrivateUsageKB(uint32_t procId);
-  static ULONG64 GetPrivateUsageMB(uint32_t procId);
-  static ULONG64 GetWorkingSetSize(uint32_t procId);
-  static ULONG64 GetWorkingSetSizeKB(uint32_t procId);
-  static ULONG64 GetWorkingSetSizeMB(uint32_t procId);
+  static uint64_t GetPrivateUsage(uint32_t procId);
+  static uint64_t GetPrivateUsageKB(uint32_t procId);
+  static uint64_t GetPrivateUsageMB(uint32_t procId);
+  static uint64_t GetWorkingSetSize(uint32_t procId);
+  static uint64_t GetWorkingSetSizeKB(uint32_t procId);
+  static uint64_t GetWorkingSetSizeMB(uint32_t procId);
 
-  static DWORD GetMemoryLoad(int);
+  static uint32_t GetMemoryLoad(int);
   [[nodiscard]] float GetMemoryLoad() const;
 
   /* Physical Memory */
-  [[nodiscard]] DWORDLONG GetTotalPhysical() const;
-  [[nodiscard]] DWORDLONG GetTotalPhysicalKB() const;
-  [[nodiscard]] DWORDLONG GetTotalPhysicalMB() const;
-  [[nodiscard]] DWORDLONG GetAvailPhysical() const;
-  [[nodiscard]] DWORDLONG GetAvailPhysicalKB() const;
-  [[nodiscard]] DWORDLONG GetAvailPhysicalMB() const;
-  [[nodiscard]] DWORDLONG GetUsedPhysical() const;
-  [[nodiscard]] DWORDLONG GetUsedPhysicalKB() const;
-  [[nodiscard]] DWORDLONG GetUsedPhysicalMB() const;
+  [[nodiscard]] uint64_t GetTotalPhysical() const;
+  [[nodiscard]] uint64_t GetTotalPhysicalKB() const;
+  [[nodiscard]] uint64_t GetTotalPhysicalMB() const;
+  [[nodiscard]] uint64_t GetAvailPhysical() const;
+  [[nodiscard]] uint64_t GetAvailPhysicalKB() const;
+  [[nodiscard]] uint64_t GetAvailPhysicalMB() const;
+  [[nodiscard]] uint64_t GetUsedPhysical() const;
+  [[nodiscard]] uint64_t GetUsedPhysicalKB() const;
+  [[nodiscard]] uint64_t GetUsedPhysicalMB() const;
 
   /* Virtual Memory */
-  [[nodiscard]] DWORDLONG GetTotalVirtual() const;
-  [[nodiscard]] DWORDLONG GetAvailVirtual() const;
-  [[nodiscard]] DWORDLONG GetUsedVirtual() const;
-  [[nodiscard]] SIZE_T GetCurrProcUsageVirtual() const;
+  [[nodiscard]] uint64_t GetTotalVirtual() const;
+  [[nodiscard]] uint64_t GetAvailVirtual() const;
+  [[nodiscard]] uint64_t GetUsedVirtual() const;
+  [[nodiscard]] uint64_t GetCurrProcUsageVirtual() const;
+  [[nodiscard]] uint64_t GetCurrProcWorkingSet() const;
 
   [[nodiscard]] bool IsRunning() const { return mRunning; }
 
   void SetUpdateInterval(Timestep interval = TimeTick::Rate::Normal);
 
+  // Takes a sample read from a trace in place of one from the OS
+  void ReplaySample(const MemoryStatus &status, const ProcessMetrics &metrics,
+                    int64_t time);
+
 private:
   MemoryPerformance();
-  void UpdateMemoryInfo();
-  void UpdatePmc();
+  // Fired by the sample scheduler
+  void SampleTick();
+  // Publishes the sample and records it into the metric history
+  void ApplySample(const MemoryStatus &status, const ProcessMetrics &metrics,
+                   int64_t time);
+  void RecordHistory(const MemoryStatus &status, const ProcessMetrics &metrics,
+                     int64_t time);
 
-  static void GetProcessMemoryInformation(PROCESS_MEMORY_COUNTERS_EX &dest,
-                                          uint32_t procId);
+  // Implemented per platform
+  static bool QueryMemoryStatus(MemoryStatus &status);
 
 private:
-  MEMORYSTATUSEX mMemoryInfo{};
-  PROCESS_MEMORY_COUNTERS_EX mPmc{};
+  // Written by the sampler threads, read from any thread without locking
+  SnapshotPublisher<MemoryStatus> mMemoryInfo{};
+  SnapshotPublisher<ProcessMetrics> mProcessMetrics{};
   uint32_t mUpdateInterval{};
+  SampleScheduler::TaskId mSampleTask{};
   bool mRunning = false;
 
+  // History series; registered on the first sample
+  MetricHistory::SeriesId mUsedSeries = MetricHistory::INVALID_SERIES;
+  MetricHistory::SeriesId mLoadSeries = MetricHistory::INVALID_SERIES;
+  MetricHistory::SeriesId mSelfSeries = MetricHistory::INVALID_SERIES;
+
   static std::shared_ptr<MemoryPerformance> sInstance;
 };
 
@@ -6,12 +6,17 @@ namespace RESANA {
 
 Process::Process() { mName = "Process " + std::to_string(sDefaultId++); }
 
+#ifdef RS_PLATFORM_WINDOWS
 Process::Process(const PROCESSENTRY32 &pe32) { *this = pe32; }
+#else
+Process::Process(const ProcPidStat &stat) { *this = stat; }
+#endif
 
 Process::Process(const Process *process) { *this = process; }
 
 Process::~Process() = default;
 
+#ifdef RS_PLATFORM_WINDOWS
 Process &Process::operator=(const PROCESSENTRY32 &pe32) {
   mData = std::make_shared<PdhData>();
   mName = pe32.szExeFile;
@@ -23,11 +28,27 @@ Process &Process::operator=(const PROCESSENTRY32 &pe32) {
   mFlags = pe32.dwFlags;
   return *this;
 }
+#else
+Process &Process::operator=(const ProcPidStat &stat) {
+  mData = std::make_shared<PdhData>();
+  mData->Handle = (int)stat.Id;
+  mData->CreationTime = ProcTicksToNanoseconds(stat.StartTicks);
+  mName = stat.Name;
+  mId = stat.Id;
+  mParentId = stat.ParentId;
+  mModuleId = 0;
+  mThreadCount = stat.ThreadCount;
+  mPriorityClass = (uint32_t)stat.Priority;
+  mFlags = 0;
+  return *this;
+}
+#endif
 
 Process &Process::operator=(const Process *process) {
   if (!process) {
     mData.reset();
     mName = "Process " + std::to_string(sDefaultId++);
+    mCommandLine.clear();
     mId = 0;
     mParentId = 0;
     mModuleId = 0;
@@ -35,11 +56,15 @@ Process &Process::operator=(const Process *process) {
     mPriorityClass = 0;
     mWorkingSetSize = 0;
     mPrivateUsage = 0;
+    mReadBytes = 0;
+    mWriteBytes = 0;
     mFlags = 0;
     mCpuLoad = 0;
   } else {
-    mData = std::make_shared<PdhData>(*process->mData);
+    mData = process->mData ? std::make_shared<PdhData>(*process->mData)
+                           : std::make_shared<PdhData>();
     mName = process->mName;
+    mCommandLine = process->mCommandLine;
     mId = process->mId;
     mParentId = process->mParentId;
     mModuleId = process->mModuleId;
@@ -47,8 +72,10 @@ Process &Process::operator=(const Process *process) {
     mPriorityClass = process->mPriorityClass;
     mWorkingSetSize = process->mWorkingSetSize;
     mPrivateUsage = process->mPrivateUsage;
+    mReadBytes = process->mReadBytes;
+    mWriteBytes = process->mWriteBytes;
     mFlags = process->mFlags;
-    mCpuLoad = process->mCpuLoad._Storage._Value;
+    mCpuLoad = process->mCpuLoad.load();
   }
   return *this;
 }
@@ -1,8 +1,18 @@
 #pragma once
 
-#include <TlHelp32.h>
+#include "core/PlatformDetection.h"
+
 #include <system/cpu/LogicalCoreData.h>
 
+#include <atomic>
+#include <string>
+
+#ifdef RS_PLATFORM_WINDOWS
+#include <TlHelp32.h>
+#else
+#include "platform/linux/ProcPidStat.h"
+#endif
+
 namespace RESANA {
 
 class ProcessEntry;
@@ -10,15 +20,24 @@ class ProcessEntry;
 class Process {
 public:
   Process();
+#ifdef RS_PLATFORM_WINDOWS
   Process(const PROCESSENTRY32 &pe32);
+#else
+  Process(const ProcPidStat &stat);
+#endif
   Process(const Process *process);
   ~Process();
 
+#ifdef RS_PLATFORM_WINDOWS
   Process &operator=(const PROCESSENTRY32 &pe32);
+#else
+  Process &operator=(const ProcPidStat &stat);
+#endif
   Process &operator=(const Process *process);
 
 protected:
   std::string mName;
+  std::string mCommandLine; // Read once, when the process is first seen
   uint32_t mId{};
   uint32_t mParentId{};
   uint32_t mModuleId{};
@@ -27,6 +46,8 @@ protected:
   uint32_t mFlags{};
   uint64_t mPrivateUsage{};
   uint64_t mWorkingSetSize{};
+  uint64_t mReadBytes{};
+  uint64_t mWriteBytes{};
   std::atomic<double> mCpuLoad{0};
   std::shared_ptr<PdhData> mData = nullptr;
   bool mRunning = true;
@@ -2,21 +2,26 @@
 #include "rspch.h"
 
 #include "ProcessEntry.h"
+#include "ProcessTable.h"
 
 namespace RESANA {
 
 ProcessContainer::ProcessContainer() = default;
 
 ProcessContainer::ProcessContainer(const ProcessContainer &other)
-    : mEntries(other.mEntries), mSelectedEntry(other.GetSelectedEntry()) {}
+    : mEntries(other.mEntries), mIndex(other.mIndex),
+      mNumErased(other.mNumErased), mSelectedEntry(other.GetSelectedEntry()) {}
 
 ProcessContainer::~ProcessContainer() { Clear(mMutex); };
 
-int ProcessContainer::GetNumEntries() const { return (int)mEntries.size(); }
+int ProcessContainer::GetNumEntries() const {
+  return (int)(mEntries.size() - mNumErased);
+}
 
 std::mutex &ProcessContainer::GetMutex() { return mMutex; }
 
 std::vector<std::shared_ptr<ProcessEntry>> &ProcessContainer::GetEntries() {
+  Compact();
   return mEntries;
 }
 
@@ -34,20 +39,97 @@ ProcessContainer::FindEntry(const std::shared_ptr<ProcessEntry> &entry) const {
 
 std::shared_ptr<ProcessEntry>
 ProcessContainer::FindEntry(uint32_t procId) const {
-  for (auto &proc : mEntries) {
-    if (proc->GetId() == procId) {
-      return proc;
-    }
+  const auto it = mIndex.find(procId);
+  if (it == mIndex.end()) {
+    return nullptr;
   }
 
-  return nullptr;
+  // The entries were reordered without a Reindex()
+  auto index = it->second.Index;
+  if (index >= mEntries.size() || !mEntries[index] ||
+      mEntries[index]->GetId() != procId) {
+    Reindex();
+    index = it->second.Index;
+  }
+  return index < mEntries.size() ? mEntries[index] : nullptr;
+}
+
+int ProcessContainer::FindIndex(uint32_t procId) {
+  Compact();
+  const auto it = mIndex.find(procId);
+  return it == mIndex.end() ? -1 : (int)it->second.Index;
 }
 
 void ProcessContainer::AddEntry(std::shared_ptr<ProcessEntry> &entry) {
+  if (!entry) {
+    return;
+  }
+
+  mIndex[entry->GetId()] = {(uint32_t)mEntries.size(), mSyncTick};
   mEntries.emplace_back(entry);
   SetDirty();
 }
 
+void ProcessContainer::Reindex() const {
+  for (uint32_t i = 0; i < (uint32_t)mEntries.size(); ++i) {
+    if (mEntries[i]) {
+      mIndex[mEntries[i]->GetId()].Index = i;
+    }
+  }
+}
+
+void ProcessContainer::Sync(const ProcessColumns &processes,
+                            uint64_t version) {
+  ++mSyncTick;
+  mSyncVersion = version;
+  mIndex.reserve(processes.Size());
+
+  size_t synced = 0;
+  for (size_t row = 0; row < processes.Size(); ++row) {
+    const auto procId = processes.Id[row];
+    if (auto existing = FindEntry(procId)) {
+      existing->Assign(processes, row);
+      mIndex[procId].SyncTick = mSyncTick;
+    } else {
+      auto entry = std::make_shared<ProcessEntry>();
+      entry->Assign(processes, row);
+      AddEntry(entry);
+    }
+    ++synced;
+  }
+
+  if (synced == mEntries.size()) {
+    return;
+  }
+
+  // Drop the processes that exited, keeping the current order
+  auto isStale = [&](const std::shared_ptr<ProcessEntry> &entry) {
+    if (!entry) {
+      return true;
+    }
+
+    const auto it = mIndex.find(entry->GetId());
+    if (it == mIndex.end()) {
+      return true;
+    }
+    if (it->second.SyncTick == mSyncTick) {
+      return false;
+    }
+
+    if (entry == mSelectedEntry) {
+      mSelectedEntry = nullptr;
+    }
+    mIndex.erase(it);
+    return true;
+  };
+  mEntries.erase(std::remove_if(mEntries.begin(), mEntries.end(), isStale),
+                 mEntries.end());
+  mNumErased = 0;
+
+  Reindex();
+  SetDirty();
+}
+
 void ProcessContainer::SelectEntry(const uint32_t procId, bool preserve) {
   if (const auto entry = FindEntry(procId); entry) {
     if (mSelectedEntry) {
@@ -82,20 +164,32 @@ void ProcessContainer::EraseEntry(std::shared_ptr<ProcessEntry> &entry) {
     return;
   }
 
-  for (auto it = mEntries.begin(); it != mEntries.end(); ++it) {
-    if (auto &proc = mEntries.at(
-            reinterpret_cast<
-                std::vector<std::shared_ptr<ProcessEntry>>::size_type>(&it));
-        proc->GetId() == entry->GetId()) {
-      proc.reset();
-      proc = nullptr;
-      break;
-    }
+  const auto procId = entry->GetId();
+  if (!FindEntry(procId)) {
+    return;
   }
 
+  const auto index = mIndex[procId].Index;
+  if (mEntries[index] == mSelectedEntry) {
+    mSelectedEntry = nullptr;
+  }
+  mEntries[index] = nullptr;
+  mIndex.erase(procId);
+  ++mNumErased;
   SetDirty();
 }
 
+void ProcessContainer::Compact() {
+  if (mNumErased == 0) {
+    return;
+  }
+
+  mEntries.erase(std::remove(mEntries.begin(), mEntries.end(), nullptr),
+                 mEntries.end());
+  mNumErased = 0;
+  Reindex();
+}
+
 void ProcessContainer::Copy(ProcessContainer &other) {
   if (this == &other) {
     return;
@@ -108,7 +202,8 @@ void ProcessContainer::Copy(ProcessContainer &other) {
   std::scoped_lock lock2(other.GetMutex());
 
   for (const auto &entry : other.GetEntries()) {
-    mEntries.emplace_back(std::make_shared<ProcessEntry>(entry));
+    auto copy = std::make_shared<ProcessEntry>(entry);
+    AddEntry(copy);
   }
 
   SetDirty();
@@ -117,6 +212,8 @@ void ProcessContainer::Copy(ProcessContainer &other) {
 ProcessContainer &ProcessContainer::operator=(const ProcessContainer &other) {
   if (this != &other) {
     mEntries = other.mEntries;
+    mIndex = other.mIndex;
+    mNumErased = other.mNumErased;
     mDirty = other.mDirty;
 
     mSelectedEntry = other.mSelectedEntry;
@@ -125,13 +222,6 @@ ProcessContainer &ProcessContainer::operator=(const ProcessContainer &other) {
   return *this;
 }
 
-void ProcessContainer::UpdateEntries() {
-  std::scoped_lock lock1(mMutex);
-  for (auto &entry : mEntries) {
-    entry->UpdatePerfStats();
-  }
-}
-
 bool ProcessContainer::Contains(uint32_t procId) const {
   if (auto proc = FindEntry(procId)) {
     return true;
@@ -1,12 +1,16 @@
 #pragma once
 
 #include <mutex>
+#include <unordered_map>
 #include <vector>
 
 #include "ProcessEntry.h"
 
 namespace RESANA {
 class ProcessEntry;
+struct ProcessColumns;
+
+using ProcessList = std::vector<std::shared_ptr<ProcessEntry>>;
 
 class ProcessContainer {
 public:
@@ -17,19 +21,34 @@ public:
   std::mutex &GetMutex();
   [[nodiscard]] int GetNumEntries() const;
 
+  // Drops the slots of erased entries first
   std::vector<std::shared_ptr<ProcessEntry>> &GetEntries();
   [[nodiscard]] std::shared_ptr<ProcessEntry> GetSelectedEntry() const;
   [[nodiscard]] std::shared_ptr<ProcessEntry>
   FindEntry(const std::shared_ptr<ProcessEntry> &entry) const;
   [[nodiscard]] std::shared_ptr<ProcessEntry> FindEntry(uint32_t procId) const;
+  // Position of the process in GetEntries(), or -1
+  [[nodiscard]] int FindIndex(uint32_t procId);
 
   void AddEntry(std::shared_ptr<ProcessEntry> &entry);
   void SelectEntry(uint32_t procId, bool preserve = false);
   void SelectEntry(std::shared_ptr<ProcessEntry> &entry, bool preserve = false);
+  // Empties the entry's slot; the entries are compacted on the next Sync()
+  // or GetEntries(), so a run of erases costs one pass over them
   void EraseEntry(std::shared_ptr<ProcessEntry> &entry);
   void Copy(ProcessContainer &other);
 
-  void UpdateEntries();
+  // Makes the entries a copy of the published processes: existing entries are
+  // updated in place, new pids are appended and pids no longer listed are
+  // removed. Linear in the number of processes. The caller holds the mutex.
+  void Sync(const ProcessColumns &processes, uint64_t version);
+  // Version passed to the last Sync()
+  [[nodiscard]] uint64_t GetSyncVersion() const { return mSyncVersion; }
+
+  // Should be called after the entries were reordered, e.g. sorted. A lookup
+  // that finds a stale position reindexes as well.
+  void Reindex() const;
+
   void SetClean() { mDirty = false; }
   void SetDirty() { mDirty = true; }
   bool IsDirty() const { return mDirty; }
@@ -41,7 +60,20 @@ public:
   ProcessContainer &operator=(const ProcessContainer &other);
 
 private:
+  void Compact();
+
+private:
+  struct Slot {
+    uint32_t Index{};
+    uint32_t SyncTick{}; // Last Sync() that saw this pid
+  };
+
   std::vector<std::shared_ptr<ProcessEntry>> mEntries{};
+  // pid -> position in mEntries; lookups fix up stale positions
+  mutable std::unordered_map<uint32_t, Slot> mIndex{};
+  size_t mNumErased{}; // Emptied slots in mEntries
+  uint32_t mSyncTick{};
+  uint64_t mSyncVersion{};
   std::mutex mMutex{};
   bool mDirty = false;
 
@@ -56,6 +88,8 @@ template <class _MutTy> void ProcessContainer::Clear(_MutTy &mutex) {
   }
 
   mEntries.clear();
+  mIndex.clear();
+  mNumErased = 0;
 }
 
 } // namespace RESANA
@@ -2,21 +2,45 @@
 
 #include <memory>
 
-#include "system/cpu/CpuPerformance.h"
-#include "system/memory/MemoryPerformance.h"
+#include "ProcessTable.h"
 
 namespace RESANA {
 
-ProcessEntry::ProcessEntry(const PROCESSENTRY32 &pe32)
-    : Process(pe32), mLock(mMutex, std::defer_lock) {
-
+namespace {
+
+// The Status column: stopped or traced, and zombie or dead processes are not
+// running; sleeping ones are. 0 is a free row.
+bool IsRunningState(const char state) {
+  switch (state) {
+  case 0:
+  case 'T':
+  case 't':
+  case 'Z':
+  case 'X':
+  case 'x':
+    return false;
+  default:
+    return true;
+  }
 }
 
+} // namespace
+
+ProcessEntry::ProcessEntry() = default;
+
+#ifdef RS_PLATFORM_WINDOWS
+ProcessEntry::ProcessEntry(const PROCESSENTRY32 &pe32)
+    : Process(pe32) {}
+#else
+ProcessEntry::ProcessEntry(const ProcPidStat &stat)
+    : Process(stat) {}
+#endif
+
 ProcessEntry::ProcessEntry(const std::shared_ptr<Process> &process)
-    : Process(process.get()), mLock(mMutex, std::defer_lock) {}
+    : Process(process.get()) {}
 
 ProcessEntry::ProcessEntry(const std::shared_ptr<ProcessEntry> &entry)
-    : Process(entry.get()), mLock(mMutex, std::defer_lock) {
+    : Process(entry.get()) {
   mRunning = entry->IsRunning();
 }
 
@@ -29,10 +53,16 @@ std::shared_ptr<PdhData> ProcessEntry::GetData() const { return this->mData; }
 
 double ProcessEntry::GetCpuLoad() const { return this->mCpuLoad; }
 
+uint64_t ProcessEntry::GetCreationTime() const {
+  return this->mData ? this->mData->CreationTime : 0;
+}
+
 ProcessEntry &ProcessEntry::operator=(ProcessEntry *entry) {
   if (entry) {
     std::scoped_lock slock(entry->mMutex);
     this->mName = entry->GetName();
+    this->mNameGeneration = NextNameGeneration();
+    this->mCommandLine = entry->GetCommandLine();
     this->mId = entry->GetId();
     this->mParentId = entry->GetParentId();
     this->mModuleId = entry->GetModuleId();
@@ -51,6 +81,35 @@ ProcessEntry &ProcessEntry::operator=(ProcessEntry *entry) {
   return *this;
 }
 
+void ProcessEntry::Assign(const ProcessColumns &columns, const size_t row) {
+  std::scoped_lock slock(mMutex);
+  if (!this->mData) {
+    this->mData = std::make_shared<PdhData>();
+  }
+
+  // A new entry, or the pid now belongs to another process
+  if (this->mId != columns.Id[row] ||
+      this->mData->CreationTime != columns.CreationTime[row]) {
+    this->mCommandLine.assign(columns.GetCommandLine(row));
+    this->mData->CreationTime = columns.CreationTime[row];
+  }
+  if (const auto name = columns.GetName(row); this->mName != name) {
+    this->mName.assign(name);
+    this->mNameGeneration = NextNameGeneration();
+  }
+
+  this->mId = columns.Id[row];
+  this->mParentId = columns.ParentId[row];
+  this->mThreadCount = columns.ThreadCount[row];
+  this->mPriorityClass = columns.PriorityClass[row];
+  this->mWorkingSetSize = columns.WorkingSetSize[row];
+  this->mPrivateUsage = columns.PrivateUsage[row];
+  this->mReadBytes = columns.ReadBytes[row];
+  this->mWriteBytes = columns.WriteBytes[row];
+  this->mCpuLoad = columns.CpuLoad[row];
+  this->mRunning = IsRunningState(columns.State[row]);
+}
+
 ProcessEntry &ProcessEntry::operator=(Process *other) {
   std::mutex mutex;
   std::lock(mutex, mMutex);
@@ -74,12 +133,9 @@ void ProcessEntry::SetData(std::shared_ptr<PdhData> &data) {
 
 void ProcessEntry::SetCpuLoad(float load) { this->mCpuLoad = load; }
 
-void ProcessEntry::UpdatePerfStats() {
-  std::scoped_lock slock(mMutex);
-  this->mWorkingSetSize =
-      (uint32_t)MemoryPerformance::GetPrivateUsage(this->mId);
-  this->mPrivateUsage =
-      (uint32_t)MemoryPerformance::GetWorkingSetSize(this->mId);
-  this->mCpuLoad = CpuPerformance::GetProcessLoad(this->mId, this->mData.get());
+uint32_t ProcessEntry::NextNameGeneration() {
+  static std::atomic<uint32_t> sNameGeneration{0};
+  return ++sNameGeneration;
 }
+
 } // namespace RESANA
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Process.h"
+#include "ProcessMetrics.h"
+
 #include <atomic>
 #include <mutex>
 #include <string>
@@ -8,18 +10,27 @@
 namespace RESANA {
 
 struct PdhData;
+struct ProcessColumns;
 
 class ProcessEntry : public Process {
 public:
+  ProcessEntry();
+#ifdef RS_PLATFORM_WINDOWS
   ProcessEntry(const PROCESSENTRY32 &pe32);
+#else
+  ProcessEntry(const ProcPidStat &stat);
+#endif
   ProcessEntry(const std::shared_ptr<Process> &process);
   ProcessEntry(const std::shared_ptr<ProcessEntry> &entry);
   ~ProcessEntry();
 
   [[nodiscard]] std::shared_ptr<PdhData> GetData() const;
   [[nodiscard]] double GetCpuLoad() const;
+  // 0 if the entry was never sampled
+  [[nodiscard]] uint64_t GetCreationTime() const;
 
-  std::string GetName() const { return mName; }
+  const std::string &GetName() const { return mName; }
+  const std::string &GetCommandLine() const { return mCommandLine; }
   uint32_t GetId() const { return mId; }
   uint32_t GetParentId() const { return mParentId; }
   uint32_t GetModuleId() const { return mModuleId; }
@@ -28,10 +39,18 @@ public:
   uint32_t GetFlags() const { return mFlags; }
   uint64_t GetPrivateUsage() const { return mPrivateUsage; }
   uint64_t GetWorkingSetSize() const { return mWorkingSetSize; }
+  uint64_t GetReadBytes() const { return mReadBytes; }
+  uint64_t GetWriteBytes() const { return mWriteBytes; }
   std::shared_ptr<PdhData> GetData() { return this->mData; }
   bool IsRunning() const { return mRunning; }
+  // Changes with the name, and no two entries share one
+  uint32_t GetNameGeneration() const { return mNameGeneration; }
 
-  void SetName()  { mName; }
+  void SetName(const std::string &name) {
+    mName = name;
+    mNameGeneration = NextNameGeneration();
+  }
+  void SetCommandLine(const std::string &commandLine)  { mCommandLine = commandLine; }
   void SetId(uint32_t id)  { mId = id; }
   void SetParentId(uint32_t id)  { mParentId = id; }
   void SetModuleId(uint32_t id)  { mModuleId = id; }
@@ -43,11 +62,13 @@ public:
   void SetData(std::shared_ptr<PdhData>& data);
   void SetCpuLoad(float load);
 
-  void UpdatePerfStats();
-
   std::recursive_mutex &Mutex() { return mMutex; }
   [[nodiscard]] bool IsSelected() const { return mSelected; }
 
+  // Copies one row of a published sample, keeping the selection. The command
+  // line is only copied when the row is a different process than before.
+  void Assign(const ProcessColumns &columns, size_t row);
+
   // Overloads
   ProcessEntry &operator=(ProcessEntry *entry);
   ProcessEntry &operator=(Process *other);
@@ -56,9 +77,11 @@ private:
   void Select() { mSelected = true; }
   void Deselect() { mSelected = false; }
 
+  static uint32_t NextNameGeneration();
+
 private:
   std::recursive_mutex mMutex{};
-  std::unique_lock<std::recursive_mutex> mLock{};
+  uint32_t mNameGeneration = NextNameGeneration();
   std::atomic<bool> mRunning{true};
   std::atomic<bool> mSelected{false};
 
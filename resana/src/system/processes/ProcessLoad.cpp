@@ -0,0 +1,162 @@
+#include "ProcessLoad.h"
+#include "rspch.h"
+
+#ifdef RS_PROCESS_LOAD_AVX2
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define RS_TARGET_AVX2
+#else
+#define RS_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace RESANA {
+
+namespace {
+
+// Smoothing in double, then rounded once, as the vector path does
+inline float SmoothLoad(const float load, const double sample,
+                        const double smoothing) {
+  const double previous = load;
+  return (float)(previous + smoothing * (sample - previous));
+}
+
+#ifdef RS_PROCESS_LOAD_AVX2
+bool DetectAvx2() {
+#ifdef _MSC_VER
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7) {
+    return false;
+  }
+
+  // The OS must save the YMM registers
+  __cpuid(info, 1);
+  const bool osxsave = (info[2] & (1 << 27)) != 0;
+  if (!osxsave || (_xgetbv(0) & 0x6) != 0x6) {
+    return false;
+  }
+
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  // May run before the constructor that initializes the CPU model
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+using UpdateFn = void (*)(const ProcessLoadColumns &,
+                          const ProcessLoadParams &);
+
+UpdateFn SelectUpdate() {
+#ifdef RS_PROCESS_LOAD_AVX2
+  if (DetectAvx2()) {
+    return UpdateProcessLoadsAvx2;
+  }
+#endif
+  return UpdateProcessLoadsScalar;
+}
+
+const UpdateFn sUpdate = SelectUpdate();
+
+} // namespace
+
+void UpdateProcessLoads(const ProcessLoadColumns &columns,
+                        const ProcessLoadParams &params) {
+  sUpdate(columns, params);
+}
+
+bool HasProcessLoadAvx2() {
+#ifdef RS_PROCESS_LOAD_AVX2
+  return sUpdate == UpdateProcessLoadsAvx2;
+#else
+  return false;
+#endif
+}
+
+void UpdateProcessLoadsScalar(const ProcessLoadColumns &columns,
+                              const ProcessLoadParams &params) {
+  const double smoothing = params.Smoothing;
+  for (size_t i = 0; i < columns.Count; ++i) {
+    const double sample =
+        CalcLoadSample(columns.CpuTime[i], columns.LastCpuTime[i],
+                       columns.SampleTime[i], columns.LastSampleTime[i],
+                       params.Scale);
+    columns.Load[i] = SmoothLoad(columns.Load[i], sample, smoothing);
+    columns.LastCpuTime[i] = columns.CpuTime[i];
+    columns.LastSampleTime[i] = columns.SampleTime[i];
+  }
+}
+
+#ifdef RS_PROCESS_LOAD_AVX2
+RS_TARGET_AVX2
+void UpdateProcessLoadsAvx2(const ProcessLoadColumns &columns,
+                            const ProcessLoadParams &params) {
+  // AVX2 has no 64-bit integer to double conversion. A delta below 2^52
+  // placed in the mantissa of 2^52 converts exactly: bits(2^52) | x is
+  // 2^52 + x.
+  const __m256i magicBits = _mm256_set1_epi64x(0x4330000000000000ll);
+  const __m256d magic = _mm256_set1_pd(4503599627370496.0); // 2^52
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256d scale = _mm256_set1_pd(params.Scale);
+  const __m256d maxLoad = _mm256_set1_pd(100.0);
+  const __m256d smoothing = _mm256_set1_pd(params.Smoothing);
+
+  size_t i = 0;
+  for (; i + 4 <= columns.Count; i += 4) {
+    const __m256i cpuTime =
+        _mm256_loadu_si256((const __m256i *)(columns.CpuTime + i));
+    const __m256i lastCpuTime =
+        _mm256_loadu_si256((const __m256i *)(columns.LastCpuTime + i));
+    const __m256i time =
+        _mm256_loadu_si256((const __m256i *)(columns.SampleTime + i));
+    const __m256i lastTime =
+        _mm256_loadu_si256((const __m256i *)(columns.LastSampleTime + i));
+
+    const __m256i busy = _mm256_sub_epi64(cpuTime, lastCpuTime);
+    const __m256i elapsed = _mm256_sub_epi64(time, lastTime);
+
+    // Both deltas below 2^52 and some time elapsed
+    const __m256i high = _mm256_or_si256(_mm256_srli_epi64(busy, 52),
+                                         _mm256_srli_epi64(elapsed, 52));
+    const __m256i valid =
+        _mm256_andnot_si256(_mm256_cmpeq_epi64(elapsed, zero),
+                            _mm256_cmpeq_epi64(high, zero));
+
+    const __m256d busyTime = _mm256_sub_pd(
+        _mm256_castsi256_pd(_mm256_or_si256(busy, magicBits)), magic);
+    const __m256d elapsedTime = _mm256_sub_pd(
+        _mm256_castsi256_pd(_mm256_or_si256(elapsed, magicBits)), magic);
+
+    __m256d sample =
+        _mm256_mul_pd(_mm256_div_pd(busyTime, elapsedTime), scale);
+    sample = _mm256_min_pd(sample, maxLoad);
+    // Clears the lanes that divided by zero as well
+    sample = _mm256_and_pd(sample, _mm256_castsi256_pd(valid));
+
+    const __m256d previous = _mm256_cvtps_pd(_mm_loadu_ps(columns.Load + i));
+    const __m256d smoothed = _mm256_add_pd(
+        previous, _mm256_mul_pd(smoothing, _mm256_sub_pd(sample, previous)));
+    _mm_storeu_ps(columns.Load + i, _mm256_cvtpd_ps(smoothed));
+
+    _mm256_storeu_si256((__m256i *)(columns.LastCpuTime + i), cpuTime);
+    _mm256_storeu_si256((__m256i *)(columns.LastSampleTime + i), time);
+  }
+
+  const double scalarSmoothing = params.Smoothing;
+  for (; i < columns.Count; ++i) {
+    const double sample =
+        CalcLoadSample(columns.CpuTime[i], columns.LastCpuTime[i],
+                       columns.SampleTime[i], columns.LastSampleTime[i],
+                       params.Scale);
+    columns.Load[i] = SmoothLoad(columns.Load[i], sample, scalarSmoothing);
+    columns.LastCpuTime[i] = columns.CpuTime[i];
+    columns.LastSampleTime[i] = columns.SampleTime[i];
+  }
+}
+#endif
+
+} // namespace RESANA
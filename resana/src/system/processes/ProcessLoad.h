@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define RS_PROCESS_LOAD_AVX2
+#endif
+
+namespace RESANA {
+
+struct ProcessLoadParams {
+  double Scale = 100.0;   // Percent per unit of CPU time over wall time
+  float Smoothing = 1.0f; // Weight of the new sample in the average; 1 is off
+};
+
+// The counter columns of a process table. CpuTime is user plus system time.
+// Last* hold the previous sample and are advanced to the current one.
+struct ProcessLoadColumns {
+  const uint64_t *CpuTime = nullptr;
+  uint64_t *LastCpuTime = nullptr;
+  const uint64_t *SampleTime = nullptr;
+  uint64_t *LastSampleTime = nullptr;
+  float *Load = nullptr; // Smoothed load in percent, updated in place
+  size_t Count{};
+};
+
+// Deltas beyond this are not a sample interval; they come from a counter
+// that was reset or a baseline that was never set
+constexpr uint64_t MAX_LOAD_DELTA = 1ull << 52;
+
+// The load of one process between two samples, in percent and clamped to
+// 100. The deltas are taken modulo 2^64, so a counter that wraps still
+// yields its true delta; one that went backwards, or a sample without
+// elapsed time, reads 0.
+inline double CalcLoadSample(const uint64_t cpuTime, const uint64_t lastCpuTime,
+                             const uint64_t time, const uint64_t lastTime,
+                             const double scale) {
+  const uint64_t busy = cpuTime - lastCpuTime;
+  const uint64_t elapsed = time - lastTime;
+  if (busy >= MAX_LOAD_DELTA || elapsed >= MAX_LOAD_DELTA || elapsed == 0) {
+    return 0.0;
+  }
+
+  const double load = (double)busy / (double)elapsed * scale;
+  return load < 100.0 ? load : 100.0;
+}
+
+// Computes the load of every row in one pass: deltas, percentage,
+// exponential smoothing (Load += Smoothing * (sample - Load)) and the wrap
+// handling of CalcLoadSample(). Uses AVX2 where the CPU has it; every path
+// gives bit-identical results.
+void UpdateProcessLoads(const ProcessLoadColumns &columns,
+                        const ProcessLoadParams &params);
+
+void UpdateProcessLoadsScalar(const ProcessLoadColumns &columns,
+                              const ProcessLoadParams &params);
+#ifdef RS_PROCESS_LOAD_AVX2
+void UpdateProcessLoadsAvx2(const ProcessLoadColumns &columns,
+                            const ProcessLoadParams &params);
+#endif
+
+// True if UpdateProcessLoads() takes the AVX2 path
+bool HasProcessLoadAvx2();
+
+} // namespace RESANA
@@ -3,34 +3,23 @@
 
 #include "core/Core.h"
 
-#include "helpers/FileUtils.h"
-#include "helpers/WinFuncs.h"
-
-#include <ProcessSnapshot.h>
-#include <TlHelp32.h>
-#include <Windows.h>
-
 #include <memory>
 
-#include "core/Application.h"
+#include "system/SystemRuntime.h"
+#include "system/trace/SampleTrace.h"
+
+#ifdef RS_PLATFORM_LINUX
+#include "platform/linux/ProcScanner.h"
+#endif
 
 namespace RESANA {
 
 std::shared_ptr<ProcessManager> ProcessManager::sInstance = nullptr;
 
 ProcessManager::ProcessManager()
-    : SystemObject(this), mUpdateInterval(TimeTick::Rate::Normal),
-      mDataBusy(false) {}
+    : SystemObject(this), mUpdateInterval(TimeTick::Rate::Normal) {}
 
 ProcessManager::~ProcessManager() {
-  Time::Sleep(mUpdateInterval); // Let detached threads finish before
-
-  std::mutex mutex;
-  std::unique_lock<std::mutex> lock(mutex);
-
-  while (mDataBusy) {
-    std::this_thread::yield();
-  }
   RS_CORE_TRACE("ProcessManager destroyed");
 }
 
@@ -45,7 +34,15 @@ std::shared_ptr<ProcessManager> ProcessManager::Get() {
 }
 
 void ProcessManager::SetUpdateInterval(Timestep interval) {
+  if ((uint32_t)interval == mUpdateInterval) {
+    return;
+  }
+
   mUpdateInterval = interval;
+  if (mSampleTask) {
+    SystemRuntime::Get().GetSampleScheduler().SetInterval(mSampleTask,
+                                                        mUpdateInterval);
+  }
 }
 
 uint32_t ProcessManager::GetUpdateSpeed() const { return mUpdateInterval; }
@@ -57,7 +54,10 @@ bool ProcessManager::IsRunning() const {
   return mRunning;
 }
 
-int ProcessManager::GetNumProcesses() { return mProcessMap.Size(); }
+int ProcessManager::GetNumProcesses() {
+  const auto processes = mPublished.Acquire();
+  return processes ? (int)processes->Size() : 0;
+}
 
 void ProcessManager::Run() {
   if (!sInstance) {
@@ -66,16 +66,20 @@ void ProcessManager::Run() {
 
   if (!IsRunning()) {
     mRunning = true;
-    auto &app = Application::Get();
-    auto &threadPool = app.GetThreadPool();
-    threadPool.Queue([&] { PrepareDataThread(); });
+    if (!SystemRuntime::Get().IsReplaying()) {
+      mSampleTask = SystemRuntime::Get().GetSampleScheduler().Add(
+          "processes", mUpdateInterval, [&] { SampleTick(); });
+    }
   }
 }
 
 void ProcessManager::Stop() {
   if (sInstance && IsRunning()) {
     mRunning = false;
-    mLockContainer.NotifyAll();
+    if (mSampleTask) {
+      SystemRuntime::Get().GetSampleScheduler().Remove(mSampleTask);
+      mSampleTask = {};
+    }
   }
 }
 
@@ -87,141 +91,186 @@ void ProcessManager::Shutdown() {
   }
 }
 
-void ProcessManager::PrepareDataThread() {
-  static std::mutex mutex;
-  std::unique_lock<std::mutex> lock(mutex, std::defer_lock);
-
-  while (!ShouldClose()) {
-    if (PrepareData()) {
-      mDataPrepared = true;
-      mLockContainer.NotifyAll();
-    }
-    if (!lock.owns_lock()) {
-      lock.lock();
-    }
-    mLockContainer.WaitFor(lock, mUpdateInterval);
+void ProcessManager::SampleTick() {
+  const int64_t time = Time::GetTime();
+  mTrace = SystemRuntime::Get().GetTraceWriter();
+  if (mTrace) {
+    mTrace->BeginProcesses(time);
   }
-}
-
-bool ProcessManager::PrepareData() {
-  HANDLE hProcessSnap;
-  PROCESSENTRY32 processEntry32{};
-  processEntry32.dwSize = sizeof(PROCESSENTRY32);
 
-  // Take a snapshot of all processes in the system.
-  hProcessSnap = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
-  if (hProcessSnap == INVALID_HANDLE_VALUE) {
-    PrintWin32Error("CreateToolhelp32Snapshot (of processes)");
-    return false;
+  const bool prepared = !ShouldClose() && PrepareData();
+  if (mTrace) {
+    mTrace->EndProcesses(prepared);
+    mTrace = nullptr;
   }
-
-  if (!Process32First(hProcessSnap, &processEntry32)) {
-    PrintWin32Error("Process32First");
-    CloseHandle(hProcessSnap); // clean the snapshot object
-    return false;
+  if (prepared) {
+    PublishProcesses(time);
   }
+}
 
-  ResetAllRunningStatus();
+void ProcessManager::ReplaySample(const TraceProcess *processes,
+                                  const size_t count, const int64_t time) {
+  if (ShouldClose()) {
+    return;
+  }
 
-  // Now walk the snapshot of processes, and
-  // get information about each process in turn
-  do {
-    if (ShouldClose()) {
-      return false;
+  // The same table updates as PrepareData, from the recorded list
+  mTable.BeginScan();
+  for (size_t i = 0; i < count; ++i) {
+    const auto &process = processes[i];
+    bool created = false;
+    const auto slot = mTable.Acquire(process.Id, process.CreationTime, created);
+    mTable.SetStatus(slot, process.ParentId, process.ThreadCount,
+                     process.PriorityClass, process.State);
+    mTable.SetName(slot, process.Name);
+    if (created) {
+      mTable.SetCommandLine(slot, process.CommandLine);
     }
-
-    std::lock_guard lock2(mProcessMap.GetMutex());
-
-    // Set process running status to true and update process, if applicable
-    if (!UpdateProcess((int)processEntry32.th32ProcessID)) {
-      // Otherwise, add new process
-      auto processEntry = std::make_shared<ProcessEntry>(
-          std::make_shared<Process>(processEntry32));
-      mProcessMap.Emplace(processEntry);
+    if (process.HasMetrics) {
+      mTable.ApplyMetrics(slot, process.Metrics);
     }
-  } while (Process32Next(hProcessSnap, &processEntry32));
-
-  CloseHandle(hProcessSnap);
+  }
+  mTable.EndScan();
+  mTable.UpdateCpuLoads();
 
-  return true;
+  PublishProcesses(time);
 }
 
-void ProcessManager::GetPreparedData(ProcessContainer &container) {
-  if ((ShouldClose() || !mDataPrepared) && GetNumProcesses() == 0) {
-    return;
+void ProcessManager::AddTraceProcess(const ProcessTable::Slot slot,
+                                     const uint64_t creationTime,
+                                     const bool created,
+                                     const ProcessMetrics *metrics) {
+  auto &process = mTrace->AddProcess();
+  process.Id = mTable.GetId(slot);
+  process.ParentId = mTable.GetParentId(slot);
+  process.ThreadCount = mTable.GetThreadCount(slot);
+  process.PriorityClass = mTable.GetPriorityClass(slot);
+  process.State = mTable.GetState(slot);
+  process.CreationTime = creationTime;
+  process.Name.assign(mTable.GetName(slot));
+
+  if (created) {
+    process.CommandLine.assign(mTable.GetCommandLine(slot));
+    process.HasCommandLine = true;
+  }
+  if (metrics) {
+    process.Metrics = *metrics;
+    process.HasMetrics = true;
   }
+}
 
-  std::mutex mutex;
-  std::unique_lock<std::mutex> lock(mutex);
+void ProcessManager::PublishProcesses(const int64_t time) {
+  mTable.Gather(mPublished.BeginPublish());
+  mPublished.CommitPublish();
 
-  if (mDataBusy) {
-    mLockContainer.Wait(lock, !mDataBusy);
-  }
-  lock.unlock();
+  RecordHistory(time);
+}
 
-  if (ShouldClose()) {
-    return;
+void ProcessManager::RecordHistory(const int64_t time) {
+  auto &history = SystemRuntime::Get().GetHistory();
+
+  const size_t numSlots = mTable.GetNumSlots();
+  if (mSeries.size() < numSlots) {
+    mSeries.resize(numSlots);
   }
 
-  mDataPrepared = false;
-  std::lock(container.GetMutex(), mProcessMap.GetMutex());
-  {
-    std::lock_guard lock1(container.GetMutex(), std::adopt_lock);
-    std::lock_guard lock2(mProcessMap.GetMutex(), std::adopt_lock);
+  mSeriesIds.clear();
+  mSeriesValues.clear();
+  for (ProcessTable::Slot slot = 0; slot < numSlots; ++slot) {
+    auto &series = mSeries[slot];
+    const bool live = mTable.IsLive(slot);
+
+    // The process exited, or its slot went to another one
+    if (series.Registered &&
+        (!live || series.ProcId != mTable.GetId(slot) ||
+         series.CreationTime != mTable.GetCreationTime(slot))) {
+      history.Remove(series.Cpu);
+      history.Remove(series.Memory);
+      series = {};
+    }
+    if (!live) {
+      continue;
+    }
 
-    for (auto &[id, entry] : mProcessMap) {
-      if (auto existing = container.FindEntry(id)) {
-        existing = entry;
-      } else {
-        auto copy = std::make_shared<ProcessEntry>(entry);
-        container.AddEntry(copy);
-      }
+    // Registered once; a process that found the history full goes without
+    if (!series.Registered) {
+      const auto prefix = "process." + std::to_string(mTable.GetId(slot));
+      series.ProcId = mTable.GetId(slot);
+      series.CreationTime = mTable.GetCreationTime(slot);
+      // Compressed, as there are thousands of these
+      series.Cpu = history.Register(prefix + ".cpu",
+                                    {false, SeriesEncoding::Float});
+      series.Memory = history.Register(prefix + ".memory",
+                                       {false, SeriesEncoding::Integer});
+      series.Registered = true;
     }
+
+    mSeriesIds.push_back(series.Cpu);
+    mSeriesValues.push_back(mTable.GetCpuLoad(slot));
+    mSeriesIds.push_back(series.Memory);
+    mSeriesValues.push_back((double)mTable.GetWorkingSetSize(slot));
   }
 
-  mDataPrepared = true;
-  mLockContainer.NotifyOne();
-}
+  history.Append(mSeriesIds.data(), mSeriesValues.data(), mSeriesIds.size(),
+                 time);
 
-bool ProcessManager::UpdateProcess(int procId) {
-  if (!mProcessMap.Contains(procId)) {
-    return false;
+  if (time - mRankingTime >= TOP_PROCESS_INTERVAL_MS) {
+    mRankingTime = time;
+    RankTopProcesses(history);
   }
-  if (auto proc = mProcessMap.Find(procId)) {
-    proc->UpdatePerfStats();
-    proc->mRunning = true;
-  }
-  return true;
 }
 
-void ProcessManager::CleanMap() {
-  std::mutex mutex;
-  std::lock(mutex, mProcessMap.GetMutex());
-  {
-    std::lock_guard lock(mutex, std::adopt_lock);
-    std::lock_guard lock2(mProcessMap.GetMutex(), std::adopt_lock);
+void ProcessManager::RankTopProcesses(MetricHistory &history) {
+  mRanking.clear();
+  for (ProcessTable::Slot slot = 0; slot < mSeries.size(); ++slot) {
+    if (mSeries[slot].Registered && mTable.IsLive(slot)) {
+      mRanking.emplace_back(mTable.GetCpuLoad(slot), slot);
+    }
+  }
 
-    // Remove any processes not currently running
-    for (auto it = mProcessMap.begin(); it != mProcessMap.end(); ++it) {
-      if (!it->second->IsRunning()) {
-        mProcessMap.Erase(it->second);
-        it = mProcessMap.begin(); // Reset iterator!
+  // A process gains rollups in the top N and keeps them until it leaves the
+  // top 2N, so the ones near the cut do not flap
+  const size_t top = history.GetConfig().TopProcesses;
+  const size_t keep = std::min(mRanking.size(), top * 2);
+  std::partial_sort(mRanking.begin(), mRanking.begin() + (ptrdiff_t)keep,
+                    mRanking.end(), [](const auto &left, const auto &right) {
+                      return left.first > right.first;
+                    });
+
+  for (size_t rank = 0; rank < mRanking.size(); ++rank) {
+    auto &series = mSeries[mRanking[rank].second];
+    if (rank < top && !series.Rollups) {
+      // Either may fail once MaxRollupSeries is reached. The pair is kept
+      // whole: the one that succeeded is dropped again, and both are retried
+      // on the next ranking.
+      const bool cpu = history.SetRollups(series.Cpu, true);
+      const bool memory = history.SetRollups(series.Memory, true);
+      series.Rollups = cpu && memory;
+      if (!series.Rollups) {
+        history.SetRollups(series.Cpu, false);
+        history.SetRollups(series.Memory, false);
       }
+    } else if (rank >= keep && series.Rollups) {
+      history.SetRollups(series.Cpu, false);
+      history.SetRollups(series.Memory, false);
+      series.Rollups = false;
     }
   }
 }
 
-void ProcessManager::ResetAllRunningStatus() {
-  std::mutex mutex;
-  std::lock(mutex, mProcessMap.GetMutex());
-  {
-    std::lock_guard lock(mutex, std::adopt_lock);
-    std::lock_guard lock2(mProcessMap.GetMutex(), std::adopt_lock);
+void ProcessManager::GetPreparedData(ProcessContainer &container) {
+  if (ShouldClose()) {
+    return;
+  }
 
-    for (const auto &[id, entry] : mProcessMap) {
-      entry->mRunning = false;
-    }
+  // Pins the last published list; the sampler keeps running meanwhile
+  const auto processes = mPublished.Acquire();
+  if (!processes || processes.GetVersion() == container.GetSyncVersion()) {
+    return;
   }
+
+  std::lock_guard lock(container.GetMutex());
+  container.Sync(*processes, processes.GetVersion());
 }
 
 void ProcessManager::SyncProcessContainer(ProcessContainer &container) {
@@ -229,10 +278,8 @@ void ProcessManager::SyncProcessContainer(ProcessContainer &container) {
     return;
   }
 
-  if (sInstance->GetNumProcesses() > 0) {
-    sInstance->GetPreparedData(container);
-    container.SetDirty();
-  }
+  sInstance->GetPreparedData(container);
+  container.SetDirty();
 }
 bool ProcessManager::ShouldClose() const { return !sInstance || !IsRunning(); }
 
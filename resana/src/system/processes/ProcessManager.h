@@ -1,10 +1,13 @@
 #pragma once
 
+#include "system/SampleScheduler.h"
+#include "system/Snapshot.h"
 #include "system/base/SystemObject.h"
+#include "system/history/MetricHistory.h"
 
 #include "ProcessContainer.h"
 #include "ProcessEntry.h"
-#include "ProcessMap.h"
+#include "ProcessTable.h"
 
 #include "helpers/Time.h"
 
@@ -12,6 +15,10 @@
 
 namespace RESANA {
 
+class ProcScanner;
+class SampleTraceWriter;
+struct TraceProcess;
+
 class ProcessManager final : public SystemObject {
 public:
   ~ProcessManager() override;
@@ -31,28 +38,63 @@ public:
 
   bool IsRunning() const;
 
+  // Takes a process list read from a trace in place of a scan
+  void ReplaySample(const TraceProcess *processes, size_t count, int64_t time);
+
 private:
   ProcessManager();
 
   static void Destroy();
   bool ShouldClose() const;
-  void PrepareDataThread();
+  // Fired by the sample scheduler
+  void SampleTick();
 
+  // Scans the running processes into the table
   bool PrepareData();
+  // Writes a process PrepareData listed to the trace; metrics is null if
+  // its counters could not be read
+  void AddTraceProcess(ProcessTable::Slot slot, uint64_t creationTime,
+                       bool created, const ProcessMetrics *metrics);
+  // Publishes the running processes as columns
+  void PublishProcesses(int64_t time);
+  // Records the load and memory of every process into the metric history
+  void RecordHistory(int64_t time);
+  // Gives the series of the processes with the highest load rollups
+  void RankTopProcesses(MetricHistory &history);
   void GetPreparedData(ProcessContainer &container);
 
-  bool UpdateProcess(int procId);
-
-  void CleanMap();
-  void ResetAllRunningStatus();
-
 private:
-  ProcessMap mProcessMap{};
+  // The history series of the process in a table slot
+  struct ProcessSeries {
+    uint32_t ProcId{};
+    uint64_t CreationTime{};
+    MetricHistory::SeriesId Cpu = MetricHistory::INVALID_SERIES;
+    MetricHistory::SeriesId Memory = MetricHistory::INVALID_SERIES;
+    bool Registered = false;
+    bool Rollups = false;
+  };
+
+  // How often the top processes are picked again
+  static constexpr int64_t TOP_PROCESS_INTERVAL_MS = 10000;
+
+  ProcessTable mTable{}; // Only the sampler touches it
   bool mRunning = false;
   uint32_t mUpdateInterval{};
-  std::atomic<bool> mDataPrepared;
-  std::atomic<bool> mDataReady;
-  std::atomic<bool> mDataBusy;
+  SampleScheduler::TaskId mSampleTask{};
+  SnapshotPublisher<ProcessColumns> mPublished{};
+
+  // By table slot; reused every tick like the table
+  std::vector<ProcessSeries> mSeries{};
+  std::vector<MetricHistory::SeriesId> mSeriesIds{};
+  std::vector<double> mSeriesValues{};
+  std::vector<std::pair<float, ProcessTable::Slot>> mRanking{};
+  int64_t mRankingTime = INT64_MIN;
+
+  SampleTraceWriter *mTrace = nullptr; // For the tick being sampled, if any
+
+#ifdef RS_PLATFORM_LINUX
+  std::unique_ptr<ProcScanner> mScanner;
+#endif
 
   static std::shared_ptr<ProcessManager> sInstance;
 };
@@ -2,45 +2,336 @@
 
 #include "ProcessEntry.h"
 
-#include <map>
+#include <algorithm>
+#include <iterator>
 #include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace RESANA {
 
-class ProcessMap {
+// Open-addressing hash table of the running processes keyed by pid. Lookups
+// probe a dense array of 8-byte tags and only touch the value on a match.
+// Deletion shifts the following entries back instead of leaving tombstones,
+// so probe lengths stay short however many processes come and go.
+//
+// Every insertion gets a new generation. A (pid, generation) pair names one
+// process even after its pid has been reused by another.
+//
+// ProcessMap holds process entries; ProcessTable keeps its pid -> slot index
+// in a BasicProcessMap<ProcessTable::Slot>.
+template <typename T> class BasicProcessMap {
   typedef unsigned long ulong;
+  typedef std::pair<uint32_t, T> Value;
+
+  struct Tag {
+    uint32_t ProcId{};
+    uint32_t Generation{}; // 0 marks an empty slot
+  };
+
+  template <bool IsConst> class Iterator {
+    using Map =
+        std::conditional_t<IsConst, const BasicProcessMap, BasicProcessMap>;
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Value;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<IsConst, const Value *, Value *>;
+    using reference = std::conditional_t<IsConst, const Value &, Value &>;
+
+    Iterator(Map *map, size_t index) : mMap(map), mIndex(index) { Skip(); }
+
+    reference operator*() const { return mMap->mValues[mIndex]; }
+    pointer operator->() const { return &mMap->mValues[mIndex]; }
+
+    Iterator &operator++() {
+      ++mIndex;
+      Skip();
+      return *this;
+    }
+
+    bool operator==(const Iterator &other) const {
+      return mIndex == other.mIndex;
+    }
+    bool operator!=(const Iterator &other) const {
+      return mIndex != other.mIndex;
+    }
+
+  private:
+    void Skip() {
+      while (mIndex < mMap->mTags.size() && !mMap->mTags[mIndex].Generation) {
+        ++mIndex;
+      }
+    }
+
+  private:
+    Map *mMap;
+    size_t mIndex;
+  };
 
 public:
-  ProcessMap();
-  ~ProcessMap();
+  BasicProcessMap() { Rehash(MIN_CAPACITY); }
+  ~BasicProcessMap() {
+    std::scoped_lock lock(mMutex);
+    Clear();
+  }
 
-  std::recursive_mutex &GetMutex();
+  std::recursive_mutex &GetMutex() { return mMutex; }
 
-  [[nodiscard]] std::shared_ptr<ProcessEntry> Find(ulong procId);
+  // Returns T{} if procId is not in the map
+  [[nodiscard]] T Find(ulong procId);
+  // Returns T{} if procId now belongs to a different process
+  [[nodiscard]] T Find(ulong procId, uint32_t generation);
+  // Returns nullptr if procId is not in the map, for values where T{} is one
+  [[nodiscard]] const T *FindValue(ulong procId) const;
+  // Returns 0 if procId is not in the map
+  [[nodiscard]] uint32_t GetGeneration(ulong procId) const;
 
-  [[nodiscard]] int Count(ulong procId);
-  [[nodiscard]] int Size() const;
+  [[nodiscard]] int Count(ulong procId) { return Contains(procId) ? 1 : 0; }
+  [[nodiscard]] int Size() const { return (int)mSize; }
 
-  [[nodiscard]] bool Contains(ulong procId);
-  [[nodiscard]] bool Empty() const;
+  [[nodiscard]] bool Contains(ulong procId) {
+    return FindSlot(procId) != NPOS;
+  }
+  [[nodiscard]] bool Empty() const { return mSize == 0; }
+  // Bytes held by the tags and values
+  [[nodiscard]] size_t GetBytes() const {
+    return mTags.capacity() * sizeof(Tag) + mValues.capacity() * sizeof(Value);
+  }
 
   void Clear();
-  void Emplace(std::shared_ptr<ProcessEntry> &entry);
+  // Does nothing if procId is already in the map
+  void Emplace(ulong procId, T value);
   void Erase(ulong procId);
-  void Erase(std::shared_ptr<ProcessEntry> &entry);
+
+  // For entries that know their pid, as ProcessEntry does
+  template <typename E, typename = decltype(std::declval<E &>()->GetId())>
+  void Emplace(E &entry) {
+    if (entry) {
+      Emplace(entry->GetId(), entry);
+    }
+  }
+  template <typename E, typename = decltype(std::declval<E &>()->GetId())>
+  void Erase(E &entry);
+
+  // Erases every entry for which pred(value) is true
+  template <typename Pred> void EraseIf(Pred pred);
+
+  void Reserve(size_t count);
 
   // Overloads
-  auto begin() { return mMap.begin(); }
-  auto end() { return mMap.end(); }
-  [[nodiscard]] auto cbegin() const { return mMap.cbegin(); }
-  [[nodiscard]] auto cend() const { return mMap.cend(); }
+  auto begin() { return Iterator<false>(this, 0); }
+  auto end() { return Iterator<false>(this, mTags.size()); }
+  [[nodiscard]] auto cbegin() const { return Iterator<true>(this, 0); }
+  [[nodiscard]] auto cend() const {
+    return Iterator<true>(this, mTags.size());
+  }
+
+  T operator[](ulong procId) { return Find(procId); }
 
-  std::shared_ptr<ProcessEntry> operator[](ulong procId);
+private:
+  [[nodiscard]] size_t HomeSlot(uint32_t procId) const;
+  [[nodiscard]] size_t FindSlot(ulong procId) const;
+  void EraseSlot(size_t slot);
+  void Rehash(size_t capacity);
 
 private:
-  std::map<ulong, std::shared_ptr<ProcessEntry>> mMap{};
+  static constexpr size_t NPOS = ~(size_t)0;
+  static constexpr size_t MIN_CAPACITY = 64;
+
+  std::vector<Tag> mTags{};
+  std::vector<Value> mValues{};
+  size_t mSize{};
+  size_t mMask{};
+  uint32_t mShift{};
+  uint32_t mNextGeneration = 1;
+
   std::recursive_mutex mMutex{};
-  std::unique_lock<std::recursive_mutex> mLock;
 };
 
-} // namespace RESANA
\ No newline at end of file
+using ProcessMap = BasicProcessMap<std::shared_ptr<ProcessEntry>>;
+
+template <typename T>
+size_t BasicProcessMap<T>::HomeSlot(const uint32_t procId) const {
+  // Fibonacci hashing spreads the mostly sequential pids over the table
+  return (size_t)(((uint64_t)procId * 0x9E3779B97F4A7C15ull) >> mShift);
+}
+
+template <typename T>
+size_t BasicProcessMap<T>::FindSlot(const ulong procId) const {
+  const auto id = (uint32_t)procId;
+  for (size_t slot = HomeSlot(id);; slot = (slot + 1) & mMask) {
+    const Tag &tag = mTags[slot];
+    if (!tag.Generation) {
+      return NPOS;
+    }
+    if (tag.ProcId == id) {
+      return slot;
+    }
+  }
+}
+
+template <typename T>
+void BasicProcessMap<T>::Emplace(const ulong procId, T value) {
+  // Keep the load factor under 3/4
+  if ((mSize + 1) * 4 > mTags.size() * 3) {
+    Rehash(mTags.size() * 2);
+  }
+
+  const auto id = (uint32_t)procId;
+  size_t slot = HomeSlot(id);
+  for (; mTags[slot].Generation; slot = (slot + 1) & mMask) {
+    if (mTags[slot].ProcId == id) {
+      return; // Already present
+    }
+  }
+
+  mTags[slot] = {id, mNextGeneration};
+  mValues[slot] = {id, std::move(value)};
+  ++mSize;
+
+  if (++mNextGeneration == 0) {
+    mNextGeneration = 1;
+  }
+}
+
+template <typename T> void BasicProcessMap<T>::Clear() {
+  for (size_t slot = 0; slot < mTags.size(); ++slot) {
+    mTags[slot] = {};
+    mValues[slot].second = T{};
+  }
+  mSize = 0;
+}
+
+template <typename T> void BasicProcessMap<T>::Reserve(size_t count) {
+  size_t capacity = mTags.size();
+  while (count * 4 > capacity * 3) {
+    capacity *= 2;
+  }
+  if (capacity != mTags.size()) {
+    Rehash(capacity);
+  }
+}
+
+template <typename T> T BasicProcessMap<T>::Find(const ulong procId) {
+  const size_t slot = FindSlot(procId);
+  return slot != NPOS ? mValues[slot].second : T{};
+}
+
+template <typename T>
+T BasicProcessMap<T>::Find(const ulong procId, const uint32_t generation) {
+  const size_t slot = FindSlot(procId);
+  if (slot == NPOS || mTags[slot].Generation != generation) {
+    return T{};
+  }
+  return mValues[slot].second;
+}
+
+template <typename T>
+const T *BasicProcessMap<T>::FindValue(const ulong procId) const {
+  const size_t slot = FindSlot(procId);
+  return slot != NPOS ? &mValues[slot].second : nullptr;
+}
+
+template <typename T>
+uint32_t BasicProcessMap<T>::GetGeneration(const ulong procId) const {
+  const size_t slot = FindSlot(procId);
+  return slot != NPOS ? mTags[slot].Generation : 0;
+}
+
+template <typename T> void BasicProcessMap<T>::Erase(const ulong procId) {
+  if (const size_t slot = FindSlot(procId); slot != NPOS) {
+    EraseSlot(slot);
+  }
+}
+
+template <typename T>
+template <typename E, typename>
+void BasicProcessMap<T>::Erase(E &entry) {
+  if (!entry) {
+    return;
+  }
+  const size_t slot = FindSlot(entry->GetId());
+  if (slot == NPOS) {
+    return;
+  }
+
+  if (mValues[slot].second != entry) // entry is a copy, delete both
+  {
+    entry.reset();
+    entry = nullptr;
+  }
+  EraseSlot(slot);
+}
+
+template <typename T>
+template <typename Pred>
+void BasicProcessMap<T>::EraseIf(Pred pred) {
+  for (size_t slot = 0; slot < mTags.size();) {
+    // A backward shift may move a later entry into this slot; check it again
+    if (mTags[slot].Generation && pred(mValues[slot].second)) {
+      EraseSlot(slot);
+    } else {
+      ++slot;
+    }
+  }
+}
+
+template <typename T> void BasicProcessMap<T>::EraseSlot(size_t slot) {
+  // Shift back the entries that were displaced past this slot so no
+  // tombstone is needed.
+  for (size_t next = (slot + 1) & mMask;; next = (next + 1) & mMask) {
+    const Tag &tag = mTags[next];
+    if (!tag.Generation) {
+      break;
+    }
+
+    // An entry whose home lies in (slot, next] must stay where it is
+    const size_t home = HomeSlot(tag.ProcId);
+    const bool stays = slot <= next ? (slot < home && home <= next)
+                                    : (slot < home || home <= next);
+    if (stays) {
+      continue;
+    }
+
+    mTags[slot] = tag;
+    mValues[slot] = std::move(mValues[next]);
+    slot = next;
+  }
+
+  mTags[slot] = {};
+  mValues[slot].second = T{};
+  --mSize;
+}
+
+template <typename T> void BasicProcessMap<T>::Rehash(size_t capacity) {
+  capacity = std::max(capacity, MIN_CAPACITY);
+
+  std::vector<Tag> tags(capacity);
+  std::vector<Value> values(capacity);
+  std::swap(tags, mTags);
+  std::swap(values, mValues);
+
+  mMask = capacity - 1;
+  mShift = 64;
+  for (size_t size = capacity; size > 1; size >>= 1) {
+    --mShift;
+  }
+
+  for (size_t i = 0; i < tags.size(); ++i) {
+    if (!tags[i].Generation) {
+      continue;
+    }
+
+    size_t slot = HomeSlot(tags[i].ProcId);
+    while (mTags[slot].Generation) {
+      slot = (slot + 1) & mMask;
+    }
+    mTags[slot] = tags[i];
+    mValues[slot] = std::move(values[i]);
+  }
+}
+
+} // namespace RESANA
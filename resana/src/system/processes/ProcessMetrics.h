@@ -0,0 +1,48 @@
+#pragma once
+
+#include "core/PlatformDetection.h"
+
+#include <cstdint>
+
+#ifdef RS_PLATFORM_LINUX
+#include "platform/linux/ProcPidStat.h"
+#elif defined(RS_PLATFORM_WINDOWS)
+#include <Windows.h>
+#endif
+
+namespace RESANA {
+
+// Everything sampled for one process in one tick. Times are in the
+// platform's native unit (100 ns on Windows, ns on Linux).
+struct ProcessMetrics {
+  uint64_t Time{}; // When the sample was taken
+  uint64_t CreationTime{};
+  uint64_t UserTime{};
+  uint64_t SystemTime{};
+  uint64_t WorkingSetSize{}; // Bytes
+  uint64_t PrivateUsage{};   // Bytes
+  uint64_t ReadBytes{};      // Bytes passed to read calls
+  uint64_t WriteBytes{};     // Bytes passed to write calls
+  uint32_t ThreadCount{};    // 0 where the process list already reports it
+};
+
+// Collects all metrics of a process in a single pass. Returns false if the
+// process could not be queried (it exited or access was denied).
+bool CollectProcessMetrics(uint32_t procId, ProcessMetrics &metrics);
+
+#ifdef RS_PLATFORM_WINDOWS
+// Same, through a handle with PROCESS_QUERY_LIMITED_INFORMATION access that
+// the caller keeps open between samples
+bool CollectProcessMetrics(HANDLE handle, ProcessMetrics &metrics);
+#endif
+
+#ifdef RS_PLATFORM_LINUX
+// Builds the metrics from /proc/<pid> files that were already read. io is
+// null when /proc/<pid>/io is not readable for this process.
+void MakeProcessMetrics(const ProcPidStat &stat, const ProcPidStatm &statm,
+                        const ProcPidIo *io, ProcessMetrics &metrics);
+#endif
+
+uint32_t GetCurrentProcessIdentifier();
+
+} // namespace RESANA
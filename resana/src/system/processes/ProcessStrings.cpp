@@ -0,0 +1,156 @@
+#include "ProcessStrings.h"
+#include "rspch.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace RESANA {
+
+namespace {
+
+// Unreferenced strings kept before Trim() frees them
+constexpr size_t MIN_UNREFERENCED = 64;
+
+// Enough for the strings of a small system and the names its kernel workers
+// go through, so that it never grows the table
+constexpr size_t MIN_TEXT_BYTES = 4096;
+constexpr size_t MIN_IDS = 256;
+constexpr size_t MIN_LOOKUP = 2 * MIN_IDS;
+
+uint32_t HashText(const std::string_view text) {
+  return (uint32_t)std::hash<std::string_view>()(text);
+}
+
+uint64_t MakeSpan(const size_t offset, const size_t length) {
+  return ((uint64_t)offset << 32) | (uint32_t)length;
+}
+
+} // namespace
+
+StringTable::Id StringTable::Append(const std::string_view text) {
+  Spans.push_back(MakeSpan(Text.size(), text.size()));
+  Text.append(text);
+  return (Id)(Spans.size() - 1);
+}
+
+void StringTable::CopyFrom(const StringTable &other) {
+  Text.reserve(other.Text.capacity());
+  Spans.reserve(other.Spans.capacity());
+  Text = other.Text;
+  Spans = other.Spans;
+}
+
+ProcessStrings::ProcessStrings() {
+  mTable.Text.reserve(MIN_TEXT_BYTES);
+  mTable.Spans.reserve(MIN_IDS);
+  mSpare.reserve(MIN_TEXT_BYTES);
+  mRefs.reserve(MIN_IDS);
+  mHashes.reserve(MIN_IDS);
+  mFreeIds.reserve(MIN_IDS);
+  mRefs.push_back(0);
+  mHashes.push_back(0);
+  Rehash(MIN_LOOKUP);
+}
+
+ProcessStrings::Id ProcessStrings::Acquire(const std::string_view text) {
+  if (text.empty()) {
+    return EMPTY;
+  }
+
+  const uint32_t hash = HashText(text);
+  for (size_t bucket = hash & mMask; mLookup[bucket] != EMPTY;
+       bucket = (bucket + 1) & mMask) {
+    const Id id = mLookup[bucket];
+    if (mHashes[id] == hash && mTable.Get(id) == text) {
+      if (mRefs[id]++ == 0) {
+        --mNumUnreferenced;
+      }
+      return id;
+    }
+  }
+
+  Id id;
+  if (mFreeIds.empty()) {
+    id = mTable.Append(text);
+    mRefs.push_back(0);
+    mHashes.push_back(0);
+  } else {
+    id = mFreeIds.back();
+    mFreeIds.pop_back();
+    mTable.Spans[id] = MakeSpan(mTable.Text.size(), text.size());
+    mTable.Text.append(text);
+  }
+  mRefs[id] = 1;
+  mHashes[id] = hash;
+  ++mVersion;
+
+  // Keep the lookup at most half full
+  if (GetCount() * 2 > mLookup.size()) {
+    Rehash(mLookup.size() * 2);
+  } else {
+    Insert(id);
+  }
+  return id;
+}
+
+void ProcessStrings::Release(const Id id) {
+  if (id != EMPTY && --mRefs[id] == 0) {
+    ++mNumUnreferenced;
+  }
+}
+
+void ProcessStrings::Trim() {
+  if (mNumUnreferenced < std::max(MIN_UNREFERENCED, GetCount() / 4)) {
+    return;
+  }
+
+  // Free ids have an empty span, as no interned string is empty
+  mSpare.clear();
+  for (Id id = 1; id < (Id)mTable.Spans.size(); ++id) {
+    if (!mTable.Spans[id]) {
+      continue;
+    }
+    if (mRefs[id] == 0) {
+      mTable.Spans[id] = 0;
+      mFreeIds.push_back(id);
+      continue;
+    }
+
+    const auto text = mTable.Get(id);
+    mTable.Spans[id] = MakeSpan(mSpare.size(), text.size());
+    mSpare.append(text);
+  }
+  mTable.Text.swap(mSpare);
+  mNumUnreferenced = 0;
+  ++mVersion;
+
+  Rehash(mLookup.size());
+}
+
+size_t ProcessStrings::GetBytes() const {
+  return mTable.Text.capacity() + mSpare.capacity() +
+         mTable.Spans.capacity() * sizeof(uint64_t) +
+         mRefs.capacity() * sizeof(uint32_t) +
+         mHashes.capacity() * sizeof(uint32_t) +
+         mFreeIds.capacity() * sizeof(Id) + mLookup.capacity() * sizeof(Id);
+}
+
+void ProcessStrings::Insert(const Id id) {
+  size_t bucket = mHashes[id] & mMask;
+  while (mLookup[bucket] != EMPTY) {
+    bucket = (bucket + 1) & mMask;
+  }
+  mLookup[bucket] = id;
+}
+
+void ProcessStrings::Rehash(const size_t capacity) {
+  mLookup.assign(capacity, EMPTY);
+  mMask = capacity - 1;
+  for (Id id = 1; id < (Id)mTable.Spans.size(); ++id) {
+    if (mTable.Spans[id]) {
+      Insert(id);
+    }
+  }
+}
+
+} // namespace RESANA
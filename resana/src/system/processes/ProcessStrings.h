@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace RESANA {
+
+// Strings stored back to back in one buffer and looked up by id. This is the
+// part of a ProcessStrings that readers get.
+struct StringTable {
+  using Id = uint32_t;
+
+  std::string Text{};
+  std::vector<uint64_t> Spans{0}; // Offset << 32 | length; id 0 is empty
+
+  [[nodiscard]] std::string_view Get(Id id) const {
+    const uint64_t span = Spans[id];
+    return {Text.data() + (span >> 32), (size_t)(uint32_t)span};
+  }
+  // Adds text under a new id
+  Id Append(std::string_view text);
+  // Copies other into this table's buffers, reserving other's capacity so
+  // that later copies of the growing table do not allocate
+  void CopyFrom(const StringTable &other);
+};
+
+// The names and command lines of the processes, interned in a StringTable. A
+// slot stores a 4-byte id instead of the string, and a name many processes
+// share is kept once. Ids are reference counted. A string whose last
+// reference is released stays until Trim() finds enough of them, since
+// names like the kernel workers' change back and forth every few ticks;
+// once they are warm, interning does not allocate. Id 0 is the empty string
+// and is never released.
+class ProcessStrings {
+public:
+  using Id = StringTable::Id;
+  static constexpr Id EMPTY = 0;
+
+  ProcessStrings();
+
+  ProcessStrings(const ProcessStrings &) = delete;
+  ProcessStrings &operator=(const ProcessStrings &) = delete;
+
+  // Takes a reference on the id of text, adding it if it is new
+  [[nodiscard]] Id Acquire(std::string_view text);
+  void Release(Id id);
+  // Frees the unreferenced strings and compacts the text once they are a
+  // good part of the total
+  void Trim();
+
+  [[nodiscard]] std::string_view Get(Id id) const { return mTable.Get(id); }
+  [[nodiscard]] const StringTable &GetTable() const { return mTable; }
+  // Changes whenever the table does
+  [[nodiscard]] uint64_t GetVersion() const { return mVersion; }
+
+  // Bytes held by the text, the spans and the lookup
+  [[nodiscard]] size_t GetBytes() const;
+
+private:
+  [[nodiscard]] size_t GetCount() const {
+    return mTable.Spans.size() - 1 - mFreeIds.size();
+  }
+  void Insert(Id id);
+  void Rehash(size_t capacity);
+
+private:
+  StringTable mTable{};
+  std::vector<uint32_t> mRefs{};   // By id
+  std::vector<uint32_t> mHashes{}; // By id
+  std::vector<Id> mFreeIds{};
+  std::vector<Id> mLookup{}; // Ids by hash, probed linearly; EMPTY is a gap
+  size_t mMask{};
+  std::string mSpare{}; // Trim() compacts the text into it
+  size_t mNumUnreferenced{};
+  uint64_t mVersion = 1;
+};
+
+} // namespace RESANA
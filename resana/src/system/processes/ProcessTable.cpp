@@ -0,0 +1,297 @@
+#include "ProcessTable.h"
+#include "rspch.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace RESANA {
+
+namespace {
+
+// Half of each new sample: the load column settles within a few ticks and
+// stops jumping between them, which also keeps the table's sort stable
+constexpr float DEFAULT_LOAD_SMOOTHING = 0.5f;
+
+template <typename T> size_t CapacityBytes(const std::vector<T> &column) {
+  return column.capacity() * sizeof(T);
+}
+
+} // namespace
+
+void ProcessColumns::Resize(const size_t count) {
+  Id.resize(count);
+  ParentId.resize(count);
+  ThreadCount.resize(count);
+  PriorityClass.resize(count);
+  State.resize(count);
+  CpuLoad.resize(count);
+  CreationTime.resize(count);
+  WorkingSetSize.resize(count);
+  PrivateUsage.resize(count);
+  ReadBytes.resize(count);
+  WriteBytes.resize(count);
+  NameId.resize(count);
+  CommandLineId.resize(count);
+}
+
+ProcessTable::ProcessTable() {
+  // Loads are a share of the whole machine
+  const auto cpuCount = std::max(1u, std::thread::hardware_concurrency());
+  mLoadParams.Scale = 100.0 / (double)cpuCount;
+  mLoadParams.Smoothing = DEFAULT_LOAD_SMOOTHING;
+}
+
+ProcessTable::~ProcessTable() {
+#ifdef RS_PLATFORM_WINDOWS
+  for (const auto handle : mHandles) {
+    if (handle) {
+      ::CloseHandle(handle);
+    }
+  }
+#endif
+}
+
+void ProcessTable::BeginScan() {
+  ++mScanTick;
+  mScan.clear();
+  mScanCursor = 0;
+}
+
+ProcessTable::Slot ProcessTable::Acquire(const uint32_t procId,
+                                         const uint64_t creationTime,
+                                         bool &created) {
+  // Most processes come in the same order as in the last scan
+  Slot slot = INVALID_SLOT;
+  if (mScanCursor < mLastScan.size()) {
+    const Slot next = mLastScan[mScanCursor];
+    if (IsLive(next) && mColumns.Id[next] == procId) {
+      slot = next;
+    }
+  }
+  if (slot == INVALID_SLOT) {
+    slot = Find(procId);
+  }
+
+  if (slot != INVALID_SLOT && mSeenTick[slot] == mScanTick) {
+    // Listed twice in one scan
+    created = false;
+    return slot;
+  }
+
+  if (slot != INVALID_SLOT && mSeenTick[slot] + 1 == mScanTick) {
+    mScanCursor = mSeenPosition[slot] + 1;
+  }
+
+  if (slot != INVALID_SLOT && creationTime &&
+      mColumns.CreationTime[slot] != creationTime) {
+    FreeSlot(slot);
+    slot = INVALID_SLOT;
+  }
+
+  created = slot == INVALID_SLOT;
+  if (created) {
+    slot = NewSlot(procId, creationTime);
+  }
+
+  mSeenTick[slot] = mScanTick;
+  mSeenPosition[slot] = (uint32_t)mScan.size();
+  mScan.push_back(slot);
+  return slot;
+}
+
+void ProcessTable::EndScan() {
+  if (mScan.size() != mNumLive) {
+    for (Slot slot = 0; slot < (Slot)GetNumSlots(); ++slot) {
+      if (IsLive(slot) && mSeenTick[slot] != mScanTick) {
+        FreeSlot(slot);
+      }
+    }
+  }
+  mLastScan.swap(mScan);
+  mStrings.Trim();
+}
+
+ProcessTable::Slot ProcessTable::Find(const uint32_t procId) const {
+  const Slot *slot = mIndex.FindValue(procId);
+  return slot ? *slot : INVALID_SLOT;
+}
+
+void ProcessTable::SetStatus(const Slot slot, const uint32_t parentId,
+                             const uint32_t threadCount,
+                             const uint32_t priorityClass, const char state) {
+  mColumns.ParentId[slot] = parentId;
+  mColumns.ThreadCount[slot] = threadCount;
+  mColumns.PriorityClass[slot] = priorityClass;
+  mColumns.State[slot] = state ? state : 'R';
+}
+
+void ProcessTable::SetName(const Slot slot, const std::string_view name) {
+  // Only changes on exec, so this rarely interns
+  auto &id = mColumns.NameId[slot];
+  if (mStrings.Get(id) != name) {
+    const auto previous = id;
+    id = mStrings.Acquire(name);
+    mStrings.Release(previous);
+  }
+}
+
+void ProcessTable::SetCommandLine(const Slot slot,
+                                  const std::string_view commandLine) {
+  auto &id = mColumns.CommandLineId[slot];
+  const auto previous = id;
+  id = mStrings.Acquire(commandLine);
+  mStrings.Release(previous);
+}
+
+void ProcessTable::ApplyMetrics(const Slot slot,
+                                const ProcessMetrics &metrics) {
+  const uint64_t cpuTime = metrics.UserTime + metrics.SystemTime;
+  if (!mSampleTime[slot]) {
+    // The first sample only sets the baseline
+    mLastCpuTime[slot] = cpuTime;
+    mLastSampleTime[slot] = metrics.Time;
+  }
+  mCpuTime[slot] = cpuTime;
+  mSampleTime[slot] = metrics.Time;
+
+  if (metrics.CreationTime) {
+    mColumns.CreationTime[slot] = metrics.CreationTime;
+  }
+  mColumns.WorkingSetSize[slot] = metrics.WorkingSetSize;
+  mColumns.PrivateUsage[slot] = metrics.PrivateUsage;
+  mColumns.ReadBytes[slot] = metrics.ReadBytes;
+  mColumns.WriteBytes[slot] = metrics.WriteBytes;
+  if (metrics.ThreadCount > 0) {
+    mColumns.ThreadCount[slot] = metrics.ThreadCount;
+  }
+}
+
+void ProcessTable::UpdateCpuLoads() {
+  // Free slots are all zero and stay at 0. A slot that was not sampled this
+  // tick has no elapsed time, so its load decays towards 0.
+  ProcessLoadColumns columns;
+  columns.CpuTime = mCpuTime.data();
+  columns.LastCpuTime = mLastCpuTime.data();
+  columns.SampleTime = mSampleTime.data();
+  columns.LastSampleTime = mLastSampleTime.data();
+  columns.Load = mColumns.CpuLoad.data();
+  columns.Count = GetNumSlots();
+  UpdateProcessLoads(columns, mLoadParams);
+}
+
+void ProcessTable::Gather(ProcessColumns &columns) const {
+  columns.Resize(mNumLive);
+  if (columns.StringsVersion != mStrings.GetVersion()) {
+    columns.Strings.CopyFrom(mStrings.GetTable());
+    columns.StringsVersion = mStrings.GetVersion();
+  }
+
+  size_t row = 0;
+  for (Slot slot = 0; slot < (Slot)GetNumSlots(); ++slot) {
+    if (!IsLive(slot)) {
+      continue;
+    }
+
+    columns.Id[row] = mColumns.Id[slot];
+    columns.ParentId[row] = mColumns.ParentId[slot];
+    columns.ThreadCount[row] = mColumns.ThreadCount[slot];
+    columns.PriorityClass[row] = mColumns.PriorityClass[slot];
+    columns.State[row] = mColumns.State[slot];
+    columns.CpuLoad[row] = mColumns.CpuLoad[slot];
+    columns.CreationTime[row] = mColumns.CreationTime[slot];
+    columns.WorkingSetSize[row] = mColumns.WorkingSetSize[slot];
+    columns.PrivateUsage[row] = mColumns.PrivateUsage[slot];
+    columns.ReadBytes[row] = mColumns.ReadBytes[slot];
+    columns.WriteBytes[row] = mColumns.WriteBytes[slot];
+    columns.NameId[row] = mColumns.NameId[slot];
+    columns.CommandLineId[row] = mColumns.CommandLineId[slot];
+    ++row;
+  }
+}
+
+size_t ProcessTable::GetColumnBytes() const {
+  return CapacityBytes(mColumns.Id) + CapacityBytes(mColumns.ParentId) +
+         CapacityBytes(mColumns.ThreadCount) +
+         CapacityBytes(mColumns.PriorityClass) +
+         CapacityBytes(mColumns.State) + CapacityBytes(mColumns.CpuLoad) +
+         CapacityBytes(mColumns.CreationTime) +
+         CapacityBytes(mColumns.WorkingSetSize) +
+         CapacityBytes(mColumns.PrivateUsage) +
+         CapacityBytes(mColumns.ReadBytes) +
+         CapacityBytes(mColumns.WriteBytes) +
+         CapacityBytes(mColumns.NameId) +
+         CapacityBytes(mColumns.CommandLineId) + CapacityBytes(mCpuTime) +
+         CapacityBytes(mSampleTime) + CapacityBytes(mLastCpuTime) +
+         CapacityBytes(mLastSampleTime) + CapacityBytes(mSeenTick) +
+         CapacityBytes(mSeenPosition) + CapacityBytes(mFreeSlots) +
+         CapacityBytes(mLastScan) + CapacityBytes(mScan) +
+         mIndex.GetBytes();
+}
+
+ProcessTable::Slot ProcessTable::NewSlot(const uint32_t procId,
+                                         const uint64_t creationTime) {
+  Slot slot;
+  if (mFreeSlots.empty()) {
+    slot = (Slot)GetNumSlots();
+    ResizeSlots(slot + 1);
+  } else {
+    slot = mFreeSlots.back();
+    mFreeSlots.pop_back();
+  }
+
+  mColumns.Id[slot] = procId;
+  mColumns.CreationTime[slot] = creationTime;
+  mColumns.State[slot] = 'R';
+  ++mNumLive;
+  mIndex.Emplace(procId, slot);
+  return slot;
+}
+
+void ProcessTable::FreeSlot(const Slot slot) {
+  mIndex.Erase(mColumns.Id[slot]);
+
+#ifdef RS_PLATFORM_WINDOWS
+  if (mHandles[slot]) {
+    ::CloseHandle(mHandles[slot]);
+    mHandles[slot] = nullptr;
+  }
+#endif
+
+  mColumns.Id[slot] = 0;
+  mColumns.ParentId[slot] = 0;
+  mColumns.ThreadCount[slot] = 0;
+  mColumns.PriorityClass[slot] = 0;
+  mColumns.State[slot] = 0;
+  mColumns.CpuLoad[slot] = 0.0f;
+  mColumns.CreationTime[slot] = 0;
+  mColumns.WorkingSetSize[slot] = 0;
+  mColumns.PrivateUsage[slot] = 0;
+  mColumns.ReadBytes[slot] = 0;
+  mColumns.WriteBytes[slot] = 0;
+  mStrings.Release(mColumns.NameId[slot]);
+  mStrings.Release(mColumns.CommandLineId[slot]);
+  mColumns.NameId[slot] = ProcessStrings::EMPTY;
+  mColumns.CommandLineId[slot] = ProcessStrings::EMPTY;
+  mCpuTime[slot] = 0;
+  mSampleTime[slot] = 0;
+  mLastCpuTime[slot] = 0;
+  mLastSampleTime[slot] = 0;
+
+  --mNumLive;
+  mFreeSlots.push_back(slot);
+}
+
+void ProcessTable::ResizeSlots(const size_t count) {
+  mColumns.Resize(count);
+  mCpuTime.resize(count);
+  mSampleTime.resize(count);
+  mLastCpuTime.resize(count);
+  mLastSampleTime.resize(count);
+  mSeenTick.resize(count);
+  mSeenPosition.resize(count);
+#ifdef RS_PLATFORM_WINDOWS
+  mHandles.resize(count);
+#endif
+}
+
+} // namespace RESANA
@@ -0,0 +1,181 @@
+#pragma once
+
+#include "core/PlatformDetection.h"
+
+#include "ProcessLoad.h"
+#include "ProcessMap.h"
+#include "ProcessMetrics.h"
+#include "ProcessStrings.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef RS_PLATFORM_WINDOWS
+#include <Windows.h>
+#endif
+
+namespace RESANA {
+
+// The running processes of one sample, one row per process and one vector per
+// field, as ProcessManager publishes them. Names and command lines are ids
+// into Strings, a copy of the table's interned strings that is only renewed
+// when they change.
+struct ProcessColumns {
+  std::vector<uint32_t> Id{};
+  std::vector<uint32_t> ParentId{};
+  std::vector<uint32_t> ThreadCount{};
+  std::vector<uint32_t> PriorityClass{};
+  std::vector<char> State{}; // As in /proc/<pid>/stat; 'R' where unknown
+  std::vector<float> CpuLoad{};
+  std::vector<uint64_t> CreationTime{};
+  std::vector<uint64_t> WorkingSetSize{};
+  std::vector<uint64_t> PrivateUsage{};
+  std::vector<uint64_t> ReadBytes{};
+  std::vector<uint64_t> WriteBytes{};
+
+  std::vector<ProcessStrings::Id> NameId{};
+  std::vector<ProcessStrings::Id> CommandLineId{};
+
+  StringTable Strings{};
+  uint64_t StringsVersion{};
+
+  [[nodiscard]] size_t Size() const { return Id.size(); }
+  [[nodiscard]] std::string_view GetName(size_t row) const {
+    return Strings.Get(NameId[row]);
+  }
+  [[nodiscard]] std::string_view GetCommandLine(size_t row) const {
+    return Strings.Get(CommandLineId[row]);
+  }
+  void Resize(size_t count);
+};
+
+// Every process the sampler knows about, stored as columns indexed by slot.
+// The per-tick fields sit in contiguous arrays, so a tick streams through
+// them instead of visiting one heap object per process; a slot costs about a
+// hundred bytes instead of a ProcessEntry and its allocations. Names and
+// command lines are interned in a ProcessStrings and OS handles live in a
+// side table; both are only touched when a process starts, exits or execs.
+//
+// A tick is BeginScan(), Acquire() for every listed process, EndScan() to
+// free the slots of the processes that exited and UpdateCpuLoads(). Slots are
+// recycled. Only the sampler thread uses the table; readers get a Gather()ed
+// copy.
+class ProcessTable {
+public:
+  using Slot = uint32_t;
+  static constexpr Slot INVALID_SLOT = ~(Slot)0;
+
+  ProcessTable();
+  ~ProcessTable();
+
+  ProcessTable(const ProcessTable &) = delete;
+  ProcessTable &operator=(const ProcessTable &) = delete;
+
+  void BeginScan();
+  // Slot of a listed process. A new slot is taken if the pid is unknown or its
+  // creation time differs (the pid was reused); created tells which. A zero
+  // creation time is not checked.
+  Slot Acquire(uint32_t procId, uint64_t creationTime, bool &created);
+  // Frees the slots of the processes not acquired since BeginScan()
+  void EndScan();
+
+  // Slot of the pid, or INVALID_SLOT
+  [[nodiscard]] Slot Find(uint32_t procId) const;
+
+  // The fields the process list reports
+  void SetStatus(Slot slot, uint32_t parentId, uint32_t threadCount,
+                 uint32_t priorityClass, char state);
+  void SetName(Slot slot, std::string_view name);
+  void SetCommandLine(Slot slot, std::string_view commandLine);
+
+  // Stores this tick's counters; the CPU load follows in UpdateCpuLoads()
+  void ApplyMetrics(Slot slot, const ProcessMetrics &metrics);
+  // CPU load of every slot from its last two samples, in one vectorized pass
+  void UpdateCpuLoads();
+  // Weight of the newest sample in the smoothed load, in (0, 1]
+  void SetLoadSmoothing(float smoothing) { mLoadParams.Smoothing = smoothing; }
+
+  // Copies the live slots into columns without gaps
+  void Gather(ProcessColumns &columns) const;
+
+  [[nodiscard]] bool IsLive(Slot slot) const {
+    return mColumns.State[slot] != 0;
+  }
+  [[nodiscard]] uint32_t GetId(Slot slot) const { return mColumns.Id[slot]; }
+  [[nodiscard]] uint32_t GetParentId(Slot slot) const {
+    return mColumns.ParentId[slot];
+  }
+  [[nodiscard]] uint32_t GetThreadCount(Slot slot) const {
+    return mColumns.ThreadCount[slot];
+  }
+  [[nodiscard]] uint32_t GetPriorityClass(Slot slot) const {
+    return mColumns.PriorityClass[slot];
+  }
+  [[nodiscard]] char GetState(Slot slot) const { return mColumns.State[slot]; }
+  [[nodiscard]] float GetCpuLoad(Slot slot) const {
+    return mColumns.CpuLoad[slot];
+  }
+  [[nodiscard]] uint64_t GetCreationTime(Slot slot) const {
+    return mColumns.CreationTime[slot];
+  }
+  [[nodiscard]] uint64_t GetWorkingSetSize(Slot slot) const {
+    return mColumns.WorkingSetSize[slot];
+  }
+  [[nodiscard]] std::string_view GetName(Slot slot) const {
+    return mStrings.Get(mColumns.NameId[slot]);
+  }
+  // Empty if there is none
+  [[nodiscard]] std::string_view GetCommandLine(Slot slot) const {
+    return mStrings.Get(mColumns.CommandLineId[slot]);
+  }
+
+  [[nodiscard]] size_t GetNumProcesses() const { return mNumLive; }
+  [[nodiscard]] size_t GetNumSlots() const { return mColumns.Size(); }
+  // Bytes held by the columns and the pid index, the strings aside
+  [[nodiscard]] size_t GetColumnBytes() const;
+  [[nodiscard]] size_t GetStringBytes() const { return mStrings.GetBytes(); }
+
+#ifdef RS_PLATFORM_WINDOWS
+  // Opened once per process; closed when its slot is freed
+  [[nodiscard]] HANDLE GetHandle(Slot slot) const { return mHandles[slot]; }
+  void SetHandle(Slot slot, HANDLE handle) { mHandles[slot] = handle; }
+#endif
+
+private:
+  Slot NewSlot(uint32_t procId, uint64_t creationTime);
+  void FreeSlot(Slot slot);
+  void ResizeSlots(size_t count);
+
+private:
+  // Indexed by slot; the rows of free slots are zero, State included.
+  // Strings is left empty, the ids point into mStrings.
+  ProcessColumns mColumns{};
+  ProcessStrings mStrings{};
+  std::vector<uint64_t> mCpuTime{};        // User plus system time
+  std::vector<uint64_t> mSampleTime{};
+  std::vector<uint64_t> mLastCpuTime{};    // The previous sample
+  std::vector<uint64_t> mLastSampleTime{};
+  std::vector<uint32_t> mSeenTick{};       // Last scan that acquired the slot
+  std::vector<uint32_t> mSeenPosition{};   // Its position in that scan
+#ifdef RS_PLATFORM_WINDOWS
+  std::vector<HANDLE> mHandles{};
+#endif
+
+  std::vector<Slot> mFreeSlots{};
+  size_t mNumLive{};
+
+  // Slots in the order the last scan listed them. Scans list processes in a
+  // stable order, so most lookups are a comparison against the next one.
+  std::vector<Slot> mLastScan{};
+  std::vector<Slot> mScan{};
+  size_t mScanCursor{};
+  uint32_t mScanTick{};
+
+  BasicProcessMap<Slot> mIndex{}; // pid -> slot
+
+  ProcessLoadParams mLoadParams{};
+};
+
+} // namespace RESANA
@@ -0,0 +1,99 @@
+#include "SampleReplay.h"
+#include "rspch.h"
+
+#include "system/cpu/CpuPerformance.h"
+#include "system/memory/MemoryPerformance.h"
+#include "system/processes/ProcessManager.h"
+
+#include <chrono>
+#include <thread>
+
+namespace RESANA {
+
+namespace {
+
+uint64_t GetReplayNanoseconds() {
+  return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+} // namespace
+
+bool SampleReplay::Open(const std::string &path) { return mReader.Open(path); }
+
+ReplayStats SampleReplay::Run(const ReplaySpeed speed,
+                              const std::atomic<bool> *stop) {
+  ReplayStats stats;
+  if (!mReader.IsOpen()) {
+    return stats;
+  }
+
+  const auto cpu = CpuPerformance::Get();
+  const auto memory = MemoryPerformance::Get();
+  const auto processes = ProcessManager::Get();
+  const auto stopped = [stop] { return stop && stop->load(); };
+
+  mReader.Rewind();
+  const auto start = std::chrono::steady_clock::now();
+  const uint64_t startNs = GetReplayNanoseconds();
+  int64_t firstTime = INT64_MIN;
+  while (!stopped() && mReader.Next(mFrame)) {
+    if (speed == ReplaySpeed::Original) {
+      if (firstTime == INT64_MIN) {
+        firstTime = mFrame.Time;
+      }
+      std::this_thread::sleep_until(
+          start + std::chrono::milliseconds(mFrame.Time - firstTime));
+    }
+
+    uint64_t begin = GetReplayNanoseconds();
+    switch (mFrame.Kind) {
+    case TraceFrameKind::Cpu:
+      if (!cpu->IsRunning()) {
+        break;
+      }
+      // The process thread is behind when going fast; wait for a slot
+      // rather than drop the frame as the live sampler would
+      while (!cpu->ReplaySample(mFrame.Items.data(),
+                                (PdhSize)mFrame.Items.size(),
+                                mFrame.LayoutChanged, mFrame.Time)) {
+        if (stopped()) {
+          break;
+        }
+        std::this_thread::yield();
+        begin = GetReplayNanoseconds();
+      }
+      stats.CpuNs += GetReplayNanoseconds() - begin;
+      ++stats.CpuFrames;
+      break;
+    case TraceFrameKind::Memory:
+      if (!memory->IsRunning()) {
+        break;
+      }
+      memory->ReplaySample(mFrame.Memory, mFrame.Self, mFrame.Time);
+      stats.MemoryNs += GetReplayNanoseconds() - begin;
+      ++stats.MemoryFrames;
+      break;
+    case TraceFrameKind::Processes:
+      if (!processes->IsRunning()) {
+        break;
+      }
+      processes->ReplaySample(mFrame.Processes.data(), mFrame.NumProcesses,
+                              mFrame.Time);
+      stats.ProcessNs += GetReplayNanoseconds() - begin;
+      stats.Processes += mFrame.NumProcesses;
+      ++stats.ProcessFrames;
+      break;
+    }
+  }
+
+  // The CPU samples are processed on the collector's own thread
+  while (cpu->IsRunning() && cpu->GetPendingSamples() > 0 && !stopped()) {
+    std::this_thread::yield();
+  }
+  stats.ElapsedNs = GetReplayNanoseconds() - startNs;
+  return stats;
+}
+
+} // namespace RESANA
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "SampleTrace.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace RESANA {
+
+enum class ReplaySpeed {
+  Original, // Frames are fed as far apart as they were sampled
+  Fast,     // As fast as the collectors take them
+};
+
+// Where a replay spent its time, in nanoseconds
+struct ReplayStats {
+  size_t CpuFrames{};
+  size_t MemoryFrames{};
+  size_t ProcessFrames{};
+  size_t Processes{}; // Over all process lists
+  uint64_t ElapsedNs{};
+  uint64_t CpuNs{};     // Mapping the items and queueing the sample
+  uint64_t MemoryNs{};  // Publishing and recording
+  uint64_t ProcessNs{}; // Table update, load calculation, publishing and
+                        // recording
+};
+
+// Feeds the frames of a sample trace to CpuPerformance, MemoryPerformance
+// and ProcessManager in the order they were recorded. The collectors must
+// have been started while SystemRuntime::IsReplaying() was set, so that the
+// scheduler does not sample the OS in between; frames of a collector that is
+// not running are skipped.
+class SampleReplay {
+public:
+  bool Open(const std::string &path);
+
+  // Replays the whole trace on the calling thread, or until stop is set, and
+  // returns once the collectors have processed every frame
+  ReplayStats Run(ReplaySpeed speed, const std::atomic<bool> *stop = nullptr);
+
+private:
+  SampleTraceReader mReader{};
+  TraceFrame mFrame{};
+};
+
+} // namespace RESANA
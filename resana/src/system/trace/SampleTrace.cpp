@@ -0,0 +1,477 @@
+#include "SampleTrace.h"
+#include "rspch.h"
+
+#include "system/history/HistoryFormat.h"
+
+#include <cstring>
+#include <string_view>
+
+namespace RESANA {
+
+namespace {
+
+constexpr char TRACE_MAGIC[8] = {'R', 'S', 'T', 'R', 'A', 'C', 'E', 0};
+constexpr uint32_t TRACE_VERSION = 1;
+constexpr size_t TRACE_HEADER_BYTES = 16;
+
+// Status fields of a process, then its counters
+constexpr size_t STATUS_FIELDS = 5;
+constexpr size_t METRICS_FIELDS = 9;
+constexpr size_t PROCESS_FIELDS = STATUS_FIELDS + METRICS_FIELDS;
+constexpr size_t CREATION_TIME_FIELD = 4;
+constexpr size_t MEMORY_FIELDS = 7 + METRICS_FIELDS;
+
+// What a process record holds besides its status
+enum ProcessFlags : uint8_t {
+  PROCESS_NEW = 1, // Not in the previous list, or its pid was reused
+  PROCESS_NAME = 2,
+  PROCESS_COMMAND_LINE = 4,
+  PROCESS_METRICS = 8,
+};
+
+void AppendVarint(std::vector<uint8_t> &out, const uint64_t value) {
+  uint8_t buffer[10];
+  out.insert(out.end(), buffer, buffer + PutVarint(buffer, value));
+}
+
+void AppendString(std::vector<uint8_t> &out, const std::string_view text) {
+  AppendVarint(out, text.size());
+  out.insert(out.end(), text.begin(), text.end());
+}
+
+// Writes each field as the change since previous, and keeps it there
+void AppendDeltas(std::vector<uint8_t> &out, const uint64_t *fields,
+                  uint64_t *previous, const size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    AppendVarint(out, ZigZagEncode((int64_t)(fields[i] - previous[i])));
+    previous[i] = fields[i];
+  }
+}
+
+bool ReadVarint(const uint8_t *&data, const uint8_t *end, uint64_t &value) {
+  const size_t length = GetVarint(data, end, value);
+  data += length;
+  return length != 0;
+}
+
+bool ReadString(const uint8_t *&data, const uint8_t *end, std::string &text) {
+  uint64_t length;
+  if (!ReadVarint(data, end, length) || length > (uint64_t)(end - data)) {
+    return false;
+  }
+  text.assign((const char *)data, length);
+  data += length;
+  return true;
+}
+
+bool ReadDeltas(const uint8_t *&data, const uint8_t *end, uint64_t *previous,
+                const size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    uint64_t delta;
+    if (!ReadVarint(data, end, delta)) {
+      return false;
+    }
+    previous[i] += (uint64_t)ZigZagDecode(delta);
+  }
+  return true;
+}
+
+void GetMetricsFields(const ProcessMetrics &metrics, uint64_t *fields) {
+  fields[0] = metrics.Time;
+  fields[1] = metrics.CreationTime;
+  fields[2] = metrics.UserTime;
+  fields[3] = metrics.SystemTime;
+  fields[4] = metrics.WorkingSetSize;
+  fields[5] = metrics.PrivateUsage;
+  fields[6] = metrics.ReadBytes;
+  fields[7] = metrics.WriteBytes;
+  fields[8] = metrics.ThreadCount;
+}
+
+void SetMetricsFields(const uint64_t *fields, ProcessMetrics &metrics) {
+  metrics.Time = fields[0];
+  metrics.CreationTime = fields[1];
+  metrics.UserTime = fields[2];
+  metrics.SystemTime = fields[3];
+  metrics.WorkingSetSize = fields[4];
+  metrics.PrivateUsage = fields[5];
+  metrics.ReadBytes = fields[6];
+  metrics.WriteBytes = fields[7];
+  metrics.ThreadCount = (uint32_t)fields[8];
+}
+
+} // namespace
+
+SampleTraceWriter::~SampleTraceWriter() { Close(); }
+
+bool SampleTraceWriter::Open(const std::string &path) {
+  Close();
+
+  std::lock_guard lock(mMutex);
+  mFile = std::fopen(path.c_str(), "wb");
+  if (!mFile) {
+    RS_CORE_ERROR("Could not create the sample trace {0}", path);
+    return false;
+  }
+
+  uint8_t header[TRACE_HEADER_BYTES]{};
+  std::memcpy(header, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+  std::memcpy(header + sizeof(TRACE_MAGIC), &TRACE_VERSION,
+              sizeof(TRACE_VERSION));
+  std::fwrite(header, 1, sizeof(header), mFile);
+  mBytes = sizeof(header);
+
+  mCpuBits.clear();
+  mCpuNamed = false;
+  mMemoryFields.assign(MEMORY_FIELDS, 0);
+  mProcessStates.clear();
+  return true;
+}
+
+void SampleTraceWriter::Close() {
+  std::lock_guard lock(mMutex);
+  if (mFile) {
+    std::fclose(mFile);
+    mFile = nullptr;
+  }
+}
+
+uint64_t SampleTraceWriter::GetBytes() const {
+  std::lock_guard lock(mMutex);
+  return mBytes;
+}
+
+void SampleTraceWriter::WriteCpu(const int64_t time, const PdhItem *items,
+                                 const PdhSize count,
+                                 const bool layoutChanged) {
+  const bool named = layoutChanged || !mCpuNamed || count != mCpuBits.size();
+  mCpuPayload.clear();
+  AppendVarint(mCpuPayload, count);
+  mCpuPayload.push_back(named ? 1 : 0);
+  if (named) {
+    for (PdhSize i = 0; i < count; ++i) {
+      AppendString(mCpuPayload, items[i].szName ? items[i].szName : "");
+    }
+    mCpuBits.assign(count, 0);
+    mCpuNamed = true;
+  }
+
+  uint8_t buffer[9];
+  for (PdhSize i = 0; i < count; ++i) {
+    const uint64_t bits = DoubleToBits(items[i].FmtValue.doubleValue);
+    mCpuPayload.insert(mCpuPayload.end(), buffer,
+                       buffer + EncodeXor(buffer, bits ^ mCpuBits[i]));
+    mCpuBits[i] = bits;
+  }
+  WriteFrame(TraceFrameKind::Cpu, time, mCpuPayload);
+}
+
+void SampleTraceWriter::WriteMemory(const int64_t time,
+                                    const MemoryStatus &status,
+                                    const ProcessMetrics &self) {
+  const uint64_t fields[MEMORY_FIELDS - METRICS_FIELDS] = {
+      status.TotalPhys,     status.AvailPhys,    status.TotalPageFile,
+      status.AvailPageFile, status.TotalVirtual, status.AvailVirtual,
+      status.MemoryLoad};
+  uint64_t metrics[METRICS_FIELDS];
+  GetMetricsFields(self, metrics);
+
+  mMemoryPayload.clear();
+  AppendDeltas(mMemoryPayload, fields, mMemoryFields.data(),
+               MEMORY_FIELDS - METRICS_FIELDS);
+  AppendDeltas(mMemoryPayload, metrics,
+               mMemoryFields.data() + MEMORY_FIELDS - METRICS_FIELDS,
+               METRICS_FIELDS);
+  WriteFrame(TraceFrameKind::Memory, time, mMemoryPayload);
+}
+
+void SampleTraceWriter::BeginProcesses(const int64_t time) {
+  mProcessTime = time;
+  mNumProcesses = 0;
+}
+
+TraceProcess &SampleTraceWriter::AddProcess() {
+  if (mNumProcesses == mProcesses.size()) {
+    mProcesses.emplace_back();
+  }
+
+  auto &process = mProcesses[mNumProcesses++];
+  process.HasCommandLine = false;
+  process.HasMetrics = false;
+  return process;
+}
+
+void SampleTraceWriter::EndProcesses(const bool complete) {
+  if (!complete || !IsOpen()) {
+    return;
+  }
+
+  mProcessPayload.clear();
+  ++mProcessSerial;
+  for (size_t i = 0; i < mNumProcesses; ++i) {
+    EncodeProcess(mProcesses[i]);
+  }
+
+  // The reader forgets the processes that exited at the same point
+  for (auto it = mProcessStates.begin(); it != mProcessStates.end();) {
+    it = it->second.Serial != mProcessSerial ? mProcessStates.erase(it)
+                                             : std::next(it);
+  }
+  WriteFrame(TraceFrameKind::Processes, mProcessTime, mProcessPayload);
+}
+
+void SampleTraceWriter::EncodeProcess(const TraceProcess &process) {
+  auto [it, added] = mProcessStates.try_emplace(process.Id);
+  auto &state = it->second;
+
+  uint8_t flags = 0;
+  if (added || state.Fields[CREATION_TIME_FIELD] != process.CreationTime) {
+    flags |= PROCESS_NEW;
+    state.Fields.assign(PROCESS_FIELDS, 0);
+    state.Name.clear();
+  }
+  if (process.Name != state.Name) {
+    flags |= PROCESS_NAME;
+  }
+  if (process.HasCommandLine) {
+    flags |= PROCESS_COMMAND_LINE;
+  }
+  if (process.HasMetrics) {
+    flags |= PROCESS_METRICS;
+  }
+  state.Serial = mProcessSerial;
+
+  uint64_t fields[PROCESS_FIELDS] = {process.ParentId, process.ThreadCount,
+                                     process.PriorityClass,
+                                     (uint64_t)(uint8_t)process.State,
+                                     process.CreationTime};
+  GetMetricsFields(process.Metrics, fields + STATUS_FIELDS);
+
+  AppendVarint(mProcessPayload, process.Id);
+  mProcessPayload.push_back(flags);
+  AppendDeltas(mProcessPayload, fields, state.Fields.data(), STATUS_FIELDS);
+  if (flags & PROCESS_METRICS) {
+    AppendDeltas(mProcessPayload, fields + STATUS_FIELDS,
+                 state.Fields.data() + STATUS_FIELDS, METRICS_FIELDS);
+  }
+  if (flags & PROCESS_NAME) {
+    AppendString(mProcessPayload, process.Name);
+    state.Name = process.Name;
+  }
+  if (flags & PROCESS_COMMAND_LINE) {
+    AppendString(mProcessPayload, process.CommandLine);
+  }
+}
+
+void SampleTraceWriter::WriteFrame(const TraceFrameKind kind,
+                                   const int64_t time,
+                                   const std::vector<uint8_t> &payload) {
+  uint8_t header[21];
+  size_t length = 0;
+  header[length++] = (uint8_t)kind;
+  length += PutVarint(header + length, ZigZagEncode(time));
+  length += PutVarint(header + length, payload.size());
+
+  std::lock_guard lock(mMutex);
+  if (!mFile) {
+    return;
+  }
+  std::fwrite(header, 1, length, mFile);
+  std::fwrite(payload.data(), 1, payload.size(), mFile);
+  mBytes += length + payload.size();
+}
+
+bool SampleTraceReader::Open(const std::string &path) {
+  Close();
+  if (!mFile.Open(path, MappedFile::Access::ReadOnly)) {
+    return false;
+  }
+
+  uint32_t version = 0;
+  if (mFile.GetSize() >= TRACE_HEADER_BYTES) {
+    std::memcpy(&version, mFile.GetData() + sizeof(TRACE_MAGIC),
+                sizeof(version));
+  }
+  if (version != TRACE_VERSION ||
+      std::memcmp(mFile.GetData(), TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0) {
+    RS_CORE_ERROR("{0} is not a sample trace", path);
+    mFile.Close();
+    return false;
+  }
+
+  Rewind();
+  return true;
+}
+
+void SampleTraceReader::Close() {
+  mFile.Close();
+  mPosition = 0;
+}
+
+void SampleTraceReader::Rewind() {
+  mPosition = TRACE_HEADER_BYTES;
+  mCpuNames.clear();
+  mCpuBits.clear();
+  mMemoryFields.assign(MEMORY_FIELDS, 0);
+  mProcessStates.clear();
+}
+
+bool SampleTraceReader::Next(TraceFrame &frame) {
+  if (!IsOpen()) {
+    return false;
+  }
+
+  const uint8_t *data = mFile.GetData() + mPosition;
+  const uint8_t *end = mFile.GetData() + mFile.GetSize();
+  if (data >= end) {
+    return false;
+  }
+
+  const auto kind = (TraceFrameKind)*data++;
+  uint64_t time;
+  uint64_t length;
+  if (!ReadVarint(data, end, time) || !ReadVarint(data, end, length) ||
+      length > (uint64_t)(end - data)) {
+    // The recording stopped in the middle of a frame
+    return false;
+  }
+
+  frame.Kind = kind;
+  frame.Time = ZigZagDecode(time);
+  const uint8_t *payloadEnd = data + length;
+  bool read = false;
+  switch (kind) {
+  case TraceFrameKind::Cpu:
+    read = ReadCpu(data, payloadEnd, frame);
+    break;
+  case TraceFrameKind::Memory:
+    read = ReadMemory(data, payloadEnd, frame);
+    break;
+  case TraceFrameKind::Processes:
+    read = ReadProcesses(data, payloadEnd, frame);
+    break;
+  }
+  if (!read) {
+    RS_CORE_ERROR("Malformed sample trace frame at offset {0}", mPosition);
+    return false;
+  }
+
+  mPosition = (size_t)(payloadEnd - mFile.GetData());
+  return true;
+}
+
+bool SampleTraceReader::ReadCpu(const uint8_t *data, const uint8_t *end,
+                                TraceFrame &frame) {
+  uint64_t count;
+  if (!ReadVarint(data, end, count) || data >= end ||
+      count > (uint64_t)(end - data)) {
+    return false;
+  }
+
+  frame.LayoutChanged = *data++ != 0;
+  if (frame.LayoutChanged) {
+    mCpuNames.resize(count);
+    for (auto &name : mCpuNames) {
+      if (!ReadString(data, end, name)) {
+        return false;
+      }
+    }
+    mCpuBits.assign(count, 0);
+  } else if (count != mCpuNames.size()) {
+    return false;
+  }
+
+  frame.Items.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    uint64_t xored;
+    const size_t length = DecodeXor(data, end, xored);
+    if (!length) {
+      return false;
+    }
+    data += length;
+    mCpuBits[i] ^= xored;
+
+    auto &item = frame.Items[i];
+    item.szName = mCpuNames[i].data();
+    item.FmtValue.CStatus = 0;
+    item.FmtValue.doubleValue = BitsToDouble(mCpuBits[i]);
+  }
+  return data == end;
+}
+
+bool SampleTraceReader::ReadMemory(const uint8_t *data, const uint8_t *end,
+                                   TraceFrame &frame) {
+  if (!ReadDeltas(data, end, mMemoryFields.data(), MEMORY_FIELDS)) {
+    return false;
+  }
+
+  const uint64_t *fields = mMemoryFields.data();
+  auto &status = frame.Memory;
+  status.TotalPhys = fields[0];
+  status.AvailPhys = fields[1];
+  status.TotalPageFile = fields[2];
+  status.AvailPageFile = fields[3];
+  status.TotalVirtual = fields[4];
+  status.AvailVirtual = fields[5];
+  status.MemoryLoad = (uint32_t)fields[6];
+  SetMetricsFields(fields + MEMORY_FIELDS - METRICS_FIELDS, frame.Self);
+  return data == end;
+}
+
+bool SampleTraceReader::ReadProcesses(const uint8_t *data, const uint8_t *end,
+                                      TraceFrame &frame) {
+  ++mProcessSerial;
+  frame.NumProcesses = 0;
+  while (data < end) {
+    uint64_t id;
+    if (!ReadVarint(data, end, id) || data >= end) {
+      return false;
+    }
+    const uint8_t flags = *data++;
+
+    auto &state = mProcessStates[(uint32_t)id];
+    if (flags & PROCESS_NEW) {
+      state.Fields.assign(PROCESS_FIELDS, 0);
+      state.Name.clear();
+    } else if (state.Fields.size() != PROCESS_FIELDS) {
+      return false;
+    }
+    state.Serial = mProcessSerial;
+
+    if (!ReadDeltas(data, end, state.Fields.data(), STATUS_FIELDS) ||
+        ((flags & PROCESS_METRICS) &&
+         !ReadDeltas(data, end, state.Fields.data() + STATUS_FIELDS,
+                     METRICS_FIELDS)) ||
+        ((flags & PROCESS_NAME) && !ReadString(data, end, state.Name))) {
+      return false;
+    }
+
+    if (frame.NumProcesses == frame.Processes.size()) {
+      frame.Processes.emplace_back();
+    }
+    auto &process = frame.Processes[frame.NumProcesses++];
+    const uint64_t *fields = state.Fields.data();
+    process.Id = (uint32_t)id;
+    process.ParentId = (uint32_t)fields[0];
+    process.ThreadCount = (uint32_t)fields[1];
+    process.PriorityClass = (uint32_t)fields[2];
+    process.State = (char)fields[3];
+    process.CreationTime = fields[4];
+    process.Name = state.Name;
+    process.HasCommandLine = (flags & PROCESS_COMMAND_LINE) != 0;
+    if (process.HasCommandLine &&
+        !ReadString(data, end, process.CommandLine)) {
+      return false;
+    }
+    process.HasMetrics = (flags & PROCESS_METRICS) != 0;
+    SetMetricsFields(fields + STATUS_FIELDS, process.Metrics);
+  }
+
+  for (auto it = mProcessStates.begin(); it != mProcessStates.end();) {
+    it = it->second.Serial != mProcessSerial ? mProcessStates.erase(it)
+                                             : std::next(it);
+  }
+  return true;
+}
+
+} // namespace RESANA
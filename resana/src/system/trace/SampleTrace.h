@@ -0,0 +1,160 @@
+#pragma once
+
+#include "system/cpu/LogicalCoreData.h"
+#include "system/history/MappedFile.h"
+#include "system/memory/MemoryPerformance.h"
+#include "system/processes/ProcessMetrics.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace RESANA {
+
+// A sample trace holds what the samplers read from the OS, before any of it
+// is processed: the per-core items, the memory counters and the process
+// lists with every process's counters. Replaying one (SampleReplay) runs the
+// same processing on the same input every time.
+//
+// The file is a header and then frames, each a kind byte, the time varint,
+// the payload length varint and the payload. Counters are written as zig-zag
+// varints of their change since the previous frame (per process for the
+// process lists) and core loads XORed with the previous ones, so a frame of
+// a quiet machine is a few bytes per process.
+
+enum class TraceFrameKind : uint8_t { Cpu = 1, Memory = 2, Processes = 3 };
+
+// One process of a process list, as the sampler listed it
+struct TraceProcess {
+  uint32_t Id{};
+  uint32_t ParentId{};
+  uint32_t ThreadCount{};
+  uint32_t PriorityClass{};
+  char State{};
+  uint64_t CreationTime{}; // As given to ProcessTable::Acquire
+  std::string Name{};
+  std::string CommandLine{};   // Only read for new processes
+  bool HasCommandLine = false;
+  bool HasMetrics = false; // False if the counters could not be read
+  ProcessMetrics Metrics{};
+};
+
+// A frame as read back. The buffers are reused from frame to frame.
+struct TraceFrame {
+  TraceFrameKind Kind{};
+  int64_t Time{}; // Time::GetTime() when it was sampled
+
+  // Cpu; the item names point into the reader
+  std::vector<PdhItem> Items{};
+  bool LayoutChanged = false; // The items are not the previous frame's
+
+  // Memory
+  MemoryStatus Memory{};
+  ProcessMetrics Self{}; // This process
+
+  // Processes; only the first NumProcesses are this frame's
+  std::vector<TraceProcess> Processes{};
+  size_t NumProcesses{};
+};
+
+// Appends frames to a trace file. Each kind of frame comes from one sampler
+// thread; frames of different kinds may be written at the same time.
+class SampleTraceWriter {
+public:
+  SampleTraceWriter() = default;
+  ~SampleTraceWriter();
+
+  SampleTraceWriter(const SampleTraceWriter &) = delete;
+  SampleTraceWriter &operator=(const SampleTraceWriter &) = delete;
+
+  // Truncates the file
+  bool Open(const std::string &path);
+  void Close();
+  [[nodiscard]] bool IsOpen() const { return mFile != nullptr; }
+  [[nodiscard]] uint64_t GetBytes() const;
+
+  // layoutChanged is set when the items are not the previous sample's
+  void WriteCpu(int64_t time, const PdhItem *items, PdhSize count,
+                bool layoutChanged);
+  void WriteMemory(int64_t time, const MemoryStatus &status,
+                   const ProcessMetrics &self);
+
+  // A process list is written as a whole by EndProcesses(true); a scan that
+  // failed half way is dropped with EndProcesses(false)
+  void BeginProcesses(int64_t time);
+  // A record to fill in, reused from earlier lists
+  TraceProcess &AddProcess();
+  void EndProcesses(bool complete);
+
+private:
+  struct ProcessState {
+    std::vector<uint64_t> Fields{};
+    std::string Name{};
+    uint32_t Serial{};
+  };
+
+  void WriteFrame(TraceFrameKind kind, int64_t time,
+                  const std::vector<uint8_t> &payload);
+  void EncodeProcess(const TraceProcess &process);
+
+private:
+  mutable std::mutex mMutex{}; // Over the file
+  std::FILE *mFile = nullptr;
+  uint64_t mBytes{};
+
+  std::vector<uint8_t> mCpuPayload{};
+  std::vector<uint64_t> mCpuBits{};
+  bool mCpuNamed = false; // Names are written with the first frame
+
+  std::vector<uint8_t> mMemoryPayload{};
+  std::vector<uint64_t> mMemoryFields{};
+
+  std::vector<uint8_t> mProcessPayload{};
+  std::vector<TraceProcess> mProcesses{};
+  size_t mNumProcesses{};
+  int64_t mProcessTime{};
+  std::unordered_map<uint32_t, ProcessState> mProcessStates{}; // By pid
+  uint32_t mProcessSerial{};
+};
+
+// Reads a trace file through a read-only mapping
+class SampleTraceReader {
+public:
+  bool Open(const std::string &path);
+  void Close();
+  [[nodiscard]] bool IsOpen() const { return mFile.GetData() != nullptr; }
+  [[nodiscard]] size_t GetSize() const { return mFile.GetSize(); }
+
+  // Reads the next frame into frame. False at the end of the trace, or at a
+  // frame that was cut short or is malformed.
+  bool Next(TraceFrame &frame);
+  // Back to the first frame
+  void Rewind();
+
+private:
+  struct ProcessState {
+    std::vector<uint64_t> Fields{};
+    std::string Name{};
+    uint32_t Serial{};
+  };
+
+  bool ReadCpu(const uint8_t *data, const uint8_t *end, TraceFrame &frame);
+  bool ReadMemory(const uint8_t *data, const uint8_t *end, TraceFrame &frame);
+  bool ReadProcesses(const uint8_t *data, const uint8_t *end,
+                     TraceFrame &frame);
+
+private:
+  MappedFile mFile{};
+  size_t mPosition{};
+
+  std::vector<std::string> mCpuNames{};
+  std::vector<uint64_t> mCpuBits{};
+  std::vector<uint64_t> mMemoryFields{};
+  std::unordered_map<uint32_t, ProcessState> mProcessStates{};
+  uint32_t mProcessSerial{};
+};
+
+} // namespace RESANA